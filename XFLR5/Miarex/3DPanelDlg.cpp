@@ -25,6 +25,7 @@
 #include "../main/MainFrm.h"
 #include "Miarex.h"
 #include ".\3dpaneldlg.h"
+#include "../misc/TaskPool.h"
 #include <math.h>
 
 
@@ -63,6 +64,17 @@ C3DPanelDlg::C3DPanelDlg(CWnd* pParent /*=NULL*/)
 
 	m_nWakeNodes = 0;
 	m_WakeSize   = 0;
+	m_nWorkers   = 0;
+	m_nRowsDone  = 0;
+
+	m_pFactorCache = NULL;
+	m_pFactors     = NULL;
+	m_GeomKey      = 0;
+
+	m_pFarFieldTheta = NULL;
+	m_pFFMu          = NULL;
+	m_pFFSigma       = NULL;
+	m_FFWakeMu       = NULL;
 
 	m_strOut = "";
 
@@ -88,14 +100,25 @@ C3DPanelDlg::C3DPanelDlg(CWnd* pParent /*=NULL*/)
 	m_pRefWakeNode  = NULL;
 	m_pTempWakeNode = NULL;
 
-	memset(m_Sigma,  0, sizeof(m_Sigma));
-	memset(m_Mu,     0, sizeof(m_Mu));
-	memset(m_Cp,     0, sizeof(m_Cp));
-	memset(m_Speed,  0, sizeof(m_Speed));
+	m_Sigma  = NULL;
+	m_Mu     = NULL;
+	m_Cp     = NULL;
+	m_Speed  = NULL;
+	m_ipiv   = NULL;
+	m_cosRHS = NULL;
+	m_sinRHS = NULL;
+
+	m_WakePHC           = NULL;
+	m_WakeVHC           = NULL;
+	m_WakeColumnDisp    = NULL;
+	m_bWakeColumnUpdate = NULL;
+	m_WakeDisp          = 0.0;
 }
 
 C3DPanelDlg::~C3DPanelDlg()
 {
+	ReleaseArrays();
+	ReleaseFarField();
 }
 
 void C3DPanelDlg::DoDataExchange(CDataExchange* pDX)
@@ -232,16 +255,23 @@ void C3DPanelDlg::Plot()
 		CString strOut;
 		CPanel Panel;
 
-		m_pNode[2*VLMMATSIZE-10].Set(  1.0,  1.0, 0.0);
-		m_pNode[2*VLMMATSIZE- 9].Set( -1.0,  1.0, 0.0);
-		m_pNode[2*VLMMATSIZE- 8].Set( -1.0, -1.0, 0.0);
-		m_pNode[2*VLMMATSIZE- 7].Set(  1.0, -1.0, 0.0);
-
-		Panel.SetFrame(m_pNode[2*VLMMATSIZE-10], m_pNode[2*VLMMATSIZE-9], m_pNode[2*VLMMATSIZE-8], m_pNode[2*VLMMATSIZE-7]);
-		Panel.m_iLA = 2*VLMMATSIZE-10;
-		Panel.m_iTA = 2*VLMMATSIZE- 9;
-		Panel.m_iTB = 2*VLMMATSIZE- 8;
-		Panel.m_iLB = 2*VLMMATSIZE- 7;
+		//use a temporary node array for the test panel
+		CVector Node[4];
+		CVector *pMemNode = m_pNode;
+		CVector *pMemPanelNode = CPanel::s_pNode;
+		m_pNode = Node;
+		CPanel::s_pNode = Node;
+
+		m_pNode[0].Set(  1.0,  1.0, 0.0);
+		m_pNode[1].Set( -1.0,  1.0, 0.0);
+		m_pNode[2].Set( -1.0, -1.0, 0.0);
+		m_pNode[3].Set(  1.0, -1.0, 0.0);
+
+		Panel.SetFrame(m_pNode[0], m_pNode[1], m_pNode[2], m_pNode[3]);
+		Panel.m_iLA = 0;
+		Panel.m_iTA = 1;
+		Panel.m_iTB = 2;
+		Panel.m_iLB = 3;
 		Panel.m_iPos = 1;
 		Panel.m_bIsLeading     = false;
 		Panel.m_bIsTrailing    = false;
@@ -262,11 +292,95 @@ void C3DPanelDlg::Plot()
 			Point += Inc;
 		}
 
+		m_pNode = pMemNode;
+		CPanel::s_pNode = pMemPanelNode;
 		XFile.Close();
 	}
 }
 
 
+bool C3DPanelDlg::SolverBenchmark(CString &strong)
+{
+	// Compares the row-by-row Gauss elimination with the blocked LU factorization
+	// for increasing matrix sizes up to LUBENCHSIZE, the former fixed matrix size
+	// The results are returned in strong and written to the file XFLR5_LU.txt in the temp directory
+	// Called from the advanced settings, while the dialog box is not displayed
+	CStdioFile XFile;
+	CFileException fe;
+	CString FileName, strOut;
+	LARGE_INTEGER Freq, t0, t1, t2;
+	int i, j, k, n;
+	int *ipiv;
+	double *A, *ALU, *B, *BLU;
+	double TGauss, TLU, res, maxres;
+	char szTempPath[MAX_PATH] = "";
+
+	GetTempPath(MAX_PATH, szTempPath);
+	FileName = szTempPath;
+	FileName += "XFLR5_LU.txt";
+
+	if(!XFile.Open(FileName, CFile::modeCreate | CFile::modeWrite, &fe)) return false;
+
+	m_bCancel = false;
+	QueryPerformanceFrequency(&Freq);
+	strong = "    Size      Gauss(s)     BlockLU(s)    Speed-up      Max residual\n";
+	XFile.WriteString(strong);
+
+	for (n=LUBENCHSIZE/8; n<=LUBENCHSIZE; n*=2)
+	{
+		ipiv = new int[n];
+		A   = new double[n*n];
+		ALU = new double[n*n];
+		B   = new double[3*n];// Gauss processes m+1 columns
+		BLU = new double[3*n];
+
+		//a random, diagonally dominant matrix, as are panel matrices
+		srand(1);
+		for (i=0; i<n; i++)
+		{
+			for (j=0; j<n; j++) A[i*n+j] = (double)rand()/(double)RAND_MAX - 0.5;
+			A[i*n+i] += 2.0*pi;
+			B[i] = B[i+n] = B[i+2*n] = (double)rand()/(double)RAND_MAX;
+		}
+		memcpy(ALU, A, n*n*sizeof(double));
+		memcpy(BLU, B, 3*n*sizeof(double));
+
+		m_Progress = 0;
+		QueryPerformanceCounter(&t0);
+		Gauss(A, n, B, 2, 0);
+		QueryPerformanceCounter(&t1);
+		LUFactor(ALU, n, ipiv, 0);
+		LUSolve(ALU, n, ipiv, BLU, 2);
+		QueryPerformanceCounter(&t2);
+
+		TGauss = (double)(t1.QuadPart-t0.QuadPart)/(double)Freq.QuadPart;
+		TLU    = (double)(t2.QuadPart-t1.QuadPart)/(double)Freq.QuadPart;
+
+		maxres = 0.0;
+		for (k=0; k<2; k++)
+		{
+			for (i=0; i<n; i++)
+			{
+				res = abs(B[i+k*n]-BLU[i+k*n]);
+				if(res>maxres) maxres = res;
+			}
+		}
+
+		strOut.Format("%8d   %11.4f    %11.4f    %8.2f      %12.4e\n", n, TGauss, TLU, TGauss/TLU, maxres);
+		XFile.WriteString(strOut);
+		strong += strOut;
+
+		delete [] ipiv;
+		delete [] A;
+		delete [] ALU;
+		delete [] B;
+		delete [] BLU;
+	}
+	XFile.Close();
+	return true;
+}
+
+
 void C3DPanelDlg::OnTimer(UINT nIDEvent)
 {
 	if(m_pPanelThread && m_pPanelThread->m_bFinished)
@@ -285,6 +399,28 @@ void C3DPanelDlg::OnTimer(UINT nIDEvent)
 
 bool C3DPanelDlg::StartPanelThread()
 {
+	// the results are processed by blocks of RHSBLOCK operating points
+	// so the memory does not depend on the number of points in the sequence
+	ReleaseArrays();
+	m_Sigma  = new double[m_MatSize*RHSBLOCK];
+	m_Mu     = new double[m_MatSize*RHSBLOCK];
+	m_Cp     = new double[m_MatSize*RHSBLOCK];
+	m_Speed  = new CVector[m_MatSize];
+	m_ipiv   = new int[m_MatSize];
+	m_cosRHS = new double[m_MatSize];
+	m_sinRHS = new double[m_MatSize];
+	memset(m_Sigma,  0, m_MatSize*RHSBLOCK*sizeof(double));
+	memset(m_Mu,     0, m_MatSize*RHSBLOCK*sizeof(double));
+	memset(m_Cp,     0, m_MatSize*RHSBLOCK*sizeof(double));
+	memset(m_cosRHS, 0, m_MatSize*sizeof(double));
+	memset(m_sinRHS, 0, m_MatSize*sizeof(double));
+
+	m_WakePHC           = new double[m_MatSize*m_NWakeColumn];
+	m_WakeVHC           = new CVector[m_MatSize*m_NWakeColumn];
+	m_WakeColumnDisp    = new double[m_NWakeColumn];
+	m_bWakeColumnUpdate = new bool[m_NWakeColumn];
+	InvalidateWakeColumns();
+
 	m_pPanelThread = new C3DPanelThread();
 
 	m_pPanelThread->m_pParent     = this;
@@ -306,6 +442,33 @@ bool C3DPanelDlg::StartPanelThread()
 	return true;
 }
 
+
+void C3DPanelDlg::ReleaseArrays()
+{
+	if(m_Sigma)  delete [] m_Sigma;
+	if(m_Mu)     delete [] m_Mu;
+	if(m_Cp)     delete [] m_Cp;
+	if(m_Speed)  delete [] m_Speed;
+	if(m_ipiv)   delete [] m_ipiv;
+	if(m_cosRHS) delete [] m_cosRHS;
+	if(m_sinRHS) delete [] m_sinRHS;
+	if(m_WakePHC)           delete [] m_WakePHC;
+	if(m_WakeVHC)           delete [] m_WakeVHC;
+	if(m_WakeColumnDisp)    delete [] m_WakeColumnDisp;
+	if(m_bWakeColumnUpdate) delete [] m_bWakeColumnUpdate;
+	m_Sigma  = NULL;
+	m_Mu     = NULL;
+	m_Cp     = NULL;
+	m_Speed  = NULL;
+	m_ipiv   = NULL;
+	m_cosRHS = NULL;
+	m_sinRHS = NULL;
+	m_WakePHC           = NULL;
+	m_WakeVHC           = NULL;
+	m_WakeColumnDisp    = NULL;
+	m_bWakeColumnUpdate = NULL;
+}
+
 void C3DPanelDlg::OnCancel()
 {
 	if(!m_pPanelThread) {
@@ -329,7 +492,8 @@ void C3DPanelDlg::OnCancel()
 
 void C3DPanelDlg::SetProgress(int TaskSize, double TaskProgress)
 {
-	m_ctrlProgress.SetPos(m_Progress+ (int)((double)TaskSize * TaskProgress));
+	// the solver benchmark runs while the dialog box is not displayed
+	if(m_ctrlProgress.GetSafeHwnd()) m_ctrlProgress.SetPos(m_Progress+ (int)((double)TaskSize * TaskProgress));
 }
 
 void C3DPanelDlg::EndSequence()
@@ -350,10 +514,13 @@ void C3DPanelDlg::EndSequence()
 	if (m_bCancel) 
 		AddString("\r\n\r\nAnalysis cancelled per user request....\r\n");
 
+	//the results have been stored in the operating points, release the block memory
+	ReleaseArrays();
+
 	pMiarex->m_bVLMFinished = true;
 	m_bXFile = false;
 	m_XFile.Close();
-	if(m_bWarning && pMiarex->m_bLogFile)
+	if(m_bWarning && pMiarex->m_bLogFile && !pMiarex->m_bBatch)
 	{
 		if(IDYES == AfxMessageBox("Some points were found outside the available flight envelope\r\nView the Log file for details ?", MB_YESNOCANCEL))
 		{
@@ -564,6 +731,28 @@ bool C3DPanelDlg::Gauss(double *A, int n, double *B, int m, int TaskSize)
 }
 
 
+bool C3DPanelDlg::LUFactor(double *A, int n, int *ipiv, int TaskSize)
+{
+	// Blocked LU factorization of the influence matrix, by column panels of LUBLOCK width
+	// The factors overwrite A, and may be used for any number of RHS with LUSolve
+	// Cancellation and progress are checked once per block
+	int k0;
+	double r;
+
+	for (k0=0; k0<n; k0+=LUBLOCK)
+	{
+		if(m_bCancel) break;
+		if(!LUFactorBlock(A, n, ipiv, k0, LUBLOCK)) return false;// the matrix A is singular
+		//the work left in the trailing matrix decreases as the cube of its size
+		r = 1.0 - (double)min(k0+LUBLOCK, n)/(double)n;
+		SetProgress(TaskSize, 1.0-r*r*r);
+	}
+
+	m_Progress += TaskSize;
+	return true;
+}
+
+
 void C3DPanelDlg::CheckSolution()
 {
 	//need to add wake contribution...
@@ -611,12 +800,25 @@ void C3DPanelDlg::CheckSolution()
 
 void C3DPanelDlg::GetSpeedVector(CVector const &C, double *Mu, double *Sigma, CVector &VT)
 {	
-	CVector V;
+	CVector V, CG;
 	int pp, pw, lw;
 	double phi, sign;
-	CVector Vw[MAXSTATIONS];
 	VT.Set(0.0,0.0,0.0);
 
+	if(m_FarField.IsBuilt() && Mu==m_pFFMu && Sigma==m_pFFSigma)
+	{
+		// the far-field cells are evaluated from their moments
+		m_FarField.GetSpeed(C, VT, FarFieldNearProc, this);
+		if(m_pWPolar->m_bGround) 
+		{
+			CG.Set(C.x, C.y, -C.z-2.0*m_pWPolar->m_Height);
+			m_FarField.GetSpeed(CG, V, FarFieldNearProc, this);
+			VT.x += V.x;
+			VT.y += V.y;
+			VT.z -= V.z;
+		}
+		return;
+	}
 
 	for (pp=0; pp<m_MatSize;pp++)
 	{
@@ -648,157 +850,344 @@ void C3DPanelDlg::GetSpeedVector(CVector const &C, double *Mu, double *Sigma, CV
 }
 
 
-bool C3DPanelDlg::CreateMatrix()
+bool C3DPanelDlg::BuildFarField(double *Mu, double *Sigma)
 {
-	CVector C, CC, V, VS;
-	int p, pp, Size;
-	double phi, phiSym;
+	// builds the octree of the panels and of the wake panels, for the strengths Mu and Sigma
+	// GetSpeedVector uses it until ReleaseFarField is called
+	// returns false if the user has requested the exact summation
+	int pp, pw, lw, nWake;
+	double sign, Source;
+	CVector Doublet;
 
-	AddString("    Creating the influence matrix...\r\n");
-	if(m_b3DSymetric) Size = m_MatSize/2;
-	else              Size = m_MatSize;
+	ReleaseFarField();
+	if(!m_pFarFieldTheta || *m_pFarFieldTheta<=0.0 || !Mu || !Sigma || m_MatSize<=0) return false;
 
-	for(p=0; p<Size; p++)
+	// each wake panel carries the sum of the strengths of the panels which shed its column
+	nWake = 0;
+	for (pp=0; pp<m_MatSize; pp++)
 	{
-		if(m_bCancel) return false;
-		//for each collocation point
-		C    = m_ppPanel[p]->CollPt;
-		CC   = m_ppPanel[p]->CollPt;//symmetric point, just in case
-		CC.y = -CC.y;
-
-		for(pp=0; pp<Size; pp++)
+		if(m_pPanel[pp].m_bIsTrailing && m_pPanel[pp].m_iWake+m_pWPolar->m_NXWakePanels>nWake)
+			nWake = m_pPanel[pp].m_iWake + m_pWPolar->m_NXWakePanels;
+	}
+	m_FFWakeMu = new double[nWake+1];
+	memset(m_FFWakeMu, 0, (nWake+1)*sizeof(double));
+	for (pp=0; pp<m_MatSize; pp++)
+	{
+		if(m_pPanel[pp].m_bIsTrailing)
 		{
-			if(m_bCancel) return false;
-			//for each panel, get the unit doublet influence at the coll pt
+			if(m_pPanel[pp].m_iPos == -1) sign = -1.0; else sign  = 1.0;
+			pw = m_pPanel[pp].m_iWake;
+			for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++) m_FFWakeMu[pw+lw] += Mu[pp]*sign;
+		}
+	}
 
-			GetDoubletInfluence(C, m_ppPanel[pp], V, phi);
+	m_FarField.Allocate(m_MatSize+nWake);
+	m_FarField.m_Theta = *m_pFarFieldTheta;
+	for (pp=0; pp<m_MatSize; pp++)
+	{
+		if(m_pPanel[pp].m_iPos!=0) Source = Sigma[pp] * m_pPanel[pp].Area;
+		else                       Source = 0.0;
+		Doublet.x = m_pPanel[pp].Normal.x * Mu[pp] * m_pPanel[pp].Area;
+		Doublet.y = m_pPanel[pp].Normal.y * Mu[pp] * m_pPanel[pp].Area;
+		Doublet.z = m_pPanel[pp].Normal.z * Mu[pp] * m_pPanel[pp].Area;
+		m_FarField.SetElement(pp, m_pPanel[pp].CollPt, m_pPanel[pp].Size, Source, Doublet);
+	}
+	for (pw=0; pw<nWake; pw++)
+	{
+		Doublet.x = m_pWakePanel[pw].Normal.x * m_FFWakeMu[pw] * m_pWakePanel[pw].Area;
+		Doublet.y = m_pWakePanel[pw].Normal.y * m_FFWakeMu[pw] * m_pWakePanel[pw].Area;
+		Doublet.z = m_pWakePanel[pw].Normal.z * m_FFWakeMu[pw] * m_pWakePanel[pw].Area;
+		m_FarField.SetElement(m_MatSize+pw, m_pWakePanel[pw].CollPt, m_pWakePanel[pw].Size, 0.0, Doublet);
+	}
+	m_FarField.Build();
 
-			if(m_b3DSymetric && !m_ppPanel[pp]->m_bIsInSymPlane) // add symmetric contribution
-			{
-				GetDoubletInfluence(CC, m_ppPanel[pp], VS, phiSym);
+	m_pFFMu    = Mu;
+	m_pFFSigma = Sigma;
+	return true;
+}
 
-				V.x += VS.x;
-				V.y -= VS.y;
-				V.z += VS.z;
 
-				phi += phiSym;
-			}
-			if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)   m_aijRef[p*Size+pp] = V.dot(m_ppPanel[p]->Normal);
-			else if(m_bDirichlet)	                       m_aijRef[p*Size+pp] = phi;
+void C3DPanelDlg::ReleaseFarField()
+{
+	m_FarField.Release();
+	if(m_FFWakeMu) delete [] m_FFWakeMu;
+	m_FFWakeMu = NULL;
+	m_pFFMu    = NULL;
+	m_pFFSigma = NULL;
+}
+
+
+void C3DPanelDlg::FarFieldNearProc(int iElement, CVector const &C, CVector &V, void *pParam)
+{
+	// the exact influence of a panel or of a wake panel in free air, used for the cells close to C
+	// re-entrant, may be called concurrently by several threads
+	C3DPanelDlg *pDlg = (C3DPanelDlg*)pParam;
+	CPanel *pPanel;
+	CVector VS;
+	double phi;
+
+	if(iElement<pDlg->m_MatSize)
+	{
+		pPanel = pDlg->m_pPanel + iElement;
+		pDlg->DoubletNASA4023(C, pPanel, V, phi);
+		V.x *= pDlg->m_pFFMu[iElement];
+		V.y *= pDlg->m_pFFMu[iElement];
+		V.z *= pDlg->m_pFFMu[iElement];
+		if(pPanel->m_iPos!=0)
+		{
+			pDlg->SourceNASA4023(C, pPanel, VS, phi);
+			V.x += VS.x * pDlg->m_pFFSigma[iElement];
+			V.y += VS.y * pDlg->m_pFFSigma[iElement];
+			V.z += VS.z * pDlg->m_pFFSigma[iElement];
 		}
-		SetProgress(15, (double)p/(double)Size);
+	}
+	else
+	{
+		iElement -= pDlg->m_MatSize;
+		pDlg->DoubletNASA4023(C, pDlg->m_pWakePanel+iElement, V, phi, true);
+		V.x *= pDlg->m_FFWakeMu[iElement];
+		V.y *= pDlg->m_FFWakeMu[iElement];
+		V.z *= pDlg->m_FFWakeMu[iElement];
+	}
+}
+
+
+bool C3DPanelDlg::CreateMatrix()
+{
+	// The rows are independent, and are built in parallel
+	// Each row is built by a single thread in the same order as a serial calculation,
+	// so that the matrix does not depend on the number of threads
+	int Size;
+
+	if(m_b3DSymetric) Size = m_MatSize/2;
+	else              Size = m_MatSize;
+
+	// new geometry, the wake influences of the previous one are no longer valid
+	InvalidateWakeColumns();
+
+	// If this geometry has already been solved, reuse its factors
+	// The wake is moved during roll-up, so the matrix changes at each iteration and is not cached
+	m_pFactors = NULL;
+	if(m_pFactorCache && !m_pWPolar->m_bWakeRollUp)
+	{
+		m_GeomKey  = GetGeometryKey();
+		m_pFactors = m_pFactorCache->Find(m_GeomKey, Size);
+	}
+	if(m_pFactors)
+	{
+		AddString("    Reusing the factorized influence matrix...\r\n");
+		m_Progress += 15;
+		return true;
 	}
 
+	AddString("    Creating the influence matrix...\r\n");
+	m_nRowsDone = 0;
+	CTaskPool::Run(Size, MatrixRowTask, this, m_nWorkers, &m_bCancel);
+	if(m_bCancel) return false;
+
 	m_Progress += 15;
 
 	return true;
 }
 
 
+void C3DPanelDlg::MatrixRowTask(int p, int iWorker, void *pParam)
+{
+	C3DPanelDlg *pDlg = (C3DPanelDlg*)pParam;
+	int Size;
+
+	if(pDlg->m_b3DSymetric) Size = pDlg->m_MatSize/2;
+	else                    Size = pDlg->m_MatSize;
+
+	pDlg->CreateMatrixRow(p);
+	InterlockedIncrement(&pDlg->m_nRowsDone);
+
+	//only the analysis thread reports to the dialog box
+	if(iWorker==0) pDlg->SetProgress(15, (double)pDlg->m_nRowsDone/(double)Size);
+}
+
+
+void C3DPanelDlg::CreateMatrixRow(int p)
+{
+	// Builds the row p of the influence matrix, i.e. the unit influence of all panels at the collocation point p
+	CVector C, CC, V, VS;
+	int pp, Size;
+	double phi, phiSym;
+
+	if(m_b3DSymetric) Size = m_MatSize/2;
+	else              Size = m_MatSize;
+
+	C    = m_ppPanel[p]->CollPt;
+	CC   = m_ppPanel[p]->CollPt;//symmetric point, just in case
+	CC.y = -CC.y;
+
+	for(pp=0; pp<Size; pp++)
+	{
+		if(m_bCancel) return;
+		//for each panel, get the unit doublet influence at the coll pt
+
+		GetDoubletInfluence(C, m_ppPanel[pp], V, phi);
+
+		if(m_b3DSymetric && !m_ppPanel[pp]->m_bIsInSymPlane) // add symmetric contribution
+		{
+			GetDoubletInfluence(CC, m_ppPanel[pp], VS, phiSym);
+
+			V.x += VS.x;
+			V.y -= VS.y;
+			V.z += VS.z;
+
+			phi += phiSym;
+		}
+		if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)   m_aijRef[p*Size+pp] = V.dot(m_ppPanel[p]->Normal);
+		else if(m_bDirichlet)	                       m_aijRef[p*Size+pp] = phi;
+	}
+}
+
+
 bool C3DPanelDlg::CreateRHS(double V0, double VDelta, int nval)
 {
 	//NASA 4023 equation (20) & (22)
-	int p, pp, q, m, Size;
-	double alpha, phi, phiSym;
-	CVector V, VS, C, CC;
-	CVector QInf[100];
+	int Size;
 
 	if(m_b3DSymetric) Size = m_MatSize/2;
 	else              Size = m_MatSize;
 
 	//compute with a unit speed
 	AddString("      Creating RHS vector...\r\n");
-	p=0;
 
+	if(!CreateSourceStrength(V0, VDelta, nval)) return false;
+
+	if(m_pFactors)
+	{
+		//the unit RHS are stored with the factors
+		m_Progress += 9;
+		return true;
+	}
+
+	m_nRowsDone = 0;
+	CTaskPool::Run(Size, RHSRowTask, this, m_nWorkers, &m_bCancel);
+	if(m_bCancel) return false;
+
+	m_Progress += 9 ;
+	return true;
+}
+
+
+bool C3DPanelDlg::CreateSourceStrength(double V0, double VDelta, int nval)
+{
+	// Sets the unit source strengths for nval angles of attack, in the m_ppPanel order
+	int p, pp, q;
+	double alpha;
+	CVector QInf;
+
+	p=0;
 	for (q=0; q<nval;q++)
 	{
 		alpha = V0+q*VDelta;
-		QInf[q].Set(cos(alpha*pi/180.0), 0.0, sin(alpha*pi/180.0));
+		QInf.Set(cos(alpha*pi/180.0), 0.0, sin(alpha*pi/180.0));
 
 		for (pp=0; pp< m_MatSize; pp++)
 		{
 			if(m_bCancel) return false;
 			if(m_ppPanel[pp]->m_iPos==0) m_Sigma[p] =  0.0;
-			else                         m_Sigma[p] = -1.0/4.0/pi* QInf[q].dot(m_ppPanel[pp]->Normal);
+			else                         m_Sigma[p] = -1.0/4.0/pi* QInf.dot(m_ppPanel[pp]->Normal);
 			p++;
 		}
 		SetProgress(1*nval, (double)q/(double)nval);
 	}
 	m_Progress += 1 * nval;
+	return true;
+}
+
+
+void C3DPanelDlg::RHSRowTask(int p, int iWorker, void *pParam)
+{
+	C3DPanelDlg *pDlg = (C3DPanelDlg*)pParam;
+	int Size;
+
+	if(pDlg->m_b3DSymetric) Size = pDlg->m_MatSize/2;
+	else                    Size = pDlg->m_MatSize;
+
+	pDlg->CreateRHSRow(p);
+	InterlockedIncrement(&pDlg->m_nRowsDone);
+
+	//only the analysis thread reports to the dialog box
+	if(iWorker==0) pDlg->SetProgress(9, (double)pDlg->m_nRowsDone/(double)Size);
+}
+
+
+void C3DPanelDlg::CreateRHSRow(int p)
+{
+	// Builds the unit cosine and sine RHS at the collocation point p
+	int pp, Size;
+	double phi, phiSym;
+	CVector V, VS, C, CC;
 
-	m = 0;
-	for (p=0; p<Size; p++)
+	if(m_b3DSymetric) Size = m_MatSize/2;
+	else              Size = m_MatSize;
+
+	if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0) 
 	{
-		if(m_bCancel) return false;
+		m_cosRHS[p] = - m_ppPanel[p]->Normal.x;
+		m_sinRHS[p] = - m_ppPanel[p]->Normal.z;
+	}
+	else if(m_bDirichlet) 
+	{
+		m_cosRHS[p] = 0.0;
+		m_sinRHS[p] = 0.0;
+	}
+
+	C.x    =  m_ppPanel[p]->CollPt.x; 
+	C.y    =  m_ppPanel[p]->CollPt.y; 
+	C.z    =  m_ppPanel[p]->CollPt.z; 
+	CC.x   =  m_ppPanel[p]->CollPt.x; //symetric point, just in case
+	CC.y   = -m_ppPanel[p]->CollPt.y; 
+	CC.z   =  m_ppPanel[p]->CollPt.z; 
+	for (pp=0; pp<Size; pp++)
+	{
+		if(m_ppPanel[pp]->m_iPos!=0) GetSourceInfluence(C, *(m_ppPanel+pp), V, phi);
+		else
+		{
+			//sigma is zero on a thin surface
+			V.Set(0.0, 0.0, 0.0);
+			phi = 0.0;
+		}
 
 		if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0) 
+
 		{
-			m_cosRHS[m] = - m_ppPanel[p]->Normal.x;
-			m_sinRHS[m] = - m_ppPanel[p]->Normal.z;
+			m_cosRHS[p] -= V.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.x * -1.0/4.0/pi;
+			m_sinRHS[p] -= V.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.z * -1.0/4.0/pi;
 		}
-		else if(m_bDirichlet) 
+		else if(m_bDirichlet)
 		{
-			m_cosRHS[m] = 0.0;
-			m_sinRHS[m] = 0.0;
+			m_cosRHS[p] -= phi * m_ppPanel[pp]->Normal.x * -1.0/4.0/pi;
+			m_sinRHS[p] -= phi * m_ppPanel[pp]->Normal.z * -1.0/4.0/pi;
 		}
-
-		C.x    =  m_ppPanel[p]->CollPt.x; 
-		C.y    =  m_ppPanel[p]->CollPt.y; 
-		C.z    =  m_ppPanel[p]->CollPt.z; 
-		CC.x   =  m_ppPanel[p]->CollPt.x; //symetric point, just in case
-		CC.y   = -m_ppPanel[p]->CollPt.y; 
-		CC.z   =  m_ppPanel[p]->CollPt.z; 
-		for (pp=0; pp<Size; pp++)
+		if(m_b3DSymetric && !m_ppPanel[pp]->m_bIsInSymPlane) // add right wing contribution
 		{
-			if(m_ppPanel[pp]->m_iPos!=0) GetSourceInfluence(C, *(m_ppPanel+pp), V, phi);
+			if(m_ppPanel[pp]->m_iPos!=0)	GetSourceInfluence(CC, *(m_ppPanel+pp), VS, phiSym);
 			else
 			{
 				//sigma is zero on a thin surface
-				V.Set(0.0, 0.0, 0.0);
-				phi = 0.0;
+				VS.Set(0.0, 0.0, 0.0);
+				phiSym = 0.0;
 			}
 
+			VS.y = -VS.y;
+						
 			if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0) 
-
 			{
-				m_cosRHS[m] -= V.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.x * -1.0/4.0/pi;
-				m_sinRHS[m] -= V.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.z * -1.0/4.0/pi;
+				m_cosRHS[p] -= VS.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.x;
+				m_sinRHS[p] -= VS.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.z;
 			}
 			else if(m_bDirichlet)
 			{
-				m_cosRHS[m] -= phi * m_ppPanel[pp]->Normal.x * -1.0/4.0/pi;
-				m_sinRHS[m] -= phi * m_ppPanel[pp]->Normal.z * -1.0/4.0/pi;
-			}
-			if(m_b3DSymetric && !m_ppPanel[pp]->m_bIsInSymPlane) // add right wing contribution
-			{
-				if(m_ppPanel[pp]->m_iPos!=0)	GetSourceInfluence(CC, *(m_ppPanel+pp), VS, phiSym);
-				else
-				{
-					//sigma is zero on a thin surface
-					VS.Set(0.0, 0.0, 0.0);
-					phiSym = 0.0;
-				}
-
-				VS.y = -VS.y;
-							
-				if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0) 
-				{
-					m_cosRHS[m] -= VS.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.x;
-					m_sinRHS[m] -= VS.dot(m_ppPanel[p]->Normal) * m_ppPanel[pp]->Normal.z;
-				}
-				else if(m_bDirichlet)
-				{
-					m_cosRHS[m] -= phiSym * m_ppPanel[pp]->Normal.x * -1.0/4.0/pi;
-					m_sinRHS[m] -= phiSym * m_ppPanel[pp]->Normal.z * -1.0/4.0/pi;
-				}
+				m_cosRHS[p] -= phiSym * m_ppPanel[pp]->Normal.x * -1.0/4.0/pi;
+				m_sinRHS[p] -= phiSym * m_ppPanel[pp]->Normal.z * -1.0/4.0/pi;
 			}
 		}
-		m++;
-		SetProgress(9, (double)m/(double)(nval*Size));
 	}
-
-	m_Progress += 9 ;
-	return true;
 }
 
 bool C3DPanelDlg::CreateWakeContribution()
@@ -809,15 +1198,20 @@ bool C3DPanelDlg::CreateWakeContribution()
 	//	- add the wake's doublet contribution to the matrix
 	//	- add the potential difference at the trailing edge panels to the RHS
 	//______________________________________________________________________________________
+	// The rows are independent, and are built in parallel
+	// The influences of the wake columns which have not moved since the last iteration are reused
+
+	int kw, Size, nUpdate;
+	double Tolerance = WAKETOLERANCE * m_pWing->m_Span;
+	CString str;
+
+	if(m_pFactors)
+	{
+		//already included in the cached factors
+		m_Progress += 2;
+		return true;
+	}
 
-	int kw, lw, pw, p, pp;
-	int Size;
-	CVector V, VS, C, CC;
-	double phi, phiSym;
-	double Delta_phi_inf = 0.0;
-	double PHC[MAXSTATIONS];
-	CVector VHC[MAXSTATIONS];
-	CMiarex *pMiarex = (CMiarex*)m_pMiarex;
 	AddString("      Adding the wake's contribution...\r\n");
 
 	if(m_b3DSymetric)	Size = m_MatSize/2;
@@ -825,111 +1219,210 @@ bool C3DPanelDlg::CreateWakeContribution()
 
 	memcpy(m_aij, m_aijRef, m_MatSize * m_MatSize * sizeof(double));
 
-	for(p=0; p<Size; p++)//for each matrix row 
+	nUpdate = 0;
+	for (kw=0; kw<m_NWakeColumn; kw++)
 	{
-		if(m_bCancel) return false;
+		if(m_WakeColumnDisp[kw]<0.0 || m_WakeColumnDisp[kw]>Tolerance)
+		{
+			m_bWakeColumnUpdate[kw] = true;
+			m_WakeColumnDisp[kw]    = 0.0;
+			nUpdate++;
+		}
+		else m_bWakeColumnUpdate[kw] = false;
+	}
+	if(nUpdate<m_NWakeColumn)
+	{
+		str.Format("      Re-evaluating %d wake columns out of %d\r\n", nUpdate, m_NWakeColumn);
+		AddString(str);
+	}
 
-		C    = m_ppPanel[p]->CollPt;
-		CC.x =  C.x;//symmetric point, just in case
-		CC.y = -C.y;
-		CC.z =  C.z;
+	m_nRowsDone = 0;
+	CTaskPool::Run(Size, WakeRowTask, this, m_nWorkers, &m_bCancel);
+	if(m_bCancel) return false;
 
-		//____________________________________________________________________________
-		//build the contributions of each wake column at point C
-		//we have m_NWakeColum to consider
-		pw=0;
-		for (kw=0; kw<m_NWakeColumn; kw++)
+	m_Progress += 2;
+	return true;
+}
+
+
+void C3DPanelDlg::WakeRowTask(int p, int iWorker, void *pParam)
+{
+	C3DPanelDlg *pDlg = (C3DPanelDlg*)pParam;
+	int Size;
+
+	if(pDlg->m_b3DSymetric) Size = pDlg->m_MatSize/2;
+	else                    Size = pDlg->m_MatSize;
+
+	pDlg->CreateWakeContributionRow(p);
+	InterlockedIncrement(&pDlg->m_nRowsDone);
+
+	//only the analysis thread reports to the dialog box
+	if(iWorker==0) pDlg->SetProgress(2, (double)pDlg->m_nRowsDone/(double)Size);
+}
+
+
+void C3DPanelDlg::CreateWakeContributionRow(int p)
+{
+	// adds the contributions of the wake columns to matrix row p and to the RHS
+	// only row p is written, so that the rows may be built concurrently
+	int kw, lw, pw, pp;
+	int Size;
+	CVector V, VS, C, CC;
+	double phi, phiSym;
+
+	if(m_b3DSymetric)	Size = m_MatSize/2;
+	else				Size = m_MatSize;
+
+	//one potential and one speed per wake column, kept from one wake iteration to the next
+	double *PHC  = m_WakePHC + p*m_NWakeColumn;
+	CVector *VHC = m_WakeVHC + p*m_NWakeColumn;
+
+	C    = m_ppPanel[p]->CollPt;
+	CC.x =  C.x;//symmetric point, just in case
+	CC.y = -C.y;
+	CC.z =  C.z;
+
+	//____________________________________________________________________________
+	//build the contributions of each wake column at point C
+	//we have m_NWakeColum to consider
+	for (kw=0; kw<m_NWakeColumn; kw++)
+	{
+		if(!m_bWakeColumnUpdate[kw]) continue;
+
+		PHC[kw] = 0.0;
+		VHC[kw].Set(0.0,0.0,0.0);
+		//each wake column has m_NXWakePanels
+		pw = kw*m_pWPolar->m_NXWakePanels;
+		for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
 		{
-			PHC[kw] = 0.0;
-			VHC[kw].Set(0.0,0.0,0.0);
-			//each wake column has m_NXWakePanels
-			for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
+			GetDoubletInfluence(C,  m_pWakePanel+pw, V, phi, true);
+			PHC[kw] += phi;
+			VHC[kw] += V;
+
+			if(m_b3DSymetric && !m_pWakePanel[pw].m_bIsInSymPlane) // add right wing contribution
 			{
-				GetDoubletInfluence(C,  m_pWakePanel+pw, V, phi, true);
-				PHC[kw] += phi;
-				VHC[kw] += V;
+				GetDoubletInfluence(CC,  m_pWakePanel+pw, VS, phiSym, true);
 
-				if(m_b3DSymetric && !m_pWakePanel[pw].m_bIsInSymPlane) // add right wing contribution
-				{
-					GetDoubletInfluence(CC,  m_pWakePanel+pw, VS, phiSym, true);
-	
-					PHC[kw]    +=  phiSym;
-					VHC[kw].x  +=  VS.x;
-					VHC[kw].y  -=  VS.y;
-					VHC[kw].z  +=  VS.z;
-				}
-				pw++;
+				PHC[kw]    +=  phiSym;
+				VHC[kw].x  +=  VS.x;
+				VHC[kw].y  -=  VS.y;
+				VHC[kw].z  +=  VS.z;
 			}
+			pw++;
 		}
+	}
 
-		//____________________________________________________________________________
-		//Add the contributions to the matrix coefficients and to the RHS
+	//____________________________________________________________________________
+	//Add the contributions to the matrix coefficients and to the RHS
 
-		for(pp=0; pp<Size; pp++) //for each matrix column
+	for(pp=0; pp<Size; pp++) //for each matrix column
+	{
+		// Is the panel pp shedding a wake ?
+		if(m_ppPanel[pp]->m_bIsTrailing)
 		{
-			if(m_bCancel) return false;
+			//If so, we need to add the contributions of the wake column shedded by this panel to the RHS and to the Matrix
 
-			// Is the panel pp shedding a wake ?
-			if(m_ppPanel[pp]->m_bIsTrailing)
+			if(m_ppPanel[pp]->m_iPos == 0)
 			{
-				//If so, we need to add the contributions of the wake column shedded by this panel to the RHS and to the Matrix
-
-				if(m_ppPanel[pp]->m_iPos == 0)
+				//The panel shedding a wake is on a thin surface
+				if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)
 				{
-					//The panel shedding a wake is on a thin surface
-					if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)
-					{
-						//then add the velocity contribution of the wake column to the matrix coefficient
-						m_aij[p*Size+pp] += VHC[m_ppPanel[pp]->m_iWakeColumn].dot(m_ppPanel[p]->Normal);
-						//we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
-					}
-					else if(m_bDirichlet)
-					{
-						//then add the potential contribution of the wake column to the matrix coefficient
-						m_aij[p*Size+pp] += PHC[m_ppPanel[pp]->m_iWakeColumn];
-						//we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
-					}
+					//then add the velocity contribution of the wake column to the matrix coefficient
+					m_aij[p*Size+pp] += VHC[m_ppPanel[pp]->m_iWakeColumn].dot(m_ppPanel[p]->Normal);
+					//we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
 				}
-				else if(m_ppPanel[pp]->m_iPos == -1)//bottom side, substract
+				else if(m_bDirichlet)
 				{
-					if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)					 
-					{
-						//use Neumann B.C.
-						m_aij[p*Size+pp] -= VHC[m_ppPanel[pp]->m_iWakeColumn].dot(m_ppPanel[p]->Normal);
-						m_cosRHS[p] -= m_ppPanel[pp]->CollPt.x  * VHC[m_ppPanel[pp]->m_iWakeColumn].x * m_ppPanel[p]->Normal.x;
-						m_sinRHS[p] -= m_ppPanel[pp]->CollPt.z  * VHC[m_ppPanel[pp]->m_iWakeColumn].z * m_ppPanel[p]->Normal.z;
-					}
-					else if(m_bDirichlet)
-					{
-						m_aij[p*Size+pp] -= PHC[m_ppPanel[pp]->m_iWakeColumn];
-						m_cosRHS[p] +=  m_ppPanel[pp]->CollPt.x * PHC[m_ppPanel[pp]->m_iWakeColumn];
-						m_sinRHS[p] +=  m_ppPanel[pp]->CollPt.z * PHC[m_ppPanel[pp]->m_iWakeColumn];
-					}
+					//then add the potential contribution of the wake column to the matrix coefficient
+					m_aij[p*Size+pp] += PHC[m_ppPanel[pp]->m_iWakeColumn];
+					//we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
 				}
-				else if(m_ppPanel[pp]->m_iPos == 1)  //top side, add
+			}
+			else if(m_ppPanel[pp]->m_iPos == -1)//bottom side, substract
+			{
+				if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)					 
 				{
-					if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)
-					{
-						//use Neumann B.C.
-						m_aij[p*Size+pp] += VHC[m_ppPanel[pp]->m_iWakeColumn].dot(m_ppPanel[p]->Normal);
-						m_cosRHS[p] += m_ppPanel[pp]->CollPt.x * VHC[m_ppPanel[pp]->m_iWakeColumn].x * m_ppPanel[p]->Normal.x;
-						m_sinRHS[p] += m_ppPanel[pp]->CollPt.z * VHC[m_ppPanel[pp]->m_iWakeColumn].z * m_ppPanel[p]->Normal.z;
-					}
-					else if(m_bDirichlet)
-					{
-						m_aij[p*Size+pp] += PHC[m_ppPanel[pp]->m_iWakeColumn];
-						m_cosRHS[p] -= m_ppPanel[pp]->CollPt.x * PHC[m_ppPanel[pp]->m_iWakeColumn];
-						m_sinRHS[p] -= m_ppPanel[pp]->CollPt.z * PHC[m_ppPanel[pp]->m_iWakeColumn];
-					}
-				} 
+					//use Neumann B.C.
+					m_aij[p*Size+pp] -= VHC[m_ppPanel[pp]->m_iWakeColumn].dot(m_ppPanel[p]->Normal);
+					m_cosRHS[p] -= m_ppPanel[pp]->CollPt.x  * VHC[m_ppPanel[pp]->m_iWakeColumn].x * m_ppPanel[p]->Normal.x;
+					m_sinRHS[p] -= m_ppPanel[pp]->CollPt.z  * VHC[m_ppPanel[pp]->m_iWakeColumn].z * m_ppPanel[p]->Normal.z;
+				}
+				else if(m_bDirichlet)
+				{
+					m_aij[p*Size+pp] -= PHC[m_ppPanel[pp]->m_iWakeColumn];
+					m_cosRHS[p] +=  m_ppPanel[pp]->CollPt.x * PHC[m_ppPanel[pp]->m_iWakeColumn];
+					m_sinRHS[p] +=  m_ppPanel[pp]->CollPt.z * PHC[m_ppPanel[pp]->m_iWakeColumn];
+				}
+			}
+			else if(m_ppPanel[pp]->m_iPos == 1)  //top side, add
+			{
+				if(!m_bDirichlet || m_ppPanel[p]->m_iPos==0)
+				{
+					//use Neumann B.C.
+					m_aij[p*Size+pp] += VHC[m_ppPanel[pp]->m_iWakeColumn].dot(m_ppPanel[p]->Normal);
+					m_cosRHS[p] += m_ppPanel[pp]->CollPt.x * VHC[m_ppPanel[pp]->m_iWakeColumn].x * m_ppPanel[p]->Normal.x;
+					m_sinRHS[p] += m_ppPanel[pp]->CollPt.z * VHC[m_ppPanel[pp]->m_iWakeColumn].z * m_ppPanel[p]->Normal.z;
+				}
+				else if(m_bDirichlet)
+				{
+					m_aij[p*Size+pp] += PHC[m_ppPanel[pp]->m_iWakeColumn];
+					m_cosRHS[p] -= m_ppPanel[pp]->CollPt.x * PHC[m_ppPanel[pp]->m_iWakeColumn];
+					m_sinRHS[p] -= m_ppPanel[pp]->CollPt.z * PHC[m_ppPanel[pp]->m_iWakeColumn];
+				}
 			} 
-		}
-
-		SetProgress(2, (double)p/(double)Size);
+		} 
 	}
-	m_Progress += 2;
+}
 
-	return true;
+
+unsigned __int64 C3DPanelDlg::GetGeometryKey()
+{
+	// Returns a hash of all the data the influence matrix and the unit RHS depend upon
+	// i.e. the analysis settings, the panels in the matrix order, and the wake
+	int p, pw;
+	CPanel *pPanel;
+	unsigned __int64 Key = CFactorCache::InitKey();
+
+	CFactorCache::AddToKey(Key, 'P');// distinguish from VLM matrices
+	CFactorCache::AddToKey(Key, m_MatSize);
+	CFactorCache::AddToKey(Key, m_b3DSymetric);
+	CFactorCache::AddToKey(Key, m_bDirichlet);
+	CFactorCache::AddToKey(Key, *m_pCoreSize);
+	CFactorCache::AddToKey(Key, m_pWPolar->m_bGround);
+	CFactorCache::AddToKey(Key, m_pWPolar->m_Height);
+	CFactorCache::AddToKey(Key, m_pWPolar->m_NXWakePanels);
+	CFactorCache::AddToKey(Key, m_NWakeColumn);
+	CFactorCache::AddToKey(Key, m_WakeSize);
+
+	for(p=0; p<m_MatSize; p++)
+	{
+		pPanel = m_ppPanel[p];
+		CFactorCache::AddToKey(Key, pPanel->m_iPos);
+		CFactorCache::AddToKey(Key, pPanel->m_iWake);
+		CFactorCache::AddToKey(Key, pPanel->m_iWakeColumn);
+		CFactorCache::AddToKey(Key, pPanel->m_bIsTrailing);
+		CFactorCache::AddToKey(Key, pPanel->m_bIsInSymPlane);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iLA]);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iLB]);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iTA]);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iTB]);
+		CFactorCache::AddToKey(Key, pPanel->CollPt);
+		CFactorCache::AddToKey(Key, pPanel->Normal);
+		CFactorCache::AddToKey(Key, pPanel->A);
+		CFactorCache::AddToKey(Key, pPanel->B);
+	}
+
+	for(pw=0; pw<m_WakeSize; pw++)
+	{
+		pPanel = m_pWakePanel+pw;
+		CFactorCache::AddToKey(Key, pPanel->m_bIsInSymPlane);
+		CFactorCache::AddToKey(Key, m_pWakeNode[pPanel->m_iLA]);
+		CFactorCache::AddToKey(Key, m_pWakeNode[pPanel->m_iLB]);
+		CFactorCache::AddToKey(Key, m_pWakeNode[pPanel->m_iTA]);
+		CFactorCache::AddToKey(Key, m_pWakeNode[pPanel->m_iTB]);
+	}
+
+	return Key;
 }
 
 
@@ -944,7 +1437,7 @@ bool C3DPanelDlg::SolveMultiple(double V0, double VDelta, int nval)
 	//	- Sort results i.a.w. panel numbering
 	//______________________________________________________________________________________
 
-	int Size, nrhs, q, o, p, nel;
+	int Size, nrhs, p;
 
 	if(m_b3DSymetric) 
 	{
@@ -960,18 +1453,36 @@ bool C3DPanelDlg::SolveMultiple(double V0, double VDelta, int nval)
 	if(m_pWPolar->m_Type!=4) nrhs = nval;
 	else                     nrhs = 0;
 
-	memcpy(m_RHS,      m_cosRHS, Size * sizeof(double));
-	memcpy(m_RHS+Size, m_sinRHS, Size * sizeof(double));
-
 //double row[VLMMATSIZE]; memcpy(row, m_aij, sizeof(row));
 
-	if(!Gauss(m_aij, Size, m_RHS, 2, 30))
+	if(m_pFactors)
 	{
-		AddString("      Singular Matrix.... Aborting calculation...\r\n");
-		m_bConverged = false;
-		return false;
+		// same geometry as a previous analysis, only back-substitute
+		memcpy(m_RHS, m_pFactors->m_pRHS, 2 * Size * sizeof(double));
+		LUSolve(m_pFactors->m_pLU, Size, m_pFactors->m_pipiv, m_RHS, 2);
+		m_bConverged = true;
+		m_Progress += 30;
+	}
+	else
+	{
+		memcpy(m_RHS,      m_cosRHS, Size * sizeof(double));
+		memcpy(m_RHS+Size, m_sinRHS, Size * sizeof(double));
+
+		if(!LUFactor(m_aij, Size, m_ipiv, 30))
+		{
+			AddString("      Singular Matrix.... Aborting calculation...\r\n");
+			m_bConverged = false;
+			return false;
+		}
+		else m_bConverged = true;
+
+		if(m_bCancel) return true;
+
+		if(m_pFactorCache && !m_pWPolar->m_bWakeRollUp)
+			m_pFactorCache->Store(m_GeomKey, Size, m_aij, m_ipiv, m_RHS, 2);
+
+		LUSolve(m_aij, Size, m_ipiv, m_RHS, 2);
 	}
-	else m_bConverged = true;
 
 	memcpy(m_cosRHS, m_RHS,      Size * sizeof(double));
 	memcpy(m_sinRHS, m_RHS+Size, Size * sizeof(double));
@@ -1008,9 +1519,30 @@ bool C3DPanelDlg::SolveMultiple(double V0, double VDelta, int nval)
 		}
 	}
 
-//	reconstruct all results from cosine and sine unit vectors
-	int m;
+	CombineUnitSolutions(V0, VDelta, nval);
+
+//	CheckSolution();
+//	return false;
+	return true;
+}
+
+
+void C3DPanelDlg::CombineUnitSolutions(double V0, double VDelta, int nval)
+{
+	//______________________________________________________________________________________
+	// Method : 
+	// 	- Reconstruct the doublet strengths for nval angles of attack
+	//	  from the cosine and sine unit solutions
+	//	- Sort the doublet and source strengths i.a.w. panel numbering
+	// The unit solutions are left unchanged, so that the method may be called 
+	// again for the next block of angles without solving the system again
+	//______________________________________________________________________________________
+
+	int p, q, m, o, nel;
 	double alpha, cosa, sina;
+	double *SigmaRef = m_aij;//use existing reserved memory, do not re-allocate
+
+//	reconstruct all results from cosine and sine unit vectors
 	m=0;
 	for (q=0; q<nval;q++)
 	{
@@ -1041,10 +1573,6 @@ bool C3DPanelDlg::SolveMultiple(double V0, double VDelta, int nval)
 			m_Sigma[o+nel]    = SigmaRef[o+p];
 		}
 	}
-
-//	CheckSolution();
-//	return false;
-	return true;
 }
 
 
@@ -1449,81 +1977,55 @@ bool C3DPanelDlg::ComputePlane(double Alpha, int qrhs)
 void C3DPanelDlg::RelaxWake()
 {
 	CMiarex *pMiarex = (CMiarex*)m_pMiarex;
-	CVector V, VL, VT;
-	int mw, kw, lw, llw;
-	int nInter;
-	double t, dx, dx0;
-	double damping = 1.0;
-	double *Mu    = m_Mu   ;
-	double *Sigma = m_Sigma;
-
-	//Since the wake roll-up is performed on the tilted geometry,
-	// we define a speed vector parallel to the x-axis
-	CVector QInf(m_QInf, 0.0, 0.0);
+	int mw, kw, lw, NX;
+	double d, dmax;
+	CString str;
 
 	// Andre's method : fit the wake panels on the streamlines
 	// we have the computing power to do it
 
-	CVector LATB, TALB, Trans, PP;
-	CVector WLA, WLB,WTA,WTB, WTemp;//wake panel's leading corner points
-
-	dx0 = 0.05;
+	CVector LATB, TALB;
+	CVector WLA, WLB,WTA,WTB;//wake panel's leading corner points
 
 	AddString("      Relaxing the wake...\r\n");
 
-	memcpy(m_pTempWakeNode, m_pWakeNode, m_nWakeNodes * sizeof(CVector));
-
-	for (lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
-	{
-		if(m_bCancel) break;
-		for (kw=0; kw<m_NWakeColumn; kw++)
-		{
-			if(m_bCancel) break;
-
-			mw = kw * m_pWPolar->m_NXWakePanels + lw;
-			//left point
-			WLA.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iLA]);
-			WTA.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iTA]);
-			WTemp.Copy(WLA);
+	// the wake geometry and the speed field are frozen during the pass,
+	// so that the octree remains valid and the columns may be relaxed independently
+	BuildFarField(m_Mu, m_Sigma);
 
-			nInter = (int)((WTA.x - WLA.x)/dx0) ;
-			dx = (WTA.x - WLA.x)/nInter;
-			
-			for (llw=0; llw<nInter; llw++)
-			{
-				GetSpeedVector(WTemp, Mu, Sigma, VL);
-				VL += QInf;
-				VL.Normalize();
-				t = dx/VL.x;
-				WTemp.x += dx;
-				WTemp.y += VL.y * t;
-				WTemp.z += VL.z * t;
-			}
-			m_pTempWakeNode[m_pWakePanel[mw].m_iTA] = WTemp;
-		}
-		//finally do the same for the right side of the last right column
+	memcpy(m_pTempWakeNode, m_pWakeNode, m_nWakeNodes * sizeof(CVector));
 
-		WLB.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iLB]);
-		WTB.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iTB]);
-		WTemp.Copy(WLB);
+	// one task per streamline, i.e. the left side of each column, and the right side of the last one
+	m_nRowsDone = 0;
+	CTaskPool::Run(m_NWakeColumn+1, WakeSideTask, this, m_nWorkers, &m_bCancel);
+	m_Progress +=20;
+	ReleaseFarField();
+	if(m_bCancel) return;
 
-		nInter = (int)((WTB.x - WLB.x)/dx0);
-		dx = (WTB.x - WLB.x)/nInter;
-		
-		for (llw=0; llw<nInter; llw++)
+	// measure how far each wake column has moved
+	NX = m_pWPolar->m_NXWakePanels;
+	m_WakeDisp = 0.0;
+	for (kw=0; kw<m_NWakeColumn; kw++)
+	{
+		dmax = 0.0;
+		for (lw=0; lw<NX; lw++)
 		{
-			GetSpeedVector(WTemp, Mu, Sigma, VL);
-			VL += QInf;
-			VL.Normalize();
-			t = dx/VL.x;
-			WTemp.x += dx;
-			WTemp.y += VL.y * t;
-			WTemp.z += VL.z * t;
+			mw = kw*NX + lw;
+			d = (m_pTempWakeNode[m_pWakePanel[mw].m_iLA] - m_pWakeNode[m_pWakePanel[mw].m_iLA]).VAbs();
+			if(d>dmax) dmax = d;
+			d = (m_pTempWakeNode[m_pWakePanel[mw].m_iLB] - m_pWakeNode[m_pWakePanel[mw].m_iLB]).VAbs();
+			if(d>dmax) dmax = d;
+			d = (m_pTempWakeNode[m_pWakePanel[mw].m_iTA] - m_pWakeNode[m_pWakePanel[mw].m_iTA]).VAbs();
+			if(d>dmax) dmax = d;
+			d = (m_pTempWakeNode[m_pWakePanel[mw].m_iTB] - m_pWakeNode[m_pWakePanel[mw].m_iTB]).VAbs();
+			if(d>dmax) dmax = d;
 		}
-		m_pTempWakeNode[m_pWakePanel[mw].m_iTB] = WTemp;
-		SetProgress(20, (double)lw/(double)m_pWPolar->m_NXWakePanels);
+		//accumulated until the column's influence is re-evaluated
+		m_WakeColumnDisp[kw] += dmax;
+		if(dmax>m_WakeDisp) m_WakeDisp = dmax;
 	}
-	m_Progress +=20;
+	str.Format("      Max. wake node displacement = %g m\r\n", m_WakeDisp);
+	AddString(str);
 
 	// Paste the new wake nodes back into the wake node array
 	memcpy(m_pWakeNode, m_pTempWakeNode, m_nWakeNodes * sizeof(CVector));
@@ -1556,8 +2058,92 @@ void C3DPanelDlg::RelaxWake()
 	pMiarex->UpdateView();
 }
 
+
+void C3DPanelDlg::WakeSideTask(int kw, int iWorker, void *pParam)
+{
+	C3DPanelDlg *pDlg = (C3DPanelDlg*)pParam;
+
+	pDlg->RelaxWakeSide(kw);
+	InterlockedIncrement(&pDlg->m_nRowsDone);
+
+	//only the analysis thread reports to the dialog box
+	if(iWorker==0) pDlg->SetProgress(20, (double)pDlg->m_nRowsDone/(double)(pDlg->m_NWakeColumn+1));
+}
+
+
+void C3DPanelDlg::RelaxWakeSide(int kw)
+{
+	// fits the left side of wake column kw on the streamline issued from its leading point
+	// kw=m_NWakeColumn is the right side of the last column
+	// writes only the trailing nodes of this side, so that the sides may be relaxed concurrently
+	CVector VL, WL, WT, WTemp;
+	int mw, lw, llw, NX, iL, iT;
+	int nInter;
+	double t, dx, dx0;
+
+	//Since the wake roll-up is performed on the tilted geometry,
+	// we define a speed vector parallel to the x-axis
+	CVector QInf(m_QInf, 0.0, 0.0);
+
+	dx0 = 0.05;
+	NX  = m_pWPolar->m_NXWakePanels;
+
+	for (lw=0; lw<NX; lw++)
+	{
+		if(m_bCancel) return;
+
+		if(kw<m_NWakeColumn)
+		{
+			mw = kw * NX + lw;
+			iL = m_pWakePanel[mw].m_iLA;
+			iT = m_pWakePanel[mw].m_iTA;
+		}
+		else
+		{
+			mw = (m_NWakeColumn-1) * NX + lw;
+			iL = m_pWakePanel[mw].m_iLB;
+			iT = m_pWakePanel[mw].m_iTB;
+		}
+
+		WL.Copy(m_pTempWakeNode[iL]);
+		WT.Copy(m_pTempWakeNode[iT]);
+		WTemp.Copy(WL);
+
+		nInter = (int)((WT.x - WL.x)/dx0);
+		if(nInter<1) nInter = 1;
+		dx = (WT.x - WL.x)/nInter;
+
+		for (llw=0; llw<nInter; llw++)
+		{
+			GetSpeedVector(WTemp, m_Mu, m_Sigma, VL);
+			VL += QInf;
+			VL.Normalize();
+			t = dx/VL.x;
+			WTemp.x += dx;
+			WTemp.y += VL.y * t;
+			WTemp.z += VL.z * t;
+		}
+		m_pTempWakeNode[iT] = WTemp;
+	}
+}
+
+
+void C3DPanelDlg::InvalidateWakeColumns()
+{
+	// forces the re-evaluation of all the wake column influences at the next call to CreateWakeContribution
+	// to be called each time the geometry or the wake are reset
+	int kw;
+	if(!m_WakeColumnDisp) return;
+	for (kw=0; kw<m_NWakeColumn; kw++) m_WakeColumnDisp[kw] = -1.0;
+}
+
+
 void C3DPanelDlg::GetDoubletInfluence(CVector const &TestPt, CPanel *pPanel, CVector &V, double &phi, bool bWake)
 {
+	// Re-entrant, may be called concurrently by the threads building the matrix
+	CVector VG, CG;
+	double phiG;
+
 	DoubletNASA4023(TestPt, pPanel, V, phi, bWake);
 
 	if(m_pWPolar->m_bGround) 
@@ -1573,6 +2159,10 @@ void C3DPanelDlg::GetDoubletInfluence(CVector const &TestPt, CPanel *pPanel, CVe
 
 void C3DPanelDlg::GetSourceInfluence(CVector const &TestPt, CPanel *pPanel, CVector &V, double &phi)
 {
+	// Re-entrant, may be called concurrently by the threads building the matrix
+	CVector VG, CG;
+	double phiG;
+
 	SourceNASA4023(TestPt, pPanel, V, phi);
 
 	if(m_pWPolar->m_bGround) 
@@ -1592,7 +2182,11 @@ void C3DPanelDlg::DoubletNASA4023(CVector const &C, CPanel *pPanel, CVector &V,
 	// Influence of panel pp at coll pt of panel p
 	// vectorial operations are written inline to save computing times
 	// -->longer code, but 4x more efficient....
+	// all temporaries are local, so that the function may run concurrently in several threads
 	int i;
+	double side, sign, GL;
+	double RNUM, DNOM, PN, A, B, PA, PB, SM, SL, AM, AL, Al, pjk, CJKi;
+	CVector R[5], PJK, a, b, s, T1, h;
 	double CoreSize = 0.00000;
 	if(abs(*m_pCoreSize)>1.e-10) CoreSize = *m_pCoreSize;
 	CVector *pNode;
@@ -1754,7 +2348,12 @@ void C3DPanelDlg::SourceNASA4023(CVector const &C, CPanel *pPanel, CVector &V, d
 	//Influence of panel pp at coll pt of panel p
 	//vectorial operations are written inline to save computing times
 	//-->longer code, but 4x more efficient....
+	//all temporaries are local, so that the function may run concurrently in several threads
 	int i;
+	double side, sign, S;
+	double RNUM, DNOM, PN, A, B, PA, PB, SM, SL, AM, AL, Al, pjk, CJKi;
+	double GL = 0.0;
+	CVector R[5], PJK, a, b, s, T1, T2, T, h;
 	double CoreSize = 0.00000;
 	if(abs(*m_pCoreSize)>1.e-10) CoreSize = *m_pCoreSize;
 
@@ -2291,9 +2890,10 @@ bool C3DPanelDlg::ComputeSurfSpeeds(double *Mu, double *Sigma)
 	CVector C;
 	CVector Q(m_3DQInf[0]*cos(m_Alpha*pi/180.0),0.0,m_3DQInf[0]*sin(m_Alpha*pi/180.0));
 
+	BuildFarField(Mu, Sigma);
 	for (p=0; p<m_MatSize; p++)
 	{
-		if(m_bCancel) return false;
+		if(m_bCancel) break;
 		C = m_pPanel[p].CollPt;//+ m_pPanel[p].Normal*m_pPanel[p].Size/100.0;
 		C += m_pPanel[p].Normal*0.001;
 
@@ -2301,7 +2901,8 @@ bool C3DPanelDlg::ComputeSurfSpeeds(double *Mu, double *Sigma)
 		m_Speed[p] += Q;
 
 	}
-	return true;
+	ReleaseFarField();
+	return !m_bCancel;
 }
 
 
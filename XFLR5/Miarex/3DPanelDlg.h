@@ -24,6 +24,8 @@
 #include "Wing.h"
 #include "WPolar.h"
 #include "3DPanelThread.h"
+#include "FactorCache.h"
+#include "FarField.h"
   
 #include "afxwin.h"
  
@@ -35,6 +37,7 @@ class C3DPanelDlg : public CDialog
 	friend class CWing;
 	friend class CWingDlg;
 	friend class C3DPanelThread;
+	friend class CWAdvDlg;
 
 public:
 	C3DPanelDlg(CWnd* pParent = NULL);   // constructeur standard
@@ -56,23 +59,34 @@ protected:
 	bool ComputeAeroCoefs(double V0, double VDelta, int nrhs);
 	bool ComputeOnBody(int q, double Alpha);
 	bool ComputePlane(double Alpha, int qrhs);
+	bool BuildFarField(double *Mu, double *Sigma);
 	bool ComputeSurfSpeeds(double *Mu, double *Sigma);
 	bool CreateDoubletStrength(double V0, double VDelta, int nval);
 	bool CreateMatrix();
 	bool CreateRHS(double V0, double VDelta, int nval);
+	bool CreateSourceStrength(double V0, double VDelta, int nval);
+	void CreateMatrixRow(int p);
+	void CreateRHSRow(int p);
 	bool CreateWakeContribution();
+	void CreateWakeContributionRow(int p);
+	void InvalidateWakeColumns();
 	bool Gauss(double *A, int n, double *B, int m, int TaskSize);
+	bool LUFactor(double *A, int n, int *ipiv, int TaskSize);
 	bool StartPanelThread();
 	bool SolveMultiple(double V0, double VDelta, int nval);
+	unsigned __int64 GetGeometryKey();
 
 	void AddString(CString strong);
 	void CheckSolution();
+	void CombineUnitSolutions(double V0, double VDelta, int nval);
 	void DoubletNASA4023(CVector const &C, CPanel *pPanel, CVector &V, double &phi, bool bWake=false);
 	void EndSequence();
 	void GetDoubletInfluence(CVector const &TestPt, CPanel *pPanel, CVector &V, double &phi, bool bWake=false);
 	void GetSourceInfluence(CVector const &TestPt, CPanel *pPanel, CVector &V, double &phi);
 	void GetSpeedVector(CVector const &C, double *Mu, double *Sigma, CVector &VT);
 	void RelaxWake();
+	void RelaxWakeSide(int kw);
+	void ReleaseFarField();
 	void SetProgress(int TaskSize,double TaskProgress);
 	void SetFileHeader();
 	void SourceNASA4023(CVector const &C, CPanel *pPanel, CVector &V, double &phi);
@@ -81,18 +95,27 @@ protected:
 	void SumPanelForces(double *Cp, double Alpha, double Qinf, double &Lift, double &Drag);
 	void VLMQmn(CVector LA, CVector LB, CVector TA, CVector TB, CVector C, CVector &V);
 
+	static void FarFieldNearProc(int iElement, CVector const &C, CVector &V, void *pParam);
+	static void MatrixRowTask(int p, int iWorker, void *pParam);
+	static void RHSRowTask(int p, int iWorker, void *pParam);
+	static void WakeRowTask(int p, int iWorker, void *pParam);
+	static void WakeSideTask(int kw, int iWorker, void *pParam);
+
 	void Plot();
+	bool SolverBenchmark(CString &strong);
+	void ReleaseArrays();
 
 	double *m_aij, *m_aijRef;
 	double *m_RHS;
 	double *m_RHSRef;
 
-	double m_Sigma[VLMMATSIZE*100];			// Source strengths
-	double m_Mu[VLMMATSIZE*100];			// Doublet strengths
-	double m_Cp[VLMMATSIZE*100];			// lift coef per panel
-	double m_3DQInf[100];
+	// the results for a block of operating points, allocated for the duration of the analysis
+	double *m_Sigma;			// Source strengths
+	double *m_Mu;				// Doublet strengths
+	double *m_Cp;				// lift coef per panel
+	double m_3DQInf[RHSBLOCK];
 
-	CVector m_Speed[VLMMATSIZE];
+	CVector *m_Speed;
 
 	CStdioFile m_XFile;
 
@@ -132,23 +155,41 @@ protected:
 
 	int m_nWakeNodes;
 	int m_WakeSize;	
+	int m_nWorkers;			// the number of threads used to build the matrices, 0 for one per processor
+	volatile LONG m_nRowsDone;	// the number of matrix rows built so far
 	int m_NWakeColumn;
 	int m_WakeInterNodes;
 	int m_MaxWakeIter;
 
 	double *m_pCoreSize;
+	double *m_pFarFieldTheta;	// the opening ratio of the octree, 0 for the exact summation
+
+	// the octree of the panels and wake panels, built for the strengths m_pFFMu and m_pFFSigma
+	CFarField m_FarField;
+	double *m_pFFMu, *m_pFFSigma;
+	double *m_FFWakeMu;		// the doublet strengths of the wake panels, summed over the panels which shed them
 
-	double side, sign, dist, S, GL;
-	double RNUM, DNOM, PN, A, B, PA, PB, SM, SL, AM, AL, Al, pjk, CJKi;
 	double ftmp, Omega, r1v, r2v;
 	CVector R[5], r0, r1, r2, Psi, t;
-	CVector PJK, a, b, s, T1, T2, T, h;
 
 	CString m_strOut;
 	CString m_VersionName;
 
-	double m_row[VLMMATSIZE];
-	double m_cosRHS[VLMMATSIZE], m_sinRHS[VLMMATSIZE];
+	// the per-panel arrays, sized to m_MatSize for the duration of the analysis
+	int *m_ipiv;		// the row interchanges of the LU factorization
+	double *m_cosRHS, *m_sinRHS;
+
+	// the influences of each wake column at each collocation point, sized to m_MatSize x m_NWakeColumn
+	// a column is only re-evaluated once its nodes have moved by more than the wake tolerance
+	double *m_WakePHC;
+	CVector *m_WakeVHC;
+	double *m_WakeColumnDisp;	// the node displacement of each column since its influences were evaluated, <0 if never evaluated
+	bool *m_bWakeColumnUpdate;	// true if the column's influences are to be re-evaluated in this iteration
+	double m_WakeDisp;			// the max node displacement in the last relaxation pass
+
+	CFactorCache *m_pFactorCache;	// the cache of factorized matrices, shared with the VLM dialog
+	CFactorEntry *m_pFactors;		// the cached factorization for the current geometry, or NULL
+	unsigned __int64 m_GeomKey;		// the hash of the geometry used to build the current matrix
 
 	CPanel **m_ppPanel;//the sorted array of panel pointers
 	CPanel *m_pPanel; //the original array of panels
@@ -179,8 +220,6 @@ protected:
 	CPlane *m_pPlane;
 
 	//temp data
-	CVector VG, CG;
-	double phiG;
 	CPanel m_SymPanel;
 
 	DECLARE_MESSAGE_MAP()
@@ -114,12 +114,6 @@ bool C3DPanelThread::UnitLoop()
 	nrhs  = (int)abs((m_AlphaMax-m_Alpha)*1.0001/m_DeltaAlpha) + 1;
 
 	if(!m_bSequence) nrhs = 1;
-	else if(nrhs>=100)
-	{
-		int res = AfxMessageBox("The number of points to be calculated will be limited to 100", MB_OKCANCEL);
-		if(res ==IDCANCEL) return false;
-		nrhs = 100;
-	}
 
 	if(!m_pWPolar->m_bWakeRollUp)	MaxWakeIter = 1;
 	else							MaxWakeIter = max(p3DDlg->m_MaxWakeIter, 1);
@@ -217,8 +211,19 @@ bool C3DPanelThread::UnitLoop()
 			}
 			if (m_bCancel) return true;
 
-			if(MaxWakeIter>0 && m_pWPolar->m_bWakeRollUp) p3DDlg->RelaxWake();	
-
+			if(MaxWakeIter>0 && m_pWPolar->m_bWakeRollUp)
+			{
+				p3DDlg->RelaxWake();
+				if (m_bCancel) return true;
+
+				// stop iterating once the wake no longer moves
+				if(nWakeIter<MaxWakeIter-1 && p3DDlg->m_WakeDisp < WAKETOLERANCE * p3DDlg->m_pWing->m_Span)
+				{
+					p3DDlg->AddString("      The wake has converged\r\n");
+					p3DDlg->m_Progress += (1+40+1+20) * (MaxWakeIter-nWakeIter-1);
+					break;
+				}
+			}
 		}
 
 		p3DDlg->AddString("\r\n");
@@ -240,18 +245,13 @@ bool C3DPanelThread::AlphaLoop(void)
 {
 	CString str;
 	C3DPanelDlg * p3DDlg = (C3DPanelDlg*)m_pParent;
-	int nrhs, TotalTime;
+	int nrhs, TotalTime, q0, nBlock;
+	double Alpha;
 
 	if(m_AlphaMax<m_Alpha) m_DeltaAlpha = -abs(m_DeltaAlpha);
 	nrhs  = (int)abs((m_AlphaMax-m_Alpha)*1.0001/m_DeltaAlpha) + 1;
 
 	if(!m_bSequence) nrhs = 1;
-	else if(nrhs>=100)
-	{
-		int res = AfxMessageBox("The number of points to be calculated will be limited to 100", MB_OKCANCEL);
-		if(res ==IDCANCEL) return false;
-		nrhs = 100;
-	}
 
 	int MaxWakeIter = 1;
 	
@@ -286,7 +286,12 @@ bool C3DPanelThread::AlphaLoop(void)
 
 	if (m_bCancel) return true;
 
-	if (!p3DDlg->CreateRHS(m_Alpha, m_DeltaAlpha, nrhs)) 
+	// The points are processed by blocks of RHSBLOCK angles
+	// The system is solved once for the unit cosine and sine RHS,
+	// then the results of each block are reconstructed from the unit solutions
+	nBlock = min(nrhs, RHSBLOCK);
+
+	if (!p3DDlg->CreateRHS(m_Alpha, m_DeltaAlpha, nBlock)) 
 	{
 		p3DDlg->AddString("\r\nFailed to create RHS Vector....\r\n");
 		p3DDlg->m_bWarning = true;
@@ -303,7 +308,7 @@ bool C3DPanelThread::AlphaLoop(void)
 	}
 	if (m_bCancel) return true;
 
-	if (!p3DDlg->SolveMultiple(m_Alpha, m_DeltaAlpha, nrhs))	
+	if (!p3DDlg->SolveMultiple(m_Alpha, m_DeltaAlpha, nBlock))	
 	{
 		p3DDlg->AddString("\r\n\r\nSingular matrix - aborting....\r\n");
 		p3DDlg->m_bWarning = true;
@@ -311,20 +316,39 @@ bool C3DPanelThread::AlphaLoop(void)
 	}
 	if (m_bCancel) return true;
 
-	if(!p3DDlg->CreateDoubletStrength(m_Alpha, m_DeltaAlpha, nrhs)) 
+	for(q0=0; q0<nrhs; q0+=RHSBLOCK)
 	{
-		p3DDlg->AddString("\r\n\r\nFailed to create doublet strengths....\r\n");
-		p3DDlg->m_bWarning = true;
-		return true;
-	}
+		nBlock = min(nrhs-q0, RHSBLOCK);
+		Alpha  = m_Alpha + q0*m_DeltaAlpha;
 
-	if (m_bCancel) return true;
+		if(q0>0)
+		{
+			if(!p3DDlg->CreateSourceStrength(Alpha, m_DeltaAlpha, nBlock))
+			{
+				p3DDlg->AddString("\r\nFailed to create RHS Vector....\r\n");
+				p3DDlg->m_bWarning = true;
+				return true;
+			}
+			p3DDlg->CombineUnitSolutions(Alpha, m_DeltaAlpha, nBlock);
+		}
 
-	if(!p3DDlg->ComputeAeroCoefs(m_Alpha, m_DeltaAlpha, nrhs))
-	{
-		p3DDlg->AddString("\r\n\r\nFailed to compute aerodynamics....\r\n");
-		p3DDlg->m_bWarning = true;
-		return true;
+		if(!p3DDlg->CreateDoubletStrength(Alpha, m_DeltaAlpha, nBlock)) 
+		{
+			p3DDlg->AddString("\r\n\r\nFailed to create doublet strengths....\r\n");
+			p3DDlg->m_bWarning = true;
+			return true;
+		}
+
+		if (m_bCancel) return true;
+
+		if(!p3DDlg->ComputeAeroCoefs(Alpha, m_DeltaAlpha, nBlock))
+		{
+			p3DDlg->AddString("\r\n\r\nFailed to compute aerodynamics....\r\n");
+			p3DDlg->m_bWarning = true;
+			return true;
+		}
+
+		if (m_bCancel) return true;
 	}
 
 	return true;
@@ -334,7 +358,7 @@ bool C3DPanelThread::ReLoop(void)
 {
 	CWaitCursor Wait;
 	CString str;
-	int nrhs, TotalTime;
+	int nrhs, TotalTime, q0, nBlock;
 	double QInf=0.0;
 	double Alpha = 0.0;
 
@@ -345,11 +369,6 @@ bool C3DPanelThread::ReLoop(void)
 	nrhs  = (int)abs((m_QInfMax-m_QInf)*1.0001/m_DeltaQInf) +1 ;
 
 	if(!m_bSequence) nrhs = 1;
-	else if(nrhs>=100){
-		int res = AfxMessageBox("The number of points to be calculated will be limited to 100", MB_OKCANCEL);
-		if(res ==IDCANCEL) return false;
-		nrhs = 100;
-	}
 
 	int MaxWakeIter = 1;
 //ESTIMATED UNIT TIMES FOR OPERATIONS
@@ -419,21 +438,39 @@ bool C3DPanelThread::ReLoop(void)
 
 	if (m_bCancel) return true;
 
-	if(!p3DDlg->CreateDoubletStrength(m_QInf, m_DeltaQInf, nrhs)) {
-		p3DDlg->AddString("\r\n\r\nFailed to create doublet strengths....\r\n");
-		p3DDlg->m_bWarning = true;
-		return true;
-	}
+	// The speeds are processed by blocks of RHSBLOCK values, all scaled from the same unit solution
+	for(q0=0; q0<nrhs; q0+=RHSBLOCK)
+	{
+		nBlock = min(nrhs-q0, RHSBLOCK);
+		QInf   = m_QInf + q0*m_DeltaQInf;
 
-	if (m_bCancel) return true;
+		if(q0>0)
+		{
+			//the previous block has scaled the unit solution, so restore it
+			if(!p3DDlg->CreateSourceStrength(Alpha, m_DeltaAlpha, 1)) {
+				p3DDlg->AddString("\r\nFailed to create RHS Vector....\r\n");
+				p3DDlg->m_bWarning = true;
+				return true;
+			}
+			p3DDlg->CombineUnitSolutions(Alpha, m_DeltaAlpha, 1);
+		}
 
-	if(!p3DDlg->ComputeAeroCoefs(m_QInf, m_DeltaQInf, nrhs)){
-		p3DDlg->AddString("\r\n\r\nFailed to compute aerodynamics....\r\n");
-		p3DDlg->m_bWarning = true;
-		return true;
-	}
+		if(!p3DDlg->CreateDoubletStrength(QInf, m_DeltaQInf, nBlock)) {
+			p3DDlg->AddString("\r\n\r\nFailed to create doublet strengths....\r\n");
+			p3DDlg->m_bWarning = true;
+			return true;
+		}
 
-	if (m_bCancel) return true;
+		if (m_bCancel) return true;
+
+		if(!p3DDlg->ComputeAeroCoefs(QInf, m_DeltaQInf, nBlock)){
+			p3DDlg->AddString("\r\n\r\nFailed to compute aerodynamics....\r\n");
+			p3DDlg->m_bWarning = true;
+			return true;
+		}
+
+		if (m_bCancel) return true;
+	}
 
 	return true;
 }
@@ -0,0 +1,223 @@
+/****************************************************************************
+
+    CFactorCache Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+//////////////////////////////////////////////////////////////////////
+//
+// FactorCache.cpp: implementation of the CFactorCache class.
+// Holds the LU factorizations of the latest influence matrices, so that
+// an analysis run again on an unchanged geometry only pays for the
+// back-substitution.
+// The entries are addressed by a hash of the geometry which has been 
+// used to build the matrix, so that they never need to be invalidated :
+// any change to the panels, to the wake or to the polar's settings 
+// leads to a different key, and the old entry is eventually evicted.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "../X-FLR5.h"
+#include ".\FactorCache.h"
+
+
+CFactorEntry::CFactorEntry()
+{
+	m_Key      = 0;
+	m_Size     = 0;
+	m_nRHS     = 0;
+	m_LastUse  = 0;
+	m_pLU      = NULL;
+	m_pipiv    = NULL;
+	m_pRHS     = NULL;
+}
+
+
+CFactorEntry::~CFactorEntry()
+{
+	Release();
+}
+
+
+void CFactorEntry::Release()
+{
+	if(m_pLU)   delete [] m_pLU;
+	if(m_pipiv) delete [] m_pipiv;
+	if(m_pRHS)  delete [] m_pRHS;
+	m_pLU   = NULL;
+	m_pipiv = NULL;
+	m_pRHS  = NULL;
+	m_Key   = 0;
+	m_Size  = 0;
+	m_nRHS  = 0;
+}
+
+
+CFactorCache::CFactorCache()
+{
+	m_Clock = 0;
+	m_MaxMemory = (unsigned __int64)FACTORCACHEMEM * 1024 * 1024;
+}
+
+
+CFactorCache::~CFactorCache()
+{
+	Clear();
+}
+
+
+void CFactorCache::Clear()
+{
+	for(int i=0; i<MAXFACTORS; i++) m_Entry[i].Release();
+}
+
+
+unsigned __int64 CFactorCache::GetEntryMemory(int Size, int nRHS)
+{
+	// returns the memory required by the factors of a system of this size, in bytes
+	// computed in 64 bits, since Size*Size*8 overflows an int beyond 16000 panels
+	unsigned __int64 N = (unsigned __int64)Size;
+	return N*N*sizeof(double) + N*sizeof(int) + N*(unsigned __int64)nRHS*sizeof(double);
+}
+
+
+unsigned __int64 CFactorCache::GetMemory()
+{
+	// returns the memory held by the cache, in bytes
+	unsigned __int64 mem = 0;
+	for(int i=0; i<MAXFACTORS; i++)
+	{
+		if(m_Entry[i].m_pLU) mem += GetEntryMemory(m_Entry[i].m_Size, m_Entry[i].m_nRHS);
+	}
+	return mem;
+}
+
+
+CFactorEntry* CFactorCache::Find(unsigned __int64 Key, int Size)
+{
+	// returns the entry built for this geometry, or NULL if there is none
+	for(int i=0; i<MAXFACTORS; i++)
+	{
+		if(m_Entry[i].m_pLU && m_Entry[i].m_Key==Key && m_Entry[i].m_Size==Size)
+		{
+			m_Entry[i].m_LastUse = ++m_Clock;
+			return m_Entry+i;
+		}
+	}
+	return NULL;
+}
+
+
+CFactorEntry* CFactorCache::Store(unsigned __int64 Key, int Size, double *LU, int *ipiv, double *RHS, int nRHS)
+{
+	// Stores a copy of the factors and of the unit RHS for this geometry
+	// The least recently used entries are evicted until the new one fits in the memory budget
+	// returns NULL if the matrix is too large for the cache
+	int i, iFree, iOld;
+	unsigned __int64 mem = GetEntryMemory(Size, nRHS);
+
+	if(mem>m_MaxMemory) return NULL;
+
+	CFactorEntry *pEntry = Find(Key, Size);
+	if(pEntry) pEntry->Release();
+
+	while(GetMemory()+mem>m_MaxMemory)
+	{
+		iOld = -1;
+		for(i=0; i<MAXFACTORS; i++)
+		{
+			if(m_Entry[i].m_pLU && (iOld<0 || m_Entry[i].m_LastUse<m_Entry[iOld].m_LastUse)) iOld = i;
+		}
+		if(iOld<0) break;
+		m_Entry[iOld].Release();
+	}
+
+	iFree = -1;
+	iOld  = 0;
+	for(i=0; i<MAXFACTORS; i++)
+	{
+		if(!m_Entry[i].m_pLU) 
+		{
+			iFree = i;
+			break;
+		}
+		if(m_Entry[i].m_LastUse<m_Entry[iOld].m_LastUse) iOld = i;
+	}
+	if(iFree<0)
+	{
+		iFree = iOld;
+		m_Entry[iFree].Release();
+	}
+
+	pEntry = m_Entry+iFree;
+	pEntry->m_pLU   = new double[Size*Size];
+	pEntry->m_pipiv = new int[Size];
+	pEntry->m_pRHS  = new double[Size*nRHS];
+
+	memcpy(pEntry->m_pLU,   LU,   Size*Size*sizeof(double));
+	memcpy(pEntry->m_pipiv, ipiv, Size*sizeof(int));
+	memcpy(pEntry->m_pRHS,  RHS,  Size*nRHS*sizeof(double));
+
+	pEntry->m_Key     = Key;
+	pEntry->m_Size    = Size;
+	pEntry->m_nRHS    = nRHS;
+	pEntry->m_LastUse = ++m_Clock;
+
+	return pEntry;
+}
+
+
+unsigned __int64 CFactorCache::InitKey()
+{
+	// FNV-1a offset basis
+	return 14695981039346656037ui64;
+}
+
+
+void CFactorCache::AddToKey(unsigned __int64 &Key, void const *pData, int nBytes)
+{
+	// 64 bit FNV-1a hash
+	unsigned char const *pc = (unsigned char const *)pData;
+	for(int i=0; i<nBytes; i++)
+	{
+		Key ^= pc[i];
+		Key *= 1099511628211ui64;
+	}
+}
+
+
+void CFactorCache::AddToKey(unsigned __int64 &Key, int n)
+{
+	AddToKey(Key, &n, sizeof(int));
+}
+
+
+void CFactorCache::AddToKey(unsigned __int64 &Key, double d)
+{
+	AddToKey(Key, &d, sizeof(double));
+}
+
+
+void CFactorCache::AddToKey(unsigned __int64 &Key, CVector const &V)
+{
+	// the vector class has a virtual table, so hash the coordinates only
+	AddToKey(Key, V.x);
+	AddToKey(Key, V.y);
+	AddToKey(Key, V.z);
+}
@@ -0,0 +1,75 @@
+/****************************************************************************
+
+    CFactorCache Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+// FactorCache.h: interface for the CFactorCache class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../misc/Vector.h"
+
+#define MAXFACTORS      16	//max number of factorized matrices held in the cache
+#define FACTORCACHEMEM 128	//memory allowed for the cache, in MB
+
+class CFactorEntry
+{
+public:
+	CFactorEntry();
+	~CFactorEntry();
+	void Release();
+
+	unsigned __int64 m_Key;	// the geometry hash this factorization was built for
+	int m_Size;				// the size of the system
+	int m_nRHS;				// the number of unit RHS stored with the factors
+	int m_LastUse;			// the cache clock at the last access, for LRU eviction
+	double *m_pLU;			// the LU factors, row-major, as returned by LUFactorBlock
+	int *m_pipiv;			// the row interchanges
+	double *m_pRHS;			// the assembled unit RHS, before back-substitution
+};
+
+
+class CFactorCache  
+{
+public:
+	CFactorCache();
+	virtual ~CFactorCache();
+
+	void Clear();
+	CFactorEntry* Find(unsigned __int64 Key, int Size);
+	CFactorEntry* Store(unsigned __int64 Key, int Size, double *LU, int *ipiv, double *RHS, int nRHS);
+
+	static unsigned __int64 InitKey();
+	static void AddToKey(unsigned __int64 &Key, void const *pData, int nBytes);
+	static void AddToKey(unsigned __int64 &Key, int n);
+	static void AddToKey(unsigned __int64 &Key, double d);
+	static void AddToKey(unsigned __int64 &Key, CVector const &V);
+
+	unsigned __int64 GetMemory();
+	unsigned __int64 GetMaxMemory() {return m_MaxMemory;}
+
+protected:
+	static unsigned __int64 GetEntryMemory(int Size, int nRHS);
+
+	CFactorEntry m_Entry[MAXFACTORS];
+	int m_Clock;
+	unsigned __int64 m_MaxMemory;	// the memory budget of the cache, in bytes
+};
@@ -0,0 +1,375 @@
+/****************************************************************************
+
+    CFarField Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+// FarField.cpp: implementation of the CFarField class.
+//
+// The source cells are expanded to the dipole order, and the doublet cells to the
+// quadrupole order, so that the error is of order (Radius/Distance) for both.
+// The kernels are those of the far-field formulas of the NASA 4023 panel method,
+// i.e. without the 4.pi factor.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "FarField.h"
+#include <math.h>
+
+
+CFarFieldCell::CFarFieldCell()
+{
+	memset(m_DoubletMoment, 0, sizeof(m_DoubletMoment));
+	m_Source    = 0.0;
+	m_Radius    = 0.0;
+	m_iFirst    = 0;
+	m_nElements = 0;
+	m_iChild    = 0;
+	m_nChildren = 0;
+	m_Depth     = 0;
+}
+
+
+CFarField::CFarField()
+{
+	m_Theta = 0.5;
+
+	m_nElements = 0;
+	m_nCells    = 0;
+	m_MaxCells  = 0;
+
+	m_Index   = NULL;
+	m_Sorted  = NULL;
+	m_Size    = NULL;
+	m_Source  = NULL;
+	m_Pos     = NULL;
+	m_Doublet = NULL;
+	m_Cell    = NULL;
+}
+
+
+CFarField::~CFarField()
+{
+	Release();
+}
+
+
+void CFarField::Allocate(int nElements)
+{
+	Release();
+
+	m_nElements = nElements;
+	m_Index     = new int[nElements];
+	m_Sorted    = new int[nElements];
+	m_Size      = new double[nElements];
+	m_Source    = new double[nElements];
+	m_Pos       = new CVector[nElements];
+	m_Doublet   = new CVector[nElements];
+
+	m_MaxCells = 2*nElements/FARFIELDLEAF + 16;
+	m_Cell     = new CFarFieldCell[m_MaxCells];
+}
+
+
+void CFarField::Release()
+{
+	if(m_Index)   delete [] m_Index;
+	if(m_Sorted)  delete [] m_Sorted;
+	if(m_Size)    delete [] m_Size;
+	if(m_Source)  delete [] m_Source;
+	if(m_Pos)     delete [] m_Pos;
+	if(m_Doublet) delete [] m_Doublet;
+	if(m_Cell)    delete [] m_Cell;
+	m_Index   = NULL;
+	m_Sorted  = NULL;
+	m_Size    = NULL;
+	m_Source  = NULL;
+	m_Pos     = NULL;
+	m_Doublet = NULL;
+	m_Cell    = NULL;
+
+	m_nElements = 0;
+	m_nCells    = 0;
+	m_MaxCells  = 0;
+}
+
+
+void CFarField::SetElement(int i, CVector const &Pos, double Size, double Source, CVector const &Doublet)
+{
+	m_Pos[i].x     = Pos.x;
+	m_Pos[i].y     = Pos.y;
+	m_Pos[i].z     = Pos.z;
+	m_Size[i]      = Size;
+	m_Source[i]    = Source;
+	m_Doublet[i].x = Doublet.x;
+	m_Doublet[i].y = Doublet.y;
+	m_Doublet[i].z = Doublet.z;
+}
+
+
+void CFarField::Build()
+{
+	// the cells are created breadth-first, so that the cell array is also the queue
+	// of the cells which remain to be processed
+	int i, c;
+
+	m_nCells = 0;
+	if(m_nElements<=0) return;
+
+	for(i=0; i<m_nElements; i++) m_Index[i] = i;
+
+	m_Cell[0].m_iFirst    = 0;
+	m_Cell[0].m_nElements = m_nElements;
+	m_Cell[0].m_nChildren = 0;
+	m_Cell[0].m_Depth     = 0;
+	m_nCells = 1;
+
+	for(c=0; c<m_nCells; c++)
+	{
+		SetMoments(c);
+		if(m_Cell[c].m_nElements>FARFIELDLEAF && m_Cell[c].m_Depth<FARFIELDDEPTH) SplitCell(c);
+	}
+}
+
+
+void CFarField::SetMoments(int c)
+{
+	int i, j, k, l;
+	double d, D[3], R[3];
+	CVector P;
+	CFarFieldCell *pCell = m_Cell+c;
+
+	pCell->m_Center.Set(0.0,0.0,0.0);
+	for(l=pCell->m_iFirst; l<pCell->m_iFirst+pCell->m_nElements; l++)
+	{
+		k = m_Index[l];
+		pCell->m_Center.x += m_Pos[k].x;
+		pCell->m_Center.y += m_Pos[k].y;
+		pCell->m_Center.z += m_Pos[k].z;
+	}
+	pCell->m_Center.x /= (double)pCell->m_nElements;
+	pCell->m_Center.y /= (double)pCell->m_nElements;
+	pCell->m_Center.z /= (double)pCell->m_nElements;
+
+	pCell->m_Radius = 0.0;
+	pCell->m_Source = 0.0;
+	pCell->m_SourceMoment.Set(0.0,0.0,0.0);
+	pCell->m_Doublet.Set(0.0,0.0,0.0);
+	memset(pCell->m_DoubletMoment, 0, sizeof(pCell->m_DoubletMoment));
+
+	for(l=pCell->m_iFirst; l<pCell->m_iFirst+pCell->m_nElements; l++)
+	{
+		k = m_Index[l];
+		P.x = m_Pos[k].x - pCell->m_Center.x;
+		P.y = m_Pos[k].y - pCell->m_Center.y;
+		P.z = m_Pos[k].z - pCell->m_Center.z;
+
+		d = sqrt(P.x*P.x + P.y*P.y + P.z*P.z) + m_Size[k];
+		if(d>pCell->m_Radius) pCell->m_Radius = d;
+
+		pCell->m_Source         += m_Source[k];
+		pCell->m_SourceMoment.x += m_Source[k] * P.x;
+		pCell->m_SourceMoment.y += m_Source[k] * P.y;
+		pCell->m_SourceMoment.z += m_Source[k] * P.z;
+
+		pCell->m_Doublet.x += m_Doublet[k].x;
+		pCell->m_Doublet.y += m_Doublet[k].y;
+		pCell->m_Doublet.z += m_Doublet[k].z;
+
+		D[0] = m_Doublet[k].x;	D[1] = m_Doublet[k].y;	D[2] = m_Doublet[k].z;
+		R[0] = P.x;				R[1] = P.y;				R[2] = P.z;
+		for(i=0; i<3; i++)
+			for(j=0; j<3; j++)
+				pCell->m_DoubletMoment[i][j] += D[i]*R[j];
+	}
+}
+
+
+static int GetOctant(CVector const &P, CVector const &Mid)
+{
+	int oct = 0;
+	if(P.x>Mid.x) oct += 1;
+	if(P.y>Mid.y) oct += 2;
+	if(P.z>Mid.z) oct += 4;
+	return oct;
+}
+
+
+bool CFarField::SplitCell(int c)
+{
+	// splits the cell in eight octants at the center of the elements' bounding box
+	// the elements are sorted by octant, and the non-empty octants are appended as children
+	int i, l, k, oct, nChildren, iFirst;
+	int nCount[8], iStart[8];
+	CVector Min, Max, Mid;
+	CFarFieldCell *pNewCell;
+
+	iFirst = m_Cell[c].m_iFirst;
+
+	k = m_Index[iFirst];
+	Min.Set(m_Pos[k].x, m_Pos[k].y, m_Pos[k].z);
+	Max.Set(m_Pos[k].x, m_Pos[k].y, m_Pos[k].z);
+	for(l=iFirst+1; l<iFirst+m_Cell[c].m_nElements; l++)
+	{
+		k = m_Index[l];
+		if(m_Pos[k].x<Min.x) Min.x = m_Pos[k].x;
+		if(m_Pos[k].y<Min.y) Min.y = m_Pos[k].y;
+		if(m_Pos[k].z<Min.z) Min.z = m_Pos[k].z;
+		if(m_Pos[k].x>Max.x) Max.x = m_Pos[k].x;
+		if(m_Pos[k].y>Max.y) Max.y = m_Pos[k].y;
+		if(m_Pos[k].z>Max.z) Max.z = m_Pos[k].z;
+	}
+	// all the elements are at the same position, nothing to split
+	if(Max.x<=Min.x && Max.y<=Min.y && Max.z<=Min.z) return false;
+
+	Mid.x = (Min.x+Max.x)/2.0;
+	Mid.y = (Min.y+Max.y)/2.0;
+	Mid.z = (Min.z+Max.z)/2.0;
+
+	memset(nCount, 0, sizeof(nCount));
+	for(l=iFirst; l<iFirst+m_Cell[c].m_nElements; l++)
+	{
+		oct = GetOctant(m_Pos[m_Index[l]], Mid);
+		nCount[oct]++;
+	}
+
+	nChildren = 0;
+	iStart[0] = iFirst;
+	for(i=0; i<8; i++)
+	{
+		if(i>0) iStart[i] = iStart[i-1] + nCount[i-1];
+		if(nCount[i]) nChildren++;
+	}
+
+	// make room for the children
+	if(m_nCells+nChildren>m_MaxCells)
+	{
+		int MaxCells = 2*m_MaxCells;
+		CFarFieldCell *pCell = new CFarFieldCell[MaxCells];
+		for(i=0; i<m_nCells; i++) pCell[i] = m_Cell[i];
+		delete [] m_Cell;
+		m_Cell     = pCell;
+		m_MaxCells = MaxCells;
+	}
+
+	m_Cell[c].m_iChild    = m_nCells;
+	m_Cell[c].m_nChildren = nChildren;
+	for(i=0; i<8; i++)
+	{
+		if(!nCount[i]) continue;
+		pNewCell = m_Cell + m_nCells;
+		pNewCell->m_iFirst    = iStart[i];
+		pNewCell->m_nElements = nCount[i];
+		pNewCell->m_nChildren = 0;
+		pNewCell->m_Depth     = m_Cell[c].m_Depth+1;
+		m_nCells++;
+	}
+
+	// counting sort of the cell's elements by octant
+	for(l=iFirst; l<iFirst+m_Cell[c].m_nElements; l++)
+	{
+		oct = GetOctant(m_Pos[m_Index[l]], Mid);
+		m_Sorted[iStart[oct]++] = m_Index[l];
+	}
+	memcpy(m_Index+iFirst, m_Sorted+iFirst, m_Cell[c].m_nElements*sizeof(int));
+
+	return true;
+}
+
+
+void CFarField::GetSpeed(CVector const &C, CVector &V, NEARFIELDPROC pNearField, void *pParam) const
+{
+	// Returns the speed induced at point C by all the elements
+	// the cells too close to C are opened, and the elements of the leaf cells too close to C
+	// are evaluated exactly by the function pNearField
+	// the traversal stack is local, so that the tree may be shared by several threads
+	int Stack[8*FARFIELDDEPTH+8];
+	int nStack, c, l, i, j;
+	double r2, r3, r5, r7, DR, PR, RMR, Trace;
+	double R[3], MR[3], MtR[3];
+	CVector VE;
+	CFarFieldCell *pCell;
+
+	V.x = 0.0; V.y = 0.0; V.z = 0.0;
+	if(!m_nCells) return;
+
+	Stack[0] = 0;
+	nStack   = 1;
+	while(nStack>0)
+	{
+		pCell = m_Cell + Stack[--nStack];
+
+		R[0] = C.x - pCell->m_Center.x;
+		R[1] = C.y - pCell->m_Center.y;
+		R[2] = C.z - pCell->m_Center.z;
+		r2 = R[0]*R[0] + R[1]*R[1] + R[2]*R[2];
+
+		if(pCell->m_Radius*pCell->m_Radius < m_Theta*m_Theta*r2)
+		{
+			// far enough, use the cell's moments
+			r3 = r2*sqrt(r2);
+			r5 = r3*r2;
+			r7 = r5*r2;
+
+			// source monopole and dipole
+			DR = pCell->m_SourceMoment.x*R[0] + pCell->m_SourceMoment.y*R[1] + pCell->m_SourceMoment.z*R[2];
+			V.x += pCell->m_Source*R[0]/r3 - pCell->m_SourceMoment.x/r3 + 3.0*DR*R[0]/r5;
+			V.y += pCell->m_Source*R[1]/r3 - pCell->m_SourceMoment.y/r3 + 3.0*DR*R[1]/r5;
+			V.z += pCell->m_Source*R[2]/r3 - pCell->m_SourceMoment.z/r3 + 3.0*DR*R[2]/r5;
+
+			// doublet dipole
+			PR = pCell->m_Doublet.x*R[0] + pCell->m_Doublet.y*R[1] + pCell->m_Doublet.z*R[2];
+			V.x += (3.0*PR*R[0] - pCell->m_Doublet.x*r2)/r5;
+			V.y += (3.0*PR*R[1] - pCell->m_Doublet.y*r2)/r5;
+			V.z += (3.0*PR*R[2] - pCell->m_Doublet.z*r2)/r5;
+
+			// doublet quadrupole, from the first moment of the doublets
+			Trace = pCell->m_DoubletMoment[0][0] + pCell->m_DoubletMoment[1][1] + pCell->m_DoubletMoment[2][2];
+			for(i=0; i<3; i++)
+			{
+				MR[i]  = 0.0;
+				MtR[i] = 0.0;
+				for(j=0; j<3; j++)
+				{
+					MR[i]  += pCell->m_DoubletMoment[i][j]*R[j];
+					MtR[i] += pCell->m_DoubletMoment[j][i]*R[j];
+				}
+			}
+			RMR = R[0]*MR[0] + R[1]*MR[1] + R[2]*MR[2];
+			V.x -= 3.0*(Trace*R[0] + MR[0] + MtR[0])/r5 - 15.0*RMR*R[0]/r7;
+			V.y -= 3.0*(Trace*R[1] + MR[1] + MtR[1])/r5 - 15.0*RMR*R[1]/r7;
+			V.z -= 3.0*(Trace*R[2] + MR[2] + MtR[2])/r5 - 15.0*RMR*R[2]/r7;
+		}
+		else if(pCell->m_nChildren)
+		{
+			for(c=pCell->m_iChild; c<pCell->m_iChild+pCell->m_nChildren; c++)
+				Stack[nStack++] = c;
+		}
+		else
+		{
+			for(l=pCell->m_iFirst; l<pCell->m_iFirst+pCell->m_nElements; l++)
+			{
+				pNearField(m_Index[l], C, VE, pParam);
+				V.x += VE.x;
+				V.y += VE.y;
+				V.z += VE.z;
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+
+    CFarField Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+// FarField.h: interface for the CFarField class.
+//
+// An octree over the panels and wake panels, so that the speed induced by a cell
+// of elements far enough from the evaluation point is computed from the cell's 
+// multipole moments, instead of summing the influences of all its elements
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../misc/Vector.h"
+
+#define FARFIELDLEAF   8	//max number of elements held in a leaf cell of the octree
+#define FARFIELDDEPTH 20	//max depth of the octree
+
+// returns the exact speed induced by element iElement at point C
+typedef void (*NEARFIELDPROC)(int iElement, CVector const &C, CVector &V, void *pParam);
+
+
+class CFarFieldCell
+{
+public:
+	CFarFieldCell();
+
+	CVector m_Center;			// the mean position of the cell's elements, about which the moments are taken
+	CVector m_SourceMoment;		// the first moment of the source strengths
+	CVector m_Doublet;			// the sum of the doublet vectors
+	double m_DoubletMoment[3][3];	// the first moment of the doublet vectors, M[i][j] = Sum d_i (P-Center)_j
+	double m_Source;			// the sum of the source strengths
+	double m_Radius;			// the radius of the sphere which encloses the cell's elements
+	int m_iFirst, m_nElements;	// the cell's elements in the sorted index array
+	int m_iChild, m_nChildren;	// the cell's children, stored contiguously in the cell array
+	int m_Depth;
+};
+
+
+class CFarField  
+{
+public:
+	CFarField();
+	virtual ~CFarField();
+
+	void Allocate(int nElements);
+	void Release();
+	void SetElement(int i, CVector const &Pos, double Size, double Source, CVector const &Doublet);
+	void Build();
+	void GetSpeed(CVector const &C, CVector &V, NEARFIELDPROC pNearField, void *pParam) const;
+	bool IsBuilt() const {return m_nCells>0;}
+
+	double m_Theta;	// a cell is evaluated as a whole if its radius is less than m_Theta x its distance to the point
+
+protected:
+	void SetMoments(int c);
+	bool SplitCell(int c);
+
+	int m_nElements;
+	int m_nCells, m_MaxCells;
+
+	int *m_Index;		// the element indexes, sorted so that each cell's elements are contiguous
+	int *m_Sorted;		// work array for the sort
+	double *m_Size;		// the element sizes
+	double *m_Source;	// the source strengths, i.e. Sigma x Area
+	CVector *m_Pos;		// the element positions
+	CVector *m_Doublet;	// the doublet vectors, i.e. Mu x Area x Normal
+	CFarFieldCell *m_Cell;
+};
@@ -387,7 +387,7 @@ bool CLLTDlg::EndSequence()
 
 	m_XFile.Close();
 
-	if(m_bWarning && pMiarex->m_bLogFile)
+	if(m_bWarning && pMiarex->m_bLogFile && !pMiarex->m_bBatch)
 	{
 		if(IDYES == AfxMessageBox("Some points were found outside the available flight envelope\r\nView the Log file for details ?", MB_YESNOCANCEL))
 		{
@@ -48,8 +48,12 @@ CLLTThread::CLLTThread(CWnd * pParent)
 	m_bType4    = false;
 
 	m_IterLim = 100;
+	m_nWorkers = 0;
 
 	m_Alpha = 0.0;
+
+	m_pPoint = NULL;
+	memset(m_pWorkWing, 0, sizeof(m_pWorkWing));
 }
 
 CLLTThread::~CLLTThread()
@@ -63,7 +67,12 @@ BOOL CLLTThread::InitInstance()
 	CMiarex* pMiarex = (CMiarex*)m_pMiarex;
 	m_IterLim  = pMiarex->m_Iter;
 
-	if(!m_bType4) 
+	int nWorkers = m_nWorkers;
+	if(nWorkers<=0) nWorkers = CTaskPool::GetProcessorCount();
+
+	if(m_bSequence && nWorkers>1)
+		ParallelLoop();
+	else if(!m_bType4) 
 		AlphaLoop();
 	else 
 		ReLoop();
@@ -177,6 +186,8 @@ bool CLLTThread::AlphaLoop()
 	pIDlg->AddString(str);
 	str.Format("Relaxation factor  = %.1f\r\n", CWing::s_RelaxMax);
 	pIDlg->AddString(str);
+	if(CWing::s_bAnderson) pIDlg->AddString("Anderson mixing    = on\r\n");
+	else                   pIDlg->AddString("Anderson mixing    = off\r\n");
 	str.Format("Number of stations = %d\r\n\r\n", CWing::s_NLLTStations);
 	pIDlg->AddString(str);
 	
@@ -221,7 +232,8 @@ bool CLLTThread::AlphaLoop()
 		else if (iter<m_IterLim && !m_bCancel)
 		{
 			//converged, 
-			str.Format("    ...converged after %d iterations\r\n",iter);
+			if(CWing::s_bAnderson) str.Format("    ...converged after %d iterations (%d accelerated)\r\n",iter, m_pWing->m_nAccel);
+			else                   str.Format("    ...converged after %d iterations\r\n",iter);
 			pIDlg->AddString(str);
 			m_pWing->LLTComputeWing();// generates wing results, 
 			if (m_pWing->m_bWingOut) pIDlg->m_bWarning = true;
@@ -236,7 +248,8 @@ bool CLLTThread::AlphaLoop()
 		else 
 		{
 			if (m_pWing->m_bWingOut) pIDlg->m_bWarning = true;
-			str.Format("    ...unconverged after %2d iterations\r\n", iter);
+			if(CWing::s_bAnderson) str.Format("    ...unconverged after %2d iterations (%d accelerated)\r\n", iter, m_pWing->m_nAccel);
+			else                   str.Format("    ...unconverged after %2d iterations\r\n", iter);
 			pIDlg->AddString(str);
 			m_pWing->m_bInitCalc = true;
 		}
@@ -267,6 +280,8 @@ bool CLLTThread::ReLoop()
 	pIDlg->AddString(str);
 	str.Format("Relaxation factor  = %.1f\r\n", CWing::s_RelaxMax);
 	pIDlg->AddString(str);
+	if(CWing::s_bAnderson) pIDlg->AddString("Anderson mixing    = on\r\n");
+	else                   pIDlg->AddString("Anderson mixing    = off\r\n");
 	str.Format("Number of stations = %d\r\n\r\n", CWing::s_NLLTStations);
 	pIDlg->AddString(str);
 	
@@ -314,7 +329,8 @@ bool CLLTThread::ReLoop()
 		else if (iter<m_IterLim  && !m_bCancel)
 		{
 			//converged, 
-			str.Format("    ...converged after %d iterations\r\n",iter);
+			if(CWing::s_bAnderson) str.Format("    ...converged after %d iterations (%d accelerated)\r\n",iter, m_pWing->m_nAccel);
+			else                   str.Format("    ...converged after %d iterations\r\n",iter);
 			pIDlg->AddString(str);
 			m_pWing->LLTComputeWing();// generates wing results, 
 			if (m_pWing->m_bWingOut)pIDlg->m_bWarning = true;
@@ -330,7 +346,8 @@ bool CLLTThread::ReLoop()
 		{
 //			m_pWing->LLTComputeWing();// generates wing results, 
 			if (m_pWing->m_bWingOut) pIDlg->m_bWarning = true;
-			str.Format("    ...unconverged after %2d iterations\r\n", iter);
+			if(CWing::s_bAnderson) str.Format("    ...unconverged after %2d iterations (%d accelerated)\r\n", iter, m_pWing->m_nAccel);
+			else                   str.Format("    ...unconverged after %2d iterations\r\n", iter);
 			pIDlg->AddString(str);
 			m_pWing->m_bInitCalc = true;
 		}
@@ -339,3 +356,263 @@ bool CLLTThread::ReLoop()
 	}
 	return true;
 }
+
+
+bool CLLTThread::ParallelLoop()
+{
+	// Solves all the points of the sequence concurrently, each from the initial state of the wing,
+	// then solves again the unconverged points, in the order of the sequence, each from the converged state
+	// of its nearest neighbour, as the sequential loops do from the previous point
+	// The converged points are added to the polar in the order of the sequence
+	// The dialog shows the iterations of the calling thread, i.e. worker 0, and the skip command applies to its point
+	CString str;
+	CLLTDlg * pIDlg = (CLLTDlg*)m_pParent;
+	CMiarex* pMiarex = (CMiarex*)m_pMiarex;
+	LLTPoint *pPoint;
+	double Alpha;
+	int i, j, l, iter, nRetry;
+
+	if(!m_bType4) m_pWing->m_Alpha = m_Alpha;
+	else          m_pWing->m_QInf  = m_Alpha;
+
+	pIDlg->AddString("Launching analysis....\r\n\r\n");
+	str.Format("Max iterations     = %d\r\n", m_IterLim);
+	pIDlg->AddString(str);
+	str.Format("Alpha precision    = %.6f\r\n", CWing::s_CvPrec);
+	pIDlg->AddString(str);
+	str.Format("Relaxation factor  = %.1f\r\n", CWing::s_RelaxMax);
+	pIDlg->AddString(str);
+	if(CWing::s_bAnderson) pIDlg->AddString("Anderson mixing    = on\r\n");
+	else                   pIDlg->AddString("Anderson mixing    = off\r\n");
+	str.Format("Number of stations = %d\r\n\r\n", CWing::s_NLLTStations);
+	pIDlg->AddString(str);
+
+	if(m_AlphaMax<m_Alpha) m_DeltaAlpha = -(double)abs(m_DeltaAlpha);
+	int ia  = (int)abs((m_AlphaMax-m_Alpha)*1.001/m_DeltaAlpha);
+
+	if(!m_pWing->LLTInitialize()) return false;
+
+	int nWorkers = m_nWorkers;
+	if(nWorkers<=0)         nWorkers = CTaskPool::GetProcessorCount();
+	if(nWorkers>MAXWORKERS) nWorkers = MAXWORKERS;
+	if(nWorkers>ia+1)       nWorkers = ia+1;
+
+	m_pPoint = new LLTPoint[ia+1];
+	Alpha = m_Alpha;
+	for (i=0; i<=ia; i++)
+	{
+		m_pPoint[i].Alpha = Alpha;
+		m_pPoint[i].Iter  = m_IterLim;
+		Alpha += m_DeltaAlpha;
+	}
+
+	for (l=0; l<nWorkers; l++) m_pWorkWing[l] = new CWing;
+
+	pIDlg->m_IterGraph.ResetLimits();
+	pIDlg->m_IterGraph.SetXMax((double)m_IterLim);
+	pIDlg->m_IterGraph.SetYMinGrid(true, true, RGB(100,100,100), 2, 1, 4);
+
+	str.Format("Solving %d points on %d threads...\r\n", ia+1, nWorkers);
+	pIDlg->AddString(str);
+	CTaskPool::Run(ia+1, PointTask, this, nWorkers, &m_bCancel);
+
+	// the points which have not converged from the initial state restart from their nearest converged neighbour
+	nRetry = 0;
+	for (i=0; i<=ia; i++) if(m_pPoint[i].Iter==m_IterLim) nRetry++;
+	if(nRetry && !m_bCancel)
+	{
+		str.Format("Solving %d unconverged points from their nearest converged neighbour...\r\n", nRetry);
+		pIDlg->AddString(str);
+	}
+	for (i=0; i<=ia && nRetry; i++)
+	{
+		if(m_bCancel) break;
+		pPoint = m_pPoint+i;
+		if(pPoint->Iter!=m_IterLim) continue;
+
+		// the previous point of the sequence is preferred, as in the sequential loops
+		for (l=1; l<=ia; l++)
+		{
+			j = i-l;
+			if(j>=0 && m_pPoint[j].Iter>0 && m_pPoint[j].Iter<m_IterLim) break;
+			j = i+l;
+			if(j<=ia && m_pPoint[j].Iter>0 && m_pPoint[j].Iter<m_IterLim) break;
+		}
+		if(l>ia) break;// no converged point to start from
+
+		if(!m_bType4) m_pWing->m_Alpha = pPoint->Alpha;
+		else          m_pWing->m_QInf  = pPoint->Alpha;
+		if(m_pWing->m_Type==2) m_pWing->m_QInf = m_pPoint[j].QInf;
+		memcpy(m_pWing->m_Ai, m_pPoint[j].Ai, sizeof(m_pPoint[j].Ai));
+		m_pWing->m_bInitCalc = false;
+		m_pWing->LLTInitCl();
+
+		pIDlg->m_IterGraph.SetYMin(0.0);
+		pIDlg->m_IterGraph.SetYMax(0.5);
+		pIDlg->m_pIterCurve->ResetCurve();
+		pIDlg->m_State = 0;
+		iter = Iterate();
+		if(m_bSkip)
+		{
+			m_bSkip = false;
+			pPoint->Iter = -2;
+		}
+		else pPoint->Iter = iter;
+
+		pPoint->QInf  = m_pWing->m_QInf;
+		pPoint->Maxa  = m_pWing->m_Maxa;
+		pPoint->Accel = m_pWing->m_nAccel;
+		memcpy(pPoint->Ai, m_pWing->m_Ai, sizeof(pPoint->Ai));
+		memcpy(pPoint->Cl, m_pWing->m_Cl, sizeof(pPoint->Cl));
+		memcpy(pPoint->Re, m_pWing->m_Re, sizeof(pPoint->Re));
+	}
+	pIDlg->AddString("\r\n");
+
+	for (i=0; i<=ia; i++)
+	{
+		if(m_bCancel) 
+		{
+			pIDlg->AddString("Analysis cancelled on user request....\r\n");
+			break;
+		}
+		pPoint = m_pPoint+i;
+		iter   = pPoint->Iter;
+
+		// restore the point's state on the wing
+		if(!m_bType4) m_pWing->m_Alpha = pPoint->Alpha;
+		m_pWing->m_QInf = pPoint->QInf;
+		m_pWing->m_Maxa = pPoint->Maxa;
+		m_pWing->m_nAccel = pPoint->Accel;
+		memcpy(m_pWing->m_Ai, pPoint->Ai, sizeof(pPoint->Ai));
+		memcpy(m_pWing->m_Cl, pPoint->Cl, sizeof(pPoint->Cl));
+		memcpy(m_pWing->m_Re, pPoint->Re, sizeof(pPoint->Re));
+
+		pIDlg->m_IterGraph.SetYMin(0.0);
+		pIDlg->m_IterGraph.SetYMax(0.5);
+		pIDlg->m_pIterCurve->ResetCurve();
+		if(iter>0) pIDlg->m_pIterCurve->AddPoint((double)iter, pPoint->Maxa);
+
+		if(!m_bType4) str.Format("Calculating Alpha = %5.2f... ", pPoint->Alpha);
+		else          str.Format("Calculating QInf = %6.2f... ", pPoint->Alpha);
+		pIDlg->AddString(str);
+
+		if(iter==-2)
+		{
+			pIDlg->AddString("    ...skipped\r\n");
+			pIDlg->m_State = 2;
+			m_pWing->m_bInitCalc = true;
+		}
+		else if(iter<0)
+		{
+			if(!m_bType4) pIDlg->AddString("    ...negative Lift... Aborting\r\n");
+			else
+			{
+				//unconverged
+				pIDlg->m_bWarning = true;
+				pIDlg->AddString("\r\n");
+			}
+			pIDlg->m_State = 2;
+			m_pWing->m_bInitCalc = true;
+		}
+		else if (iter<m_IterLim)
+		{
+			//converged, 
+			if(CWing::s_bAnderson) str.Format("    ...converged after %d iterations (%d accelerated)\r\n",iter, m_pWing->m_nAccel);
+			else                   str.Format("    ...converged after %d iterations\r\n",iter);
+			pIDlg->AddString(str);
+			pIDlg->m_State = 1;
+			m_pWing->LLTComputeWing();// generates wing results, 
+			if (m_pWing->m_bWingOut) pIDlg->m_bWarning = true;
+			pMiarex->AddWOpp(m_pWing->m_bWingOut);// Adds WOpp point and adds result to polar
+			if(m_pWing->m_bWingOut)
+			{
+				str.Format("\r\n");
+				pIDlg->AddString(str);
+			}
+			m_pWing->m_bInitCalc = false;
+		}
+		else 
+		{
+			if (m_pWing->m_bWingOut) pIDlg->m_bWarning = true;
+			if(CWing::s_bAnderson) str.Format("    ...unconverged after %2d iterations (%d accelerated)\r\n", iter, m_pWing->m_nAccel);
+			else                   str.Format("    ...unconverged after %2d iterations\r\n", iter);
+			pIDlg->AddString(str);
+			pIDlg->m_State = 2;
+			m_pWing->m_bInitCalc = true;
+		}
+		pIDlg->UpdateView(pPoint->Alpha);
+	}
+
+	for (l=0; l<MAXWORKERS; l++)
+	{
+		if(m_pWorkWing[l]) delete m_pWorkWing[l];
+		m_pWorkWing[l] = NULL;
+	}
+	delete [] m_pPoint;
+	m_pPoint = NULL;
+	m_bSkip = false;
+	return true;
+}
+
+
+void CLLTThread::PointTask(int iTask, int iWorker, void *pParam)
+{
+	CLLTThread *pThread = (CLLTThread*)pParam;
+	pThread->SolvePoint(iTask, iWorker);
+}
+
+
+void CLLTThread::SolvePoint(int iPoint, int iWorker)
+{
+	// Iterates one point of the sequence on the worker's copy of the wing
+	// Only worker 0, which is this thread, shows its iterations in the dialog and may be skipped
+	CLLTDlg * pIDlg = (CLLTDlg*)m_pParent;
+	LLTPoint *pPoint = m_pPoint+iPoint;
+	CWing *pWing = m_pWorkWing[iWorker];
+	int iter = 0;
+	int resp = 0;
+
+	pWing->LLTCopyState(m_pWing);
+	if(!m_bType4) pWing->m_Alpha = pPoint->Alpha;
+	else          pWing->m_QInf  = pPoint->Alpha;
+
+	if(pWing->m_bInitCalc) pWing->LLTSetLinearSolution();
+	pWing->LLTInitCl();//with new angle...
+
+	if(iWorker==0)
+	{
+		m_bSkip = false;
+		pIDlg->m_IterGraph.SetYMin(0.0);
+		pIDlg->m_IterGraph.SetYMax(0.5);
+		pIDlg->m_pIterCurve->ResetCurve();
+		pIDlg->m_State = 0;
+	}
+
+	while(iter<m_IterLim && !m_bCancel && !(iWorker==0 && m_bSkip))
+	{
+		iter++;
+		resp = pWing->LLTIterate();
+		if(iWorker==0)
+		{
+			pIDlg->m_pIterCurve->AddPoint((double)iter, pWing->m_Maxa);
+			pIDlg->UpdateView(pPoint->Alpha);
+		}
+		if(resp!=0) break;
+	}
+
+	if(iWorker==0 && m_bSkip)
+	{
+		m_bSkip = false;
+		pPoint->Iter = -2;
+	}
+	else if(resp==1)  pPoint->Iter = iter;
+	else if(resp==-1) pPoint->Iter = -1;// Type 2, lift <0
+	else              pPoint->Iter = m_IterLim;
+
+	pPoint->QInf = pWing->m_QInf;
+	pPoint->Maxa = pWing->m_Maxa;
+	pPoint->Accel = pWing->m_nAccel;
+	memcpy(pPoint->Ai, pWing->m_Ai, sizeof(pPoint->Ai));
+	memcpy(pPoint->Cl, pWing->m_Cl, sizeof(pPoint->Cl));
+	memcpy(pPoint->Re, pWing->m_Re, sizeof(pPoint->Re));
+}
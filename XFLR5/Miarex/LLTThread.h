@@ -24,9 +24,26 @@
 // LLTThread.h : header file
 //
 #include "Wing.h"
+#include "../misc/TaskPool.h"
+
+// The converged state of one operating point of a parallel LLT sequence
+struct LLTPoint
+{
+	double Alpha;	// the aoa, or the freestream speed for Type 4 polars
+	double QInf;
+	double Maxa;
+	int Iter;		// the number of iterations, -1 if the lift is negative
+	int Accel;		// the number of iterations accelerated by Anderson mixing
+	double Ai[MAXSTATIONS+1];
+	double Cl[MAXSTATIONS+1];
+	double Re[MAXSTATIONS+1];
+};
 
 /////////////////////////////////////////////////////////////////////////////
 // CLLTThread thread
+// The points of a sequence are independent and may be solved concurrently,
+// each worker of the task pool iterating on its own copy of the wing;
+// the results are then added to the polar in the order of the sequence
 
 class CLLTThread : public CWinThread
 {
@@ -69,10 +86,17 @@ public:
 	double m_DeltaAlpha;//Angle of Attack in 
 
 	int m_Iter;
+	int m_nWorkers;			// the number of threads used for the sequences, 0 for one per processor
 
 protected:
 	bool ReLoop();
 	bool AlphaLoop();
+	bool ParallelLoop();
+	void SolvePoint(int iPoint, int iWorker);
+	static void PointTask(int iTask, int iWorker, void *pParam);
+
+	LLTPoint *m_pPoint;		// the points of the sequence
+	CWing *m_pWorkWing[MAXWORKERS];	// the wing copies used by the workers
 	// Generated message map functions
 	//{{AFX_MSG(CLLTThread)
 		// NOTE - the ClassWizard will add and remove member functions here.
@@ -43,6 +43,7 @@
 #include "ListPlrDlg.h"
 #include "CpScaleDlg.h"
 #include "WAdvDlg.h"
+#include "WPolarBatchDlg.h"
 #include "WingDlg.h"
 #include "PlaneDlg.h"
 #include "BodyNURBSDlg.h"
@@ -164,6 +165,7 @@ CMiarex::CMiarex(CWnd* pParent /*=NULL*/)
 	m_Iter      = 100;
 	CWing::s_CvPrec    =   0.01;
 	CWing::s_RelaxMax  =  20.0;
+	CWing::s_bAnderson = true;
 	CWing::s_NLLTStations = 20;
 
 	m_Panel[0].m_VortexPos = 0.25;
@@ -174,6 +176,7 @@ CMiarex::CMiarex(CWnd* pParent /*=NULL*/)
 	m_WngAnalysis.m_NXWakePanels    = 1;
 
 	m_CoreSize        = 0.000001;
+	m_FarFieldTheta   = 0.0;
 	m_MaxWakeIter     = 5;
 	m_WakeInterNodes  = 6;
 	m_bResetWake      = true;
@@ -224,16 +227,30 @@ CMiarex::CMiarex(CWnd* pParent /*=NULL*/)
 
 	m_InducedDragPoint = 0;
 
-	CPanel::s_pNode = m_Node;
 	CWing::s_pLLTDlg     = &m_LLTDlg;    //pointer to the VLM analysis dialog class
 	CWing::s_pVLMDlg     = &m_VLMDlg;    //pointer to the VLM analysis dialog class
 	CWing::s_p3DPanelDlg = &m_PanelDlg;  //pointer to the 3DPanel analysis dialog class
 
-	CWing::m_pWakePanel = m_WakePanel;
-	CWing::m_pWakeNode = m_WakeNode;
-
-	CSurface::s_pPanel = m_Panel;
-	CSurface::s_pNode  = m_Node;
+	//the panel arrays are allocated in InitializePanels, once the number of panels is known
+	m_Panel        = NULL;
+	m_WakePanel    = NULL;
+	m_MemPanel     = NULL;
+	m_RefWakePanel = NULL;
+	m_pPanel       = NULL;
+	m_Node         = NULL;
+	m_MemNode      = NULL;
+	m_WakeNode     = NULL;
+	m_RefWakeNode  = NULL;
+	m_TempWakeNode = NULL;
+	m_aij          = NULL;
+	m_aijRef       = NULL;
+	m_RHS          = NULL;
+	m_RHSRef       = NULL;
+	m_MaxPanels     = 0;
+	m_MaxNodes      = 0;
+	m_MaxWakePanels = 0;
+	m_MaxWakeNodes  = 0;
+	m_MaxMatSize    = 0;
 
 	m_ArcBall.m_pGLScale = &m_GLScale;
 	m_ArcBall.m_pOffx    = &m_UFOOffset.x;
@@ -287,6 +304,7 @@ CMiarex::CMiarex(CWnd* pParent /*=NULL*/)
 	m_bShowCpScale       = true;
 	m_bShowLight         = false;
 	m_bLogFile           = false;
+	m_bBatch             = false;
 	m_bHalfWing          = true;
 	m_bTransGraph        = true;
 	m_bIsPrinting        = false;
@@ -471,36 +489,13 @@ CMiarex::CMiarex(CWnd* pParent /*=NULL*/)
 	m_StabColor = 12477630;
 	m_FinColor  =  RGB(60,60,180);
 
-	m_VLMDlg.m_pNode         = m_Node;
-	m_VLMDlg.m_pPanel        = m_Panel;
-	m_VLMDlg.m_ppPanel       = m_pPanel;
-	m_VLMDlg.m_pWakeNode     = m_WakeNode;
-	m_VLMDlg.m_pWakePanel    = m_WakePanel;
-	m_VLMDlg.m_pMemNode      = m_MemNode;
-	m_VLMDlg.m_pMemPanel     = m_MemPanel;
-	m_VLMDlg.m_pTempWakeNode = m_TempWakeNode;
-	m_VLMDlg.m_pRefWakeNode  = m_RefWakeNode;
-	m_VLMDlg.m_pRefWakePanel = m_RefWakePanel;
-	m_VLMDlg.m_RHS           = m_RHS;		
-	m_VLMDlg.m_Gamma         = m_RHSRef;
-	m_VLMDlg.m_aij           = m_aij;		
+	SetPanelPointers();
 	m_VLMDlg.m_pCoreSize     = &m_CoreSize;
-
-	m_PanelDlg.m_pPanel        = m_Panel;
-	m_PanelDlg.m_ppPanel       = m_pPanel;
-	m_PanelDlg.m_pNode         = m_Node;
-	m_PanelDlg.m_pWakePanel    = m_WakePanel;
-	m_PanelDlg.m_pWakeNode     = m_WakeNode;
-	m_PanelDlg.m_pMemNode      = m_MemNode;
-	m_PanelDlg.m_pMemPanel     = m_MemPanel;
-	m_PanelDlg.m_pTempWakeNode = m_TempWakeNode;
-	m_PanelDlg.m_pRefWakeNode  = m_RefWakeNode;
-	m_PanelDlg.m_pRefWakePanel = m_RefWakePanel;
-	m_PanelDlg.m_aij           = m_aij;
-	m_PanelDlg.m_aijRef        = m_aijRef;
-	m_PanelDlg.m_RHS           = m_RHS;
-	m_PanelDlg.m_RHSRef        = m_RHSRef;
+	m_VLMDlg.m_pFarFieldTheta = &m_FarFieldTheta;
+	m_VLMDlg.m_pFactorCache  = &m_FactorCache;
 	m_PanelDlg.m_pCoreSize     = &m_CoreSize;
+	m_PanelDlg.m_pFarFieldTheta = &m_FarFieldTheta;
+	m_PanelDlg.m_pFactorCache  = &m_FactorCache;
 
 	m_FlowLinesDlg.Create(IDD_FLOWLINESDLG,this);
 	m_FlowLinesDlg.SetWindowPos(this, 20,80,0,0,SWP_NOSIZE);
@@ -516,11 +511,6 @@ CMiarex::CMiarex(CWnd* pParent /*=NULL*/)
 	m_poaWOpp    = NULL;
 	m_poaPOpp    = NULL;
 
-	memset(m_pPanel, 0, sizeof(m_pPanel));
-	memset(m_aij, 0, sizeof(m_aij));
-	memset(m_aijRef, 0, sizeof(m_aijRef));
-	memset(m_RHS, 0, sizeof(m_RHS));
-	memset(m_RHSRef, 0, sizeof(m_RHSRef));
 	memset(MatIn, 0, 16*sizeof(double));
 	memset(MatOut, 0, 16*sizeof(double));
 
@@ -539,6 +529,7 @@ CMiarex::CMiarex(CWnd* pParent /*=NULL*/)
 
 CMiarex::~CMiarex()
 {
+	ReleasePanelArrays();
 }
 
 void CMiarex::GLDestroyLists()
@@ -784,6 +775,7 @@ BEGIN_MESSAGE_MAP(CMiarex, CWnd)
 	ON_COMMAND(IDM_SHOWALLWOPPS, OnShowAllWOpps)
 	ON_COMMAND(IDM_DELALLPLRWOPPS, OnDelAllPlrWOpps)
 	ON_COMMAND(IDM_WADVSETTINGS, OnWAdvSettings)
+	ON_COMMAND(IDM_WBATCHANALYSIS, OnWPolarBatch)
 	ON_COMMAND(IDM_SHOWXCMREF, OnShowXCmRef)
 	ON_COMMAND(IDM_HIDEALLWPLRS, OnHideAllWPlrs)
 	ON_COMMAND(IDM_SHOWALLWPLRS, OnShowAllWPlrs)
@@ -1370,7 +1362,7 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 
 	if(pNewPoint == NULL) 
 	{
-		AfxMessageBox("Not enough memory to store the OpPoint\n", MB_OK);
+		AnalysisMessage("Not enough memory to store the OpPoint\n");
 		return;
 	}
 	else
@@ -1402,7 +1394,7 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 
 		pNewPoint->m_Span                = m_pCurWing->m_Span;
 		pNewPoint->m_MAChord             = m_pCurWing->m_MAChord;
-		pNewPoint->m_NStation            = m_pCurWing->m_NStation;
+		pNewPoint->AllocateStations(m_pCurWing->m_NStation);
 
 		pNewPoint->m_PlrName             = m_pCurWPolar->m_PlrName;
 		pNewPoint->m_AnalysisType        = m_pCurWPolar->m_AnalysisType;
@@ -1419,7 +1411,7 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 		{
 			pNewPoint->m_Alpha               = m_pCurWing->m_Alpha;
 			pNewPoint->m_QInf                = m_pCurWing->m_QInf;
-			pNewPoint->m_NVLMPanels          = m_pCurWing->m_MatSize;
+			pNewPoint->AllocatePanelResults(m_pCurWing->m_MatSize);
 			pNewPoint->m_bOut                = m_pCurWing->m_bWingOut;
 			pNewPoint->m_CL                  = m_pCurWing->m_CL;
 //			pNewPoint->m_CY                  = m_pCurWing->m_CY;
@@ -1455,7 +1447,6 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 				pNewPoint->m_XTrTop[l]        =  m_pCurWing->m_XTrTop[m_NStation-l];
 				pNewPoint->m_XTrBot[l]        =  m_pCurWing->m_XTrBot[m_NStation-l];
 				pNewPoint->m_BendingMoment[l] =  m_pCurWing->m_BendingMoment[m_NStation-l];
-				memset(pNewPoint->m_Cp, 0, sizeof(pNewPoint->m_Cp));
 				if(abs(m_pCurWing->m_BendingMoment[l])>abs(Cb))	Cb = m_pCurWing->m_BendingMoment[l];
 			}
 		}
@@ -1463,7 +1454,7 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 		{
 			pNewPoint->m_Alpha               = m_VLMDlg.m_OpAlpha;
 			pNewPoint->m_QInf                = m_VLMDlg.m_QInf;
-			pNewPoint->m_NVLMPanels          = m_VLMDlg.m_MatSize;
+			pNewPoint->AllocatePanelResults(m_VLMDlg.m_MatSize);
 			pNewPoint->m_bOut                = m_VLMDlg.m_bPointOut;
 			pNewPoint->m_CL                  = m_VLMDlg.m_CL;
 			pNewPoint->m_CY                  = m_VLMDlg.m_CY;
@@ -1491,27 +1482,29 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 				pNewPoint->m_StripArea[l] = m_pCurWing->m_StripArea[l];
 				if(abs(m_pCurWing->m_BendingMoment[l])>abs(Cb))	Cb = m_pCurWing->m_BendingMoment[l];
 			}
-			memcpy(pNewPoint->m_Cl,         m_pCurWing->m_Cl,         sizeof(m_pCurWing->m_Cl));
-			memcpy(pNewPoint->m_PCd,        m_pCurWing->m_PCd,        sizeof(m_pCurWing->m_PCd));
-			memcpy(pNewPoint->m_Cm,         m_pCurWing->m_Cm,         sizeof(m_pCurWing->m_Cm));
-			memcpy(pNewPoint->m_CmAirf,     m_pCurWing->m_CmAirf,     sizeof(m_pCurWing->m_CmAirf));
-			memcpy(pNewPoint->m_CmXRef,     m_pCurWing->m_CmXRef,     sizeof(m_pCurWing->m_CmXRef));
-			memcpy(pNewPoint->m_XCPSpanRel, m_pCurWing->m_XCPSpanRel, sizeof(m_pCurWing->m_XCPSpanRel));
-			memcpy(pNewPoint->m_XCPSpanAbs, m_pCurWing->m_XCPSpanAbs, sizeof(m_pCurWing->m_XCPSpanAbs));
-			memcpy(pNewPoint->m_Re,         m_pCurWing->m_Re,         sizeof(m_pCurWing->m_Re));
-			memcpy(pNewPoint->m_Chord,      m_pCurWing->m_Chord,      sizeof(m_pCurWing->m_Chord));
-			memcpy(pNewPoint->m_Twist,      m_pCurWing->m_Twist,      sizeof(m_pCurWing->m_Twist));
-			memcpy(pNewPoint->m_XTrTop,     m_pCurWing->m_XTrTop,     sizeof(m_pCurWing->m_XTrTop));
-			memcpy(pNewPoint->m_XTrBot,     m_pCurWing->m_XTrBot,     sizeof(m_pCurWing->m_XTrBot));
-			memcpy(pNewPoint->m_Vd,         m_pCurWing->m_Vd,         sizeof(pNewPoint->m_Vd));
-			memcpy(pNewPoint->m_F,          m_pCurWing->m_F,          sizeof(pNewPoint->m_F));
-			memcpy(pNewPoint->m_BendingMoment, m_pCurWing->m_BendingMoment, sizeof(m_pCurWing->m_BendingMoment));
-			memcpy(pNewPoint->m_ICd,        m_pCurWing->m_ICd, sizeof(pNewPoint->m_ICd));
-			memcpy(pNewPoint->m_Ai,         m_pCurWing->m_Ai,  sizeof(pNewPoint->m_Ai));
-
-			memcpy(pNewPoint->m_Cp,         m_VLMDlg.m_Cp,  sizeof(pNewPoint->m_Cp));
-
-			memcpy(pNewPoint->m_G, Gamma, sizeof(pNewPoint->m_G));
+			memcpy(pNewPoint->m_Cl,         m_pCurWing->m_Cl,         (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_PCd,        m_pCurWing->m_PCd,        (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Cm,         m_pCurWing->m_Cm,         (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_CmAirf,     m_pCurWing->m_CmAirf,     (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_CmXRef,     m_pCurWing->m_CmXRef,     (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XCPSpanRel, m_pCurWing->m_XCPSpanRel, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XCPSpanAbs, m_pCurWing->m_XCPSpanAbs, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Re,         m_pCurWing->m_Re,         (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Chord,      m_pCurWing->m_Chord,      (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Twist,      m_pCurWing->m_Twist,      (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XTrTop,     m_pCurWing->m_XTrTop,     (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XTrBot,     m_pCurWing->m_XTrBot,     (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Vd,         m_pCurWing->m_Vd,         pNewPoint->m_NStation*sizeof(CVector));
+			memcpy(pNewPoint->m_F,          m_pCurWing->m_F,          pNewPoint->m_NStation*sizeof(CVector));
+			memcpy(pNewPoint->m_BendingMoment, m_pCurWing->m_BendingMoment, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_ICd,        m_pCurWing->m_ICd, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Ai,         m_pCurWing->m_Ai,  (pNewPoint->m_NStation+1)*sizeof(double));
+
+			for(i=0; i<pNewPoint->m_NVLMPanels; i++)
+			{
+				pNewPoint->m_Cp[i] = (float)m_VLMDlg.m_Cp[i];
+				pNewPoint->m_G[i]  = (float)Gamma[i];
+			}
 
 			if(m_pCurWPolar->m_bWakeRollUp)
 			{
@@ -1529,7 +1522,7 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 		{
 			pNewPoint->m_Alpha               = m_PanelDlg.m_OpAlpha;
 			pNewPoint->m_QInf                = m_PanelDlg.m_QInf;
-			pNewPoint->m_NVLMPanels          = m_PanelDlg.m_MatSize;
+			pNewPoint->AllocatePanelResults(m_PanelDlg.m_MatSize);
 			pNewPoint->m_bOut                = m_PanelDlg.m_bPointOut;
 			pNewPoint->m_CL                  = m_PanelDlg.m_CL;
 			pNewPoint->m_CY                  = m_PanelDlg.m_CY;
@@ -1554,27 +1547,30 @@ void CMiarex::AddWOpp(bool bPointOut, double *Gamma, double *Sigma, double *Cp)
 				pNewPoint->m_StripArea[l] =  m_pCurWing->m_StripArea[l];
 				if(abs(m_pCurWing->m_BendingMoment[l])>abs(Cb))	Cb = m_pCurWing->m_BendingMoment[l];
 			}
-			memcpy(pNewPoint->m_Cl,            m_pCurWing->m_Cl, sizeof(m_pCurWing->m_Cl));
-			memcpy(pNewPoint->m_PCd,           m_pCurWing->m_PCd, sizeof(m_pCurWing->m_PCd));
-			memcpy(pNewPoint->m_Cm,            m_pCurWing->m_Cm, sizeof(m_pCurWing->m_Cm));
-			memcpy(pNewPoint->m_CmAirf,        m_pCurWing->m_CmAirf, sizeof(m_pCurWing->m_CmAirf));
-			memcpy(pNewPoint->m_CmXRef,        m_pCurWing->m_CmXRef, sizeof(m_pCurWing->m_CmXRef));
-			memcpy(pNewPoint->m_XCPSpanRel,    m_pCurWing->m_XCPSpanRel, sizeof(m_pCurWing->m_XCPSpanRel));
-			memcpy(pNewPoint->m_XCPSpanAbs,    m_pCurWing->m_XCPSpanAbs, sizeof(m_pCurWing->m_XCPSpanAbs));
-			memcpy(pNewPoint->m_Re,            m_pCurWing->m_Re, sizeof(m_pCurWing->m_Re));
-			memcpy(pNewPoint->m_Chord,         m_pCurWing->m_Chord, sizeof(m_pCurWing->m_Chord));
-			memcpy(pNewPoint->m_Twist,         m_pCurWing->m_Twist, sizeof(m_pCurWing->m_Twist));
-			memcpy(pNewPoint->m_XTrTop,        m_pCurWing->m_XTrTop, sizeof(m_pCurWing->m_XTrTop));
-			memcpy(pNewPoint->m_XTrBot,        m_pCurWing->m_XTrBot, sizeof(m_pCurWing->m_XTrBot));
-			memcpy(pNewPoint->m_BendingMoment, m_pCurWing->m_BendingMoment, sizeof(m_pCurWing->m_BendingMoment));
-			memcpy(pNewPoint->m_ICd,           m_pCurWing->m_ICd, sizeof(pNewPoint->m_ICd));
-			memcpy(pNewPoint->m_Vd,            m_pCurWing->m_Vd, sizeof(pNewPoint->m_Vd));
-			memcpy(pNewPoint->m_F,             m_pCurWing->m_F,  sizeof(pNewPoint->m_F));
-			memcpy(pNewPoint->m_Ai,            m_pCurWing->m_Ai, sizeof(pNewPoint->m_Ai));
-
-			memcpy(pNewPoint->m_Cp,    Cp,    sizeof(pNewPoint->m_Cp));
-			memcpy(pNewPoint->m_G,     Gamma, sizeof(pNewPoint->m_G));
-			memcpy(pNewPoint->m_Sigma, Sigma, sizeof(pNewPoint->m_G));
+			memcpy(pNewPoint->m_Cl,            m_pCurWing->m_Cl, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_PCd,           m_pCurWing->m_PCd, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Cm,            m_pCurWing->m_Cm, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_CmAirf,        m_pCurWing->m_CmAirf, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_CmXRef,        m_pCurWing->m_CmXRef, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XCPSpanRel,    m_pCurWing->m_XCPSpanRel, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XCPSpanAbs,    m_pCurWing->m_XCPSpanAbs, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Re,            m_pCurWing->m_Re, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Chord,         m_pCurWing->m_Chord, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Twist,         m_pCurWing->m_Twist, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XTrTop,        m_pCurWing->m_XTrTop, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_XTrBot,        m_pCurWing->m_XTrBot, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_BendingMoment, m_pCurWing->m_BendingMoment, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_ICd,           m_pCurWing->m_ICd, (pNewPoint->m_NStation+1)*sizeof(double));
+			memcpy(pNewPoint->m_Vd,            m_pCurWing->m_Vd, pNewPoint->m_NStation*sizeof(CVector));
+			memcpy(pNewPoint->m_F,             m_pCurWing->m_F,  pNewPoint->m_NStation*sizeof(CVector));
+			memcpy(pNewPoint->m_Ai,            m_pCurWing->m_Ai, (pNewPoint->m_NStation+1)*sizeof(double));
+
+			for(i=0; i<pNewPoint->m_NVLMPanels; i++)
+			{
+				pNewPoint->m_Cp[i]    = (float)Cp[i];
+				pNewPoint->m_G[i]     = (float)Gamma[i];
+				pNewPoint->m_Sigma[i] = (float)Sigma[i];
+			}
  
 			if(m_pCurWPolar->m_bWakeRollUp)
 			{
@@ -3004,6 +3000,8 @@ void CMiarex::SaveSettings(CArchive &ar)
 
 	ar << m_NHoopPoints;
 	ar << m_NXPoints;
+
+	ar << m_FarFieldTheta;
 }
 
 
@@ -3602,6 +3600,18 @@ bool CMiarex::LoadSettings(CArchive &ar, int format)
 		ar >> m_NHoopPoints;
 		ar >> m_NXPoints;
 
+		if(format>=200417)
+		{
+			ar >> m_FarFieldTheta;
+			if(m_FarFieldTheta<0.0 || m_FarFieldTheta>1.0)
+			{
+				m_FarFieldTheta = 0.0;
+				CArchiveException *pfe = new CArchiveException(CArchiveException::badIndex);
+				pfe->m_strFileName = ar.m_strFileName;
+				throw pfe;
+			}
+		}
+
 		pFrame->m_WOperDlgBar.SetParams(NULL);
 		m_FlowLinesDlg.SetUnits();
 
@@ -6351,6 +6361,11 @@ BOOL CMiarex::PreTranslateMessage(MSG* pMsg)
 				OnControlAnalysis();
 				return true;
 			}
+			if(GetKeyState(VK_SHIFT) & 0x8000)
+			{
+				OnWPolarBatch();
+				return true;
+			}
 			OnDefineAnalysis();
 			return true;
 		}
@@ -9273,10 +9288,12 @@ void CMiarex::OnWAdvSettings()
 	CWAdvDlg dlg;
 	dlg.m_AlphaPrec       = CWing::s_CvPrec;
 	dlg.m_Relax           = CWing::s_RelaxMax;
+	dlg.m_bAnderson       = CWing::s_bAnderson;
 	dlg.m_NStation        = CWing::s_NLLTStations;
 	dlg.m_Iter            = m_Iter;
 	dlg.m_MaxWakeIter     = m_MaxWakeIter;
 	dlg.m_CoreSize        = m_CoreSize;
+	dlg.m_FarFieldTheta   = m_FarFieldTheta;
 	dlg.m_bResetWake      = m_bResetWake;
 	dlg.m_bDirichlet      = m_bDirichlet;
 	dlg.m_bTrefftz        = m_bTrefftz;
@@ -9287,15 +9304,18 @@ void CMiarex::OnWAdvSettings()
 	dlg.m_VortexPos       = CPanel::m_VortexPos;
 	dlg.m_WakeInterNodes  = m_WakeInterNodes;
 	dlg.m_pFrame          = m_pFrame;
+	dlg.m_pMiarex         = this;
 
 	if(dlg.DoModal() == IDOK)
 	{
 		CWing::s_CvPrec        = dlg.m_AlphaPrec;
 		CWing::s_RelaxMax      = dlg.m_Relax;
+		CWing::s_bAnderson     = dlg.m_bAnderson;
 		CWing::s_NLLTStations  = dlg.m_NStation;
 		m_Iter                 = dlg.m_Iter;
 		m_MaxWakeIter          = dlg.m_MaxWakeIter;
 		m_CoreSize             = dlg.m_CoreSize;
+		m_FarFieldTheta        = dlg.m_FarFieldTheta;
 		m_bResetWake           = dlg.m_bResetWake;
 		m_bDirichlet           = dlg.m_bDirichlet;
 		m_bTrefftz             = dlg.m_bTrefftz;
@@ -9315,6 +9335,66 @@ void CMiarex::OnWAdvSettings()
 }
 
 
+void CMiarex::OnWPolarBatch() 
+{
+	// Runs the analyses of a selection of the project's wing and plane polars
+	CMainFrame* pFrame = (CMainFrame*)m_pFrame;
+	CString UFOName, PlrName;
+	MEMORYSTATUS ms;
+
+	if(!m_poaWPolar->GetSize())
+	{
+		AfxMessageBox("No analysis has been defined", MB_OK);
+		return;
+	}
+
+	if(m_pCurPlane)     UFOName = m_pCurPlane->m_PlaneName;
+	else if(m_pCurWing) UFOName = m_pCurWing->m_WingName;
+	if(m_pCurWPolar)    PlrName = m_pCurWPolar->m_PlrName;
+
+	GlobalMemoryStatus(&ms);
+
+	CWPolarBatchDlg dlg(this);
+	dlg.m_pMiarex      = this;
+	dlg.m_pFrame       = m_pFrame;
+	dlg.m_AlphaMin     = pFrame->m_WOperDlgBar.m_Alpha0;
+	dlg.m_AlphaMax     = pFrame->m_WOperDlgBar.m_AlphaMax;
+	dlg.m_DeltaAlpha   = pFrame->m_WOperDlgBar.m_DeltaAlpha;
+	dlg.m_QInfMin      = pFrame->m_WOperDlgBar.m_QInf0;
+	dlg.m_QInfMax      = pFrame->m_WOperDlgBar.m_QInfMax;
+	dlg.m_DeltaQInf    = pFrame->m_WOperDlgBar.m_DeltaQInf;
+	dlg.m_ControlMin   = pFrame->m_WOperDlgBar.m_Control0;
+	dlg.m_ControlMax   = pFrame->m_WOperDlgBar.m_ControlMax;
+	dlg.m_DeltaControl = pFrame->m_WOperDlgBar.m_DeltaControl;
+	dlg.m_MemLimit     = (double)(ms.dwAvailPhys/1024/1024);
+
+	// the message boxes of the analyses would interrupt the batch, their text goes to the batch output instead
+	m_bBatch = true;
+	dlg.DoModal();
+	m_bBatch = false;
+
+	pFrame->m_WOperDlgBar.m_Alpha0       = dlg.m_AlphaMin;
+	pFrame->m_WOperDlgBar.m_AlphaMax     = dlg.m_AlphaMax;
+	pFrame->m_WOperDlgBar.m_DeltaAlpha   = dlg.m_DeltaAlpha;
+	pFrame->m_WOperDlgBar.m_QInf0        = dlg.m_QInfMin;
+	pFrame->m_WOperDlgBar.m_QInfMax      = dlg.m_QInfMax;
+	pFrame->m_WOperDlgBar.m_DeltaQInf    = dlg.m_DeltaQInf;
+	pFrame->m_WOperDlgBar.m_Control0     = dlg.m_ControlMin;
+	pFrame->m_WOperDlgBar.m_ControlMax   = dlg.m_ControlMax;
+	pFrame->m_WOperDlgBar.m_DeltaControl = dlg.m_DeltaControl;
+
+	// restore the wing or plane and the polar which were selected before the batch
+	if(UFOName.GetLength())
+	{
+		SetUFO(UFOName);
+		if(PlrName.GetLength()) SetWPlr(false, PlrName);
+	}
+	if(m_iView==2) CreateWPolarCurves();
+	else           CreateWOppCurves();
+	UpdateView();
+}
+
+
 void CMiarex::OnHideAllWPlrs() 
 {
 	int i;
@@ -10585,24 +10665,10 @@ void CMiarex::GLCreateSurfSpeeds()
 	CVector RefPoint(0.0,0.0,0.0);
 
 	factor = 0.2;
-	if(m_pCurPOpp)     
-	{
-		Gamma = m_pCurPOpp->m_G;
-		Mu    = m_pCurPOpp->m_G;
-		Sigma = m_pCurPOpp->m_Sigma;
-	}
-	else if (m_pCurWOpp)  
-	{
-		Gamma = m_pCurWOpp->m_G;
-		Mu    = m_pCurWOpp->m_G;
-		Sigma = m_pCurWOpp->m_Sigma;
-	}
-	else 
-	{
-		Gamma = NULL;
-		Mu    = NULL;
-		Sigma = NULL;
-	}
+	AllocateStrengths(Mu, Sigma);
+	Gamma = Mu;
+	if(m_pCurWPolar->m_AnalysisType==2)      m_VLMDlg.BuildFarField(Gamma);
+	else if(m_pCurWPolar->m_AnalysisType==3) m_PanelDlg.BuildFarField(Mu, Sigma);
 
 	glNewList(SURFACESPEEDS, GL_COMPILE);
 	{
@@ -10708,6 +10774,10 @@ void CMiarex::GLCreateSurfSpeeds()
 		glDisable (GL_LINE_STIPPLE);
 	}
 	glEndList();
+	m_VLMDlg.ReleaseFarField();
+	m_PanelDlg.ReleaseFarField();
+	if(Mu)    delete [] Mu;
+	if(Sigma) delete [] Sigma;
 	dlg.ShowWindow(SW_HIDE);
 }
 
@@ -10749,24 +10819,8 @@ void CMiarex::GLCreateStreamLines()
 	Wing[2] = m_pCurStab;
 	Wing[3] = m_pCurFin;
  
-	if(m_pCurPOpp)      
-	{
-		Gamma = m_pCurPOpp->m_G;
-		Mu    = m_pCurPOpp->m_G;
-		Sigma = m_pCurPOpp->m_Sigma;
-	}
-	else if (m_pCurWOpp)  
-	{
-		Gamma = m_pCurWOpp->m_G;
-		Mu    = m_pCurWOpp->m_G;
-		Sigma = m_pCurWOpp->m_Sigma;
-	}
-	else 
-	{
-		Gamma = NULL;
-		Mu    = NULL;
-		Sigma = NULL;
-	}
+	AllocateStrengths(Mu, Sigma);
+	Gamma = Mu;
 
 	m_PanelDlg.m_bCancel = false;
 	m_VLMDlg.m_bCancel   = false;
@@ -10782,6 +10836,10 @@ void CMiarex::GLCreateStreamLines()
 	//Tilt the geometry w.r.t. aoa
 	RotateGeomY(m_pCurWOpp->m_Alpha, RefPoint);
 
+	// the octree is built on the tilted geometry
+	if(m_pCurWPolar->m_AnalysisType==2)      m_VLMDlg.BuildFarField(Gamma);
+	else if(m_pCurWPolar->m_AnalysisType==3) m_PanelDlg.BuildFarField(Mu, Sigma);
+
 	glNewList(VLMSTREAMLINES,GL_COMPILE);
 	{
 		m_GLList++;
@@ -10944,16 +11002,39 @@ void CMiarex::GLCreateStreamLines()
 	}
 	glEndList();
 
+	m_VLMDlg.ReleaseFarField();
+	m_PanelDlg.ReleaseFarField();
+
 	//restore the initial geometry
 	memcpy(m_Panel, m_MemPanel, m_MatSize * sizeof(CPanel));
 	memcpy(m_Node,  m_MemNode,  m_nNodes  * sizeof(CVector));
 	memcpy(m_WakePanel, m_RefWakePanel,  m_WakeSize   * sizeof(CPanel));
 	memcpy(m_WakeNode,  m_RefWakeNode,   m_nWakeNodes * sizeof(CVector));
 
+	if(Mu)    delete [] Mu;
+	if(Sigma) delete [] Sigma;
 	dlg.ShowWindow(SW_HIDE);
 }
 
 
+void CMiarex::AllocateStrengths(double *&Mu, double *&Sigma)
+{
+	// the operating points store the strengths in single precision
+	// expand them for the velocity calculations - the caller releases the arrays
+	int n;
+	Mu    = NULL;
+	Sigma = NULL;
+	if(m_pCurPOpp)                         n = m_pCurPOpp->m_NPanels;
+	else if(m_pCurWOpp && m_pCurWOpp->m_G) n = m_pCurWOpp->m_NVLMPanels;
+	else return;
+
+	Mu    = new double[n+1];
+	Sigma = new double[n+1];
+	if(m_pCurPOpp) m_pCurPOpp->GetStrengths(Mu, Sigma);
+	else           m_pCurWOpp->GetStrengths(Mu, Sigma);
+}
+
+
 void CMiarex::GLCreateDownwash(CWing *pWing, CWOpp *pWOpp, UINT List, int surf0)
 {
 	// pWing is either the Wing, the stab, or the fin
@@ -11101,8 +11182,12 @@ void CMiarex::GLCreateCp()
 	CVector LA,LB,TA,TB, Pt;
 	CVector C,N;
 	double color, lmin, lmax, range;
-	double *tab;
-	double CpInf[2*VLMMATSIZE], CpSup[2*VLMMATSIZE], Cp100[2*VLMMATSIZE];
+	float *tab;
+	double *CpInf, *CpSup, *Cp100;
+
+	CpInf = new double[m_nNodes+1];
+	CpSup = new double[m_nNodes+1];
+	Cp100 = new double[m_nNodes+1];
 
 	glNewList(PANELCP,GL_COMPILE);
 	{
@@ -11230,6 +11315,9 @@ void CMiarex::GLCreateCp()
 	}
 	glEndList();
 
+	delete [] CpInf;
+	delete [] CpSup;
+	delete [] Cp100;
 }
 
 
@@ -15679,14 +15767,14 @@ void CMiarex::LLTAnalyze(double V0, double VMax, double VDelta, bool bSequence,
 		{
 			CString strong;
 			strong = "Could not find the wing's foil "+ m_pCurWing->m_RFoil[l] +"...\nAborting Calculation";
-			AfxMessageBox(strong);
+			AnalysisMessage(strong);
 			return;
 		}
 		if (!pFrame->GetFoil(m_pCurWing->m_LFoil[l]))
 		{
 			CString strong;
 			strong = "Could not find the wing's foil "+ m_pCurWing->m_LFoil[l] +"...\nAborting Calculation";
-			AfxMessageBox(strong);
+			AnalysisMessage(strong);
 			return;
 		}
 	}
@@ -15717,6 +15805,213 @@ void CMiarex::LLTAnalyze(double V0, double VMax, double VDelta, bool bSequence,
 }
 
 
+bool CMiarex::AllocatePanelArrays(int nPanels, int nNodes, int nWakePanels, int nWakeNodes)
+{
+	// Sizes the panel and node arrays for the current geometry
+	// The arrays are only re-allocated if the geometry requires more elements than are currently available,
+	// so that switching between polars or planes does not cost a new allocation each time
+	// The content of the arrays is not preserved
+	try
+	{
+		if(nPanels>m_MaxPanels)
+		{
+			if(m_Panel)    delete [] m_Panel;
+			if(m_MemPanel) delete [] m_MemPanel;
+			if(m_pPanel)   delete [] m_pPanel;
+			m_Panel    = NULL;
+			m_MemPanel = NULL;
+			m_pPanel   = NULL;
+			m_MaxPanels = 0;
+
+			m_Panel    = new CPanel[nPanels];
+			m_MemPanel = new CPanel[nPanels];
+			m_pPanel   = new CPanel*[nPanels];
+			memset(m_pPanel, 0, nPanels*sizeof(CPanel*));
+			m_MaxPanels = nPanels;
+		}
+		if(nNodes>m_MaxNodes)
+		{
+			if(m_Node)    delete [] m_Node;
+			if(m_MemNode) delete [] m_MemNode;
+			m_Node    = NULL;
+			m_MemNode = NULL;
+			m_MaxNodes = 0;
+
+			m_Node    = new CVector[nNodes];
+			m_MemNode = new CVector[nNodes];
+			m_MaxNodes = nNodes;
+		}
+		if(nWakePanels>m_MaxWakePanels)
+		{
+			if(m_WakePanel)    delete [] m_WakePanel;
+			if(m_RefWakePanel) delete [] m_RefWakePanel;
+			m_WakePanel    = NULL;
+			m_RefWakePanel = NULL;
+			m_MaxWakePanels = 0;
+
+			m_WakePanel    = new CPanel[nWakePanels];
+			m_RefWakePanel = new CPanel[nWakePanels];
+			m_MaxWakePanels = nWakePanels;
+		}
+		if(nWakeNodes>m_MaxWakeNodes)
+		{
+			if(m_WakeNode)     delete [] m_WakeNode;
+			if(m_RefWakeNode)  delete [] m_RefWakeNode;
+			if(m_TempWakeNode) delete [] m_TempWakeNode;
+			m_WakeNode     = NULL;
+			m_RefWakeNode  = NULL;
+			m_TempWakeNode = NULL;
+			m_MaxWakeNodes = 0;
+
+			m_WakeNode     = new CVector[nWakeNodes];
+			m_RefWakeNode  = new CVector[nWakeNodes];
+			m_TempWakeNode = new CVector[nWakeNodes];
+			m_MaxWakeNodes = nWakeNodes;
+		}
+	}
+	catch (CMemoryException *ex)
+	{
+		ex->Delete();
+		ReleasePanelArrays();
+		return false;
+	}
+
+	SetPanelPointers();
+	return true;
+}
+
+
+bool CMiarex::AllocateMatrixArrays(int MatSize)
+{
+	// Sizes the influence matrices and the RHS arrays before a VLM or a panel analysis
+	// m_aij is also used as a work array by the solvers to sort the results of a block of RHSBLOCK operating points
+	int MatrixSize;
+	if(MatSize<=m_MaxMatSize) return true;
+
+	if(m_aij)    delete [] m_aij;
+	if(m_aijRef) delete [] m_aijRef;
+	if(m_RHS)    delete [] m_RHS;
+	if(m_RHSRef) delete [] m_RHSRef;
+	m_aij    = NULL;
+	m_aijRef = NULL;
+	m_RHS    = NULL;
+	m_RHSRef = NULL;
+	m_MaxMatSize = 0;
+
+	MatrixSize = MatSize * max(MatSize, RHSBLOCK);
+	try
+	{
+		m_aij    = new double[MatrixSize];
+		m_aijRef = new double[MatrixSize];
+		m_RHS    = new double[MatSize*RHSBLOCK];
+		m_RHSRef = new double[MatSize*RHSBLOCK];
+	}
+	catch (CMemoryException *ex)
+	{
+		ex->Delete();
+		if(m_aij)    delete [] m_aij;
+		if(m_aijRef) delete [] m_aijRef;
+		if(m_RHS)    delete [] m_RHS;
+		m_aij    = NULL;
+		m_aijRef = NULL;
+		m_RHS    = NULL;
+		SetPanelPointers();
+		return false;
+	}
+	memset(m_aij,    0, MatrixSize*sizeof(double));
+	memset(m_aijRef, 0, MatrixSize*sizeof(double));
+	memset(m_RHS,    0, MatSize*RHSBLOCK*sizeof(double));
+	memset(m_RHSRef, 0, MatSize*RHSBLOCK*sizeof(double));
+	m_MaxMatSize = MatSize;
+
+	SetPanelPointers();
+	return true;
+}
+
+
+void CMiarex::ReleasePanelArrays()
+{
+	if(m_Panel)        delete [] m_Panel;
+	if(m_MemPanel)     delete [] m_MemPanel;
+	if(m_pPanel)       delete [] m_pPanel;
+	if(m_WakePanel)    delete [] m_WakePanel;
+	if(m_RefWakePanel) delete [] m_RefWakePanel;
+	if(m_Node)         delete [] m_Node;
+	if(m_MemNode)      delete [] m_MemNode;
+	if(m_WakeNode)     delete [] m_WakeNode;
+	if(m_RefWakeNode)  delete [] m_RefWakeNode;
+	if(m_TempWakeNode) delete [] m_TempWakeNode;
+	if(m_aij)          delete [] m_aij;
+	if(m_aijRef)       delete [] m_aijRef;
+	if(m_RHS)          delete [] m_RHS;
+	if(m_RHSRef)       delete [] m_RHSRef;
+
+	m_Panel        = NULL;
+	m_MemPanel     = NULL;
+	m_pPanel       = NULL;
+	m_WakePanel    = NULL;
+	m_RefWakePanel = NULL;
+	m_Node         = NULL;
+	m_MemNode      = NULL;
+	m_WakeNode     = NULL;
+	m_RefWakeNode  = NULL;
+	m_TempWakeNode = NULL;
+	m_aij          = NULL;
+	m_aijRef       = NULL;
+	m_RHS          = NULL;
+	m_RHSRef       = NULL;
+
+	m_MaxPanels     = 0;
+	m_MaxNodes      = 0;
+	m_MaxWakePanels = 0;
+	m_MaxWakeNodes  = 0;
+	m_MaxMatSize    = 0;
+
+	SetPanelPointers();
+}
+
+
+void CMiarex::SetPanelPointers()
+{
+	// the classes which work on the panels keep a pointer to the arrays ;
+	// these need to be updated each time the arrays are re-allocated
+	CPanel::s_pNode     = m_Node;
+	CSurface::s_pPanel  = m_Panel;
+	CSurface::s_pNode   = m_Node;
+	CWing::m_pWakePanel = m_WakePanel;
+	CWing::m_pWakeNode  = m_WakeNode;
+
+	m_VLMDlg.m_pNode         = m_Node;
+	m_VLMDlg.m_pPanel        = m_Panel;
+	m_VLMDlg.m_ppPanel       = m_pPanel;
+	m_VLMDlg.m_pWakeNode     = m_WakeNode;
+	m_VLMDlg.m_pWakePanel    = m_WakePanel;
+	m_VLMDlg.m_pMemNode      = m_MemNode;
+	m_VLMDlg.m_pMemPanel     = m_MemPanel;
+	m_VLMDlg.m_pTempWakeNode = m_TempWakeNode;
+	m_VLMDlg.m_pRefWakeNode  = m_RefWakeNode;
+	m_VLMDlg.m_pRefWakePanel = m_RefWakePanel;
+	m_VLMDlg.m_RHS           = m_RHS;		
+	m_VLMDlg.m_Gamma         = m_RHSRef;
+	m_VLMDlg.m_aij           = m_aij;		
+
+	m_PanelDlg.m_pPanel        = m_Panel;
+	m_PanelDlg.m_ppPanel       = m_pPanel;
+	m_PanelDlg.m_pNode         = m_Node;
+	m_PanelDlg.m_pWakePanel    = m_WakePanel;
+	m_PanelDlg.m_pWakeNode     = m_WakeNode;
+	m_PanelDlg.m_pMemNode      = m_MemNode;
+	m_PanelDlg.m_pMemPanel     = m_MemPanel;
+	m_PanelDlg.m_pTempWakeNode = m_TempWakeNode;
+	m_PanelDlg.m_pRefWakeNode  = m_RefWakeNode;
+	m_PanelDlg.m_pRefWakePanel = m_RefWakePanel;
+	m_PanelDlg.m_aij           = m_aij;
+	m_PanelDlg.m_aijRef        = m_aijRef;
+	m_PanelDlg.m_RHS           = m_RHS;
+	m_PanelDlg.m_RHSRef        = m_RHSRef;
+}
+
+
 bool CMiarex::InitializePanels()
 {
 	if(!m_pCurWing) return false;
@@ -15732,12 +16027,14 @@ bool CMiarex::InitializePanels()
 	CWaitCursor wait;
 	CMainFrame *pFrame = (CMainFrame*)m_pFrame;
 	int p, pp;
-	int Nel;
+	int Nel, NXWake, nWakeColumns;
 	m_MatSize = 0;
+	nWakeColumns = 0;
 
 	for (j=0; j<m_NSurfaces; j++) 
 	{
 		m_MatSize += m_pSurface[j]->m_NXPanels * m_pSurface[j]->m_NYPanels ;
+		nWakeColumns += m_pSurface[j]->m_NYPanels;
 	}
 	if(m_pCurWPolar && m_pCurWPolar->m_AnalysisType==3 && !m_pCurWPolar->m_bThinSurfaces)
 	{
@@ -15760,25 +16057,30 @@ bool CMiarex::InitializePanels()
 		else                                      bBodyEl = false;
 	}
 
-	if(m_MatSize>VLMMATSIZE)
+	// one wake column is created for each trailing panel, i.e. at most one per spanwise strip
+	if(m_pCurWPolar && m_pCurWPolar->m_AnalysisType>=2) NXWake = m_pCurWPolar->m_NXWakePanels;
+	else                                                NXWake = 0;
+
+	// size the arrays for this geometry ; in the worst case the panels do not share nodes
+	if(!AllocatePanelArrays(m_MatSize, 4*m_MatSize, NXWake*nWakeColumns, 4*NXWake*nWakeColumns))
 	{
 		CString strong;
-		strong.Format("The total number of panels is %d\n The Max Number is %d\nA reduction of the number of panels is required",m_MatSize, VLMMATSIZE);
-		AfxMessageBox(strong, MB_OK);
+		strong.Format("Not enough memory to create %d panels\nA reduction of the number of panels is required",m_MatSize);
+		AnalysisMessage(strong);
 		m_MatSize = 0;
 		m_nNodes  = 0;
 		return false;
 	}
 
+	for (p=0; p<m_MatSize; p++)   m_Panel[p].Reset();
+	for (p=0; p<4*m_MatSize; p++) m_Node[p].Set(0.0, 0.0, 0.0);
+
 	m_MatSize     = 0;
 	m_nNodes      = 0;
 	m_NWakeColumn = 0;
 	m_nWakeNodes  = 0;
 	m_WakeSize    = 0;
 
-	memset(m_Panel, 0, sizeof(m_Panel));
-	memset(m_Node,  0, sizeof(m_Node));
-
 	p = 0;
 	CPanel *ptr = m_Panel;
 
@@ -16903,14 +17205,14 @@ void CMiarex::Analyze(double V0, double VMax, double VDelta, bool bSequence, boo
 		{
 			CString strong;
 			strong = "Could not find the wing's foil "+ m_pCurWing->m_RFoil[l] +"...\nAborting Calculation";
-			AfxMessageBox(strong);
+			AnalysisMessage(strong);
 			return;
 		}
 		if (!pFrame->GetFoil(m_pCurWing->m_LFoil[l]))
 		{
 			CString strong;
 			strong = "Could not find the wing's foil "+ m_pCurWing->m_LFoil[l] +"...\nAborting Calculation";
-			AfxMessageBox(strong);
+			AnalysisMessage(strong);
 			return;
 		}
 	}
@@ -16921,13 +17223,13 @@ void CMiarex::Analyze(double V0, double VMax, double VDelta, bool bSequence, boo
 			if (!pFrame->GetFoil(m_pCurStab->m_RFoil[l])){
 				CString strong;
 				strong = "Could not find the elevator's foil "+ m_pCurStab->m_RFoil[l] +"...\nAborting Calculation";
-				AfxMessageBox(strong);
+				AnalysisMessage(strong);
 				return;
 			}
 			if (!pFrame->GetFoil(m_pCurStab->m_LFoil[l])){
 				CString strong;
 				strong = "Could not find the elevator's foil "+ m_pCurStab->m_LFoil[l] +"...\nAborting Calculation";
-				AfxMessageBox(strong);
+				AnalysisMessage(strong);
 				return;
 			}
 		}
@@ -16939,14 +17241,205 @@ void CMiarex::Analyze(double V0, double VMax, double VDelta, bool bSequence, boo
 			if (!pFrame->GetFoil(m_pCurFin->m_RFoil[l])){
 				CString strong;
 				strong = "Could not find the fin's foil "+ m_pCurFin->m_RFoil[l] +"...\nAborting Calculation";
-				AfxMessageBox(strong);
+				AnalysisMessage(strong);
 				return;
 			}
 		}
 	}
+	if(m_pCurWPolar->m_AnalysisType>=2 && !AllocateMatrixArrays(m_MatSize))
+	{
+		CString strong;
+		strong.Format("Not enough memory to build the influence matrix for %d panels\nAborting Calculation", m_MatSize);
+		AnalysisMessage(strong);
+		return;
+	}
+
+	// the polars may have changed since the last analysis
+	m_PolarIndex.Build(m_poaPolar);
+
 	if(m_pCurWPolar->m_AnalysisType==1)      LLTAnalyze(V0, VMax, VDelta, bSequence, bInitCalc);
 	else if(m_pCurWPolar->m_AnalysisType==2) VLMAnalyze(V0, VMax, VDelta, bSequence, bInitCalc);
 	else if(m_pCurWPolar->m_AnalysisType==3) PanelAnalyze(V0, VMax, VDelta, bSequence, bInitCalc);
+
+	// do not keep pointers to polars which may be deleted before the next analysis
+	m_PolarIndex.Clear();
+}
+
+
+int CMiarex::BatchAnalyze(CWPolar *pWPolar, double V0, double VMax, double VDelta, CString &strong)
+{
+	// Runs the sequence of the polar pWPolar for the batch analysis, without any message box
+	// Returns 1 if the analysis has been run, 0 if it has been skipped, with the reason in strong,
+	// and -1 if it has been cancelled from the analysis dialog
+	CPlane *pPlane = GetPlane(pWPolar->m_UFOName);
+	CWing  *pWing  = GetWing(pWPolar->m_UFOName);
+	CString UFOName, FoilName;
+	bool bFoils = true;
+
+	if(pPlane)
+	{
+		bFoils = CheckFoils(&pPlane->m_Wing, FoilName);
+		if(bFoils && pPlane->m_bBiplane) bFoils = CheckFoils(&pPlane->m_Wing2, FoilName);
+		if(bFoils && pPlane->m_bStab)    bFoils = CheckFoils(&pPlane->m_Stab,  FoilName);
+		if(bFoils && pPlane->m_bFin)     bFoils = CheckFoils(&pPlane->m_Fin,   FoilName);
+	}
+	else if(pWing) bFoils = CheckFoils(pWing, FoilName);
+	else
+	{
+		strong = "the wing or plane could not be found";
+		return 0;
+	}
+	if(!bFoils)
+	{
+		strong = "the foil " + FoilName + " could not be found";
+		return 0;
+	}
+
+	if(m_pCurPlane)     UFOName = m_pCurPlane->m_PlaneName;
+	else if(m_pCurWing) UFOName = m_pCurWing->m_WingName;
+	if(UFOName != pWPolar->m_UFOName) SetUFO(pWPolar->m_UFOName);
+	SetWPlr(false, pWPolar->m_PlrName);
+	if(m_pCurWPolar != pWPolar)
+	{
+		strong = "the polar could not be selected";
+		return 0;
+	}
+
+	m_LLTDlg.m_bCancel    = false;
+	m_VLMDlg.m_bCancel    = false;
+	m_PanelDlg.m_bCancel  = false;
+	m_LLTDlg.m_bWarning   = false;
+	m_VLMDlg.m_bWarning   = false;
+	m_PanelDlg.m_bWarning = false;
+	m_strBatchMessage.Empty();
+
+	Analyze(V0, VMax, VDelta, true, true);
+
+	if(m_LLTDlg.m_bCancel || m_VLMDlg.m_bCancel || m_PanelDlg.m_bCancel) return -1;
+
+	// the messages are those of the checks which abort the analysis
+	if(m_strBatchMessage.GetLength())
+	{
+		strong = m_strBatchMessage;
+		strong.Replace("\n", " ");
+		strong.TrimRight();
+		return 0;
+	}
+	if(m_LLTDlg.m_bWarning || m_VLMDlg.m_bWarning || m_PanelDlg.m_bWarning)
+		strong = "some points were found outside the flight envelope, see the log file";
+	else 
+		strong.Empty();
+	return 1;
+}
+
+
+void CMiarex::AnalysisMessage(CString const &strong)
+{
+	// Advises the user that the analysis has failed
+	// In batch mode, the message is stored for the batch output rather than displayed
+	if(m_bBatch)
+	{
+		if(m_strBatchMessage.GetLength()) m_strBatchMessage += " ";
+		m_strBatchMessage += strong;
+	}
+	else AfxMessageBox(strong);
+}
+
+
+bool CMiarex::CheckFoils(CWing *pWing, CString &FoilName)
+{
+	// Returns false, with the name of the first missing foil, if some of the wing's foils have not been loaded
+	CMainFrame *pFrame = (CMainFrame*)m_pFrame;
+	int l;
+	for (l=0; l<=pWing->m_NPanel; l++)
+	{
+		if (!pFrame->GetFoil(pWing->m_RFoil[l]))
+		{
+			FoilName = pWing->m_RFoil[l];
+			return false;
+		}
+		if (!pFrame->GetFoil(pWing->m_LFoil[l]))
+		{
+			FoilName = pWing->m_LFoil[l];
+			return false;
+		}
+	}
+	return true;
+}
+
+
+double CMiarex::GetAnalysisMemory(CWPolar *pWPolar, int &nPanels)
+{
+	// Estimates the memory in MB required by the analysis of the polar, from the panel count of its wing or plane,
+	// as in InitializePanels : the influence matrix and its reference, the RHS blocks, the panels and the nodes,
+	// the wake panels and their nodes, and the factor cache, which may fill up to its budget during the analysis
+	// The LLT does not require any significant memory
+	CPlane *pPlane = GetPlane(pWPolar->m_UFOName);
+	CWing  *pWing  = GetWing(pWPolar->m_UFOName);
+	int N, nTip, nStrips, NWake;
+	double Mem;
+
+	nPanels = 0;
+	if(pWPolar->m_AnalysisType<2) return 0.0;
+
+	if(pPlane)
+	{
+		N       = pPlane->m_Wing.VLMGetPanelTotal();
+		nStrips = pPlane->m_Wing.VLMGetStripTotal();
+		nTip    = pPlane->m_Wing.m_NXPanels[pPlane->m_Wing.m_NPanel-1];
+		if(pPlane->m_bBiplane)
+		{
+			N       += pPlane->m_Wing2.VLMGetPanelTotal();
+			nStrips += pPlane->m_Wing2.VLMGetStripTotal();
+			nTip    += pPlane->m_Wing2.m_NXPanels[pPlane->m_Wing2.m_NPanel-1];
+		}
+		if(pPlane->m_bStab)
+		{
+			N       += pPlane->m_Stab.VLMGetPanelTotal();
+			nStrips += pPlane->m_Stab.VLMGetStripTotal();
+			nTip    += pPlane->m_Stab.m_NXPanels[pPlane->m_Stab.m_NPanel-1];
+		}
+		if(pPlane->m_bFin)
+		{
+			if(pPlane->m_bDoubleFin || pPlane->m_bSymFin)
+			{
+				N       += 2*pPlane->m_Fin.VLMGetPanelTotal();
+				nStrips += 2*pPlane->m_Fin.VLMGetStripTotal();
+			}
+			else
+			{
+				N       += pPlane->m_Fin.VLMGetPanelTotal();
+				nStrips += pPlane->m_Fin.VLMGetStripTotal();
+			}
+			nTip += pPlane->m_Fin.m_NXPanels[pPlane->m_Fin.m_NPanel-1];
+		}
+	}
+	else if(pWing)
+	{
+		N       = pWing->VLMGetPanelTotal();
+		nStrips = pWing->VLMGetStripTotal();
+		nTip    = pWing->m_NXPanels[pWing->m_NPanel-1];
+	}
+	else return 0.0;
+
+	// top and bottom surfaces, and the tip patches on both sides
+	if(pWPolar->m_AnalysisType==3 && !pWPolar->m_bThinSurfaces) N = 2*N + 2*nTip;
+
+	// the body is only meshed for panel analyses
+	if(pWPolar->m_AnalysisType==3 && pPlane && pPlane->m_bBody && pPlane->m_pBody) 
+		N += 2 * pPlane->m_pBody->m_nxPanels * pPlane->m_pBody->m_nhPanels;
+
+	// one wake column is shed by each spanwise strip
+	NWake = pWPolar->m_NXWakePanels * nStrips;
+
+	nPanels = N;
+
+	Mem  = 2.0 * (double)N * (double)max(N, RHSBLOCK) * sizeof(double);
+	Mem += 2.0 * (double)N * (double)RHSBLOCK * sizeof(double);
+	Mem += (double)N * (2.0*sizeof(CPanel) + sizeof(CPanel*) + 8.0*sizeof(CVector));
+	Mem += (double)NWake * (2.0*sizeof(CPanel) + 8.0*sizeof(CVector));
+	Mem += (double)(__int64)m_FactorCache.GetMaxMemory();
+	return Mem/1024.0/1024.0;
 }
 
 CWing * CMiarex::GetWing(CString WingName)
@@ -17560,7 +18053,7 @@ void CMiarex::AddPOpp(bool bPointOut, double *Cp, double *Gamma, double *Sigma,
 		pPOpp = new CPOpp();
 		if(pPOpp == NULL)
 		{
-			AfxMessageBox("Not enough memory to store the OpPoint\n", MB_OK);
+			AnalysisMessage("Not enough memory to store the OpPoint\n");
 			return;
 		}
 
@@ -17620,7 +18113,7 @@ void CMiarex::AddPOpp(bool bPointOut, double *Cp, double *Gamma, double *Sigma,
 
 		if(m_pCurWPolar->m_AnalysisType==2)
 		{
-			pPOpp->m_NPanels             = m_VLMDlg.m_MatSize;
+			pPOpp->AllocatePanelResults(m_VLMDlg.m_MatSize);
 			pPOpp->m_Alpha               = m_VLMDlg.m_OpAlpha;
 			pPOpp->m_QInf                = m_VLMDlg.m_QInf;
 			if(m_pCurWPolar->m_Type>=5)  
@@ -17655,7 +18148,7 @@ void CMiarex::AddPOpp(bool bPointOut, double *Cp, double *Gamma, double *Sigma,
 		}
 		else if(m_pCurWPolar->m_AnalysisType==3)
 		{
-			pPOpp->m_NPanels             = m_PanelDlg.m_MatSize;
+			pPOpp->AllocatePanelResults(m_PanelDlg.m_MatSize);
 			pPOpp->m_Alpha               = m_PanelDlg.m_OpAlpha;
 			pPOpp->m_QInf                = m_PanelDlg.m_QInf;
 
@@ -17687,44 +18180,15 @@ void CMiarex::AddPOpp(bool bPointOut, double *Cp, double *Gamma, double *Sigma,
 		pPOpp->m_FinWOpp.m_QInf    = pPOpp->m_QInf;
 
 
-		if(Cp) memcpy(pPOpp->m_Cp, Cp,  sizeof(pPOpp->m_Cp));
-
-		if(Gamma)	memcpy(pPOpp->m_G,  Gamma,   sizeof(pPOpp->m_G));
-
-		if(Sigma)	memcpy(pPOpp->m_Sigma,  Sigma,   sizeof(pPOpp->m_G));
-
-		p = 0;
-		for(i=0; i<m_pCurWing->m_MatSize; i++){
-			pPOpp->m_WingWOpp.m_Cp[p] = pPOpp->m_Cp[p];
-			p++;
-		}
-		if(m_pCurWing2)
-		{
-			for(i=0; i<m_pCurWing2->m_MatSize; i++)
-			{
-				pPOpp->m_Wing2WOpp.m_Cp[i] = pPOpp->m_Cp[p];
-				p++;
-			}
-			memcpy(pPOpp->m_Wing2WOpp.m_Vd,       m_pCurWing2->m_Vd,  sizeof(pPOpp->m_Wing2WOpp.m_Vd));
-		}
-		if(m_pCurStab)
-		{
-			for(i=0; i<m_pCurStab->m_MatSize; i++)
-			{
-				pPOpp->m_StabWOpp.m_Cp[i] = pPOpp->m_Cp[p];
-				p++;
-			}
-			memcpy(pPOpp->m_StabWOpp.m_Vd,        m_pCurStab->m_Vd,  sizeof(pPOpp->m_StabWOpp.m_Vd));
-		}
-		if(m_pCurFin)
+		for(p=0; p<pPOpp->m_NPanels; p++)
 		{
-			for(i=0; i<m_pCurFin->m_MatSize; i++)
-			{
-				pPOpp->m_FinWOpp.m_Cp[i] = pPOpp->m_Cp[p];
-				p++;
-			}
-			memcpy(pPOpp->m_FinWOpp.m_Vd,         m_pCurFin->m_Vd,  sizeof(pPOpp->m_FinWOpp.m_Vd));
+			if(Cp)    pPOpp->m_Cp[p]    = (float)Cp[p];
+			if(Gamma) pPOpp->m_G[p]     = (float)Gamma[p];
+			if(Sigma) pPOpp->m_Sigma[p] = (float)Sigma[p];
 		}
+
+		// the wings' Cp values are read from the plane's array
+		pPOpp->AttachWingResults();
 		
 		m_pCurWPolar->AddPoint(pPOpp);
 
@@ -17858,7 +18322,7 @@ void CMiarex::CreateWOpp(CWOpp *pWOpp, CWing *pWing)
 	pWOpp->m_bVLM1               = m_pCurWPolar->m_bVLM1;
 	pWOpp->m_bThinSurface        = m_pCurWPolar->m_bThinSurfaces;
 	pWOpp->m_bTiltedGeom         = m_pCurWPolar->m_bTiltedGeom;
-	pWOpp->m_NStation            = pWing->m_NStation;
+	pWOpp->AllocateStations(pWing->m_NStation);
 	pWOpp->m_NVLMPanels          = pWing->m_MatSize;
 	pWOpp->m_AnalysisType        = m_pCurWPolar->m_AnalysisType;
 
@@ -17890,23 +18354,23 @@ void CMiarex::CreateWOpp(CWOpp *pWOpp, CWing *pWing)
 	pWOpp->m_XCP                 = pWing->m_XCP;
 	pWOpp->m_YCP                 = pWing->m_YCP;
 
-	memcpy(pWOpp->m_Ai,            pWing->m_Ai,            sizeof(pWing->m_Ai));
-	memcpy(pWOpp->m_Cl,            pWing->m_Cl,            sizeof(pWing->m_Cl));
-	memcpy(pWOpp->m_PCd,           pWing->m_PCd,           sizeof(pWing->m_PCd));
-	memcpy(pWOpp->m_ICd,           pWing->m_ICd,           sizeof(pWing->m_ICd));
-	memcpy(pWOpp->m_Cm,            pWing->m_Cm,            sizeof(pWing->m_Cm));
-	memcpy(pWOpp->m_CmAirf,        pWing->m_CmAirf,        sizeof(pWing->m_CmAirf));
-	memcpy(pWOpp->m_CmXRef,        pWing->m_CmXRef,        sizeof(pWing->m_CmXRef));
-	memcpy(pWOpp->m_XCPSpanRel,    pWing->m_XCPSpanRel,    sizeof(pWing->m_XCPSpanRel));
-	memcpy(pWOpp->m_XCPSpanAbs,    pWing->m_XCPSpanAbs,    sizeof(pWing->m_XCPSpanAbs));
-	memcpy(pWOpp->m_Re,            pWing->m_Re,            sizeof(pWing->m_Re));
-	memcpy(pWOpp->m_Chord,         pWing->m_Chord,         sizeof(pWing->m_Chord));
-	memcpy(pWOpp->m_Twist,         pWing->m_Twist,         sizeof(pWing->m_Twist));
-	memcpy(pWOpp->m_XTrTop,        pWing->m_XTrTop,        sizeof(pWing->m_XTrTop));
-	memcpy(pWOpp->m_XTrBot,        pWing->m_XTrBot,        sizeof(pWing->m_XTrBot));
-	memcpy(pWOpp->m_BendingMoment, pWing->m_BendingMoment, sizeof(pWing->m_BendingMoment));
-	memcpy(pWOpp->m_Vd,            pWing->m_Vd,            sizeof(pWOpp->m_Vd));
-	memcpy(pWOpp->m_F,             pWing->m_F,             sizeof(pWOpp->m_F));
+	memcpy(pWOpp->m_Ai,            pWing->m_Ai,            (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_Cl,            pWing->m_Cl,            (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_PCd,           pWing->m_PCd,           (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_ICd,           pWing->m_ICd,           (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_Cm,            pWing->m_Cm,            (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_CmAirf,        pWing->m_CmAirf,        (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_CmXRef,        pWing->m_CmXRef,        (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_XCPSpanRel,    pWing->m_XCPSpanRel,    (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_XCPSpanAbs,    pWing->m_XCPSpanAbs,    (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_Re,            pWing->m_Re,            (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_Chord,         pWing->m_Chord,         (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_Twist,         pWing->m_Twist,         (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_XTrTop,        pWing->m_XTrTop,        (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_XTrBot,        pWing->m_XTrBot,        (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_BendingMoment, pWing->m_BendingMoment, (pWOpp->m_NStation+1)*sizeof(double));
+	memcpy(pWOpp->m_Vd,            pWing->m_Vd,            pWOpp->m_NStation*sizeof(CVector));
+	memcpy(pWOpp->m_F,             pWing->m_F,             pWOpp->m_NStation*sizeof(CVector));
 
 	double Cb =0.0;
 
@@ -20441,14 +20905,48 @@ double CMiarex::GetVar(int nVar, CFoil *pFoil0, CFoil *pFoil1, double Re, double
 }
 
 
-double CMiarex::GetPlrPointFromCl(CFoil *pFoil, double Re, double Cl, int PlrVar, bool &bOutRe, bool &bError)
+void CMiarex::GetFoilVarsFromCl(CFoil *pFoil0, CFoil *pFoil1, double Re, double Cl, double Tau, double *Var, bool &bOutRe, bool &bError)
 {
-	//TODO : check this GetPlrPoint duplicate with CMAinFrame
-/*	Var 
-
-
-	0 =	m_Alpha;
-	1 = m_Cl;
+	//returns in Var the PLRVARS interpolated polar variables, in the order of GetPlrVariable,
+	//with the same results as GetVar but with a single interpolation per foil
+	bool IsOutRe = false;
+	bool IsError  = false;
+	double Var0[PLRVARS], Var1[PLRVARS];
+	int k;
+	bOutRe = false;
+	bError = false;
+
+	if(!pFoil0)
+	{
+		Cl = 0.0;
+		memset(Var0, 0, PLRVARS*sizeof(double));
+	}
+	else GetPlrPointsFromCl(pFoil0, Re, Cl, 0, PLRVARS, Var0, IsOutRe, IsError);
+	if(IsOutRe) bOutRe = true;
+	if(IsError) bError = true;
+	if(!pFoil1) 
+	{
+		Cl = 0.0;
+		memset(Var1, 0, PLRVARS*sizeof(double));
+	}
+	else GetPlrPointsFromCl(pFoil1, Re, Cl, 0, PLRVARS, Var1, IsOutRe, IsError);
+	if(IsOutRe) bOutRe = true;
+	if(IsError) bError = true;
+
+	if (Tau<0.0) Tau = 0.0;
+	if (Tau>1.0) Tau = 1.0;
+	for(k=0; k<PLRVARS; k++) Var[k] = (1-Tau) * Var0[k] + Tau * Var1[k];
+}
+
+
+double CMiarex::GetPlrPointFromCl(CFoil *pFoil, double Re, double Cl, int PlrVar, bool &bOutRe, bool &bError)
+{
+	//TODO : check this GetPlrPoint duplicate with CMAinFrame
+/*	Var 
+
+
+	0 =	m_Alpha;
+	1 = m_Cl;
 	2 = m_Cd;
 	3 = m_Cdp;
 	4 = m_Cm;
@@ -20456,14 +20954,21 @@ double CMiarex::GetPlrPointFromCl(CFoil *pFoil, double Re, double Cl, int PlrVar
 	7, 8 = m_HMom, m_Cpmn;
 	9,10 = m_ClCd, m_Cl32Cd;
 */
+	double Var;
+	if(PlrVar<0 || PlrVar>=PLRVARS) PlrVar = 0;
+	GetPlrPointsFromCl(pFoil, Re, Cl, PlrVar, 1, &Var, bOutRe, bError);
+	return Var;
+}
 
-	CArray <double, double> *pX;	
-	double Clmin, Clmax;
-	CPolar *pPolar;
-	double Var1, Var2, u, dist;
-	int pt;
+
+void CMiarex::GetPlrPointsFromCl(CFoil *pFoil, double Re, double Cl, int iVar, int nVar, double *Var, bool &bOutRe, bool &bError)
+{
+	// interpolates the polar variables iVar to iVar+nVar-1 at the specified Re and Cl
+	double const *c;
+	CPolarEntry *pEntry;
+	double Var1[PLRVARS], Var2[PLRVARS];
 	int size;
-	int n, i;
+	int i, k;
 
 	bOutRe = false;
 	bError = false;
@@ -20471,321 +20976,143 @@ double CMiarex::GetPlrPointFromCl(CFoil *pFoil, double Re, double Cl, int PlrVar
 	if(!pFoil) {
 		bOutRe = true;
 		bError = true;
-		return 0.000;
+		for(k=0; k<nVar; k++) Var[k] = 0.0;
+		return;
 	}
 
+	// the index is built by Analyze, from which all the viscous interpolations are called
+	ASSERT(m_PolarIndex.IsBuilt());
+	CPolarFoil *pFoilIndex = m_PolarIndex.GetFoil(pFoil->m_FoilName);
+	int nPolars = 0;
+	if(pFoilIndex) nPolars = pFoilIndex->GetSize();
 
-	n=0;
-	// Are there any Type 1 polars available for this foil ?
-	for (i = 0; i< m_poaPolar->GetSize(); i++)
+	//Type 1 Polars are indexed by crescending Re Number
+	//if Re is less than that of the first polar, use this one
+	if(nPolars && Re < pFoilIndex->GetAt(0)->m_Reynolds)
 	{
-		pPolar = (CPolar*)m_poaPolar->GetAt(i);
-		if((pPolar->m_Type == 1) && (pPolar->m_FoilName == pFoil->m_FoilName))
+		bOutRe = true;
+		//interpolate Cl on this polar
+		pEntry = pFoilIndex->GetAt(0);
+		c = pEntry->m_pPolar->m_Cl.GetData();
+		size = (int)pEntry->m_pPolar->m_Cl.GetSize();
+		if(Cl < c[0])
 		{
-			n++;
-			if(n>=2) break;
+			pEntry->GetPoint(0, iVar, nVar, Var);
+			return;
+		}
+		if(Cl > c[size-1])
+		{
+			pEntry->GetPoint(size-1, iVar, nVar, Var);
+			return;
+		}
+		i = pEntry->FindCl(Cl, 0, size-2);
+		if(i>=0)
+		{
+			pEntry->Interpolate(c, i, Cl, false, iVar, nVar, Var);
+			return;
 		}
 	}
 
-//more than one polar - interpolate between  - tough job
-
 	//First Find the two polars with Reynolds number surrounding wanted Re
-	CPolar * pPolar1 = NULL;
-	CPolar * pPolar2 = NULL;
-	int nPolars = (int)m_poaPolar->GetSize();
-	//Type 1 Polars are sorted by crescending Re Number
-
-	//if Re is less than that of the first polar, use this one
-	for (i=0; i< nPolars; i++)
+	CPolarEntry * pEntry1 = NULL;
+	CPolarEntry * pEntry2 = NULL;
+	k = 0;
+	if(nPolars) k = pFoilIndex->UpperRe(Re);
+	for (i=k-1; i>=0; i--)
 	{
-		pPolar = (CPolar*)m_poaPolar->GetAt(i);
-		if((pPolar->m_Type == 1) && (pPolar->m_FoilName == pFoil->m_FoilName) && pPolar->m_Cl.GetSize()>0)
+		pEntry = pFoilIndex->GetAt(i);
+		if(pEntry->m_Clmin <= Cl && Cl <= pEntry->m_Clmax)
 		{
-			// we have found the first type 1 polar for this foil
-			if (Re < pPolar->m_Reynolds) 
-			{
-				bOutRe = true;
-				//interpolate Cl on this polar
-				pX = (CArray <double, double> *) GetPlrVariable(pPolar, PlrVar);
-				size = (int)pPolar->m_Cl.GetSize();
-				if(Cl < pPolar->m_Cl[0])    
-				{
-					return (*pX)[0];
-				}
-				if(Cl > pPolar->m_Cl[size-1])
-				{
-					return (*pX)[size-1];
-				}
-				for (i=0; i<size-1; i++)
-				{
-					if(pPolar->m_Cl[i] <= Cl && Cl < pPolar->m_Cl[i+1]){
-						//interpolate
-						if(pPolar->m_Cl[i+1]-pPolar->m_Cl[i] < 0.00001)//do not divide by zero
-							return (*pX)[i];
-						else {
-							u = (Cl - pPolar->m_Cl[i])
-									 /(pPolar->m_Cl[i+1]-pPolar->m_Cl[i]);
-							return ((*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]));
-						}
-					}
-				}
-				break;
-			}
+			pEntry1 = pEntry;
 			break;
 		}
 	}
-
-	// if not Find the two polars
-	for (i=0; i< nPolars; i++)
+	for (i=k; i<nPolars; i++)
 	{
-		pPolar = (CPolar*)m_poaPolar->GetAt(i);
-		if((pPolar->m_Type == 1) && (pPolar->m_FoilName == pFoil->m_FoilName)  && pPolar->m_Cl.GetSize()>0)
+		pEntry = pFoilIndex->GetAt(i);
+		if(pEntry->m_Clmin <= Cl && Cl <= pEntry->m_Clmax)
 		{
-			// we have found the first type 1 polar for this foil
-			pPolar->GetClLimits(Clmin, Clmax);
-			if (pPolar->m_Reynolds <= Re) 
-			{
-				if(Clmin <= Cl && Cl <= Clmax) 
-				{	
-					pPolar1 = pPolar;
-				}
-			}
-			else
-			{
-				if(Clmin <= Cl && Cl <= Clmax)
-				{	
-					pPolar2 = pPolar;
-					break;
-				}
-			}
+			pEntry2 = pEntry;
+			break;
 		}
 	}
 
-
-	if (!pPolar2)
+	if (!pEntry2)
 	{
 		//then Re is greater than that of any polar
 		// so use last polar and interpolate Cls on this polar
 		bOutRe = true;
-		if(!pPolar1)
+		if(!pEntry1)
 		{
-			bOutRe = true; 
 			bError = true;
-			return 0.000;
-		}
-		size = (int)pPolar1->m_Cl.GetSize();
-		if(!size)
-		{
-			bOutRe = true; 
-			bError = true;
-			return 0.000;
+			for(k=0; k<nVar; k++) Var[k] = 0.0;
+			return;
 		}
-
-		pX = (CArray <double, double> *) GetPlrVariable(pPolar1, PlrVar);
-		if(Cl < pPolar1->m_Cl[0])	   return (*pX)[0];
-		if(Cl > pPolar1->m_Cl[size-1]) return (*pX)[size-1];
-		for (i=0; i<size-1; i++)
+		c = pEntry1->m_pPolar->m_Cl.GetData();
+		size = (int)pEntry1->m_pPolar->m_Cl.GetSize();
+		if(Cl < c[0])
 		{
-			if(pPolar1->m_Cl[i] <= Cl && Cl < pPolar1->m_Cl[i+1])
-			{
-				//interpolate
-				if(pPolar1->m_Cl[i+1]-pPolar1->m_Cl[i] < 0.00001)
-				{//do not divide by zero
-					return (*pX)[i];
-				}
-				else 
-				{
-					u = (Cl - pPolar1->m_Cl[i])
-							 /(pPolar1->m_Cl[i+1]-pPolar1->m_Cl[i]);
-					return ((*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]));
-				}
-			}
+			pEntry1->GetPoint(0, iVar, nVar, Var);
+			return;
 		}
+		i = -1;
+		if(Cl <= c[size-1]) i = pEntry1->FindCl(Cl, 0, size-2);
+		if(i>=0) pEntry1->Interpolate(c, i, Cl, false, iVar, nVar, Var);
 		//Out in Re, out in Cl...
-		return (*pX)[size-1];
+		else     pEntry1->GetPoint(size-1, iVar, nVar, Var);
 	}
 	else 
 	{
 		// Re is between that of polars 1 and 2
 		// so interpolate Cls for each
-		if(!pPolar1) 
-		{
-			bOutRe = true;
-			bError = true;
-			return 0.000;
-		}
-		size = (int)pPolar1->m_Cl.GetSize();
-		if(!size) 
+		if(!pEntry1) 
 		{
 			bOutRe = true;
 			bError = true;
-			return 0.000;
-		}
-
-		pX = (CArray <double, double> *) GetPlrVariable(pPolar1, PlrVar);
-		pPolar1->GetClLimits(Clmin, Clmax);
-
-		if(Cl < Clmin)
-		{	         
-			Var1 = (*pX)[0];
-			bOutRe = true;
-		}
-		else if(Cl > Clmax)
-		{
-			Var1 = (*pX)[size-1];
-			bOutRe = true;
+			for(k=0; k<nVar; k++) Var[k] = 0.0;
+			return;
 		}
-		else
-		{
-			//first Find the point closest to Cl=0
-			pt = 0;
-			dist = abs(pPolar1->m_Cl[0]);
-			for (i=1; i<size;i++)
-			{
-				if (abs(pPolar1->m_Cl[i])< dist)
-				{
-					dist = abs(pPolar1->m_Cl[i]);
-					pt = i;
-				}
-			}
-			if(Cl<pPolar1->m_Cl[pt])
-			{
-				for (i=pt; i>0; i--)
-				{
-					if(Cl<= pPolar1->m_Cl[i] && Cl > pPolar1->m_Cl[i-1])
-					{
-						//interpolate
-						if(abs(pPolar1->m_Cl[i]-pPolar1->m_Cl[i-1]) < 0.00001)
-						{
-							//do not divide by zero
-							Var1 = (*pX)[i];
-							break;
-						}
-						else
-						{
-							u = (Cl - pPolar1->m_Cl[i-1])
-									 /(pPolar1->m_Cl[i]-pPolar1->m_Cl[i-1]);
-							Var1 = (*pX)[i-1] + u * ((*pX)[i]-(*pX)[i-1]);
-							break;
-						}
-					}
-				}
-			}
-			else 
-			{
-				for (i=pt; i<size-1; i++)
-				{
-					if(pPolar1->m_Cl[i] <=Cl && Cl < pPolar1->m_Cl[i+1])
-					{
-						//interpolate
-						if(abs(pPolar1->m_Cl[i+1]-pPolar1->m_Cl[i]) < 0.00001){//do not divide by zero
-							Var1 = (*pX)[i];
-							break;
-						}
-						else
-						{
-							u = (Cl - pPolar1->m_Cl[i])
-									 /(pPolar1->m_Cl[i+1]-pPolar1->m_Cl[i]);
-							Var1 = (*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]);
-							break;
-						}
-					}
-				}
-			}
-		} 
+		InterpolateCl(pEntry1, Cl, iVar, nVar, Var1, bOutRe);
+		InterpolateCl(pEntry2, Cl, iVar, nVar, Var2, bOutRe);
 
-		size = (int)pPolar2->m_Cl.GetSize();
-		if(!size) 
-		{
-			bOutRe = true;
-			bError = true;
-			return 0.000;
-		}
+		// then interpolate Variable
+		double v =   (Re - pEntry1->m_Reynolds) / (pEntry2->m_Reynolds - pEntry1->m_Reynolds);
+		for(k=0; k<nVar; k++) Var[k] = Var1[k] + v * (Var2[k]-Var1[k]);
+	} 
+}
 
-		pX = (CArray <double, double> *) GetPlrVariable(pPolar2, PlrVar);
-		pPolar2->GetClLimits(Clmin, Clmax);
 
-		if(Cl < Clmin)
-		{	         
-			Var2 = (*pX)[0];
-			bOutRe = true;
-		}
-		else if(Cl > Clmax) 
-		{
-			Var2 = (*pX)[size-1];
-			bOutRe = true;
-		}
-		else
-		{
-			//first Find the point closest to Cl=0
-			pt = 0;
-			dist = abs(pPolar2->m_Cl[0]);
-			for (i=1; i<size;i++)
-			{
-				if (abs(pPolar2->m_Cl[i])< dist)
-				{
-					dist = abs(pPolar2->m_Cl[i]);
-					pt = i;
-				}
-			}
-			if(Cl<pPolar2->m_Cl[pt])
-			{
-				for (i=pt; i>0; i--)
-				{
-					if(Cl<= pPolar2->m_Cl[i] && Cl > pPolar2->m_Cl[i-1])
-					{
-						//interpolate
-						if(abs(pPolar2->m_Cl[i]-pPolar2->m_Cl[i-1]) < 0.00001)
-						{//do not divide by zero
-							Var2 = (*pX)[i];
-							break;
-						}
-						else
-						{
-							u = (Cl - pPolar2->m_Cl[i-1])
-									 /(pPolar2->m_Cl[i]-pPolar2->m_Cl[i-1]);
-							Var2 = (*pX)[i-1] + u * ((*pX)[i]-(*pX)[i-1]);
-							break;
-						}
-					}
-				}
-			}
-			else 
-			{
-				for (i=pt; i<size-1; i++)
-				{
-					if(pPolar2->m_Cl[i] <=Cl && Cl < pPolar2->m_Cl[i+1])
-					{
-						//interpolate
-						if(abs(pPolar2->m_Cl[i+1]-pPolar2->m_Cl[i]) < 0.00001)
-						{
-							//do not divide by zero
-							Var2 = (*pX)[i];
-							break;
-						}
-						else
-						{
-							u = (Cl - pPolar2->m_Cl[i])
-									 /(pPolar2->m_Cl[i+1]-pPolar2->m_Cl[i]);
-							Var2 = (*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]);
-							break;
-						}
-					}
-				}
-			}
-		} 
-
-		// then interpolate Variable
+void CMiarex::InterpolateCl(CPolarEntry *pEntry, double Cl, int iVar, int nVar, double *Var, bool &bOutRe)
+{
+	// interpolates the variables on the polar's branch which holds Cl, 
+	// starting from the point closest to Cl=0
+	double const *c = pEntry->m_pPolar->m_Cl.GetData();
+	int size = (int)pEntry->m_pPolar->m_Cl.GetSize();
+	int pt = pEntry->m_iCl0;
+	int i;
 
-		double v =   (Re - pPolar1->m_Reynolds) / (pPolar2->m_Reynolds - pPolar1->m_Reynolds);
-		double Var = Var1 + v * (Var2-Var1);
-		return Var;
-	} 
-		
-//	AfxMessageBox("Error interpolating", MB_OK);
-//	bOutRe = true;
-//	bError = true;
-//	return 0.000;// we missed something somewhere...
+	if(Cl < pEntry->m_Clmin)
+	{	         
+		bOutRe = true;
+		pEntry->GetPoint(0, iVar, nVar, Var);
+	}
+	else if(Cl > pEntry->m_Clmax)
+	{
+		bOutRe = true;
+		pEntry->GetPoint(size-1, iVar, nVar, Var);
+	}
+	else if(Cl<c[pt])
+	{
+		i = pEntry->FindClDown(Cl, 0, pt-1);
+		if(i>=0) pEntry->Interpolate(c, i, Cl, true, iVar, nVar, Var);
+		else     pEntry->GetPoint(0, iVar, nVar, Var);
+	}
+	else
+	{
+		i = pEntry->FindCl(Cl, pt, size-2);
+		if(i>=0) pEntry->Interpolate(c, i, Cl, false, iVar, nVar, Var);
+		else     pEntry->GetPoint(size-1, iVar, nVar, Var);
+	}
 }
 
 void * CMiarex::GetPlrVariable(CPolar *pPolar, int iVar)
@@ -20852,12 +21179,22 @@ double CMiarex::GetPlrPointFromAlpha(CFoil *pFoil, double Re, double Alpha, int
 	9,10 = m_ClCd, m_Cl32Cd;
 	11 = m_XCp
 */
+	double Var;
+	if(PlrVar<0 || PlrVar>=PLRVARS) PlrVar = 0;
+	GetPlrPointsFromAlpha(pFoil, Re, Alpha, PlrVar, 1, &Var, bOutRe, bError);
+	return Var;
+}
 
-	CArray <double, double> *pX;	
-	double amin, amax;
-	double Var1, Var2, u;
-	int i;
-	CPolar *pPolar;
+
+void CMiarex::GetPlrPointsFromAlpha(CFoil *pFoil, double Re, double Alpha, int iVar, int nVar, double *Var, bool &bOutRe, bool &bError)
+{
+	// interpolates the polar variables iVar to iVar+nVar-1 at the specified Re and Alpha
+	double const *a;
+	CPolarEntry *pEntry;
+	double Var1[PLRVARS], Var2[PLRVARS];
+	bool bOut;
+	int size;
+	int i, k;
 
 	bOutRe = false;
 	bError = false;
@@ -20866,225 +21203,141 @@ double CMiarex::GetPlrPointFromAlpha(CFoil *pFoil, double Re, double Alpha, int
 	{
 		bOutRe = true;
 		bError = true;
-		return 0.000;
+		for(k=0; k<nVar; k++) Var[k] = 0.0;
+		return;
 	}
 
+	// the index is built by Analyze, from which all the viscous interpolations are called
+	ASSERT(m_PolarIndex.IsBuilt());
+	CPolarFoil *pFoilIndex = m_PolarIndex.GetFoil(pFoil->m_FoilName);
+	int nPolars = 0;
+	if(pFoilIndex) nPolars = pFoilIndex->GetSize();
 
-	int size;
-	int n = 0;
-
-	// Are there any Type 1 polars available for this foil ?
-	for (i = 0; i< m_poaPolar->GetSize(); i++)
+	//Type 1 Polars are indexed by crescending Re Number
+	//if Re is less than that of the first polar, use this one
+	if(nPolars && Re < pFoilIndex->GetAt(0)->m_Reynolds)
 	{
-		pPolar = (CPolar*)m_poaPolar->GetAt(i);
-		if((pPolar->m_Type == 1) && (pPolar->m_FoilName == pFoil->m_FoilName))
+		bOutRe = true;
+		//interpolate Alpha on this polar
+		pEntry = pFoilIndex->GetAt(0);
+		a = pEntry->m_pPolar->m_Alpha.GetData();
+		size = (int)pEntry->m_pPolar->m_Alpha.GetSize();
+		if(Alpha < a[0])
+		{
+			pEntry->GetPoint(0, iVar, nVar, Var);
+			return;
+		}
+		if(Alpha > a[size-1])
+		{
+			pEntry->GetPoint(size-1, iVar, nVar, Var);
+			return;
+		}
+		i = pEntry->FindAlpha(Alpha, false);
+		if(i>=0)
 		{
-			n++;
-			if(n>=2) break;
+			pEntry->Interpolate(a, i, Alpha, false, iVar, nVar, Var);
+			return;
 		}
 	}
 
-//more than one polar - interpolate between  - tough job
-
 	//First Find the two polars with Reynolds number surrounding wanted Re
-	CPolar * pPolar1 = NULL;
-	CPolar * pPolar2 = NULL;
-	int nPolars = (int)m_poaPolar->GetSize();
-	//Type 1 Polars are sorted by crescending Re Number
-
-	//if Re is less than that of the first polar, use this one
-	for (i=0; i< nPolars; i++)
-	{
-		pPolar = (CPolar*)m_poaPolar->GetAt(i);
-		if((pPolar->m_Type == 1) && (pPolar->m_FoilName == pFoil->m_FoilName))
-		{
-			// we have found the first type 1 polar for this foil
-			if (Re < pPolar->m_Reynolds) {
-				bOutRe = true;
-				//interpolate Alpha on this polar
-				pX = (CArray <double, double> *) GetPlrVariable(pPolar, PlrVar);
-				size = (int)pPolar->m_Alpha.GetSize();
-				if(Alpha < pPolar->m_Alpha[0])      
-				{
-					return (*pX)[0];
-				}
-				if(Alpha > pPolar->m_Alpha[size-1])
-				{
-					return (*pX)[size-1];
-				}
-				for (i=0; i<size-1; i++)
-				{
-					if(pPolar->m_Alpha[i] <= Alpha && Alpha < pPolar->m_Alpha[i+1])
-					{
-						//interpolate
-						if(pPolar->m_Alpha[i+1]-pPolar->m_Alpha[i] < 0.00001)//do not divide by zero
-							return (*pX)[i];
-						else 
-						{
-							u = (Alpha - pPolar->m_Alpha[i])
-									 /(pPolar->m_Alpha[i+1]-pPolar->m_Alpha[i]);
-							return ((*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]));
-						}						
-					}
-				}
-				break;
-			}
+	CPolarEntry * pEntry1 = NULL;
+	CPolarEntry * pEntry2 = NULL;
+	k = 0;
+	if(nPolars) k = pFoilIndex->UpperRe(Re);
+	for (i=k-1; i>=0; i--)
+	{
+		pEntry = pFoilIndex->GetAt(i);
+		if(pEntry->m_amin <= Alpha && Alpha <= pEntry->m_amax)
+		{
+			pEntry1 = pEntry;
 			break;
 		}
 	}
-
-	// if not Find the two polars
-	for (i=0; i< nPolars; i++)
+	for (i=k; i<nPolars; i++)
 	{
-		pPolar = (CPolar*)m_poaPolar->GetAt(i);
-		if((pPolar->m_Type == 1) && (pPolar->m_FoilName == pFoil->m_FoilName))
+		pEntry = pFoilIndex->GetAt(i);
+		if(pEntry->m_amin <= Alpha && Alpha <= pEntry->m_amax)
 		{
-			// we have found the first type 1 polar for this foil
-			pPolar->GetAlphaLimits(amin, amax);
-			if (pPolar->m_Reynolds <= Re) 
-			{
-				if(amin <= Alpha && Alpha <= amax) 
-				{	
-					pPolar1 = pPolar;
-				}
-			}
-			else {
-				if(amin <= Alpha && Alpha <= amax)
-				{	
-					pPolar2 = pPolar;
-					break;
-				}
-			}
+			pEntry2 = pEntry;
+			break;
 		}
 	}
 
-	if (!pPolar2) 
+	if (!pEntry2) 
 	{
 		//then Re is greater than that of any polar
 		// so use last polar and interpolate alphas on this polar
 		bOutRe = true;
-		if(!pPolar1)
+		if(!pEntry1)
 		{
 			bError = true;
-			return 0.000;
-		}
-		size = (int)pPolar1->m_Alpha.GetSize();
-		if(!size) 
-		{
-			bError = true;
-			return 0.000;
+			for(k=0; k<nVar; k++) Var[k] = 0.0;
+			return;
 		}
-
-		pX = (CArray <double, double> *) GetPlrVariable(pPolar1, PlrVar);
-		if(Alpha < pPolar1->m_Alpha[0])	     return (*pX)[0];
-		if(Alpha > pPolar1->m_Alpha[size-1]) return (*pX)[size-1];
-		for (i=0; i<size-1; i++)
+		a = pEntry1->m_pPolar->m_Alpha.GetData();
+		size = (int)pEntry1->m_pPolar->m_Alpha.GetSize();
+		if(Alpha < a[0])
 		{
-			if(pPolar1->m_Alpha[i] <= Alpha && Alpha < pPolar1->m_Alpha[i+1])
-			{
-				//interpolate
-				if(pPolar1->m_Alpha[i+1]-pPolar1->m_Alpha[i] < 0.00001){//do not divide by zero
-					return (*pX)[i];
-				}
-				else
-				{
-					u = (Alpha - pPolar1->m_Alpha[i])
-							 /(pPolar1->m_Alpha[i+1]-pPolar1->m_Alpha[i]);
-					return (*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]);
-				}
-			}
+			pEntry1->GetPoint(0, iVar, nVar, Var);
+			return;
 		}
+		i = -1;
+		if(Alpha <= a[size-1]) i = pEntry1->FindAlpha(Alpha, false);
+		if(i>=0) pEntry1->Interpolate(a, i, Alpha, false, iVar, nVar, Var);
 		//Out in Re, out in alpha...
-		return (*pX)[size-1] ;
-
+		else     pEntry1->GetPoint(size-1, iVar, nVar, Var);
 	}
 	else 
 	{
 		// Re is between that of polars 1 and 2
 		// so interpolate alphas for each
-
-		if(!pPolar1)
+		if(!pEntry1)
 		{
 			bOutRe = true; 
 			bError = true;
-			return 0.000;
-		}
-		size = (int)pPolar1->m_Alpha.GetSize();
-		if(!size) {
-			bOutRe = true;
-			bError = true;
-			return 0.000;
-		}
-		pX = (CArray <double, double> *) GetPlrVariable(pPolar1, PlrVar);
-		if(Alpha < pPolar1->m_Alpha[0])	          Var1 = (*pX)[0];
-		else if(Alpha > pPolar1->m_Alpha[size-1]) Var1 = (*pX)[size-1];
-		else
-		{
-			for (i=0; i<size-1; i++)
-			{
-				if(pPolar1->m_Alpha[i] <= Alpha && Alpha < pPolar1->m_Alpha[i+1]){
-					//interpolate
-					if(pPolar1->m_Alpha[i+1]-pPolar1->m_Alpha[i] < 0.00001)//do not divide by zero
-						Var1 = (*pX)[i];
-					else
-					{
-						u = (Alpha - pPolar1->m_Alpha[i])
-								 /(pPolar1->m_Alpha[i+1]-pPolar1->m_Alpha[i]);
-						Var1 = (*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]);
-					}
-				}
-			}
-		}
-
-		size = (int)pPolar2->m_Alpha.GetSize();
-		if(!size) 
-		{
-			bOutRe = true;
-			bError = true;
-			return 0.000;
-		}
-		pX = (CArray <double, double> *) GetPlrVariable(pPolar2, PlrVar);
-		if(Alpha < pPolar2->m_Alpha[0])
-		{
-			bOutRe = true;
-			bError = true;
-			Var2 = (*pX)[0];
+			for(k=0; k<nVar; k++) Var[k] = 0.0;
+			return;
 		}
-		else if(Alpha > pPolar2->m_Alpha[size-1]) 
+		InterpolateAlpha(pEntry1, Alpha, iVar, nVar, Var1, bOut);
+		InterpolateAlpha(pEntry2, Alpha, iVar, nVar, Var2, bOut);
+		if(bOut)
 		{
 			bOutRe = true;
 			bError = true;
-			Var2 = (*pX)[size-1];
 		}
-		else{
-			for (i=0; i<size-1; i++)
-			{
-				if(pPolar2->m_Alpha[i] <= Alpha && Alpha < pPolar2->m_Alpha[i+1])
-				{
-					//interpolate
-					pX = (CArray <double, double> *) GetPlrVariable(pPolar2, PlrVar);
-					if(pPolar2->m_Alpha[i+1]-pPolar2->m_Alpha[i] < 0.00001)//do not divide by zero
-						Var2 = (*pX)[i];
-					else{
-						u = (Alpha - pPolar2->m_Alpha[i])
-								 /(pPolar2->m_Alpha[i+1]-pPolar2->m_Alpha[i]);
-						Var2 = (*pX)[i] + u * ((*pX)[i+1]-(*pX)[i]);
-					}
-				}
-			}
-		}
-		// then interpolate Variable
 
-		double v =   (Re - pPolar1->m_Reynolds) 
-				  / (pPolar2->m_Reynolds - pPolar1->m_Reynolds);
-		double Var = Var1 + v * (Var2-Var1);
-		return Var;
+		// then interpolate Variable
+		double v =   (Re - pEntry1->m_Reynolds) 
+				  / (pEntry2->m_Reynolds - pEntry1->m_Reynolds);
+		for(k=0; k<nVar; k++) Var[k] = Var1[k] + v * (Var2[k]-Var1[k]);
 	} 
-		
-//	AfxMessageBox("Error interpolating", MB_OK);
-//	bOutRe = true;
-//	bError = true;
-//	return 0.000;// we missed something somewhere...
+}
+
+
+void CMiarex::InterpolateAlpha(CPolarEntry *pEntry, double Alpha, int iVar, int nVar, double *Var, bool &bOut)
+{
+	// interpolates the variables on the last segment of the polar which holds Alpha
+	double const *a = pEntry->m_pPolar->m_Alpha.GetData();
+	int size = (int)pEntry->m_pPolar->m_Alpha.GetSize();
+	int i;
+
+	bOut = false;
+	if(Alpha < a[0])
+	{
+		bOut = true;
+		pEntry->GetPoint(0, iVar, nVar, Var);
+		return;
+	}
+	if(Alpha > a[size-1])
+	{
+		bOut = true;
+		pEntry->GetPoint(size-1, iVar, nVar, Var);
+		return;
+	}
+	i = pEntry->FindAlpha(Alpha, true);
+	if(i>=0) pEntry->Interpolate(a, i, Alpha, false, iVar, nVar, Var);
+	else     pEntry->GetPoint(size-1, iVar, nVar, Var);
 }
 
 
@@ -21189,6 +21442,58 @@ double CMiarex::GetCm(CFoil *pFoil0, CFoil *pFoil1, double Re, double Alpha, dou
 	return ((1-Tau) * Cm0 + Tau * Cm1);
 }
 
+
+void CMiarex::GetFoilVars(CFoil *pFoil0, CFoil *pFoil1, double Re, double Alpha, double Tau, double AR,
+						  double *Var, bool &bOutRe, bool &bError)
+{
+	//For LLT calculations
+	//returns in Var the PLRVARS interpolated polar variables, in the order of GetPlrVariable,
+	//with the same results as GetCl, GetCd, GetXTr, GetCm and GetXCp
+	//but with a single interpolation per foil
+	double Var0[PLRVARS], Var1[PLRVARS];
+	double Cl;
+	bool IsOutRe = false;
+	bool IsError  = false;
+	int k;
+	bOutRe = false;
+	bError = false;
+
+	if(!pFoil0) 
+	{
+		Cl = 2.0*pi*(Alpha*pi/180.0);
+		memset(Var0, 0, PLRVARS*sizeof(double));
+		Var0[0] = Alpha;
+		Var0[1] = Cl;
+		Var0[2] = Cl*Cl/pi/AR;
+		Var0[5] = 1.0;
+		Var0[6] = 1.0;
+	}
+	else GetPlrPointsFromAlpha(pFoil0, Re, Alpha, 0, PLRVARS, Var0, IsOutRe, IsError);
+	if(IsOutRe) bOutRe = true;
+	if(IsError) bError = true;
+
+	if(!pFoil1) 
+	{
+		Cl = 2.0*pi*(Alpha*pi/180.0);
+		memset(Var1, 0, PLRVARS*sizeof(double));
+		Var1[0] = Alpha;
+		Var1[1] = Cl;
+		Var1[2] = Cl*Cl/pi/AR;
+		Var1[5] = 1.0;
+		Var1[6] = 1.0;
+	}
+	else GetPlrPointsFromAlpha(pFoil1, Re, Alpha, 0, PLRVARS, Var1, IsOutRe, IsError);
+	if(IsOutRe) bOutRe = true;
+	if(IsError) bError = true;
+
+	if (Tau<0.0) Tau = 0.0;
+	if (Tau>1.0) Tau = 1.0;
+	for(k=0; k<PLRVARS; k++) Var[k] = (1-Tau) * Var0[k] + Tau * Var1[k];
+
+	// no center of pressure without the foils' polars
+	if(!pFoil0 || !pFoil1) Var[11] = 0.0;
+}
+
 void CMiarex::OnSelectBodyOverlay()
 {
 	CMainFrame* pMainFrame = (CMainFrame*)m_pFrame;
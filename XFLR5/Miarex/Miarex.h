@@ -38,6 +38,7 @@
 #include "GLLight.h"
 #include "FlowLinesDlg.h"
 #include "LLTDlg.h"
+#include "PolarIndex.h"
 #include "Body.h"
 #include "BodyCtrlBar.h"
 #include "ArcBall.h"
@@ -97,6 +98,7 @@ class CMiarex : public CWnd
 	friend class CArcBall;
 	friend class CBodyScaleDlg;
 	friend class CBodyTransDlg;
+	friend class CWPolarBatchDlg;
 
 // Construction
 public:
@@ -237,6 +239,7 @@ private:
 	void OnHideWingOpps();
 	void OnShowWingOpps();
 	void OnWAdvSettings();
+	void OnWPolarBatch();
 
 	void GLDrawBodyLegend();
 	void GLDrawAxes();
@@ -275,9 +278,16 @@ private:
 	void GLCreateVortices();
 	void GLSetViewport();
 	void GLInverseMatrix();
+	void ReleasePanelArrays();
+	void SetPanelPointers();
 
 	void * GetUFOPlrVariable(CWPolar *pWPolar, int iVar);
 
+	bool AllocatePanelArrays(int nPanels, int nNodes, int nWakePanels, int nWakeNodes);
+	bool AllocateMatrixArrays(int MatSize);
+	bool CheckFoils(CWing *pWing, CString &FoilName);
+	void AnalysisMessage(CString const &strong);
+	void AllocateStrengths(double *&Mu, double *&Sigma);
 	bool CreateWakeElems(int PanelIndex);
 	bool InitializePanels();
 	bool Intersect(CVector const &LA, CVector const &LB, CVector const &TA, CVector const &TB, CVector const &Normal,
@@ -292,6 +302,7 @@ private:
 	bool SetPOpp(bool bCurrent, double Alpha = 0.0);
 	bool UnlockCurBody();
 
+	int BatchAnalyze(CWPolar *pWPolar, double V0, double VMax, double VDelta, CString &strong);
 	int CreateElements(CSurface *pSurface);
 	int CreateBodyElements(CPanel *pPanel);
 	int IsNode(CVector &Pt);
@@ -365,6 +376,7 @@ private:
 	void GLToClient(CVector const &real, CPoint &point);
 	void SnapClient(CDC *pDC, CImage *pImage, CString FileName, int FileType);
 
+	double GetAnalysisMemory(CWPolar *pWPolar, int &nPanels);
 	double GetCl(CFoil  *pFoil0, CFoil *pFoil1, double Re, double Alpha, double Tau, bool &bOutRe, bool &bError);
 	double GetCm(CFoil  *pFoil0, CFoil *pFoil1, double Re, double Alpha, double Tau, bool &bOutRe, bool &bError);
 	double GetCm0(CFoil *pFoil0, CFoil *pFoil1, double Re, double Tau, bool &bOutRe, bool &bError);
@@ -373,8 +385,14 @@ private:
 	double GetXTr(CFoil *pFoil0, CFoil *pFoil1, double Re, double Alpha, double Tau, bool bTop, bool &bOutRe, bool &bError);
 	double GetZeroLiftAngle(CFoil *pFoil0, CFoil *pFoil1, double Re, double Tau);
 	double GetVar(int nVar, CFoil *pFoil0, CFoil *pFoil1, double Re, double Cl, double Tau, bool &bOutRe, bool &bError);
+	void GetFoilVars(CFoil *pFoil0, CFoil *pFoil1, double Re, double Alpha, double Tau, double AR, double *Var, bool &bOutRe, bool &bError);
+	void GetFoilVarsFromCl(CFoil *pFoil0, CFoil *pFoil1, double Re, double Cl, double Tau, double *Var, bool &bOutRe, bool &bError);
 	double GetPlrPointFromAlpha(CFoil *pFoil, double Re, double Alpha, int PlrVar, bool &bOutRe, bool &bError);
 	double GetPlrPointFromCl(   CFoil *pFoil, double Re, double Cl,    int PlrVar, bool &bOutRe, bool &bError);
+	void GetPlrPointsFromAlpha(CFoil *pFoil, double Re, double Alpha, int iVar, int nVar, double *Var, bool &bOutRe, bool &bError);
+	void GetPlrPointsFromCl(   CFoil *pFoil, double Re, double Cl,    int iVar, int nVar, double *Var, bool &bOutRe, bool &bError);
+	void InterpolateAlpha(CPolarEntry *pEntry, double Alpha, int iVar, int nVar, double *Var, bool &bOut);
+	void InterpolateCl(   CPolarEntry *pEntry, double Cl,    int iVar, int nVar, double *Var, bool &bOutRe);
 	void * GetPlrVariable(CPolar *pPolar, int iVar);
 
 	CString RenameUFO(CString UFOName);
@@ -397,22 +415,28 @@ private:
 
 //____________________Variables______________________________________
 //
-	CPanel m_Panel[VLMMATSIZE];		// the panel array for the currently loaded UFO
-	CPanel m_WakePanel[VLMMATSIZE];	// the reference current wake panel array
-	CPanel m_MemPanel[VLMMATSIZE];		// used if the analysis should be performed on the tilted geometry
-	CPanel m_RefWakePanel[VLMMATSIZE]; 	// the reference wake panel array if wake needs to be reset
-	CPanel *m_pPanel[VLMMATSIZE];		// an array to the re-ordered VLM panels for a calculation
-
-	CVector m_Node[2*VLMMATSIZE];		// the node array for the currently loaded UFO
-	CVector m_MemNode[2*VLMMATSIZE];	// used if the analysis should be performed on the tilted geometry
-	CVector m_WakeNode[2*VLMMATSIZE];	// the reference current wake node array
-	CVector m_RefWakeNode[2*VLMMATSIZE]; 	// the reference wake node array if wake needs to be reset
-	CVector m_TempWakeNode[2*VLMMATSIZE];	// the temporary wake node array during relaxation calc
-
-	double m_aij[VLMMATSIZE*VLMMATSIZE];    // coefficient matrix
-	double m_aijRef[VLMMATSIZE*VLMMATSIZE]; // coefficient matrix
-	double m_RHS[VLMMATSIZE*100];			// RHS vector
-	double m_RHSRef[VLMMATSIZE*100];		// RHS vector
+	// the panel, node and matrix arrays are allocated on the heap when the panels are created
+	// and are only re-allocated if the next geometry requires more elements
+	CPanel *m_Panel;		// the panel array for the currently loaded UFO
+	CPanel *m_WakePanel;	// the reference current wake panel array
+	CPanel *m_MemPanel;		// used if the analysis should be performed on the tilted geometry
+	CPanel *m_RefWakePanel; 	// the reference wake panel array if wake needs to be reset
+	CPanel **m_pPanel;		// an array to the re-ordered VLM panels for a calculation
+
+	CVector *m_Node;		// the node array for the currently loaded UFO
+	CVector *m_MemNode;		// used if the analysis should be performed on the tilted geometry
+	CVector *m_WakeNode;		// the reference current wake node array
+	CVector *m_RefWakeNode; 	// the reference wake node array if wake needs to be reset
+	CVector *m_TempWakeNode;	// the temporary wake node array during relaxation calc
+
+	double *m_aij;    // coefficient matrix
+	double *m_aijRef; // coefficient matrix
+	double *m_RHS;		// RHS vector
+	double *m_RHSRef;		// RHS vector
+
+	int m_MaxPanels, m_MaxNodes;		// allocated sizes of the panel and node arrays
+	int m_MaxWakePanels, m_MaxWakeNodes;	// allocated sizes of the wake panel and wake node arrays
+	int m_MaxMatSize;			// the matrix size for which m_aij, m_aijRef and the RHS arrays are allocated
 
 	CVector m_L[(MAXBODYFRAMES+1)*(MAXSIDELINES+1)]; //temporary points to save calculation times for body NURBS surfaces
 	CVector m_T[(MAXBODYFRAMES+1)*(MAXSIDELINES+1)];
@@ -430,6 +454,8 @@ private:
 
 	CVLMDlg m_VLMDlg;			// the dialog class which manages the VLM calculations
 	C3DPanelDlg m_PanelDlg;			// the dialog class which manages the 3D panel calculations
+	CFactorCache m_FactorCache;		// the factorized influence matrices of the latest analyses
+	CPolarIndex m_PolarIndex;		// the foil polars indexed by foil name and Re, for the viscous interpolations
 	CLLTDlg m_LLTDlg;			// the dialog class which manages the LLT calculations
 	CGLLight m_GLLightDlg;			// the dialog class for GL light options 
 	CFlowLinesDlg m_FlowLinesDlg;		// the dialog class for streamline options
@@ -476,6 +502,8 @@ private:
 	bool m_bIs3DScaleSet;		// true if the 3D scale has been set, false if needs to be reset 
 	bool m_bAutoScales;			// true if the scale is to be reset after each UFO selection
 	bool m_bLogFile;			// true if the log file warning is turned on
+	bool m_bBatch;				// true while the batch runner analyzes the polars, no message box is shown then
+	CString m_strBatchMessage;	// the messages of the current batch analysis
 	bool m_bShowLight;			// true if the virtual light is to be displayed
 	bool m_bResetWake;
 	bool m_bVLMFinished;		// true if the VLM calculation is finished
@@ -523,6 +551,7 @@ private:
 	double m_LegendMin, m_LegendMax;
 	double m_CurSpanPos;		//Span position for Cp Grpah
 	double m_CoreSize;			// core size for VLM vortices
+	double m_FarFieldTheta;		// opening ratio of the octree used for the induced speeds, 0 for the exact summation
 	double m_MinPanelSize;			// wing minimum panel size ; panels of less length are ignored
 	double pi;				// ???
 	double m_WingScale;			// scale for 2D display
@@ -58,13 +58,78 @@ CPOpp::CPOpp()
 	m_QInf                = 0.0;
 	m_Ctrl                = 0.0;
 
-	memset(m_Cp, 0, sizeof(m_Cp));
-	memset(m_G,  0, sizeof(m_G));
+	m_Cp    = NULL;
+	m_G     = NULL;
+	m_Sigma = NULL;
+	AllocatePanelResults(0);
 }
 
 CPOpp::~CPOpp()
 {
+	// release the wings' slices before the plane's arrays
+	m_WingWOpp.ReleasePanelResults();
+	m_Wing2WOpp.ReleasePanelResults();
+	m_StabWOpp.ReleasePanelResults();
+	m_FinWOpp.ReleasePanelResults();
+	if(m_Cp)    delete [] m_Cp;
+	if(m_G)     delete [] m_G;
+	if(m_Sigma) delete [] m_Sigma;
+}
+
+
+void CPOpp::AllocatePanelResults(int nPanels)
+{
+	// sizes the panel result arrays to the number of panels of the analysis
+	// the archive holds m_NPanels+1 values for each array, so keep the extra slot
+	m_WingWOpp.ReleasePanelResults();
+	m_Wing2WOpp.ReleasePanelResults();
+	m_StabWOpp.ReleasePanelResults();
+	m_FinWOpp.ReleasePanelResults();
+	if(m_Cp)    delete [] m_Cp;
+	if(m_G)     delete [] m_G;
+	if(m_Sigma) delete [] m_Sigma;
+
+	m_NPanels = nPanels;
+	m_Cp    = new float[nPanels+1];
+	m_G     = new float[nPanels+1];
+	m_Sigma = new float[nPanels+1];
+	memset(m_Cp,    0, (nPanels+1)*sizeof(float));
+	memset(m_G,     0, (nPanels+1)*sizeof(float));
+	memset(m_Sigma, 0, (nPanels+1)*sizeof(float));
+}
+
+
+void CPOpp::AttachWingResults()
+{
+	// the wings' panels are numbered in sequence in the plane's arrays
+	// wing, wing2, stab, fin, so each WOpp points to its slice of m_Cp
+	int p = 0;
+	CWOpp *pWOpp[4] = {&m_WingWOpp, &m_Wing2WOpp, &m_StabWOpp, &m_FinWOpp};
+	bool bWing[4]   = {true, m_bBiplane, m_bStab, m_bFin};
+
+	for(int iw=0; iw<4; iw++)
+	{
+		if(!bWing[iw]) continue;
+		if(p+pWOpp[iw]->m_NVLMPanels>m_NPanels) 
+		{
+			pWOpp[iw]->ReleasePanelResults();
+			pWOpp[iw]->m_NVLMPanels = 0;
+			continue;
+		}
+		pWOpp[iw]->AttachPanelResults(m_Cp+p);
+		p += pWOpp[iw]->m_NVLMPanels;
+	}
+}
 
+
+void CPOpp::GetStrengths(double *Mu, double *Sigma)
+{
+	// expands the stored strengths for the velocity calculations
+	for(int p=0; p<m_NPanels; p++)
+	{
+		Mu[p]    = m_G[p];
+		Sigma[p] = m_Sigma[p];
+	}
 }
 
 void CPOpp::GetBWStyle(COLORREF &color, int &style, int &width)
@@ -116,10 +181,10 @@ bool CPOpp::SerializePOpp(CArchive &ar)
 
 		ar << m_VLMType;
 
-		m_WingWOpp.SerializeWOpp(ar);
-		if(m_bBiplane)	m_Wing2WOpp.SerializeWOpp(ar);
-		if(m_bStab)		m_StabWOpp.SerializeWOpp(ar);
-		if(m_bFin)		m_FinWOpp.SerializeWOpp(ar);
+		m_WingWOpp.SerializeWOpp(ar, false);
+		if(m_bBiplane)	m_Wing2WOpp.SerializeWOpp(ar, false);
+		if(m_bStab)		m_StabWOpp.SerializeWOpp(ar, false);
+		if(m_bFin)		m_FinWOpp.SerializeWOpp(ar, false);
 	}
 	else {
 		try{			
@@ -227,7 +292,8 @@ bool CPOpp::SerializePOpp(CArchive &ar)
 				}
 			}
 			if(ArchiveFormat>=1002){
-				ar >>m_NPanels;
+				ar >> k;
+				AllocatePanelResults(k);
 
 				for (k=0; k<=m_NPanels; k++) {
 					ar >> f;
@@ -237,7 +303,7 @@ bool CPOpp::SerializePOpp(CArchive &ar)
 			if(ArchiveFormat>=1003){
 				for (k=0; k<=m_NPanels; k++) {
 					ar >> f;
-					if(ArchiveFormat<1004)	m_G[k] = f/1000.0;
+					if(ArchiveFormat<1004)	m_G[k] = f/1000.0f;
 					else 					m_G[k] = f;
 				}
 			}
@@ -251,7 +317,7 @@ bool CPOpp::SerializePOpp(CArchive &ar)
 
 			ar >> m_VLMType;
 			
-			if (!m_WingWOpp.SerializeWOpp(ar)){
+			if (!m_WingWOpp.SerializeWOpp(ar, false)){
 				CArchiveException *pfe = new CArchiveException(CArchiveException::badIndex);
 				pfe->m_strFileName = ar.m_strFileName;
 				throw pfe;
@@ -259,7 +325,7 @@ bool CPOpp::SerializePOpp(CArchive &ar)
 
 			if(ArchiveFormat>=1005){
 				if(m_bBiplane){
-					if (!m_Wing2WOpp.SerializeWOpp(ar)){
+					if (!m_Wing2WOpp.SerializeWOpp(ar, false)){
 						CArchiveException *pfe = new CArchiveException(CArchiveException::badIndex);
 						pfe->m_strFileName = ar.m_strFileName;
 						throw pfe;
@@ -267,19 +333,20 @@ bool CPOpp::SerializePOpp(CArchive &ar)
 				}
 			}
 			if(m_bStab){
-				if (!m_StabWOpp.SerializeWOpp(ar)){
+				if (!m_StabWOpp.SerializeWOpp(ar, false)){
 					CArchiveException *pfe = new CArchiveException(CArchiveException::badIndex);
 					pfe->m_strFileName = ar.m_strFileName;
 					throw pfe;
 				}
 			}
 			if(m_bFin){
-				if (!m_FinWOpp.SerializeWOpp(ar)){
+				if (!m_FinWOpp.SerializeWOpp(ar, false)){
 					CArchiveException *pfe = new CArchiveException(CArchiveException::badIndex);
 					pfe->m_strFileName = ar.m_strFileName;
 					throw pfe;
 				}
 			}
+			AttachWingResults();
 		}
 		catch (CArchiveException *ex){
 /*			TCHAR   szCause[255];
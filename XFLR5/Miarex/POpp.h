@@ -38,6 +38,9 @@ public:
 	CPOpp();
 	virtual ~CPOpp();
 	bool SerializePOpp(CArchive &ar);
+	void AllocatePanelResults(int nPanels);
+	void AttachWingResults();
+	void GetStrengths(double *Mu, double *Sigma);
 	void GetBWStyle(COLORREF &color, int &style, int &width);
 
 private:
@@ -53,9 +56,9 @@ private:
 	double m_Beta;
 	double  m_Ctrl;			//Control Variable
 	double m_Weight;		// the plane's wieght
-	double m_Cp[VLMMATSIZE];	// the Cp array
-	double m_G[VLMMATSIZE];		// the VLM vortex strengths, or the panel's doublet's strengths
-	double m_Sigma[VLMMATSIZE];		// the panel's source strengths
+	float *m_Cp;		// the Cp array, sized to m_NPanels, shared with the wings' WOpps
+	float *m_G;		// the VLM vortex strengths, or the panel's doublet's strengths
+	float *m_Sigma;		// the panel's source strengths
 	int m_NStation;			// unused
 	int m_NPanels;		// the number of VLM or 3D-panels
 	int m_Type;			// analysis type
@@ -250,22 +250,12 @@ void CPlaneDlg::OnStab()
 
 void CPlaneDlg::OnOK() 
 {
-	int j, n;
+	int j;
 	CMiarex *pMiarex = (CMiarex*)s_pMiarex;
 	CString strong;
 	ReadParams();
 	ComputePlane();
 
-	n = m_pPlane->m_Wing.VLMGetPanelTotal();
-	if(m_pPlane->m_bStab) n+= m_pPlane->m_Stab.VLMGetPanelTotal();
-	if(m_pPlane->m_bFin)  n+= m_pPlane->m_Fin.VLMGetPanelTotal();
-	if(n>VLMMATSIZE)
-	{
-		strong.Format("Total number of VLM panels =%d\n Max Number =%d\nA reduction of the number of VLM panels is required",n, VLMMATSIZE);
-		AfxMessageBox(strong, MB_OK);
-		return ;
-	}
-
 	//check the number of surfaces
 	int nSurfaces = 0;
 	for (j=0; j<m_pPlane->m_Wing.m_NPanel; j++)
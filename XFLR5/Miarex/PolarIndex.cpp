@@ -0,0 +1,322 @@
+/****************************************************************************
+
+    CPolarIndex Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+//////////////////////////////////////////////////////////////////////
+//
+// PolarIndex.cpp: implementation of the CPolarIndex class.
+// Indexes the Type 1 foil polars by foil name and by Reynolds number,
+// so that the interpolations made at each wing station do not need to 
+// scan the whole polar array and compare the foil names each time.
+// The alpha and Cl arrays of each polar are split in strictly increasing
+// runs, so that a point is located by bisection while returning the same
+// segment as the linear searches it replaces.
+// The variables of each point are copied in a single record, so that 
+// a wing station gets all its interpolated variables from the same 
+// bracketing and the same few cache lines.
+// The index holds pointers to the polars : it must be rebuilt whenever
+// the polar array has changed, i.e. before each analysis.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "../X-FLR5.h"
+#include ".\PolarIndex.h"
+#include <math.h>
+
+
+CPolarEntry::CPolarEntry(CPolar *pPolar)
+{
+	int i, k, nk;
+	double const *pk;
+	CArray <double, double> *pVar[PLRVARS] = {
+		&pPolar->m_Alpha, &pPolar->m_Cl,   &pPolar->m_Cd,   &pPolar->m_Cdp,
+		&pPolar->m_Cm,    &pPolar->m_XTr1, &pPolar->m_XTr2, &pPolar->m_HMom,
+		&pPolar->m_Cpmn,  &pPolar->m_ClCd, &pPolar->m_Cl32Cd, &pPolar->m_XCp};
+
+	m_pPolar   = pPolar;
+	m_Reynolds = pPolar->m_Reynolds;
+	pPolar->GetAlphaLimits(m_amin, m_amax);
+	pPolar->GetClLimits(m_Clmin, m_Clmax);
+
+	int nCl = (int)pPolar->m_Cl.GetSize();
+	double const *Cl = pPolar->m_Cl.GetData();
+	m_iCl0 = 0;
+	for(i=1; i<nCl; i++)
+	{
+		if(fabs(Cl[i])<fabs(Cl[m_iCl0])) m_iCl0 = i;
+	}
+
+	int n = (int)pPolar->m_Alpha.GetSize();
+	BuildRuns(pPolar->m_Alpha.GetData(), n, m_AlphaRun);
+	BuildRuns(Cl, nCl, m_ClRun);
+
+	m_Rec = new double[n*PLRVARS];
+	for(k=0; k<PLRVARS; k++)
+	{
+		nk = (int)pVar[k]->GetSize();
+		pk = pVar[k]->GetData();
+		for(i=0; i<n; i++)
+		{
+			if(i<nk) m_Rec[i*PLRVARS+k] = pk[i];
+			else     m_Rec[i*PLRVARS+k] = 0.0;
+		}
+	}
+}
+
+
+CPolarEntry::~CPolarEntry()
+{
+	delete [] m_Rec;
+}
+
+
+void CPolarEntry::BuildRuns(double const *c, int n, CArray<int,int> &Run)
+{
+	// stores the first and last points of each run of strictly increasing values
+	// only these runs can hold a segment such that c[j] <= v < c[j+1]
+	int i, s;
+	Run.RemoveAll();
+	i=0;
+	while(i<n-1)
+	{
+		if(c[i]<c[i+1])
+		{
+			s = i;
+			while(i<n-1 && c[i]<c[i+1]) i++;
+			Run.Add(s);
+			Run.Add(i);
+		}
+		else i++;
+	}
+}
+
+
+int CPolarEntry::FindUp(double const *c, CArray<int,int> &Run, double v, int jMin, int jMax, bool bLast)
+{
+	// returns the first segment j in [jMin, jMax] such that c[j] <= v < c[j+1], 
+	// or the last one if bLast is true, or -1 if there is none
+	int k, r, lo, hi, mid;
+	int nRuns = (int)Run.GetSize()/2;
+	int const *pRun = Run.GetData();
+
+	for(k=0; k<nRuns; k++)
+	{
+		if(bLast) r = nRuns-1-k;
+		else      r = k;
+		lo = max(pRun[2*r],     jMin);
+		hi = min(pRun[2*r+1]-1, jMax);
+		if(lo>hi || v<c[lo] || v>=c[hi+1]) continue;
+		while(lo<hi)
+		{
+			mid = (lo+hi+1)/2;
+			if(c[mid]<=v) lo = mid;
+			else          hi = mid-1;
+		}
+		return lo;
+	}
+	return -1;
+}
+
+
+int CPolarEntry::FindDown(double const *c, CArray<int,int> &Run, double v, int jMin, int jMax)
+{
+	// returns the last segment j in [jMin, jMax] such that c[j] < v <= c[j+1], or -1 if there is none
+	int k, lo, hi, mid;
+	int nRuns = (int)Run.GetSize()/2;
+	int const *pRun = Run.GetData();
+
+	for(k=nRuns-1; k>=0; k--)
+	{
+		lo = max(pRun[2*k],     jMin);
+		hi = min(pRun[2*k+1]-1, jMax);
+		if(lo>hi || v<=c[lo] || v>c[hi+1]) continue;
+		while(lo<hi)
+		{
+			mid = (lo+hi)/2;
+			if(v<=c[mid+1]) hi = mid;
+			else            lo = mid+1;
+		}
+		return lo;
+	}
+	return -1;
+}
+
+
+int CPolarEntry::FindAlpha(double Alpha, bool bLast)
+{
+	return FindUp(m_pPolar->m_Alpha.GetData(), m_AlphaRun, Alpha, 0, (int)m_pPolar->m_Alpha.GetSize()-2, bLast);
+}
+
+
+int CPolarEntry::FindCl(double Cl, int jMin, int jMax)
+{
+	return FindUp(m_pPolar->m_Cl.GetData(), m_ClRun, Cl, jMin, jMax, false);
+}
+
+
+int CPolarEntry::FindClDown(double Cl, int jMin, int jMax)
+{
+	return FindDown(m_pPolar->m_Cl.GetData(), m_ClRun, Cl, jMin, jMax);
+}
+
+
+void CPolarEntry::GetPoint(int i, int iVar, int nVar, double *Var)
+{
+	// returns the variables iVar to iVar+nVar-1 of point i
+	double const *r = m_Rec + i*PLRVARS + iVar;
+	for(int k=0; k<nVar; k++) Var[k] = r[k];
+}
+
+
+void CPolarEntry::Interpolate(double const *c, int j, double v, bool bUpper, int iVar, int nVar, double *Var)
+{
+	// interpolates the variables iVar to iVar+nVar-1 on the segment [j, j+1]
+	if(c[j+1]-c[j] < 0.00001)
+	{
+		//do not divide by zero
+		if(bUpper) GetPoint(j+1, iVar, nVar, Var);
+		else       GetPoint(j,   iVar, nVar, Var);
+		return;
+	}
+	double u = (v - c[j])/(c[j+1]-c[j]);
+	double const *r0 = m_Rec + j*PLRVARS + iVar;
+	double const *r1 = r0 + PLRVARS;
+	for(int k=0; k<nVar; k++) Var[k] = r0[k] + u * (r1[k]-r0[k]);
+}
+
+
+
+CPolarFoil::CPolarFoil(CString const &FoilName)
+{
+	m_FoilName = FoilName;
+}
+
+
+CPolarFoil::~CPolarFoil()
+{
+	for(int i=0; i<m_oaEntry.GetSize(); i++) delete (CPolarEntry*)m_oaEntry.GetAt(i);
+	m_oaEntry.RemoveAll();
+}
+
+
+int CPolarFoil::UpperRe(double Re)
+{
+	// returns the index of the first entry with a Reynolds number greater than Re
+	int lo = 0;
+	int hi = (int)m_oaEntry.GetSize();
+	int mid;
+	while(lo<hi)
+	{
+		mid = (lo+hi)/2;
+		if(GetAt(mid)->m_Reynolds<=Re) lo = mid+1;
+		else                           hi = mid;
+	}
+	return lo;
+}
+
+
+void CPolarFoil::Insert(CPolarEntry *pEntry)
+{
+	// polars with the same Re are kept in the order of the polar array
+	m_oaEntry.InsertAt(UpperRe(pEntry->m_Reynolds), pEntry);
+}
+
+
+
+CPolarIndex::CPolarIndex()
+{
+	m_bBuilt = false;
+}
+
+
+CPolarIndex::~CPolarIndex()
+{
+	Clear();
+}
+
+
+void CPolarIndex::Clear()
+{
+	for(int i=0; i<m_oaFoil.GetSize(); i++) delete (CPolarFoil*)m_oaFoil.GetAt(i);
+	m_oaFoil.RemoveAll();
+	m_bBuilt = false;
+}
+
+
+int CPolarIndex::Locate(CString const &FoilName, bool &bFound)
+{
+	// returns the position of the foil in the sorted array, or the position where it should be inserted
+	int lo = 0;
+	int hi = (int)m_oaFoil.GetSize();
+	int mid, cmp;
+	bFound = false;
+	while(lo<hi)
+	{
+		mid = (lo+hi)/2;
+		cmp = ((CPolarFoil*)m_oaFoil.GetAt(mid))->m_FoilName.Compare(FoilName);
+		if(cmp==0)
+		{
+			bFound = true;
+			return mid;
+		}
+		if(cmp<0) lo = mid+1;
+		else      hi = mid;
+	}
+	return lo;
+}
+
+
+void CPolarIndex::Build(CObArray *poaPolar)
+{
+	// indexes the Type 1 polars which hold at least one point
+	int i, pos;
+	bool bFound;
+	CPolar *pPolar;
+	CPolarFoil *pFoilIndex;
+
+	Clear();
+	if(!poaPolar) return;
+
+	for(i=0; i<poaPolar->GetSize(); i++)
+	{
+		pPolar = (CPolar*)poaPolar->GetAt(i);
+		if(pPolar->m_Type!=1 || !pPolar->m_Alpha.GetSize() || !pPolar->m_Cl.GetSize()) continue;
+
+		pos = Locate(pPolar->m_FoilName, bFound);
+		if(bFound) pFoilIndex = (CPolarFoil*)m_oaFoil.GetAt(pos);
+		else
+		{
+			pFoilIndex = new CPolarFoil(pPolar->m_FoilName);
+			m_oaFoil.InsertAt(pos, pFoilIndex);
+		}
+		pFoilIndex->Insert(new CPolarEntry(pPolar));
+	}
+	m_bBuilt = true;
+}
+
+
+CPolarFoil* CPolarIndex::GetFoil(CString const &FoilName)
+{
+	bool bFound;
+	int pos = Locate(FoilName, bFound);
+	if(!bFound) return NULL;
+	return (CPolarFoil*)m_oaFoil.GetAt(pos);
+}
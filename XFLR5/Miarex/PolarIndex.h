@@ -0,0 +1,95 @@
+/****************************************************************************
+
+    CPolarIndex Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+// PolarIndex.h: interface for the CPolarIndex class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../XDirect/Polar.h"
+
+#define PLRVARS 12	// the number of variables in a polar record, indexed as in CMiarex::GetPlrVariable
+
+class CPolarEntry
+{
+public:
+	CPolarEntry(CPolar *pPolar);
+	~CPolarEntry();
+
+	int FindAlpha(double Alpha, bool bLast);
+	int FindCl(double Cl, int jMin, int jMax);
+	int FindClDown(double Cl, int jMin, int jMax);
+	void GetPoint(int i, int iVar, int nVar, double *Var);
+	void Interpolate(double const *c, int j, double v, bool bUpper, int iVar, int nVar, double *Var);
+
+	CPolar *m_pPolar;		// the indexed Type 1 polar
+	double m_Reynolds;
+	double m_amin, m_amax;		// the alpha limits, as returned by CPolar::GetAlphaLimits
+	double m_Clmin, m_Clmax;	// the Cl limits, as returned by CPolar::GetClLimits
+	int m_iCl0;			// the first point closest to Cl=0
+
+protected:
+	static void BuildRuns(double const *c, int n, CArray<int,int> &Run);
+	static int FindUp(double const *c, CArray<int,int> &Run, double v, int jMin, int jMax, bool bLast);
+	static int FindDown(double const *c, CArray<int,int> &Run, double v, int jMin, int jMax);
+
+	CArray<int,int> m_AlphaRun;	// first and last points of the strictly increasing runs of m_Alpha
+	CArray<int,int> m_ClRun;	// first and last points of the strictly increasing runs of m_Cl
+	double *m_Rec;			// the PLRVARS variables of each point, interleaved
+};
+
+
+class CPolarFoil
+{
+public:
+	CPolarFoil(CString const &FoilName);
+	~CPolarFoil();
+
+	void Insert(CPolarEntry *pEntry);
+	int GetSize() {return (int)m_oaEntry.GetSize();}
+	CPolarEntry* GetAt(int i) {return (CPolarEntry*)m_oaEntry.GetAt(i);}
+	int UpperRe(double Re);
+
+	CString m_FoilName;
+
+protected:
+	CPtrArray m_oaEntry;		// the entries, sorted by crescending Re
+};
+
+
+class CPolarIndex  
+{
+public:
+	CPolarIndex();
+	virtual ~CPolarIndex();
+
+	void Build(CObArray *poaPolar);
+	void Clear();
+	bool IsBuilt() {return m_bBuilt;}
+	CPolarFoil* GetFoil(CString const &FoilName);
+
+protected:
+	int Locate(CString const &FoilName, bool &bFound);
+
+	CPtrArray m_oaFoil;		// the foils, sorted by name
+	bool m_bBuilt;
+};
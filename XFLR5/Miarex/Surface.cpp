@@ -776,6 +776,8 @@ void CSurface::AddFlapPanel(CPanel *pPanel)
 	bool bFound = false;
 	int i;
 
+	if(m_nFlapNodes>VLMHALF-4 || m_nFlapPanels>=VLMHALF) return;//no room left for this panel's nodes
+
 	//Add Nodes
 
 	for (i=0; i< m_nFlapNodes; i++)
@@ -30,6 +30,7 @@
 #include "../main/MainFrm.h"
 #include "Miarex.h"
 #include ".\vlmdlg.h"
+#include "../misc/TaskPool.h"
 
 /////////////////////////////////////////////////////////////////////////////
 // CVLMDlg dialog
@@ -112,10 +113,45 @@ CVLMDlg::CVLMDlg(CWnd* pParent /*=NULL*/)
 	m_pRefWakeNode  = NULL;
 	m_pTempWakeNode = NULL;
 
-	memset(m_Cp,0,sizeof(m_Cp));
+	m_pFactorCache = NULL;
+	m_pFactors     = NULL;
+	m_GeomKey      = 0;
+
+	m_pFarFieldTheta = NULL;
+	m_pFFGamma       = NULL;
+	m_FFPanel        = NULL;
+
+	m_nWorkers = 0;
+
+	m_xRHS = NULL;
+	m_yRHS = NULL;
+	m_zRHS = NULL;
+	m_ipiv = NULL;
+	m_Cp   = NULL;
+
 	memset(m_VLMQInf,0,sizeof(m_VLMQInf));
-	memset(m_zRHS, 0, sizeof(m_zRHS));
-	memset(m_xRHS, 0, sizeof(m_xRHS));
+}
+
+
+CVLMDlg::~CVLMDlg()
+{
+	ReleaseArrays();
+	ReleaseFarField();
+}
+
+
+void CVLMDlg::ReleaseArrays()
+{
+	if(m_xRHS) delete [] m_xRHS;
+	if(m_yRHS) delete [] m_yRHS;
+	if(m_zRHS) delete [] m_zRHS;
+	if(m_ipiv) delete [] m_ipiv;
+	if(m_Cp)   delete [] m_Cp;
+	m_xRHS = NULL;
+	m_yRHS = NULL;
+	m_zRHS = NULL;
+	m_ipiv = NULL;
+	m_Cp   = NULL;
 }
 
 
@@ -161,6 +197,17 @@ BOOL CVLMDlg::OnInitDialog()
 
 	m_bWakeRollUp    = false;
 
+	//the per-panel arrays are sized to the current geometry for the duration of the analysis
+	ReleaseArrays();
+	m_xRHS = new double[m_MatSize];
+	m_yRHS = new double[m_MatSize];
+	m_zRHS = new double[m_MatSize];
+	m_ipiv = new int[m_MatSize];
+	m_Cp   = new double[m_MatSize];
+	memset(m_xRHS, 0, m_MatSize*sizeof(double));
+	memset(m_yRHS, 0, m_MatSize*sizeof(double));
+	memset(m_zRHS, 0, m_MatSize*sizeof(double));
+	memset(m_Cp,   0, m_MatSize*sizeof(double));
 
 	m_ctrlOutput.SetLimitText(100000);
 
@@ -459,13 +506,16 @@ void CVLMDlg::EndSequence()
 	if (m_bCancel) 
 		AddString("\r\n\r\nAnalysis cancelled per user request....\r\n");
 
+	//the results have been stored in the operating points
+	ReleaseArrays();
+
 	CMiarex* pMiarex = (CMiarex*)m_pMiarex;
 	if(pMiarex->m_bVLMFinished && !m_bXFile) return;
 	
 	pMiarex->m_bVLMFinished = true;
 	m_bXFile = false;
 	m_XFile.Close();
-	if(m_bWarning && pMiarex->m_bLogFile && !m_bCancel)
+	if(m_bWarning && pMiarex->m_bLogFile && !pMiarex->m_bBatch && !m_bCancel)
 	{
 		if(IDYES == AfxMessageBox("Some points were found outside the available flight envelope\r\nView the Log file for details ?", MB_YESNOCANCEL))
 		{
@@ -521,11 +571,26 @@ bool CVLMDlg::VLMCreateMatrix()
 	int p,pp, Size;
 	int pos = 0;
 	CVector  CC;
-	AddString("      Creating the influence matrix...\r\n");
 
 	if(m_bVLMSymetric) Size = m_MatSize/2;
 	else               Size = m_MatSize;
 
+	// If this geometry has already been solved, reuse its factors
+	// the wake moves between the roll-up iterations, so its matrices cannot be reused
+	m_pFactors = NULL;
+	if(m_pFactorCache && !m_pWPolar->m_bWakeRollUp)
+	{
+		m_GeomKey  = GetGeometryKey();
+		m_pFactors = m_pFactorCache->Find(m_GeomKey, Size);
+	}
+	if(m_pFactors)
+	{
+		AddString("      Reusing the factorized influence matrix...\r\n");
+		return true;
+	}
+
+	AddString("      Creating the influence matrix...\r\n");
+
 	for(p=0; p<Size; p++)
 	{
 		if(m_bCancel) break;
@@ -561,7 +626,7 @@ bool CVLMDlg::VLMSolveDouble()
 	CMainFrame *pFrame = (CMainFrame*)m_pFrame;
 	CString strong, strange;
 
-	int Size;
+	int Size, k0;
 	
 	if(m_bVLMSymetric) Size = m_MatSize/2;
 	else               Size = m_MatSize;
@@ -575,13 +640,31 @@ bool CVLMDlg::VLMSolveDouble()
 	memcpy(m_RHS,      m_xRHS, Size * sizeof(double));
 	memcpy(m_RHS+Size, m_zRHS, Size * sizeof(double));
 
-	if(!Gauss(m_aij,Size, m_RHS, 2))
+	if(m_pFactors)
 	{
-		AddString("      Singular Matrix.... Aborting calculation...\r\n");
-		m_bConverged = false;
-		return false;
+		// same geometry as a previous analysis, only back-substitute
+		LUSolve(m_pFactors->m_pLU, Size, m_pFactors->m_pipiv, m_RHS, 2);
+		m_bConverged = true;
+	}
+	else
+	{
+		for(k0=0; k0<Size; k0+=LUBLOCK)
+		{
+			if(m_bCancel) return true;
+			if(!LUFactorBlock(m_aij, Size, m_ipiv, k0, min(LUBLOCK, Size-k0)))
+			{
+				AddString("      Singular Matrix.... Aborting calculation...\r\n");
+				m_bConverged = false;
+				return false;
+			}
+		}
+		m_bConverged = true;
+
+		if(m_pFactorCache && !m_pWPolar->m_bWakeRollUp)
+			m_pFactorCache->Store(m_GeomKey, Size, m_aij, m_ipiv, m_RHS, 2);
+
+		LUSolve(m_aij, Size, m_ipiv, m_RHS, 2);
 	}
-	else m_bConverged = true;
 
 	memcpy(m_xRHS, m_RHS,      Size * sizeof(double));
 	memcpy(m_zRHS, m_RHS+Size, Size * sizeof(double));
@@ -591,6 +674,52 @@ bool CVLMDlg::VLMSolveDouble()
 
 
 
+unsigned __int64 CVLMDlg::GetGeometryKey()
+{
+	// Returns a hash of all the data the influence matrix depends upon
+	// i.e. the analysis settings, the panels in the matrix order, and the wake
+	int p, pw;
+	CPanel *pPanel;
+	unsigned __int64 Key = CFactorCache::InitKey();
+
+	CFactorCache::AddToKey(Key, 'V');// distinguish from 3D panel matrices
+	CFactorCache::AddToKey(Key, m_MatSize);
+	CFactorCache::AddToKey(Key, m_bVLMSymetric);
+	CFactorCache::AddToKey(Key, *m_pCoreSize);
+	CFactorCache::AddToKey(Key, m_pWPolar->m_bVLM1);
+	CFactorCache::AddToKey(Key, m_pWPolar->m_bGround);
+	CFactorCache::AddToKey(Key, m_pWPolar->m_Height);
+	CFactorCache::AddToKey(Key, m_pWPolar->m_NXWakePanels);
+	CFactorCache::AddToKey(Key, m_WakeSize);
+
+	for(p=0; p<m_MatSize; p++)
+	{
+		pPanel = m_ppPanel[p];
+		CFactorCache::AddToKey(Key, pPanel->m_iElement);
+		CFactorCache::AddToKey(Key, pPanel->m_iWake);
+		CFactorCache::AddToKey(Key, pPanel->m_bIsTrailing);
+		CFactorCache::AddToKey(Key, pPanel->m_bIsInSymPlane);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iLA]);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iLB]);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iTA]);
+		CFactorCache::AddToKey(Key, m_pNode[pPanel->m_iTB]);
+		CFactorCache::AddToKey(Key, pPanel->CtrlPt);
+		CFactorCache::AddToKey(Key, pPanel->Normal);
+		CFactorCache::AddToKey(Key, pPanel->A);
+		CFactorCache::AddToKey(Key, pPanel->B);
+	}
+
+	for(pw=0; pw<m_WakeSize; pw++)
+	{
+		pPanel = m_pWakePanel+pw;
+		CFactorCache::AddToKey(Key, pPanel->A);
+		CFactorCache::AddToKey(Key, pPanel->B);
+	}
+
+	return Key;
+}
+
+
 bool CVLMDlg::VLMSolveMultiple(double V0, double VDelta, int nval)
 {
 	//______________________________________________________________________________________
@@ -610,7 +739,6 @@ bool CVLMDlg::VLMSolveMultiple(double V0, double VDelta, int nval)
 	int n, o, o1, nel, m;
 
 	double Lift, alpha, cosa, sina;
-	double row[VLMMATSIZE];memset(row, 0, sizeof(row));
 
 	CVector N, Force, WindNormal;
 	CVector VInf;
@@ -1102,8 +1230,30 @@ void CVLMDlg::VLMSumForces(double *Gamma, double Alpha, double QInf, double &Lif
 CVector CVLMDlg::GetSpeedVector(CVector C, double *Gamma)
 {
 	int pp;
-	CVector VTot;
+	CVector V, VTot, VGround, CGround;
 	VTot.Set(0.0,0.0,0.0);
+
+	if(m_FarField.IsBuilt() && Gamma==m_pFFGamma)
+	{
+		// the rings of the far-field cells are evaluated from the cells' moments
+		m_FarField.GetSpeed(C, VTot, FarFieldNearProc, this);
+		if(m_pWPolar->m_bGround) 
+		{
+			// the image of a ring evaluated at C is the opposite of the ring evaluated at the image of C
+			CGround.Set(C.x, C.y, -C.z - 2.0*m_pWPolar->m_Height);
+			m_FarField.GetSpeed(CGround, VGround, FarFieldNearProc, this);
+			VTot -= VGround;
+		}
+		for (pp=0; pp<m_MatSize;pp++)
+		{
+			if(m_pPanel[pp].m_bIsTrailing)
+			{
+				VLMGetVortexInfluence(m_pPanel+pp, C, V, true);
+				VTot += V * Gamma[pp];
+			}
+		}
+		return VTot;
+	}
 	
 	for (pp=0; pp<m_MatSize;pp++)
 	{
@@ -1115,12 +1265,91 @@ CVector CVLMDlg::GetSpeedVector(CVector C, double *Gamma)
 } 
 
 
+bool CVLMDlg::BuildFarField(double *Gamma)
+{
+	// builds the octree of the vortex rings of the non-trailing panels, for the strengths Gamma
+	// a ring is equivalent in the far field to a doublet of moment Gamma.S/4.pi,
+	// where S is the vector area of the ring
+	// GetSpeedVector uses the octree until ReleaseFarField is called
+	// returns false if the user has requested the exact summation, or if the analysis uses horseshoe vortices
+	int pp, n;
+	double Size;
+	CVector LA, LB, TA, TB, Center, Doublet;
+
+	ReleaseFarField();
+	if(!m_pFarFieldTheta || *m_pFarFieldTheta<=0.0 || !Gamma || m_MatSize<=0) return false;
+	if(m_pWPolar->m_bVLM1) return false;
+
+	n = 0;
+	for (pp=0; pp<m_MatSize; pp++) if(!m_pPanel[pp].m_bIsTrailing) n++;
+	if(!n) return false;
+
+	m_FFPanel = new int[n];
+	m_FarField.Allocate(n);
+	m_FarField.m_Theta = *m_pFarFieldTheta;
+
+	n = 0;
+	for (pp=0; pp<m_MatSize; pp++)
+	{
+		if(m_pPanel[pp].m_bIsTrailing) continue;
+
+		LA.Set(m_pPanel[pp].A);
+		LB.Set(m_pPanel[pp].B);
+		TA.Set(m_pPanel[pp-1].A);
+		TB.Set(m_pPanel[pp-1].B);
+
+		Center.x = (LA.x + LB.x + TA.x + TB.x)/4.0;
+		Center.y = (LA.y + LB.y + TA.y + TB.y)/4.0;
+		Center.z = (LA.z + LB.z + TA.z + TB.z)/4.0;
+
+		// the ring is traversed LB->TB->TA->LA in VLMQmn
+		Doublet.x = ((TA.y-LB.y)*(LA.z-TB.z) - (TA.z-LB.z)*(LA.y-TB.y)) * Gamma[pp]/8.0/pi;
+		Doublet.y = ((TA.z-LB.z)*(LA.x-TB.x) - (TA.x-LB.x)*(LA.z-TB.z)) * Gamma[pp]/8.0/pi;
+		Doublet.z = ((TA.x-LB.x)*(LA.y-TB.y) - (TA.y-LB.y)*(LA.x-TB.x)) * Gamma[pp]/8.0/pi;
+
+		Size = __max(__max((LA-Center).VAbs(), (LB-Center).VAbs()), __max((TA-Center).VAbs(), (TB-Center).VAbs()));
+
+		m_FFPanel[n] = pp;
+		m_FarField.SetElement(n, Center, Size, 0.0, Doublet);
+		n++;
+	}
+	m_FarField.Build();
+
+	m_pFFGamma = Gamma;
+	return true;
+}
+
+
+void CVLMDlg::ReleaseFarField()
+{
+	m_FarField.Release();
+	if(m_FFPanel) delete [] m_FFPanel;
+	m_FFPanel  = NULL;
+	m_pFFGamma = NULL;
+}
+
+
+void CVLMDlg::FarFieldNearProc(int iElement, CVector const &C, CVector &V, void *pParam)
+{
+	// the exact influence of a vortex ring in free air, used for the cells close to C
+	CVLMDlg *pDlg = (CVLMDlg*)pParam;
+	int p = pDlg->m_FFPanel[iElement];
+
+	pDlg->VLMQmn(pDlg->m_pPanel[p].A, pDlg->m_pPanel[p].B, pDlg->m_pPanel[p-1].A, pDlg->m_pPanel[p-1].B, C, V);
+	V.x *= pDlg->m_pFFGamma[p];
+	V.y *= pDlg->m_pFFGamma[p];
+	V.z *= pDlg->m_pFFGamma[p];
+}
+
+
 void CVLMDlg::VLMGetVortexInfluence(CPanel *pPanel, CVector const &C, CVector &V, bool bAll)
 {
 	// calculates the the panel p's vortex influence at point C
 	// V is the resulting velocity
+	// all temporaries are local, so that the function may run concurrently in several threads
 	int lw, pw;
 	int p = pPanel->m_iElement;
+	CVector AA, BB, AA1, BB1, AAG, BBG, VG, VT;
 	V.Set(0.0,0.0,0.0);
 
 	if(m_pWPolar->m_bVLM1)
@@ -1566,20 +1795,19 @@ void CVLMDlg::VLMSetAi(double *Gamma)
 
 void CVLMDlg::ResetWakeNodes()
 {
-	memcpy(m_pWakeNode, m_pRefWakeNode, sizeof(m_pRefWakeNode));
+	memcpy(m_pWakeNode, m_pRefWakeNode, m_nWakeNodes * sizeof(CVector));
 }
 
 
 void CVLMDlg::RelaxWake()
 {
 	int mw=0;
-	int lw, kw, llw;
-	double t, dx;
-	double *Gamma = m_Gamma;
-	CVector LATB, TALB, Trans, VL, VT;
-	CVector QInf(m_QInf*cos(m_Alpha*pi/180.0), 0.0, m_QInf*sin(m_Alpha*pi/180.0)) ;
-	CVector WLA, WLB,WTA,WTB, WTemp;//wake panel's leading corner points
+	int i;
+	double d, dmax;
+	CVector LATB, TALB;
+	CVector WLA, WLB,WTA,WTB;//wake panel's leading corner points
 	CMiarex *pMiarex = (CMiarex*)m_pMiarex;
+	CString str;
 
 	// calculates the induced velocity at the wake panel points 
 	// and realigns the panel's sides with the local flow vector
@@ -1590,84 +1818,27 @@ void CVLMDlg::RelaxWake()
 
 	AddString("      Relaxing the wake...\r\n\r\n");
 
-	memcpy(m_pTempWakeNode, m_pWakeNode, sizeof(m_pTempWakeNode));
-
-	for (kw=0; kw<m_NWakeColumn; kw++)
-	{
-		if(m_bCancel) break;
-		for (lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
-		{
-			//left point
-			mw = kw * m_pWPolar->m_NXWakePanels + lw;
-
-			//left point
-			WLA.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iLA]);
-			WTA.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iTA]);
-			WTemp.Copy(WLA);
-			
-			dx  = (WTA.x-WLA.x);
-
-			VL  = GetSpeedVector(WLA, Gamma);
-			VL += QInf;
-			VT  = GetSpeedVector(WTA, Gamma);
-			VT += QInf;
-			V = (VL +VT)/2.0;
-			V.Normalize();
-
-			t = dx/V.x;
-			WTemp.x += dx;
-			WTemp.y += V.y * t;
-			WTemp.z += V.z * t;
-			
-
-			//define the translation vector and move the panel's left T.E. node
-			Trans = WTemp-WLA;
+	// the rings on the wing's surface do not move, only the wake panels are summed exactly
+	BuildFarField(m_Gamma);
 
-			//and move all the nodes downstream, i.e. all panels left nodes
-			for (llw=0; llw <m_pWPolar->m_NXWakePanels-lw; llw++)
-			{
-				m_pTempWakeNode[m_pWakePanel[mw+llw].m_iTA].y += Trans.y;
-				m_pTempWakeNode[m_pWakePanel[mw+llw].m_iTA].z += Trans.z;
-			}
-		}
-	}
+	memcpy(m_pTempWakeNode, m_pWakeNode, m_nWakeNodes * sizeof(CVector));
 
-	//finally do the same for the right side of the last panel
+	// the speed field is frozen during the pass, so that the sides of the columns may be relaxed concurrently
+	CTaskPool::Run(m_NWakeColumn+1, WakeSideTask, this, m_nWorkers, &m_bCancel);
+	ReleaseFarField();
+	if(m_bCancel) return;
 
-	for (lw=0; lw <m_pWPolar->m_NXWakePanels; lw++)
+	dmax = 0.0;
+	for (i=0; i<m_nWakeNodes; i++)
 	{
-		mw = (m_NWakeColumn-1) * m_pWPolar->m_NXWakePanels + lw;
-		WLB.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iLB]);
-		WTB.Copy(m_pTempWakeNode[m_pWakePanel[mw].m_iTB]);
-		WTemp.Copy(WLB);
-		dx  = (WTB.x-WLB.x);
-
-		VL  = GetSpeedVector(WLB, Gamma);
-		VL += QInf;
-		VT  = GetSpeedVector(WTB, Gamma);
-		VT += QInf;
-		V = (VL +VT)/2.0;
-		V.Normalize();
-
-		t = dx/V.x;
-		WTemp.x += dx;
-		WTemp.y += V.y * t;
-		WTemp.z += V.z * t;
-		
-
-		//define the translation vector and move the panel's right T.E. node
-		Trans = WTemp-WLB;
-		//and move all the nodes downstream, i.e. all panels left nodes
-		for (llw=0; llw <m_pWPolar->m_NXWakePanels-lw; llw++)
-		{
-			m_pTempWakeNode[m_pWakePanel[mw+llw].m_iTB].y += Trans.y;
-			m_pTempWakeNode[m_pWakePanel[mw+llw].m_iTB].z += Trans.z;
-		}
+		d = (m_pTempWakeNode[i] - m_pWakeNode[i]).VAbs();
+		if(d>dmax) dmax = d;
 	}
-
+	str.Format("      Max. wake node displacement = %g m\r\n", dmax);
+	AddString(str);
 
 	// Paste the new wake nodes back into the working wake node array
-	memcpy(m_pWakeNode, m_pTempWakeNode, sizeof(m_pTempWakeNode));
+	memcpy(m_pWakeNode, m_pTempWakeNode, m_nWakeNodes * sizeof(CVector));
 
 	// Re-create the wake panels
 	mw=0;
@@ -1698,6 +1869,75 @@ void CVLMDlg::RelaxWake()
 }
 
 
+void CVLMDlg::WakeSideTask(int kw, int iWorker, void *pParam)
+{
+	CVLMDlg *pDlg = (CVLMDlg*)pParam;
+	pDlg->RelaxWakeSide(kw);
+}
+
+
+void CVLMDlg::RelaxWakeSide(int kw)
+{
+	// aligns the left side of wake column kw with the local flow
+	// kw=m_NWakeColumn is the right side of the last column
+	// only the trailing nodes of this side are moved, so that the sides may be relaxed concurrently
+	int mw, lw, llw, NX, iL, iT;
+	double t, dx;
+	CVector V, VL, VT, WL, WT, WTemp, Trans;
+	CVector QInf(m_QInf*cos(m_Alpha*pi/180.0), 0.0, m_QInf*sin(m_Alpha*pi/180.0)) ;
+
+	NX = m_pWPolar->m_NXWakePanels;
+
+	for (lw=0; lw<NX; lw++)
+	{
+		if(m_bCancel) return;
+
+		if(kw<m_NWakeColumn)
+		{
+			mw = kw * NX + lw;
+			iL = m_pWakePanel[mw].m_iLA;
+			iT = m_pWakePanel[mw].m_iTA;
+		}
+		else
+		{
+			mw = (m_NWakeColumn-1) * NX + lw;
+			iL = m_pWakePanel[mw].m_iLB;
+			iT = m_pWakePanel[mw].m_iTB;
+		}
+
+		WL.Copy(m_pTempWakeNode[iL]);
+		WT.Copy(m_pTempWakeNode[iT]);
+		WTemp.Copy(WL);
+
+		dx  = (WT.x-WL.x);
+
+		VL  = GetSpeedVector(WL, m_Gamma);
+		VL += QInf;
+		VT  = GetSpeedVector(WT, m_Gamma);
+		VT += QInf;
+		V = (VL +VT)/2.0;
+		V.Normalize();
+
+		t = dx/V.x;
+		WTemp.x += dx;
+		WTemp.y += V.y * t;
+		WTemp.z += V.z * t;
+
+		//define the translation vector and move the panel's T.E. node
+		Trans = WTemp-WL;
+
+		//and move all the nodes downstream on this side
+		for (llw=0; llw <NX-lw; llw++)
+		{
+			if(kw<m_NWakeColumn) iT = m_pWakePanel[mw+llw].m_iTA;
+			else                 iT = m_pWakePanel[mw+llw].m_iTB;
+			m_pTempWakeNode[iT].y += Trans.y;
+			m_pTempWakeNode[iT].z += Trans.z;
+		}
+	}
+}
+
+
 
 /*
 void CVLMDlg::RelaxWake()
@@ -1929,16 +2169,21 @@ void CVLMDlg::Plot()
 		CString strOut;
 		CPanel Panel;
 
-		m_pNode[2*VLMMATSIZE-10].Set( 1.0,  1.0, 0.0);
-		m_pNode[2*VLMMATSIZE- 9].Set( -1.0,  1.0, 0.0);
-		m_pNode[2*VLMMATSIZE- 8].Set( -1.0, -1.0, 0.0);
-		m_pNode[2*VLMMATSIZE- 7].Set(  1.0, -1.0, 0.0);
-
-		Panel.SetFrame(m_pNode[2*VLMMATSIZE-10], m_pNode[2*VLMMATSIZE-9], m_pNode[2*VLMMATSIZE-8], m_pNode[2*VLMMATSIZE-7]);
-		Panel.m_iLA = 2*VLMMATSIZE-10;
-		Panel.m_iTA = 2*VLMMATSIZE- 9;
-		Panel.m_iTB = 2*VLMMATSIZE- 8;
-		Panel.m_iLB = 2*VLMMATSIZE- 7;
+		//use a temporary node array for the test panel
+		CVector Node[4];
+		CVector *pMemPanelNode = CPanel::s_pNode;
+		CPanel::s_pNode = Node;
+
+		Node[0].Set( 1.0,  1.0, 0.0);
+		Node[1].Set( -1.0,  1.0, 0.0);
+		Node[2].Set( -1.0, -1.0, 0.0);
+		Node[3].Set(  1.0, -1.0, 0.0);
+
+		Panel.SetFrame(Node[0], Node[1], Node[2], Node[3]);
+		Panel.m_iLA = 0;
+		Panel.m_iTA = 1;
+		Panel.m_iTB = 2;
+		Panel.m_iLB = 3;
 		Panel.m_iPos = 1;
 		Panel.m_bIsLeading     = false;
 		Panel.m_bIsTrailing    = false;
@@ -1954,12 +2199,13 @@ void CVLMDlg::Plot()
 		for (i=0; i<=N; i++)
 		{
 			//VLMQmn(CVector const &LA, CVector const &LB, CVector const &TA, CVector const &TB, CVector const &C, CVector &V)
-			VLMQmn(m_pNode[2*VLMMATSIZE- 9], m_pNode[2*VLMMATSIZE-10], m_pNode[2*VLMMATSIZE-8], m_pNode[2*VLMMATSIZE-7], Point, V);
+			VLMQmn(Node[1], Node[0], Node[2], Node[3], Point, V);
 			strOut.Format("%12.7f       %12.7f       %12.7f       %12.7f\n", Point.z, V.x, V.y, V.z);
 			XFile.WriteString(strOut);
 			Point += Inc;
 		}
 
+		CPanel::s_pNode = pMemPanelNode;
 		XFile.Close();
 	}
 }
@@ -1986,11 +2232,14 @@ void CVLMDlg::VLMQmn(CVector const &LA, CVector const &LB, CVector const &TA, CV
 	// V is the resulting speed
 	//
 	// Vectorial operations are written explicitly to save computing times (4x more efficient)
+	// All temporaries are local, so that the function may run concurrently in several threads
 	//
 	double CoreSize = 0.00000;
 	if(abs(*m_pCoreSize)>1.e-10) CoreSize = *m_pCoreSize;
 
 	int i;
+	double ftmp, Omega, r1v, r2v;
+	CVector R[5], r0, r1, r2, Psi, t;
 
 	V.x = 0.0;
 	V.y = 0.0;
@@ -2071,8 +2320,11 @@ void CVLMDlg::VLMCmn(CVector const &A, CVector const &B, CVector const &C, CVect
 	//
 	// Vectorial operations are written inline to save computing times
 	// -->longer code, but 4x more efficient....
+	// All temporaries are local, so that the function may run concurrently in several threads
 	double CoreSize = 0.000000;
 	if(abs(*m_pCoreSize)>1.e-10) CoreSize = *m_pCoreSize;
+	double ftmp, Omega;
+	CVector r0, r1, r2, Psi, t, h, Far;
 
 	if(!m_pWing) return;
 
@@ -25,6 +25,8 @@
 
 #include "VLMThread.h"
 #include "Plane.h"
+#include "FactorCache.h"
+#include "FarField.h"
 
 /////////////////////////////////////////////////////////////////////////////
 // CVLMDlg dialog
@@ -41,6 +43,7 @@ class CVLMDlg : public CDialog
 // Construction
 public:
 	CVLMDlg(CWnd* pParent = NULL);   // standard constructor
+	~CVLMDlg();
 
 // Dialog Data
 	//{{AFX_DATA(CVLMDlg)
@@ -68,14 +71,18 @@ public:
 	DECLARE_MESSAGE_MAP()
 
 	CVector GetSpeedVector(CVector C, double *Gamma);
+	bool BuildFarField(double *Gamma);
+	void ReleaseFarField();
 	void AddString(CString strong);
 	void SetFileHeader();
 	void EndSequence();
+	void ReleaseArrays();
 
 	bool VLMCreateRHS(double V0);
 	bool VLMCreateMatrix();
 	bool VLMSolveDouble();
 	bool VLMSolveMultiple(double V0, double VDelta, int nval);
+	unsigned __int64 GetGeometryKey();
 
 	double VLMComputeCm(double alpha, bool bTrace=false);
 	void CVLMDlg::pgmat(double const &mach, double const &alfa, double const &beta, double pg[3][3]);
@@ -88,8 +95,12 @@ public:
 	void VLMQmn(CVector const &LA, CVector const &LB, CVector const &TA, CVector const &TB, CVector const &C, CVector &V);
 	void ResetWakeNodes();
 	void RelaxWake();
+	void RelaxWakeSide(int kw);
 	bool Gauss(double *A, int n, double *B, int m);
 
+	static void FarFieldNearProc(int iElement, CVector const &C, CVector &V, void *pParam);
+	static void WakeSideTask(int kw, int iWorker, void *pParam);
+
 	void Plot();
 protected:
 	CWnd* m_pMiarex;
@@ -114,14 +125,17 @@ protected:
 	int m_nWakeNodes;
 	int m_WakeSize;// Max Size for the VLMMatrix
 	int m_NWakeColumn;
+	int m_nWorkers;		// the number of threads used to relax the wake, 0 for one per processor
 
 	double pi;
 	double *m_RHS;
 	double *m_aij;
 	double *m_Gamma;
-	double m_xRHS[VLMMATSIZE], m_yRHS[VLMMATSIZE], m_zRHS[VLMMATSIZE];
-	double m_Cp[VLMMATSIZE];//lift coef per panel
-	double m_VLMQInf[100];
+	// the per-panel arrays, sized to m_MatSize for the duration of the analysis
+	double *m_xRHS, *m_yRHS, *m_zRHS;
+	int *m_ipiv;		// the row interchanges of the LU factorization
+	double *m_Cp;//lift coef per panel
+	double m_VLMQInf[RHSBLOCK];
 	double m_OpAlpha, m_Ctrl;
 	double m_QInf, m_QInfMax, m_DeltaQInf;
 	double m_Control, m_ControlMax, m_DeltaControl;
@@ -132,6 +146,13 @@ protected:
 	double Omega;
 	double ftmp;
 	double *m_pCoreSize;
+	double *m_pFarFieldTheta;	// the opening ratio of the octree, 0 for the exact summation
+
+	// the octree of the vortex rings, built for the strengths m_pFFGamma
+	// the trailing panels and their wake are always summed exactly
+	CFarField m_FarField;
+	double *m_pFFGamma;
+	int *m_FFPanel;		// the panel index of each element of the octree
 
 	double m_VCm,m_VYm; //Viscous moments
 	double m_IYm;		// Induced Yawing Moment
@@ -165,6 +186,10 @@ protected:
 	CWing *m_pFin;
 	CWPolar *m_pWPolar;
 
+	CFactorCache *m_pFactorCache;	// the cache of factorized matrices, shared with the 3D panel dialog
+	CFactorEntry *m_pFactors;		// the cached factorization for the current geometry, or NULL
+	unsigned __int64 m_GeomKey;		// the hash of the geometry used to build the current matrix
+
 	CVector AA, BB, AA1, BB1, AAG, BBG, V, VT, VS, CG, VG, D;
 	CVector Far;
 	CVector r0, r1, r2;
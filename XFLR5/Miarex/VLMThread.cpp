@@ -110,18 +110,13 @@ bool CVLMThread::AlphaLoop()
 {
 	CString str;
 	CVLMDlg * pVLMDlg = (CVLMDlg*)m_pParent;
-	int nrhs;
+	int nrhs, q0, nBlock;
+	double Alpha;
 
 	if(m_AlphaMax<m_Alpha) m_DeltaAlpha = -abs(m_DeltaAlpha);
 	nrhs  = (int)abs((m_AlphaMax-m_Alpha)*1.0001/m_DeltaAlpha) + 1;
 
 	if(!m_bSequence) nrhs = 1;
-	else if(nrhs>=100)
-	{
-		int res = AfxMessageBox("The number of points to be calculated will be limited to 100", MB_OKCANCEL);
-		if(res ==IDCANCEL) return false;
-		nrhs = 100;
-	}
 	pVLMDlg->m_bTrace = true;
 	CWaitCursor Wait;
 	str.Format("   Solving the problem... \r\n\r\n");
@@ -150,13 +145,22 @@ bool CVLMThread::AlphaLoop()
 		pVLMDlg->m_bWarning = true;
 		return true;
 	}
-	pVLMDlg->VLMSolveMultiple(m_Alpha, m_DeltaAlpha, nrhs);	
 
-	if (m_bCancel) return true;
+	// The points are processed by blocks of RHSBLOCK angles,
+	// all reconstructed from the unit cosine and sine solutions
+	for(q0=0; q0<nrhs; q0+=RHSBLOCK)
+	{
+		nBlock = min(nrhs-q0, RHSBLOCK);
+		Alpha  = m_Alpha + q0*m_DeltaAlpha;
+
+		pVLMDlg->VLMSolveMultiple(Alpha, m_DeltaAlpha, nBlock);	
+
+		if (m_bCancel) return true;
+			
+		pVLMDlg->VLMComputePlane(Alpha, m_DeltaAlpha, nBlock);
 		
-	pVLMDlg->VLMComputePlane(m_Alpha, m_DeltaAlpha, nrhs);
-	
-	if (m_bCancel) return true;
+		if (m_bCancel) return true;
+	}
 
 	return true;
 }
@@ -179,10 +183,6 @@ bool CVLMThread::UnitLoop()
 
 
 	if(!m_bSequence) nrhs = 1;
-	else if(nrhs>=100){
-		AfxMessageBox("The number of points to be calculated will be limited to 100", MB_OK);
-		nrhs = 100;
-	}
 
 	pVLMDlg->m_bTrace = true;
 	pVLMDlg->m_Alpha = 0.0;
@@ -242,7 +242,7 @@ bool CVLMThread::ReLoop()
 {
 	CWaitCursor Wait;
 	CString str;
-	int nrhs;
+	int nrhs, q0, nBlock;
 	double QInf  = 0.0;
 	double Alpha = 0.0;
 
@@ -253,12 +253,6 @@ bool CVLMThread::ReLoop()
 	nrhs  = (int)abs((m_QInfMax-m_QInf)*1.0001/m_DeltaQInf) + 1;
 
 	if(!m_bSequence) nrhs = 1;
-	else if(nrhs>=100)
-	{
-		int res = AfxMessageBox("The number of points to be calculated will be limited to 100", MB_OKCANCEL);
-		if(res ==IDCANCEL) return false;
-		nrhs = 100;
-	}
 	pVLMDlg->m_bTrace = true;
 
 	if(m_pWPolar->m_bTiltedGeom)
@@ -298,10 +292,18 @@ bool CVLMThread::ReLoop()
 		pVLMDlg->m_bWarning = true;
 		return true;
 	}
-	pVLMDlg->VLMSolveMultiple(m_QInf, m_DeltaQInf, nrhs);
 
-//then compute all points
-	pVLMDlg->VLMComputePlane(m_QInf, m_DeltaQInf, nrhs);
+//then compute all points, by blocks of RHSBLOCK speeds
+	for(q0=0; q0<nrhs; q0+=RHSBLOCK)
+	{
+		nBlock = min(nrhs-q0, RHSBLOCK);
+		QInf   = m_QInf + q0*m_DeltaQInf;
+
+		pVLMDlg->VLMSolveMultiple(QInf, m_DeltaQInf, nBlock);
+		pVLMDlg->VLMComputePlane(QInf, m_DeltaQInf, nBlock);
+
+		if (m_bCancel) return true;
+	}
 
 	return true;
 }
@@ -330,11 +332,6 @@ bool CVLMThread::ControlLoop()
 	nrhs  = (int)abs((m_ControlMax-m_Control)*1.0001/m_DeltaControl) + 1;
 
 	if(!m_bSequence) nrhs = 1;
-	else if(nrhs>=100)
-	{
-		AfxMessageBox("The number of points to be calculated will be limited to 100", MB_OK);
-		nrhs = 100;
-	}
 
 //	Loop for each control value
 //     Update the geometry, design variables
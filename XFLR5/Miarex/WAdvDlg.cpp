@@ -25,6 +25,7 @@
 #include "stdafx.h"
 #include "../X-FLR5.h"
 #include "../main/MainFrm.h"
+#include "Miarex.h"
 #include "WAdvDlg.h"
 #include ".\wadvdlg.h"
 
@@ -47,18 +48,21 @@ CWAdvDlg::CWAdvDlg(CWnd* pParent /*=NULL*/)
 
 	m_MaxWakeIter     = 1;
 	m_CoreSize        = 0.0;
+	m_FarFieldTheta   = 0.0;
 	m_WakeInterNodes  = 6;
 	m_MinPanelSize    = 1.0;
 
 	m_InducedDragPoint = 0;
 
 	m_bResetWake      = true;
+	m_bAnderson       = true;
 	m_bDirichlet      = true;
 	m_BLogFile        = true;
 	m_bKeepOutOpps    = true;
 
 
 	m_pFrame  = NULL;
+	m_pMiarex = NULL;
 	m_ControlPos = 0.75;
 	m_VortexPos  = 0.25;
 }
@@ -76,7 +80,9 @@ void CWAdvDlg::DoDataExchange(CDataExchange* pDX)
 	DDX_Control(pDX, IDC_ITERMAX, m_ctrlIterMax);
 	DDX_Control(pDX, IDC_MAXWAKEITER, m_ctrlMaxWakeIter);
 	DDX_Control(pDX, IDC_CORESIZE, m_ctrlCoreSize);
+	DDX_Control(pDX, IDC_FARFIELDTHETA, m_ctrlFarFieldTheta);
 	DDX_Control(pDX, IDC_KEEPOUTOPPS, m_ctrlKeepOutOpps);
+	DDX_Control(pDX, IDC_ANDERSON, m_ctrlAnderson);
 	DDX_Control(pDX, IDC_ASTAT2, m_ctrlAStat);
 	DDX_Control(pDX, IDC_MINPANELSIZE, m_ctrlMinPanelSize);
 	DDX_Control(pDX, IDC_RESETWAKE, m_ctrlResetWake);
@@ -95,6 +101,8 @@ BEGIN_MESSAGE_MAP(CWAdvDlg, CDialog)
 	ON_WM_CLOSE()
 	ON_BN_CLICKED(IDC_KEEPOUTOPPS, OnKeepOutOpps)
 	ON_BN_CLICKED(IDC_RESETWAKE, OnResetWake)
+	ON_BN_CLICKED(IDC_ANDERSON, OnAnderson)
+	ON_BN_CLICKED(IDC_SOLVERBENCH, OnSolverBenchmark)
 	ON_BN_CLICKED(IDC_RESET, OnResetDefaults)
 	ON_BN_CLICKED(IDC_RADIO1, OnRadio1)
 	ON_BN_CLICKED(IDC_RADIO2, OnRadio1)
@@ -131,6 +139,10 @@ BOOL CWAdvDlg::OnInitDialog()
 	m_ctrlCoreSize.SetMax(1.0);
 	m_ctrlCoreSize.SetPrecision(3);
 
+	m_ctrlFarFieldTheta.SetMin(0.0);
+	m_ctrlFarFieldTheta.SetMax(1.0);
+	m_ctrlFarFieldTheta.SetPrecision(2);
+
 	CString len;
 	CMainFrame *pFrame = (CMainFrame*)m_pFrame;
 	GetLengthUnit(len,pFrame->m_LengthUnit);
@@ -170,6 +182,7 @@ void CWAdvDlg::ReadParams()
 	if(m_NStation>MAXSTATIONS) m_NStation=MAXSTATIONS;
 
 	m_CoreSize        = m_ctrlCoreSize.GetValue()/ pFrame->m_mtoUnit;
+	m_FarFieldTheta   = m_ctrlFarFieldTheta.GetValue();
 	m_MaxWakeIter     = m_ctrlMaxWakeIter.GetValue();
 	m_WakeInterNodes  = m_ctrlInterNodes.GetValue();
 
@@ -189,6 +202,7 @@ void CWAdvDlg::SetParams()
 	m_ctrlNStation.SetValue(m_NStation);
 
 	m_ctrlCoreSize.SetValue(m_CoreSize* pFrame->m_mtoUnit);
+	m_ctrlFarFieldTheta.SetValue(m_FarFieldTheta);
 	m_ctrlMaxWakeIter.SetValue(m_MaxWakeIter);
 	m_ctrlInterNodes.SetValue(m_WakeInterNodes);
 
@@ -197,6 +211,9 @@ void CWAdvDlg::SetParams()
 	if(m_bResetWake)	m_ctrlResetWake.SetCheck(TRUE);
 	else				m_ctrlResetWake.SetCheck(FALSE);
 
+	if(m_bAnderson)		m_ctrlAnderson.SetCheck(TRUE);
+	else				m_ctrlAnderson.SetCheck(FALSE);
+
 	if(m_BLogFile)		m_ctrlLogFile.SetCheck(TRUE);
 	else				m_ctrlLogFile.SetCheck(FALSE);
 
@@ -224,6 +241,22 @@ void CWAdvDlg::OnResetWake()
 	else                           m_bResetWake = false;
 }
 
+void CWAdvDlg::OnAnderson() 
+{
+	if(m_ctrlAnderson.GetCheck()) m_bAnderson = true;
+	else                          m_bAnderson = false;
+}
+
+void CWAdvDlg::OnSolverBenchmark() 
+{
+	// times the Gauss elimination against the blocked LU factorization of the panel method
+	CMiarex *pMiarex = (CMiarex*)m_pMiarex;
+	CString strong;
+	CWaitCursor Wait;
+	if(pMiarex->m_PanelDlg.SolverBenchmark(strong))
+		AfxMessageBox(strong, MB_OK);
+}
+
 void CWAdvDlg::OnResetDefaults() 
 {
 	m_Relax           = 20.0;
@@ -232,12 +265,14 @@ void CWAdvDlg::OnResetDefaults()
 	m_NStation        = 20;
 	m_MaxWakeIter     = 5;
 	m_CoreSize        = 0.00001;
+	m_FarFieldTheta   = 0.0;
 	m_WakeInterNodes  = 6;
 	m_BLogFile        = TRUE;
 	m_VortexPos       = 0.25;
 	m_ControlPos      = 0.75;
 	m_bDirichlet      = true;
 	m_bResetWake      = true;
+	m_bAnderson       = true;
 	m_bTrefftz        = true;
 	m_bKeepOutOpps    = false;
 	SetParams();
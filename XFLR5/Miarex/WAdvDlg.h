@@ -44,6 +44,7 @@ public:
 	CButton m_ctrlOK;
 	CButton m_ctrlResetWake;
 	CButton	m_ctrlKeepOutOpps;
+	CButton	m_ctrlAnderson;
 	CNumEdit	m_ctrlInterNodes;
 	CFloatEdit	m_ctrlRelax;
 	CFloatEdit	m_ctrlAlphaPrec;
@@ -52,6 +53,7 @@ public:
 	CNumEdit	m_ctrlIterMax;
 	CNumEdit    m_ctrlMaxWakeIter;
 	CFloatEdit m_ctrlCoreSize;
+	CFloatEdit m_ctrlFarFieldTheta;
 	CFloatEdit m_ctrlVortexPos;
 	CFloatEdit m_ctrlControlPos;
 	CStatic	m_ctrlAStat;
@@ -76,6 +78,7 @@ protected:
 	bool m_bTrefftz;
 	bool m_bKeepOutOpps;
 	bool m_bResetWake;
+	bool m_bAnderson;
 
 	int m_Iter;
 	int m_NStation;
@@ -86,6 +89,7 @@ protected:
 	double m_ControlPos, m_VortexPos;
 	double m_Relax, m_AlphaPrec;
 	double m_CoreSize;
+	double m_FarFieldTheta;
 	double m_MinPanelSize;
 	CFont m_SymbolFont;
 
@@ -93,6 +97,7 @@ protected:
 	void SetParams();
 
 	CWnd* m_pFrame;
+	CWnd* m_pMiarex;
 
 	// Generated message map functions
 
@@ -101,6 +106,8 @@ protected:
 	afx_msg void OnClose();
 	afx_msg void OnKeepOutOpps();
 	afx_msg void OnResetWake();
+	afx_msg void OnAnderson();
+	afx_msg void OnSolverBenchmark();
 	afx_msg void OnRadio1();
 	afx_msg void OnRadio3();
 	afx_msg void OnResetDefaults();
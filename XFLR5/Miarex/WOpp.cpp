@@ -76,45 +76,173 @@ CWOpp::CWOpp()
 	m_YCP                 = 0.0;
 	m_Ctrl                = 0.0;
 
-	memset(m_Ai,0,sizeof(m_Ai));
-	memset(m_Twist,0,sizeof(m_Twist));
-	memset(m_Cl,0,sizeof(m_Cl));
-	memset(m_PCd,0,sizeof(m_PCd));
-	memset(m_ICd,0,sizeof(m_ICd));
-	memset(m_Cm,0,sizeof(m_Cm));
-	memset(m_CmAirf,0,sizeof(m_CmAirf));
-	memset(m_CmXRef,0,sizeof(m_CmXRef));
-	memset(m_XCPSpanRel,0,sizeof(m_XCPSpanRel));
-	memset(m_XCPSpanAbs,0,sizeof(m_XCPSpanAbs));
-	memset(m_Chord,0,sizeof(m_Chord));
-	memset(m_SpanPos,0,sizeof(m_SpanPos));
-	memset(m_StripArea,0,sizeof(m_StripArea));
-	memset(m_Re,0,sizeof(m_Re));
-	memset(m_Twist,0,sizeof(m_Twist));
-	memset(m_XTrTop,0,sizeof(m_XTrTop));
-	memset(m_XTrBot,0,sizeof(m_XTrBot));
-	memset(m_BendingMoment,0,sizeof(m_BendingMoment));
-	memset(m_Cp,0,sizeof(m_Cp));
-	memset(m_Vd,0,sizeof(m_Vd));
-	memset(m_F,0,sizeof(m_F));
-	memset(m_G,0,sizeof(m_G));
-	memset(m_Sigma,0,sizeof(m_Sigma));
 	memset(m_FlapMoment,0,sizeof(m_FlapMoment));
+
+	m_Chord         = NULL;
+	m_SpanPos       = NULL;
+	m_StripArea     = NULL;
+	m_Twist         = NULL;
+	m_Re            = NULL;
+	m_Ai            = NULL;
+	m_Cl            = NULL;
+	m_PCd           = NULL;
+	m_ICd           = NULL;
+	m_Cm            = NULL;
+	m_CmAirf        = NULL;
+	m_CmXRef        = NULL;
+	m_XCPSpanRel    = NULL;
+	m_XCPSpanAbs    = NULL;
+	m_XTrTop        = NULL;
+	m_XTrBot        = NULL;
+	m_BendingMoment = NULL;
+	m_F             = NULL;
+	m_Vd            = NULL;
+	AllocateStations(0);
+
+	m_Cp    = NULL;
+	m_G     = NULL;
+	m_Sigma = NULL;
+	m_bOwnsPanelResults = true;
 }
 
 CWOpp::~CWOpp()
 {
+	ReleaseStations();
+	ReleasePanelResults();
+}
 
+
+static double* NewStationArray(int NStation)
+{
+	double *pArray = new double[NStation+1];
+	memset(pArray, 0, (NStation+1)*sizeof(double));
+	return pArray;
 }
 
-bool CWOpp::SerializeWOpp(CArchive &ar)
+
+void CWOpp::AllocateStations(int NStation)
+{
+	// sizes the station arrays to the number of stations of the analysis
+	// the span positions are stored at the NStation+1 strip boundaries
+	ReleaseStations();
+
+	m_NStation      = NStation;
+	m_Chord         = NewStationArray(NStation);
+	m_SpanPos       = NewStationArray(NStation);
+	m_StripArea     = NewStationArray(NStation);
+	m_Twist         = NewStationArray(NStation);
+	m_Re            = NewStationArray(NStation);
+	m_Ai            = NewStationArray(NStation);
+	m_Cl            = NewStationArray(NStation);
+	m_PCd           = NewStationArray(NStation);
+	m_ICd           = NewStationArray(NStation);
+	m_Cm            = NewStationArray(NStation);
+	m_CmAirf        = NewStationArray(NStation);
+	m_CmXRef        = NewStationArray(NStation);
+	m_XCPSpanRel    = NewStationArray(NStation);
+	m_XCPSpanAbs    = NewStationArray(NStation);
+	m_XTrTop        = NewStationArray(NStation);
+	m_XTrBot        = NewStationArray(NStation);
+	m_BendingMoment = NewStationArray(NStation);
+	m_F             = new CVector[NStation+1];
+	m_Vd            = new CVector[NStation+1];
+}
+
+
+void CWOpp::ReleaseStations()
+{
+	if(m_Chord)         delete [] m_Chord;
+	if(m_SpanPos)       delete [] m_SpanPos;
+	if(m_StripArea)     delete [] m_StripArea;
+	if(m_Twist)         delete [] m_Twist;
+	if(m_Re)            delete [] m_Re;
+	if(m_Ai)            delete [] m_Ai;
+	if(m_Cl)            delete [] m_Cl;
+	if(m_PCd)           delete [] m_PCd;
+	if(m_ICd)           delete [] m_ICd;
+	if(m_Cm)            delete [] m_Cm;
+	if(m_CmAirf)        delete [] m_CmAirf;
+	if(m_CmXRef)        delete [] m_CmXRef;
+	if(m_XCPSpanRel)    delete [] m_XCPSpanRel;
+	if(m_XCPSpanAbs)    delete [] m_XCPSpanAbs;
+	if(m_XTrTop)        delete [] m_XTrTop;
+	if(m_XTrBot)        delete [] m_XTrBot;
+	if(m_BendingMoment) delete [] m_BendingMoment;
+	if(m_F)             delete [] m_F;
+	if(m_Vd)            delete [] m_Vd;
+
+	m_Chord = m_SpanPos = m_StripArea = m_Twist = m_Re = m_Ai = m_Cl = NULL;
+	m_PCd = m_ICd = m_Cm = m_CmAirf = m_CmXRef = m_XCPSpanRel = m_XCPSpanAbs = NULL;
+	m_XTrTop = m_XTrBot = m_BendingMoment = NULL;
+	m_F  = NULL;
+	m_Vd = NULL;
+}
+
+
+void CWOpp::AllocatePanelResults(int nPanels)
 {
+	// sizes the panel result arrays to the number of panels of the analysis
+	ReleasePanelResults();
+
+	m_NVLMPanels = nPanels;
+	m_Cp    = new float[nPanels+1];
+	m_G     = new float[nPanels+1];
+	m_Sigma = new float[nPanels+1];
+	memset(m_Cp,    0, (nPanels+1)*sizeof(float));
+	memset(m_G,     0, (nPanels+1)*sizeof(float));
+	memset(m_Sigma, 0, (nPanels+1)*sizeof(float));
+	m_bOwnsPanelResults = true;
+}
+
+
+void CWOpp::AttachPanelResults(float *Cp)
+{
+	// the wings of a plane share the Cp array of their CPOpp,
+	// which also holds the plane's vortex and source strengths
+	ReleasePanelResults();
+	m_Cp = Cp;
+	m_bOwnsPanelResults = false;
+}
+
+
+void CWOpp::ReleasePanelResults()
+{
+	if(m_bOwnsPanelResults)
+	{
+		if(m_Cp)    delete [] m_Cp;
+		if(m_G)     delete [] m_G;
+		if(m_Sigma) delete [] m_Sigma;
+	}
+	m_Cp    = NULL;
+	m_G     = NULL;
+	m_Sigma = NULL;
+	m_bOwnsPanelResults = true;
+}
+
+
+void CWOpp::GetStrengths(double *Mu, double *Sigma)
+{
+	// expands the stored strengths for the velocity calculations
+	int p;
+	for(p=0; p<m_NVLMPanels; p++)
+	{
+		Mu[p]    = m_G     ? m_G[p]     : 0.0;
+		Sigma[p] = m_Sigma ? m_Sigma[p] : 0.0;
+	}
+}
+
+bool CWOpp::SerializeWOpp(CArchive &ar, bool bPanelResults)
+{
+	// bPanelResults is false for the wings of a plane, 
+	// whose panel results are serialized by the parent CPOpp
 	int ArchiveFormat;
 	int a,p,k;
 	float f, f1, f2;
+	bool bReadPanels;
 
 	if(ar.IsStoring()){
-		ar << 1015;
+		ar << 1016;
+		//1016 : panel results of a plane's wings are held by the CPOpp only
 		//1015 : added M_CX and m_CY values
 		//1014 : redefined moment coefficients
 		//1013 : added m_bTiltedGeom
@@ -165,11 +293,14 @@ bool CWOpp::SerializeWOpp(CArchive &ar)
 		}
 		for (k=0; k<=m_NStation; k++) ar << (float)m_SpanPos[k] << (float)m_StripArea[k];
 		ar << m_NVLMPanels;
-		for (p=0; p<m_NVLMPanels;p++)	ar << (float)m_Cp[p] ;
-		for (p=0; p<m_NVLMPanels;p++)	ar << (float)m_G[p] ;
-		if(m_AnalysisType==3)
+		if(bPanelResults)
 		{
-			for (p=0; p<m_NVLMPanels;p++)	ar << (float)m_Sigma[p] ;
+			for (p=0; p<m_NVLMPanels;p++)	ar << m_Cp[p] ;
+			for (p=0; p<m_NVLMPanels;p++)	ar << m_G[p] ;
+			if(m_AnalysisType==3)
+			{
+				for (p=0; p<m_NVLMPanels;p++)	ar << m_Sigma[p] ;
+			}
 		}
 
 		ar << m_WingType;
@@ -255,7 +386,14 @@ bool CWOpp::SerializeWOpp(CArchive &ar)
 			}
 
 			ar >> m_Style >> m_Width >> m_Color;
-			ar >> m_Type >> m_NStation;
+			ar >> m_Type >> k;
+			if (k<0)
+			{
+				CArchiveException *pfe = new CArchiveException(CArchiveException::badIndex);
+				pfe->m_strFileName = ar.m_strFileName;
+				throw pfe;
+			}
+			AllocateStations(k);
 			ar >> f; m_Alpha =f;
 			ar >> f; m_QInf =f;
 			ar >> f; m_Weight =f;
@@ -345,29 +483,45 @@ bool CWOpp::SerializeWOpp(CArchive &ar)
 				else m_StripArea[k] = 0.0;
 
 			}
+			// older formats hold the panel results of a plane's wings, which are skipped
+			bReadPanels = bPanelResults || ArchiveFormat<1016;
 			if(ArchiveFormat>=1003)
 			{
-				ar>> m_NVLMPanels;
-				for (p=0; p<m_NVLMPanels;p++)
+				ar>> k;
+				if(bPanelResults) AllocatePanelResults(k);
+				else
 				{
-					ar >> f; m_Cp[p] =f;
-
+					ReleasePanelResults();
+					m_NVLMPanels = k;
+				}
+				if(bReadPanels)
+				{
+					for (p=0; p<m_NVLMPanels;p++)
+					{
+						ar >> f; 
+						if(m_Cp) m_Cp[p] =f;
+					}
 				}
 			}
-			if(ArchiveFormat>=1009)
+			if(ArchiveFormat>=1009 && bReadPanels)
 			{
 				for (p=0; p<m_NVLMPanels;p++)
 				{
-					ar >> f; m_G[p] =f;
-					if(ArchiveFormat<1010) m_G[p] =  f/1000.0;
+					ar >> f; 
+					if(m_G)
+					{
+						if(ArchiveFormat<1010) m_G[p] = f/1000.0f;
+						else                   m_G[p] = f;
+					}
 				}
 			}
-			if(ArchiveFormat>1010)
+			if(ArchiveFormat>1010 && bReadPanels)
 			{
 				if(m_AnalysisType==3){	
 					for (p=0; p<m_NVLMPanels;p++)
 					{
-						ar >> f; m_Sigma[p] = f;
+						ar >> f; 
+						if(m_Sigma) m_Sigma[p] = f;
 					}
 				}
 			}
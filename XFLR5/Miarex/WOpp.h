@@ -74,28 +74,32 @@ private:
 	double m_Weight;
 	double m_Span;
 	double m_MAChord;
-	double m_Chord[MAXSTATIONS+1];		// chord at stations
-	double m_SpanPos[MAXSTATIONS+1];	// station spanwise positions
-	double m_StripArea[MAXSTATIONS+1];	
-	double m_Twist[MAXSTATIONS+1];		// twist at span stations
+	// station arrays, sized to m_NStation+1
+	double *m_Chord;		// chord at stations
+	double *m_SpanPos;		// station spanwise positions
+	double *m_StripArea;	
+	double *m_Twist;		// twist at span stations
 
 	//RESULTS
-	double m_Re[MAXSTATIONS+1];		// Reynolds number at stations
-	double m_Ai[MAXSTATIONS+1];		//Induced angles, in degrees
-	double m_Cl[MAXSTATIONS+1];		//Lift coefficient at stations
-	double m_PCd[MAXSTATIONS+1];		//Drag coefficient at stations
-	double m_ICd[MAXSTATIONS+1];		//Drag coefficient at stations
-	double m_Cm[MAXSTATIONS+1];		//Pitching moment coefficient at stations
-	double m_CmAirf[MAXSTATIONS+1];		//Pitching moment coefficient at stations
-	double m_CmXRef[MAXSTATIONS+1];		//Pitching moment coefficient at stations
-	double m_XCPSpanRel[MAXSTATIONS+1];	//Centre of pressure position at stations
-	double m_XCPSpanAbs[MAXSTATIONS+1];	//Centre of pressure position at stations
-	double m_XTrTop[MAXSTATIONS+1];		// Transition location - top
-	double m_XTrBot[MAXSTATIONS+1];		// Transition location - bottom
-	double m_BendingMoment[MAXSTATIONS+1];
-	double m_Cp[VLMMATSIZE];		// lift coeffs for each panel
-	double m_G[VLMMATSIZE];			// vortice or doublet strengths
-	double m_Sigma[VLMMATSIZE];		// source strengths
+	double *m_Re;			// Reynolds number at stations
+	double *m_Ai;			//Induced angles, in degrees
+	double *m_Cl;			//Lift coefficient at stations
+	double *m_PCd;			//Drag coefficient at stations
+	double *m_ICd;			//Drag coefficient at stations
+	double *m_Cm;			//Pitching moment coefficient at stations
+	double *m_CmAirf;		//Pitching moment coefficient at stations
+	double *m_CmXRef;		//Pitching moment coefficient at stations
+	double *m_XCPSpanRel;		//Centre of pressure position at stations
+	double *m_XCPSpanAbs;		//Centre of pressure position at stations
+	double *m_XTrTop;		// Transition location - top
+	double *m_XTrBot;		// Transition location - bottom
+	double *m_BendingMoment;
+
+	// panel arrays, sized to m_NVLMPanels, stored in single precision as in the project file
+	float *m_Cp;			// lift coeffs for each panel
+	float *m_G;			// vortice or doublet strengths, NULL for the wings of a plane
+	float *m_Sigma;			// source strengths, NULL for the wings of a plane
+	bool m_bOwnsPanelResults;	// false if m_Cp is a slice of the parent CPOpp's array
 	double m_FlapMoment[20]; 		// flap hinge moments
 
 	double m_CL;				// Wing lift coefficient
@@ -110,11 +114,17 @@ private:
 	double m_MaxBending;		// max bending moment along the span
 	double m_XCP, m_YCP;		// centre of pressure position relative to the wing's XCref
 
-	CVector m_F[MAXSTATIONS];		// Stripforce
-	CVector m_Vd[MAXSTATIONS];		// speed deflection at trailing edge
+	CVector *m_F;		// Stripforce
+	CVector *m_Vd;		// speed deflection at trailing edge
 
 //________________METHODS____________________________________
-	bool SerializeWOpp(CArchive &ar);
+	bool SerializeWOpp(CArchive &ar, bool bPanelResults=true);
+	void AllocateStations(int NStation);
+	void AllocatePanelResults(int nPanels);
+	void AttachPanelResults(float *Cp);
+	void ReleaseStations();
+	void ReleasePanelResults();
+	void GetStrengths(double *Mu, double *Sigma);
 	bool Export(CStdioFile *pXFile, int FileType);
 	void GetBWStyle(COLORREF &color, int &style, int &width);
 	double GetMaxLift();
@@ -0,0 +1,377 @@
+/****************************************************************************
+
+    CWPolarBatchDlg Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+// WPolarBatchDlg.cpp : implementation file
+//
+
+#include "stdafx.h"
+#include "../X-FLR5.h"
+#include "../main/MainFrm.h"
+#include "Miarex.h"
+#include "WPolarBatchDlg.h"
+
+
+/////////////////////////////////////////////////////////////////////////////
+// CWPolarBatchDlg dialog
+
+
+CWPolarBatchDlg::CWPolarBatchDlg(CWnd* pParent /*=NULL*/)
+	: CDialog(CWPolarBatchDlg::IDD, pParent)
+{
+	//{{AFX_DATA_INIT(CWPolarBatchDlg)
+	//}}AFX_DATA_INIT
+	m_pMiarex = NULL;
+	m_pFrame  = NULL;
+
+	m_bRunning = false;
+
+	m_AlphaMin     =  0.0;
+	m_AlphaMax     = 10.0;
+	m_DeltaAlpha   =  1.0;
+	m_QInfMin      = 10.0;
+	m_QInfMax      = 15.0;
+	m_DeltaQInf    =  5.0;
+	m_ControlMin   =  0.0;
+	m_ControlMax   =  1.0;
+	m_DeltaControl =  0.1;
+	m_MemLimit     = 1024.0;
+}
+
+
+void CWPolarBatchDlg::DoDataExchange(CDataExchange* pDX)
+{
+	CDialog::DoDataExchange(pDX);
+	//{{AFX_DATA_MAP(CWPolarBatchDlg)
+	DDX_Control(pDX, IDC_JOBLIST, m_ctrlJobList);
+	DDX_Control(pDX, IDC_OUTPUT, m_ctrlOutput);
+	DDX_Control(pDX, IDC_ANALYSIS, m_ctrlAnalysis);
+	DDX_Control(pDX, IDCANCEL, m_ctrlClose);
+	DDX_Control(pDX, IDC_AMIN, m_ctrlAlphaMin);
+	DDX_Control(pDX, IDC_AMAX, m_ctrlAlphaMax);
+	DDX_Control(pDX, IDC_DALPHA, m_ctrlDeltaAlpha);
+	DDX_Control(pDX, IDC_QINFMIN, m_ctrlQInfMin);
+	DDX_Control(pDX, IDC_QINFMAX, m_ctrlQInfMax);
+	DDX_Control(pDX, IDC_DQINF, m_ctrlDeltaQInf);
+	DDX_Control(pDX, IDC_CTRLMIN, m_ctrlControlMin);
+	DDX_Control(pDX, IDC_CTRLMAX, m_ctrlControlMax);
+	DDX_Control(pDX, IDC_DCTRL, m_ctrlDeltaControl);
+	DDX_Control(pDX, IDC_MEMLIMIT, m_ctrlMemLimit);
+	DDX_Control(pDX, IDC_SPEEDUNIT, m_ctrlSpeedUnit);
+	//}}AFX_DATA_MAP
+}
+
+
+BEGIN_MESSAGE_MAP(CWPolarBatchDlg, CDialog)
+	//{{AFX_MSG_MAP(CWPolarBatchDlg)
+	ON_BN_CLICKED(IDC_ANALYSIS, OnAnalysis)
+	//}}AFX_MSG_MAP
+END_MESSAGE_MAP()
+
+/////////////////////////////////////////////////////////////////////////////
+// CWPolarBatchDlg message handlers
+
+BOOL CWPolarBatchDlg::OnInitDialog() 
+{
+	CDialog::OnInitDialog();
+	CMainFrame *pFrame = (CMainFrame*)m_pFrame;
+	CString str;
+
+	m_ctrlJobList.SetExtendedStyle(LVS_EX_FULLROWSELECT|LVS_EX_GRIDLINES|LVS_EX_CHECKBOXES);
+	m_ctrlJobList.InsertColumn(0,"Wing/Plane",LVCFMT_LEFT, 120);
+	m_ctrlJobList.InsertColumn(1,"Polar",LVCFMT_LEFT, 160);
+	m_ctrlJobList.InsertColumn(2,"Method",LVCFMT_LEFT, 50);
+	m_ctrlJobList.InsertColumn(3,"Type",LVCFMT_RIGHT, 40);
+	m_ctrlJobList.InsertColumn(4,"Panels",LVCFMT_RIGHT, 50);
+	m_ctrlJobList.InsertColumn(5,"Memory (MB)",LVCFMT_RIGHT, 75);
+	m_ctrlJobList.InsertColumn(6,"Status",LVCFMT_LEFT, 75);
+	FillJobList();
+
+	m_ctrlAlphaMin.SetPrecision(2);
+	m_ctrlAlphaMax.SetPrecision(2);
+	m_ctrlDeltaAlpha.SetPrecision(2);
+	m_ctrlQInfMin.SetPrecision(2);
+	m_ctrlQInfMax.SetPrecision(2);
+	m_ctrlDeltaQInf.SetPrecision(2);
+	m_ctrlControlMin.SetPrecision(3);
+	m_ctrlControlMax.SetPrecision(3);
+	m_ctrlDeltaControl.SetPrecision(3);
+	m_ctrlMemLimit.SetPrecision(0);
+	m_ctrlMemLimit.SetMin(1.0);
+
+	m_ctrlAlphaMin.SetValue(m_AlphaMin);
+	m_ctrlAlphaMax.SetValue(m_AlphaMax);
+	m_ctrlDeltaAlpha.SetValue(m_DeltaAlpha);
+	m_ctrlQInfMin.SetValue(m_QInfMin*pFrame->m_mstoUnit);
+	m_ctrlQInfMax.SetValue(m_QInfMax*pFrame->m_mstoUnit);
+	m_ctrlDeltaQInf.SetValue(m_DeltaQInf*pFrame->m_mstoUnit);
+	m_ctrlControlMin.SetValue(m_ControlMin);
+	m_ctrlControlMax.SetValue(m_ControlMax);
+	m_ctrlDeltaControl.SetValue(m_DeltaControl);
+	m_ctrlMemLimit.SetValue(m_MemLimit);
+
+	GetSpeedUnit(str, pFrame->m_SpeedUnit);
+	m_ctrlSpeedUnit.SetWindowText(str);
+
+	m_ctrlOutput.SetLimitText(100000);
+	m_ctrlAnalysis.SetFocus();
+	return FALSE;
+}
+
+
+void CWPolarBatchDlg::OnCancel() 
+{
+	// the batch is interrupted from the analysis dialogs, not from here
+	if(m_bRunning) return;
+	CDialog::OnCancel();
+}
+
+
+void CWPolarBatchDlg::FillJobList()
+{
+	// Lists the polars of the project which may be analyzed, all selected
+	CMiarex *pMiarex = (CMiarex*)m_pMiarex;
+	CWPolar *pWPolar;
+	CString str;
+	int i, n, nPanels;
+	double Mem;
+
+	m_ctrlJobList.DeleteAllItems();
+	n = 0;
+	for (i=0; i<pMiarex->m_poaWPolar->GetSize(); i++)
+	{
+		pWPolar = (CWPolar*)pMiarex->m_poaWPolar->GetAt(i);
+		if(!pMiarex->GetPlane(pWPolar->m_UFOName) && !pMiarex->GetWing(pWPolar->m_UFOName)) continue;
+
+		Mem = pMiarex->GetAnalysisMemory(pWPolar, nPanels);
+
+		m_ctrlJobList.InsertItem(n, pWPolar->m_UFOName);
+		m_ctrlJobList.SetItemText(n, 1, pWPolar->m_PlrName);
+		if(pWPolar->m_AnalysisType==1)      str = "LLT";
+		else if(pWPolar->m_AnalysisType==2) str = "VLM";
+		else                                str = "Panel";
+		m_ctrlJobList.SetItemText(n, 2, str);
+		str.Format("%d", pWPolar->m_Type);
+		m_ctrlJobList.SetItemText(n, 3, str);
+		if(pWPolar->m_AnalysisType==1) str = "-";
+		else                           str.Format("%d", nPanels);
+		m_ctrlJobList.SetItemText(n, 4, str);
+		str.Format("%.1f", Mem);
+		m_ctrlJobList.SetItemText(n, 5, str);
+		m_ctrlJobList.SetItemData(n, (DWORD_PTR)pWPolar);
+		m_ctrlJobList.SetCheck(n, TRUE);
+		n++;
+	}
+	if(!n) m_ctrlAnalysis.EnableWindow(false);
+}
+
+
+void CWPolarBatchDlg::ReadParams()
+{
+	CMainFrame *pFrame = (CMainFrame*)m_pFrame;
+
+	m_AlphaMin     = m_ctrlAlphaMin.GetValue();
+	m_AlphaMax     = m_ctrlAlphaMax.GetValue();
+	m_DeltaAlpha   = abs(m_ctrlDeltaAlpha.GetValue());
+	if(m_DeltaAlpha<0.01)
+	{
+		m_DeltaAlpha = 0.01;
+		m_ctrlDeltaAlpha.SetValue(0.01);
+	}
+
+	m_QInfMin      = m_ctrlQInfMin.GetValue()/pFrame->m_mstoUnit;
+	m_QInfMax      = m_ctrlQInfMax.GetValue()/pFrame->m_mstoUnit;
+	m_DeltaQInf    = abs(m_ctrlDeltaQInf.GetValue())/pFrame->m_mstoUnit;
+	if(m_DeltaQInf<0.1)
+	{
+		m_DeltaQInf = 1.0;
+		m_ctrlDeltaQInf.SetValue(1.0*pFrame->m_mstoUnit);
+	}
+
+	m_ControlMin   = m_ctrlControlMin.GetValue();
+	m_ControlMax   = m_ctrlControlMax.GetValue();
+	m_DeltaControl = abs(m_ctrlDeltaControl.GetValue());
+	if(m_DeltaControl<0.001)
+	{
+		m_DeltaControl = 0.001;
+		m_ctrlDeltaControl.SetValue(0.001);
+	}
+
+	m_MemLimit = max(m_ctrlMemLimit.GetValue(), 1.0);
+}
+
+
+void CWPolarBatchDlg::SetJobStatus(int iJob, CString Status)
+{
+	m_ctrlJobList.SetItemText(iJob, 6, Status);
+	m_ctrlJobList.EnsureVisible(iJob, FALSE);
+	m_ctrlJobList.UpdateWindow();
+}
+
+
+void CWPolarBatchDlg::UpdateOutput(CString strong)
+{
+	int length = m_ctrlOutput.GetWindowTextLength();
+	m_ctrlOutput.SetSel(length,length,true);
+	m_ctrlOutput.ReplaceSel(strong);
+	m_ctrlOutput.UpdateWindow();
+}
+
+
+void CWPolarBatchDlg::OnAnalysis() 
+{
+	// Schedules the selected polars, then runs their analyses one after the other
+	CMiarex *pMiarex   = (CMiarex*)m_pMiarex;
+	CMainFrame *pFrame = (CMainFrame*)m_pFrame;
+	CWPolar *pWPolar, *pWPolar0;
+	CString strong, str;
+	int i, j, k, l, n, nJobs, nPanels, res, nDone;
+	int *Job, *Rank;
+	double *Mem;
+	double V0, VMax, VDelta;
+	DWORD t0, tBatch;
+
+	ReadParams();
+
+	n = m_ctrlJobList.GetItemCount();
+	Job  = new int[n];
+	Rank = new int[n];
+	Mem  = new double[n];
+
+	// order the jobs by wing or plane, in the order of the list, then by increasing memory
+	nJobs = 0;
+	for (i=0; i<n; i++)
+	{
+		m_ctrlJobList.SetItemText(i, 6, "");
+		if(!m_ctrlJobList.GetCheck(i)) continue;
+
+		pWPolar = (CWPolar*)m_ctrlJobList.GetItemData(i);
+		for (j=0; j<i; j++)
+		{
+			pWPolar0 = (CWPolar*)m_ctrlJobList.GetItemData(j);
+			if(pWPolar0->m_UFOName==pWPolar->m_UFOName) break;
+		}
+
+		k = nJobs;
+		Job[k]  = i;
+		Rank[k] = j;
+		Mem[k]  = pMiarex->GetAnalysisMemory(pWPolar, nPanels);
+		while(k>0 && (Rank[k-1]>Rank[k] || (Rank[k-1]==Rank[k] && Mem[k-1]>Mem[k])))
+		{
+			l = Job[k];  Job[k]  = Job[k-1];  Job[k-1]  = l;
+			l = Rank[k]; Rank[k] = Rank[k-1]; Rank[k-1] = l;
+			V0 = Mem[k]; Mem[k]  = Mem[k-1];  Mem[k-1]  = V0;
+			k--;
+		}
+		nJobs++;
+	}
+
+	if(!nJobs)
+	{
+		delete [] Job;
+		delete [] Rank;
+		delete [] Mem;
+		AfxMessageBox("No analysis has been selected", MB_OK);
+		return;
+	}
+
+	for (k=0; k<nJobs; k++) SetJobStatus(Job[k], "Pending");
+
+	m_bRunning = true;
+	m_ctrlAnalysis.EnableWindow(false);
+	m_ctrlClose.EnableWindow(false);
+
+	strong.Format("Running %d analyses...\r\n", nJobs);
+	UpdateOutput(strong);
+
+	nDone  = 0;
+	tBatch = GetTickCount();
+	for (k=0; k<nJobs; k++)
+	{
+		pWPolar = (CWPolar*)m_ctrlJobList.GetItemData(Job[k]);
+		strong  = pWPolar->m_UFOName + " / " + pWPolar->m_PlrName;
+
+		if(Mem[k]>m_MemLimit)
+		{
+			SetJobStatus(Job[k], "Skipped");
+			str.Format(" : skipped, %.0f MB are required\r\n", Mem[k]);
+			UpdateOutput(strong + str);
+			continue;
+		}
+
+		if(pWPolar->m_Type==4)
+		{
+			V0     = m_QInfMin;
+			VMax   = m_QInfMax;
+			VDelta = m_DeltaQInf;
+		}
+		else if(pWPolar->m_Type==5 || pWPolar->m_Type==6)
+		{
+			V0     = m_ControlMin;
+			VMax   = m_ControlMax;
+			VDelta = m_DeltaControl;
+		}
+		else
+		{
+			V0     = m_AlphaMin;
+			VMax   = m_AlphaMax;
+			VDelta = m_DeltaAlpha;
+		}
+
+		SetJobStatus(Job[k], "Running");
+		t0 = GetTickCount();
+		res = pMiarex->BatchAnalyze(pWPolar, V0, VMax, VDelta, str);
+
+		if(res<0)
+		{
+			SetJobStatus(Job[k], "Cancelled");
+			UpdateOutput(strong + " : cancelled\r\n");
+			break;
+		}
+		else if(res==0)
+		{
+			SetJobStatus(Job[k], "Skipped");
+			UpdateOutput(strong + " : skipped, " + str + "\r\n");
+			continue;
+		}
+
+		// the operating points have been stored in the polar by the analysis
+		pFrame->SetSaveState(false);
+		nDone++;
+		SetJobStatus(Job[k], "Done");
+		strong += " : done";
+		if(str.GetLength()) strong += ", " + str;
+		str.Format(", %d s, %d points in the polar\r\n", (GetTickCount()-t0)/1000, pWPolar->m_Alpha.GetSize());
+		UpdateOutput(strong + str);
+	}
+
+	strong.Format("%d of %d analyses completed in %d s\r\n\r\n", nDone, nJobs, (GetTickCount()-tBatch)/1000);
+	UpdateOutput(strong);
+
+	m_bRunning = false;
+	m_ctrlAnalysis.EnableWindow(true);
+	m_ctrlClose.EnableWindow(true);
+	m_ctrlClose.SetFocus();
+
+	delete [] Job;
+	delete [] Rank;
+	delete [] Mem;
+}
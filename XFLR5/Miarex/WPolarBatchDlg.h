@@ -0,0 +1,100 @@
+/****************************************************************************
+
+    CWPolarBatchDlg Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+#pragma once
+
+// WPolarBatchDlg.h : header file
+//
+#include "WPolar.h"
+#include "../misc/FloatEdit.h"
+
+/////////////////////////////////////////////////////////////////////////////
+// CWPolarBatchDlg dialog
+
+// Runs the analyses of a list of wing and plane polars of the project, one after the other,
+// without user interaction between the analyses.
+// Each analysis is run by CMiarex::BatchAnalyze with the usual analysis dialogs, which close
+// when the sequence is finished, so that the operating points are stored as each analysis completes.
+// The jobs are ordered by wing or plane, so that the geometry is built once for all its polars,
+// and by increasing memory estimate, so that the smallest analyses are done first
+// Jobs whose memory estimate exceeds the user's limit are skipped.
+
+class CWPolarBatchDlg : public CDialog
+{
+	friend class CMiarex;
+// Construction
+public:
+	CWPolarBatchDlg(CWnd* pParent = NULL);   // standard constructor
+
+// Dialog Data
+	//{{AFX_DATA(CWPolarBatchDlg)
+	enum { IDD = IDD_WPOLARBATCHDLG };
+	CListCtrl	m_ctrlJobList;
+	CEdit	m_ctrlOutput;
+	CButton	m_ctrlAnalysis;
+	CButton	m_ctrlClose;
+	CFloatEdit	m_ctrlAlphaMin;
+	CFloatEdit	m_ctrlAlphaMax;
+	CFloatEdit	m_ctrlDeltaAlpha;
+	CFloatEdit	m_ctrlQInfMin;
+	CFloatEdit	m_ctrlQInfMax;
+	CFloatEdit	m_ctrlDeltaQInf;
+	CFloatEdit	m_ctrlControlMin;
+	CFloatEdit	m_ctrlControlMax;
+	CFloatEdit	m_ctrlDeltaControl;
+	CFloatEdit	m_ctrlMemLimit;
+	CStatic	m_ctrlSpeedUnit;
+	//}}AFX_DATA
+
+
+// Overrides
+	// ClassWizard generated virtual function overrides
+	//{{AFX_VIRTUAL(CWPolarBatchDlg)
+	protected:
+	virtual void DoDataExchange(CDataExchange* pDX);    // DDX/DDV support
+	virtual void OnCancel();
+	//}}AFX_VIRTUAL
+
+// Implementation
+protected:
+	void FillJobList();
+	void ReadParams();
+	void SetJobStatus(int iJob, CString Status);
+	void UpdateOutput(CString strong);
+
+	bool m_bRunning;		// true while the batch is running
+
+	double m_AlphaMin, m_AlphaMax, m_DeltaAlpha;
+	double m_QInfMin, m_QInfMax, m_DeltaQInf;
+	double m_ControlMin, m_ControlMax, m_DeltaControl;
+	double m_MemLimit;		// the max memory allowed for an analysis, in MB
+
+	CWnd *m_pMiarex;
+	CWnd *m_pFrame;
+
+	// Generated message map functions
+	//{{AFX_MSG(CWPolarBatchDlg)
+	virtual BOOL OnInitDialog();
+	afx_msg void OnAnalysis();
+	//}}AFX_MSG
+	DECLARE_MESSAGE_MAP()
+};
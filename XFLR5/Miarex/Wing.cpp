@@ -38,8 +38,8 @@
 
 /////////////////////////////////////////////////////////////////////////////
 // CWing dialog
-CVector *CWing::m_pWakeNode;			//pointer to the VLM wake node array
-CPanel  *CWing::m_pWakePanel;			//pointer to the VLM Wake Panel array
+CVector *CWing::m_pWakeNode  = NULL;	//pointer to the VLM wake node array
+CPanel  *CWing::m_pWakePanel = NULL;	//pointer to the VLM Wake Panel array
 
 CWnd* CWing::s_pFrame;		//pointer to the Frame window
 CWnd* CWing::s_pMiarex;	//pointer to the Miarex Application window
@@ -49,6 +49,7 @@ CWnd* CWing::s_p3DPanelDlg;//pointer to the 3DPanel analysis dialog class
 int CWing::s_NLLTStations;//pointer to the 3DPanel analysis dialog class
 double CWing::s_CvPrec;	// Precision required for LLT convergence
 double CWing::s_RelaxMax;	// relaxation factor for LLT convergence
+bool CWing::s_bAnderson;	// true if the LLT iterations are accelerated by Anderson mixing
 
 
 CWing::CWing(CWnd* pParent /*=NULL*/)
@@ -116,11 +117,13 @@ CWing::CWing(CWnd* pParent /*=NULL*/)
 	m_QInf0    = 0.0;
 	m_Weight   = 0.0;
 	m_Maxa     = 0.0;
+	m_nAccel   = 0;
+	LLTResetHistory();
 
 	m_pXFile     = NULL;
 	m_pPanel     = NULL;
-	m_pWakeNode  = NULL; 
-	m_pWakePanel = NULL;
+	// the static wake pointers are set by CMiarex::SetPanelPointers, each time the arrays are allocated,
+	// and must not be reset by the construction of another wing, e.g. of a worker's copy during an analysis
 
 	m_CL                = 0.0;
 	m_ViscousDrag       = 0.0;
@@ -444,6 +447,36 @@ void CWing::Duplicate(CWing *pWing)
 	m_nFlaps = pWing->m_nFlaps;
 }
 
+
+void CWing::LLTCopyState(CWing *pWing)
+{
+	// Copies the wing's geometry and the LLT state after LLTInitialize,
+	// so that an operating point may be solved on this copy independently of the others
+	Duplicate(pWing);
+
+	m_bTrace      = false;
+	m_bInitCalc   = pWing->m_bInitCalc;
+	m_bConverged  = pWing->m_bConverged;
+	m_bWingOut    = pWing->m_bWingOut;
+	m_Type        = pWing->m_Type;
+	m_Alpha       = pWing->m_Alpha;
+	m_QInf        = pWing->m_QInf;
+	m_QInf0       = pWing->m_QInf0;
+	m_Weight      = pWing->m_Weight;
+	m_Density     = pWing->m_Density;
+	m_Viscosity   = pWing->m_Viscosity;
+	m_Maxa        = pWing->m_Maxa;
+
+	memcpy(m_Chord,     pWing->m_Chord,     sizeof(m_Chord));
+	memcpy(m_Offset,    pWing->m_Offset,    sizeof(m_Offset));
+	memcpy(m_Twist,     pWing->m_Twist,     sizeof(m_Twist));
+	memcpy(m_SpanPos,   pWing->m_SpanPos,   sizeof(m_SpanPos));
+	memcpy(m_StripArea, pWing->m_StripArea, sizeof(m_StripArea));
+	memcpy(m_Re,        pWing->m_Re,        sizeof(m_Re));
+	memcpy(m_Ai,        pWing->m_Ai,        sizeof(m_Ai));
+	memcpy(m_Cl,        pWing->m_Cl,        sizeof(m_Cl));
+}
+
 /*	if(!m_bIsFin){
 		m_Area    = 2.0 * surface;
 		m_Volume *= 2.0;
@@ -841,6 +874,9 @@ void CWing::LLTInitCl()
 
 	bool bOutRe, bError;
 
+	m_nAccel = 0;
+	LLTResetHistory();
+
 	for (k=1; k<s_NLLTStations; k++)
 	{
 		yob   = cos(k*pi/s_NLLTStations);
@@ -984,17 +1020,31 @@ int CWing::LLTIterate()
 	int k ;
 	CFoil* pFoil0  = NULL;
 	CFoil* pFoil1  = NULL;
-	double a, yob, tau, anext;
+	double a, yob, tau;
+	double AiNext[MAXSTATIONS+1];
 	bool bOutRe, bError;
 
 	m_Maxa = 0.0;
 
 	for (k=1; k<s_NLLTStations; k++)
 	{
-		a        = m_Ai[k];
-		anext    = -AlphaInduced(k);
-		m_Ai[k]  = a +(anext-a)/s_RelaxMax;
-		m_Maxa   = __max(m_Maxa, abs(a-anext));
+		a         = m_Ai[k];
+		AiNext[k] = -AlphaInduced(k);
+		m_Maxa    = __max(m_Maxa, abs(a-AiNext[k]));
+	}
+
+	if(s_bAnderson && m_Maxa>=s_CvPrec && LLTAndersonStep(AiNext))
+	{
+		m_nAccel++;
+	}
+	else
+	{
+		//fall back on the relaxed fixed point iteration
+		for (k=1; k<s_NLLTStations; k++)
+		{
+			a        = m_Ai[k];
+			m_Ai[k]  = a +(AiNext[k]-a)/s_RelaxMax;
+		}
 	}
 
 	double Lift=0.0;// required for Type 2
@@ -1037,6 +1087,107 @@ int CWing::LLTIterate()
 	return 0;
 }
 
+bool CWing::LLTAndersonStep(double *AiNext)
+{
+	// Anderson mixing of the induced angles :
+	// the next iterate is the relaxed step corrected by the combination of the past iterates
+	// which best cancels the current residual in the least square sense.
+	// Returns false if the relaxed step should be taken instead, i.e. if the history is empty,
+	// if it has just been restarted because the residual has not decreased after a mixed step
+	// or has grown after a relaxed step, or if the least square system is singular or ill-conditioned
+	int i, j, k, n;
+	double beta = 1.0/s_RelaxMax;
+	double res, sum, trace;
+	double Res[MAXSTATIONS+1];
+	double A[LLTHISTORY*LLTHISTORY], B[LLTHISTORY];
+	bool bStep = true;
+
+	for (k=1; k<s_NLLTStations; k++) Res[k] = AiNext[k] - m_Ai[k];
+
+	if(m_MaxaPrev>=0.0)
+	{
+		if((m_bMixed && m_Maxa>=m_MaxaPrev) || m_Maxa>LLTRESGROWTH*m_MaxaPrev)
+		{
+			//the mixing is diverging, restart from the relaxed step
+			m_nHist = 0;
+			m_iHist = -1;
+			bStep = false;
+		}
+		else
+		{
+			m_iHist = (m_iHist+1)%LLTHISTORY;
+			if(m_nHist<LLTHISTORY) m_nHist++;
+			for (k=1; k<s_NLLTStations; k++)
+			{
+				m_dAi[m_iHist][k]  = m_Ai[k] - m_AiPrev[k];
+				m_dRes[m_iHist][k] = Res[k]  - m_ResPrev[k];
+			}
+		}
+	}
+	memcpy(m_AiPrev,  m_Ai, sizeof(m_AiPrev));
+	memcpy(m_ResPrev, Res,  sizeof(m_ResPrev));
+	m_MaxaPrev = m_Maxa;
+	m_bMixed   = false;
+
+	if(!bStep || m_nHist==0) return false;
+
+	//normal equations of the least square problem min|Res - dRes.Gamma|
+	n = m_nHist;
+	trace = 0.0;
+	for (i=0; i<n; i++)
+	{
+		sum = 0.0;
+		for (k=1; k<s_NLLTStations; k++) sum += m_dRes[i][k] * Res[k];
+		B[i] = sum;
+		for (j=0; j<=i; j++)
+		{
+			sum = 0.0;
+			for (k=1; k<s_NLLTStations; k++) sum += m_dRes[i][k] * m_dRes[j][k];
+			A[i*n+j] = sum;
+			A[j*n+i] = sum;
+		}
+		trace += A[i*n+i];
+	}
+	//regularization scaled on the matrix, since the differences vanish as the iterations converge
+	for (i=0; i<n; i++) A[i*n+i] += 1.e-8*trace/n;
+
+	if(!Gauss(A, n, B, 0))
+	{
+		m_nHist = 0;
+		m_iHist = -1;
+		return false;
+	}
+	sum = 0.0;
+	for (i=0; i<n; i++) sum += abs(B[i]);
+	if(sum>LLTMAXCOEF)
+	{
+		//ill-conditioned history, the combination would only amplify the round-off
+		m_nHist = 0;
+		m_iHist = -1;
+		return false;
+	}
+
+	for (k=1; k<s_NLLTStations; k++)
+	{
+		res = m_Ai[k] + beta*Res[k];
+		for (i=0; i<n; i++) res -= B[i] * (m_dAi[i][k] + beta*m_dRes[i][k]);
+		m_Ai[k] = res;
+	}
+	m_bMixed = true;
+	return true;
+}
+
+
+void CWing::LLTResetHistory()
+{
+	// Clears the Anderson mixing history before the iterations of a new point
+	m_nHist    = 0;
+	m_iHist    = -1;
+	m_MaxaPrev = -1.0;
+	m_bMixed   = false;
+}
+
+
 double CWing::GetTwist(double y)
 {
 	int l;
@@ -1258,6 +1409,7 @@ void CWing::LLTComputeWing()
 	double GCm                 = 0.0;
 	double eta, sigma;
 	double Cm0;
+	double Var[PLRVARS];
 	bool bOutRe, bError;
 	bool bPointOutRe, bPointOutAlpha;
 	m_bWingOut = false;
@@ -1269,32 +1421,18 @@ void CWing::LLTComputeWing()
 		yob   = cos((double)m*pi/(double)s_NLLTStations);
 		GetFoils(&pFoil0, &pFoil1, yob*m_Span/2.0, tau);
 
-		m_Cl[m]     = pMiarex->GetCl(pFoil0, pFoil1, m_Re[m],
-									m_Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
-		if(bOutRe) bPointOutRe = true;
-		if(bError) 
-			bPointOutAlpha = true;
-		
-		m_PCd[m]    = pMiarex->GetCd(pFoil0, pFoil1, m_Re[m], m_Alpha+m_Ai[m]+m_Twist[m], tau, m_AR, bOutRe, bError);
+		// all the station's variables from the same polar interpolation
+		pMiarex->GetFoilVars(pFoil0, pFoil1, m_Re[m], m_Alpha+m_Ai[m]+m_Twist[m], tau, m_AR, Var, bOutRe, bError);
 		if(bOutRe) bPointOutRe = true;
 		if(bError) bPointOutAlpha = true;
 
+		m_Cl[m]     = Var[1];
+		m_PCd[m]    = Var[2];
 		m_ICd[m]    = -m_Cl[m] * (m_Ai[m]* pi/180.0);
-
-		m_XTrTop[m] = pMiarex->GetXTr(pFoil0, pFoil1, m_Re[m],
-									m_Alpha+m_Ai[m] + m_Twist[m], tau, true, bOutRe, bError);
-		if(bOutRe) bPointOutRe = true;
-		if(bError) bPointOutAlpha = true;
-		
-		m_XTrBot[m] = pMiarex->GetXTr(pFoil0, pFoil1, m_Re[m],m_Alpha+m_Ai[m]+m_Twist[m], tau, false, bOutRe, bError);
-		if(bOutRe) bPointOutRe = true;
-		if(bError) bPointOutAlpha = true;
-		
-		m_CmAirf[m] = pMiarex->GetCm(pFoil0, pFoil1, m_Re[m], m_Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
-		if(bOutRe) bPointOutRe = true;
-		if(bError) bPointOutAlpha = true;
-
-		m_XCPSpanRel[m]  = pMiarex->GetXCp(pFoil0, pFoil1, m_Re[m], m_Alpha+m_Ai[m]+m_Twist[m], tau, m_AR, bOutRe, bError);
+		m_XTrTop[m] = Var[5];
+		m_XTrBot[m] = Var[6];
+		m_CmAirf[m] = Var[4];
+		m_XCPSpanRel[m]  = Var[11];
 
 		if(abs(m_XCPSpanRel[m])<0.000001)
 		{
@@ -1635,6 +1773,24 @@ int CWing::VLMGetPanelTotal()
 	else          return total;
 }
 
+
+int CWing::VLMGetStripTotal()
+{
+	// Returns the number of spanwise strips of the surfaces, i.e. the number of wake columns
+	CMiarex    *pMiarex = (CMiarex*)   s_pMiarex;
+	double MinPanelSize;
+	if(pMiarex->m_MinPanelSize>0.0) MinPanelSize = pMiarex->m_MinPanelSize;
+	else                            MinPanelSize = m_Span/1000.0;
+
+	int total = 0;
+	for (int i=0; i<m_NPanel; i++){
+			if (abs(m_TPos[i]-m_TPos[i+1]) > MinPanelSize)
+				total +=m_NYPanels[i];
+	}
+	if(!m_bIsFin) return total*2;
+	else          return total;
+}
+
 void CWing::InsertSection(double TPos, double TChord, double TOffset,
 						  double TZPos, double Twist, CString Foil,
 						  int NChord, int NSpan, int SSpan)
@@ -1720,12 +1876,12 @@ bool CWing::VLMSetAutoMesh(int total)
 	m_bVLMAutoMesh = true;
 	m_bChanged = true;
 	//split (NYTotal) panels on each side proportionnaly to length, and space evenly
-	//Set VLMMATSIZE/NYTotal panels along chord
+	//Set 500/NYTotal panels along chord
 	int NYTotal, size;
 	
 	if(!total)
 	{
-		size = (int)(VLMMATSIZE/4);//why not ? Too much refinement isn't worthwile
+		size = 500;//why not ? Too much refinement isn't worthwile
 		NYTotal = 22;
 	}
 	else{
@@ -2024,6 +2180,7 @@ void CWing::VLMComputeWing(double *Gamma, double *Cp,  double &VDrag, double &XC
 	int  j, k, l, p, m, nFlap;
 	bool bOutRe, bError, bPointOutRe, bPointOutCl;
 	double CPStrip, tau, NForce, q, Alpha, cosa, sina;
+	double Var[PLRVARS];
 	CString string, strong;
 	CFoil *pFoil0, *pFoil1;
 	CVector DragVector, VInf, WindNormal, WindDirection;
@@ -2149,15 +2306,11 @@ void CWing::VLMComputeWing(double *Gamma, double *Cp,  double &VDrag, double &XC
 
 			if(bViscous)
 			{
-				m_PCd[m]    = pMiarex->GetVar(2, pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, bOutRe, bError);
-				bPointOutRe = bOutRe || bPointOutRe;
-				if(bError) bPointOutCl = true;
-
-				m_XTrTop[m] = pMiarex->GetVar(5, pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, bOutRe, bError);
-				bPointOutRe = bOutRe || bPointOutRe;
-				if(bError) bPointOutCl = true;
-				
-				m_XTrBot[m] = pMiarex->GetVar(6, pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, bOutRe, bError);
+				// Cd, XTr top and XTr bottom from the same polar interpolation
+				pMiarex->GetFoilVarsFromCl(pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, Var, bOutRe, bError);
+				m_PCd[m]    = Var[2];
+				m_XTrTop[m] = Var[5];
+				m_XTrBot[m] = Var[6];
 				bPointOutRe = bOutRe || bPointOutRe;
 				if(bError) bPointOutCl = true;
 				m_ViscousDrag  = m_PCd[m] * m_StripArea[m];
@@ -2325,6 +2478,7 @@ void CWing::PanelComputeWing(double *Cp, double &VDrag, double &XCP, double &YCP
 	CVector H, HA, HB, V1, HingeLeverArm, HingeMoment, DragMoment, GeomMoment, PtC4, PtLE, DragVector;
 	CVector Force, SurfaceNormal, LeverArm, LeverArmC4, PanelLeverArm, PanelForce, StripForce, Moment0, WindNormal, WindDirection;
 	double CPStrip, tau, NForce, Alpha, cosa, sina;
+	double Var[PLRVARS];
 
 	bOutRe = bError = false;
 
@@ -2439,15 +2593,11 @@ void CWing::PanelComputeWing(double *Cp, double &VDrag, double &XCP, double &YCP
 
 			if(bViscous)
 			{
-				m_PCd[m]    = pMiarex->GetVar(2, pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, bOutRe, bError);
-				bPointOutRe = bOutRe || bPointOutRe;
-				if(bError) bPointOutCl = true;
-
-				m_XTrTop[m] = pMiarex->GetVar(5, pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, bOutRe, bError);
-				bPointOutRe = bOutRe || bPointOutRe;
-				if(bError) bPointOutCl = true;
-				
-				m_XTrBot[m] = pMiarex->GetVar(6, pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, bOutRe, bError);
+				// Cd, XTr top and XTr bottom from the same polar interpolation
+				pMiarex->GetFoilVarsFromCl(pFoil0, pFoil1, m_Re[m], m_Cl[m], tau, Var, bOutRe, bError);
+				m_PCd[m]    = Var[2];
+				m_XTrTop[m] = Var[5];
+				m_XTrBot[m] = Var[6];
 				bPointOutRe = bOutRe || bPointOutRe;
 				if(bError) bPointOutCl = true;
 				m_ViscousDrag = m_PCd[m] * m_StripArea[m];
@@ -2938,6 +3088,7 @@ bool CWing::SplineInterpolation(int n, double *x, double *y, double *a, double *
 
 	M = pVLMDlg->m_aij;
 	RHS = pVLMDlg->m_RHS;
+	if(!M || !RHS) return false;// the matrices are allocated at the start of the VLM analysis
 
 /*	for(i=0;i<4*n;i++)
 	{
@@ -71,6 +71,7 @@ protected:
 
 	bool VLMSetAutoMesh(int total = 0);
 	int  VLMGetPanelTotal(void);
+	int  VLMGetStripTotal(void);
 	void VLMSetBending();
 	void VLMTrefftz(double *Gamma, int pos, CVector &Force, double & Drag, bool bTilted);
 	void VLMComputeWing(double *Gamma, double *Cp, double &VDrag, double &XCP, double &YCP,
@@ -86,6 +87,9 @@ protected:
 	void LLTInitCl();
 	void LLTComputeWing();
 	int  LLTIterate();
+	bool LLTAndersonStep(double *AiNext);
+	void LLTResetHistory();
+	void LLTCopyState(CWing *pWing);
  
 	void CreateXPoints(int NXPanels, int XDist, CFoil *pFoilA, CFoil *pFoilB,
 		               double *xPointA, double *xPointB, int &NXLead, int &NXFlap);
@@ -133,6 +137,7 @@ protected:
 	static int s_NLLTStations;
 	static double s_CvPrec;	// Precision required for LLT convergence
 	static double s_RelaxMax;	// relaxation factor for LLT convergence
+	static bool s_bAnderson;	// true if the LLT iterations are accelerated by Anderson mixing
 
 	CString m_WingName;	//the wing's name
 
@@ -185,6 +190,13 @@ protected:
 	double m_Alpha;		// angle of attack
 	double m_Maxa; 		// Used in LLT
 
+	int m_nAccel;		// number of LLT iterations accelerated by Anderson mixing for the current point
+	int m_nHist, m_iHist;	// number of stored differences, and index of the latest, in the mixing history
+	double m_MaxaPrev;	// max residual of the previous LLT iteration
+	bool m_bMixed;		// true if the previous LLT iterate was given by the Anderson mixing
+	double m_AiPrev[MAXSTATIONS+1], m_ResPrev[MAXSTATIONS+1];	// previous LLT iterate and its residual
+	double m_dAi[LLTHISTORY][MAXSTATIONS+1], m_dRes[LLTHISTORY][MAXSTATIONS+1];	// differences of the past iterates and residuals
+
 	double m_VYm, m_VCm; // Viscous yawing and pitching moments for the wing
 	double m_IYm;		// Induced Yawing Moment
 	double m_GCm, m_GRm, m_GYm;		// Geometric Yawing Moment
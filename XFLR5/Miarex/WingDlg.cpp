@@ -1438,12 +1438,6 @@ bool CWingDlg::CheckWing()
 		}
 	}
 
-	if(VLMGetPanelTotal()>VLMMATSIZE/2) 
-	{
-		AfxMessageBox("Too many panels\nReduce the mesh size");
-		return false;
-	}
-
 	if(m_pWing->m_nFlaps>=20)
 	{
 		int res = AfxMessageBox("Only 10 flaps x 2 will be handled", MB_OKCANCEL);
@@ -1710,11 +1704,11 @@ bool CWingDlg::VLMSetAutoMesh(int total)
 	m_pWing->m_bVLMAutoMesh = true;
 	m_bChanged = true;
 	//split (NYTotal) panels on each side proportionnaly to length, and space evenly
-	//Set VLMMATSIZE/NYTotal panels along chord
+	//Set 500/NYTotal panels along chord
 	int NYTotal, size;
 	
 	if(!total){
-		size = (int)(VLMMATSIZE/4);//why not ? Too much refinement isn't worthwile
+		size = 500;//why not ? Too much refinement isn't worthwile
 		NYTotal = 22;
 	}
 	else{
@@ -1739,12 +1733,6 @@ bool CWingDlg::VLMSetAutoMesh(int total)
 //		m_pWing->m_XPanelDist[i] = 1;//cosine distribution
 //		m_pWing->m_YPanelDist[i] = 0;//uniformly distributed, except at the root and tip (see next)
 	}
-
-	if(VLMGetPanelTotal()>VLMMATSIZE/2)
-	{
-		AfxMessageBox("Too many panels\nReduce the mesh size", MB_OK);
-		return false;
-	}
 	return true;
 }
 
@@ -26,6 +26,9 @@
 #include "stdafx.h"
 #include "X-FLR5.h"
 #include "./main/MainFrm.h"
+#include "./XDirect/PolarJob.h"
+
+#define LUTILE 256 //column tile width for the trailing update of the blocked LU factorization
 
 
 // CXFLR5App
@@ -39,6 +42,8 @@ END_MESSAGE_MAP()
 
 CXFLR5App::CXFLR5App()
 {
+	m_bHeadless = false;
+	m_ExitCode  = 0;
 }
 
 
@@ -84,6 +89,25 @@ BOOL CXFLR5App::InitInstance()
 	}
 	Trace("CX5App::InitInstance::Launching app");
 
+	// X-FLR6.exe /polars JobFile : calculates the polars defined in the job file, without any window
+	if(__argc>=3 && stricmp(__argv[1], "/polars")==0)
+	{
+		CPolarJob Job;
+		m_bHeadless = true;
+		if(Job.Read(__argv[2])) m_ExitCode = Job.Run();
+		else
+		{
+			// no message box, the job may be run unattended
+			CStdioFile XFile;
+			m_ExitCode = -1;
+			if(XFile.Open(CString(__argv[2])+".log", CFile::modeCreate | CFile::modeWrite | CFile::typeText))
+			{
+				XFile.WriteString(Job.m_strError + "\n");
+				XFile.Close();
+			}
+		}
+		return FALSE;
+	}
 
 //	AfxEnableControlContainer();
 
@@ -214,6 +238,15 @@ BOOL CXFLR5App::InitInstance()
 }
 
 
+int CXFLR5App::ExitInstance()
+{
+	// the command line job returns the number of failed polars, or -1 if the job file is invalid
+	int ExitCode = CWinApp::ExitInstance();
+	if(m_bHeadless) return m_ExitCode;
+	return ExitCode;
+}
+
+
 BOOL CXFLR5App::OnIdle(LONG lCount) 
 {
 	CMainFrame* pFrame = (CMainFrame*)m_pMainWnd;
@@ -1485,7 +1518,7 @@ bool GaussSeidel (double *a, int MatSize, double *b, double *xk, double eps, int
 {
 	int iter, i, j;
 	double sum, max;
-	double xk1[VLMMATSIZE];
+	double *xk1 = new double[MatSize];
 
 	for (iter=0; iter<IterMax; iter++)
 	{
@@ -1502,9 +1535,14 @@ bool GaussSeidel (double *a, int MatSize, double *b, double *xk, double eps, int
 			if(abs(xk1[i]-xk[i])>max) max=abs(xk1[i]-xk[i]);
 
 //		TRACE("%3d   %10.3e\n",iter, max);
-		if(max<eps) return true;
+		if(max<eps) 
+		{
+			delete [] xk1;
+			return true;
+		}
 		memcpy(xk, xk1, MatSize*sizeof(double));
 	}
+	delete [] xk1;
 	return false;
 }
 
@@ -1606,6 +1644,160 @@ bool Gauss(double *A, int n, double *B, int m)
 
 
 
+bool LUFactorBlock(double *A, int n, int *ipiv, int k0, int nb)
+{
+	// One step of a right-looking blocked LU factorization with partial pivoting
+	// A is stored row-wise, i.e. A[i*n+j]
+	// Factors the column panel k0..k0+nb-1, then updates the trailing sub-matrix
+	// The caller loops on k0 = 0, nb, 2nb... so that progress and cancellation
+	// can be handled between two blocks
+	// Row interchanges are recorded in ipiv, and are applied to the whole rows, LAPACK style
+	int i, j, c, t, p, k1, c0, c1;
+	double pivot, dum, lij, l0, l1, l2, l3;
+	double *pa, *pp, *pr, *pu, *u0, *u1, *u2, *u3;
+
+	if(k0+nb>n) nb = n-k0;
+	k1 = k0+nb;
+
+	// factor the column panel
+	for(j=k0; j<k1; j++)
+	{
+		//  find the pivot row
+		p = j;
+		pivot = abs(A[j*n+j]);
+		for(i=j+1; i<n; i++)
+		{
+			if((dum=abs(A[i*n+j]))>pivot)
+			{
+				pivot = dum;
+				p = i;
+			}
+		}
+		if(pivot<=0.0) return false;// the matrix A is singular
+
+		ipiv[j] = p;
+		if(p!=j)
+		{
+			pa = A+j*n;
+			pp = A+p*n;
+			for(c=0; c<n; c++)
+			{
+				dum   = pa[c];
+				pa[c] = pp[c];
+				pp[c] = dum;
+			}
+		}
+
+		pa  = A+j*n;
+		dum = 1.0/pa[j];
+		for(i=j+1; i<n; i++)
+		{
+			pr = A+i*n;
+			pr[j] *= dum;
+			lij = pr[j];
+			if(lij!=0.0)
+				for(c=j+1; c<k1; c++) pr[c] -= lij*pa[c];
+		}
+	}
+
+	if(k1>=n) return true;
+
+	// U12 = L11^-1 * A12
+	for(j=k0; j<k1; j++)
+	{
+		pa = A+j*n;
+		for(i=j+1; i<k1; i++)
+		{
+			pr  = A+i*n;
+			lij = pr[j];
+			if(lij!=0.0)
+				for(c=k1; c<n; c++) pr[c] -= lij*pa[c];
+		}
+	}
+
+	// A22 = A22 - L21 * U12
+	// columns are processed by tiles, so that the block of U12 rows stays in cache
+	for(c0=k1; c0<n; c0+=LUTILE)
+	{
+		c1 = min(c0+LUTILE, n);
+		for(i=k1; i<n; i++)
+		{
+			pr = A+i*n;
+			// four rows of U12 at a time, to save on the loads and stores of row i
+			for(t=k0; t+3<k1; t+=4)
+			{
+				l0 = pr[t];
+				l1 = pr[t+1];
+				l2 = pr[t+2];
+				l3 = pr[t+3];
+				u0 = A+t*n;
+				u1 = u0+n;
+				u2 = u1+n;
+				u3 = u2+n;
+				for(c=c0; c<c1; c++) pr[c] -= l0*u0[c] + l1*u1[c] + l2*u2[c] + l3*u3[c];
+			}
+			for(; t<k1; t++)
+			{
+				lij = pr[t];
+				pu  = A+t*n;
+				for(c=c0; c<c1; c++) pr[c] -= lij*pu[c];
+			}
+		}
+	}
+	return true;
+}
+
+
+void LUSolve(double *A, int n, int *ipiv, double *B, int m)
+{
+	// Solves the m right hand sides stored in B[row+k*n] using the factors built by LUFactorBlock
+	// The rows of A are swept in the outer loop, so that each row is read only once for all rhs
+	int i, j, k;
+	double sum, dum, *pr, *b;
+
+	for(k=0; k<m; k++)
+	{
+		b = B+k*n;
+		for(j=0; j<n; j++)
+		{
+			if(ipiv[j]!=j)
+			{
+				dum        = b[j];
+				b[j]       = b[ipiv[j]];
+				b[ipiv[j]] = dum;
+			}
+		}
+	}
+
+	// Forward substitution, L has a unit diagonal
+	for(i=1; i<n; i++)
+	{
+		pr = A+i*n;
+		for(k=0; k<m; k++)
+		{
+			b = B+k*n;
+			sum = b[i];
+			for(j=0; j<i; j++) sum -= pr[j]*b[j];
+			b[i] = sum;
+		}
+	}
+
+	// Backward substitution
+	for(i=n-1; i>=0; i--)
+	{
+		pr  = A+i*n;
+		dum = 1.0/pr[i];
+		for(k=0; k<m; k++)
+		{
+			b = B+k*n;
+			sum = b[i];
+			for(j=i+1; j<n; j++) sum -= pr[j]*b[j];
+			b[i] = sum*dum;
+		}
+	}
+}
+
+
 
 double IntegralC2(double y1, double y2, double c1, double c2)
 {
@@ -86,6 +86,8 @@ bool GetPrintColor();
 bool Intersect(CVector A, CVector B, CVector C, CVector D, CVector *M);
 bool GaussSeidel (double *a, int MatSize, double *b, double *xk, double eps, int IterMax);
 bool Gauss(double *A, int n, double *B, int m);
+bool LUFactorBlock(double *A, int n, int *ipiv, int k0, int nb);
+void LUSolve(double *A, int n, int *ipiv, double *B, int m);
 double IntegralC2(double y1, double y2, double c1, double c2);
 double IntegralCy(double y1, double y2, double c1, double c2);
 
@@ -108,10 +110,13 @@ public:
 	bool g_bColor;
 	int g_GraphDlgPage;
 	double m_PenWidth;
+	bool m_bHeadless;	// true if the application runs a polar job from the command line
+	int m_ExitCode;
 
 // Overrides
 public:
 	virtual BOOL InitInstance();
+	virtual int ExitInstance();
 	virtual BOOL OnIdle(LONG lCount);
 
 // Implementation
@@ -83,6 +83,7 @@ BEGIN_MESSAGE_MAP(C2DPanelDlg, CDialog)
 	ON_EN_CHANGE(IDC_XSREF2, OnChanged)
 	ON_EN_CHANGE(IDC_XPREF2, OnChanged)
 	ON_BN_CLICKED(IDC_APPLY, OnApply)
+	ON_BN_CLICKED(IDC_PANELCOST, OnPanelCost)
 	//}}AFX_MSG_MAP
 END_MESSAGE_MAP()
 
@@ -118,11 +119,13 @@ void C2DPanelDlg::OnApply()
 		return;
 	}
 
-	ReadParams();
+	ReadParams(m_pXFoil);
 
 	m_pXFoil->pangen();
-	if(m_pXFoil->n>350) {
-		AfxMessageBox("Panel number cannot exceed 350", MB_OK);
+	if(m_pXFoil->n>IQX-6) {
+		CString strong;
+		strong.Format("Panel number cannot exceed %d", IQX-6);
+		AfxMessageBox(strong, MB_OK);
 		//reset everything and retry
 		for (int i=0; i< m_pMemFoil->nb; i++){
 			m_pXFoil->x[i+1] = m_pMemFoil->xb[i] ;
@@ -181,7 +184,7 @@ BOOL C2DPanelDlg::OnInitDialog()
 	xpref2 = m_pXFoil->xpref2;
 
 	m_ctrlNPanels.SetValue(npan);
-	m_ctrlNPanels.SetMin(0); m_ctrlNPanels.SetMax(300);
+	m_ctrlNPanels.SetMin(0); m_ctrlNPanels.SetMax(IQX-6);
 	m_ctrlCVpar.SetValue(cvpar);
 	m_ctrlCTErat.SetValue(cterat);
 	m_ctrlCTRrat.SetValue(ctrrat);
@@ -207,16 +210,122 @@ void C2DPanelDlg::OnOK()
 }
 
 
-void C2DPanelDlg::ReadParams()
+void C2DPanelDlg::ReadParams(XFoil *pXFoil)
 {
-	m_pXFoil->npan   = m_ctrlNPanels.GetValue();
-	m_pXFoil->cvpar  = m_ctrlCVpar.GetValue();
-	m_pXFoil->cterat = m_ctrlCTErat.GetValue();
-	m_pXFoil->ctrrat = m_ctrlCTRrat.GetValue();
-	m_pXFoil->xsref1 = m_ctrlXsRef1.GetValue();
-	m_pXFoil->xsref2 = m_ctrlXsRef2.GetValue();
-	m_pXFoil->xpref1 = m_ctrlXpRef1.GetValue();
-	m_pXFoil->xpref2 = m_ctrlXpRef2.GetValue();
+	pXFoil->npan   = m_ctrlNPanels.GetValue();
+	pXFoil->cvpar  = m_ctrlCVpar.GetValue();
+	pXFoil->cterat = m_ctrlCTErat.GetValue();
+	pXFoil->ctrrat = m_ctrlCTRrat.GetValue();
+	pXFoil->xsref1 = m_ctrlXsRef1.GetValue();
+	pXFoil->xsref2 = m_ctrlXsRef2.GetValue();
+	pXFoil->xpref1 = m_ctrlXpRef1.GetValue();
+	pXFoil->xpref2 = m_ctrlXpRef2.GetValue();
 
 }
 
+
+void C2DPanelDlg::OnPanelCost() 
+{
+	// Repanels the foil with the current bunching parameters for increasing numbers of panels
+	// and times the analysis at zero incidence, viscous if a polar is selected, inviscid otherwise,
+	// so that the resolution can be chosen by weighing the cost against the convergence of Cl and Cd
+	// The results are written to the file XFLR5_Panels.txt in the temp directory
+	CStdioFile XFile;
+	CFileException fe;
+	CString FileName, strOut, strong;
+	LARGE_INTEGER Freq, t0, t1, t2;
+	int i, nPanels, Iterations;
+	double TInv, TVisc;
+	bool bViscous;
+	char szTempPath[MAX_PATH] = "";
+
+	GetTempPath(MAX_PATH, szTempPath);
+	FileName = szTempPath;
+	FileName += "XFLR5_Panels.txt";
+
+	if(!XFile.Open(FileName, CFile::modeCreate | CFile::modeWrite, &fe)) return;
+
+	CWaitCursor Wait;
+	XFoil *pXFoil = new XFoil;
+	*pXFoil = *m_pXFoil;// with the analysis settings of the current polar
+	pXFoil->pXFile   = NULL;
+	pXFoil->m_bTrace = false;
+	pXFoil->m_bFactorCache = false;// time the factorization of aij, not its retrieval from the cache
+	ReadParams(pXFoil);
+	bViscous = pXFoil->reinf1>0.0;
+
+	QueryPerformanceFrequency(&Freq);
+	XFile.WriteString(Title+"\n");
+	if(bViscous) strOut.Format("Viscous analysis at Re = %.0f, Alpha = 0\n\n", pXFoil->reinf1);
+	else         strOut.Format("Inviscid analysis, Alpha = 0\n\n");
+	XFile.WriteString(strOut);
+	strong = "  Panels   Inviscid(s)   Viscous(s)   Iter        Cl          Cm          Cd\n";
+	XFile.WriteString(strong);
+
+	for (nPanels=100; nPanels<=IQX-6; nPanels+=50)
+	{
+		for (i=0; i< m_pMemFoil->nb; i++)
+		{
+			pXFoil->xb[i+1] = m_pMemFoil->xb[i];
+			pXFoil->yb[i+1] = m_pMemFoil->yb[i];
+		}
+		pXFoil->nb = m_pMemFoil->nb;
+		pXFoil->lflap  = false;
+		pXFoil->lbflap = false;
+		if(!pXFoil->Preprocess()) break;
+
+		pXFoil->npan = nPanels;
+		pXFoil->pangen();
+		if(pXFoil->n>IQX-6) break;
+
+		//the analyses run on the paneled foil, as they would on the foil created by OnApply
+		for (i=1; i<=pXFoil->n; i++)
+		{
+			pXFoil->xb[i] = pXFoil->x[i];
+			pXFoil->yb[i] = pXFoil->y[i];
+		}
+		pXFoil->nb = pXFoil->n;
+		if(!pXFoil->Preprocess()) break;
+
+		pXFoil->alfa   = 0.0;
+		pXFoil->lalfa  = true;
+		pXFoil->qinf   = 1.0;
+		pXFoil->lblini = false;
+		pXFoil->lipan  = false;
+		pXFoil->lvisc  = bViscous;
+
+		QueryPerformanceCounter(&t0);
+		if(!pXFoil->specal()) break;
+		QueryPerformanceCounter(&t1);
+
+		Iterations = 0;
+		if(bViscous)
+		{
+			if(!pXFoil->viscal()) break;
+			while(Iterations<100 && !pXFoil->lvconv)
+			{
+				if(!pXFoil->ViscousIter()) break;
+				Iterations++;
+			}
+			pXFoil->ViscalEnd();
+		}
+		QueryPerformanceCounter(&t2);
+
+		TInv  = (double)(t1.QuadPart-t0.QuadPart)/(double)Freq.QuadPart;
+		TVisc = (double)(t2.QuadPart-t1.QuadPart)/(double)Freq.QuadPart;
+
+		if(!bViscous)             strOut.Format("%8d   %11.4f            -      -   %9.5f   %9.5f           -\n", 
+										pXFoil->n, TInv, pXFoil->cl, pXFoil->cm);
+		else if(pXFoil->lvconv)   strOut.Format("%8d   %11.4f  %11.4f   %4d   %9.5f   %9.5f   %9.6f\n", 
+										pXFoil->n, TInv, TVisc, Iterations, pXFoil->cl, pXFoil->cm, pXFoil->cd);
+		else                      strOut.Format("%8d   %11.4f  %11.4f   %4d   unconverged\n", 
+										pXFoil->n, TInv, TVisc, Iterations);
+		XFile.WriteString(strOut);
+		strong += strOut;
+	}
+	XFile.Close();
+	delete pXFoil;
+
+	AfxMessageBox(strong, MB_OK);
+}
+
@@ -69,7 +69,7 @@ public:
 // Implementation
 public:
 private:
-	void ReadParams();
+	void ReadParams(XFoil *pXFoil);
 	CWnd* m_pChildView;
 	XFoil* m_pXFoil;
 	CString Title;
@@ -95,6 +95,7 @@ protected:
 	//{{AFX_MSG(C2DPanelDlg)
 	afx_msg void OnApply();
 	afx_msg void OnChanged();
+	afx_msg void OnPanelCost();
 	virtual BOOL OnInitDialog();
 	virtual void OnOK();
 	//}}AFX_MSG
@@ -0,0 +1,189 @@
+/****************************************************************************
+
+    Alpha Stepper class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+//////////////////////////////////////////////////////////////////////
+//
+// AlphaStepper.cpp: implementation of the CAlphaStepper class.
+// The caller asks for the next angle, runs the viscous analysis, then reports
+// the result, and adds the point to the polar only if the stepper keeps it.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "../X-FLR5.h"
+#include "AlphaStepper.h"
+
+#define ADAPTIVEFASTITER  0.2	// fraction of the iteration limit below which a point is deemed easy
+#define ADAPTIVESLOWITER  0.5	// fraction of the iteration limit above which the step is reduced
+#define ADAPTIVELINEAR    0.1	// relative change of the lift slope below which the lift curve is deemed linear
+#define ADAPTIVEMARGIN    0.8	// fraction of the resolution aimed at by the predicted increments
+
+
+CAlphaStepper::CAlphaStepper()
+{
+	Init(0.0, 0.0, 1.0, 0.0, 0.0, 100);
+}
+
+
+void CAlphaStepper::Init(double SpMin, double SpMax, double SpInc, double dClMax, double dCdMax, int IterLim)
+{
+	m_SpMin   = SpMin;
+	m_SpMax   = SpMax;
+	m_SpInc   = SpInc;
+	m_dClMax  = dClMax;
+	m_dCdMax  = dCdMax;
+	m_IterLim = IterLim;
+
+	m_Step   = abs(SpInc);
+	m_Spec   = SpMin;
+	m_nConv  = 0;
+	m_bFirst = true;
+	m_bDone  = false;
+}
+
+
+double CAlphaStepper::Ahead(double Sp0, double Sp1)
+{
+	// returns the distance from Sp0 to Sp1 counted in the direction of the sequence
+	if(m_SpInc>=0.0) return Sp1-Sp0;
+	else             return Sp0-Sp1;
+}
+
+
+bool CAlphaStepper::GetNext(double &Spec)
+{
+	// returns the angle of the next point, or false if the sequence is complete
+	double tol = 1.e-4*abs(m_SpInc);
+
+	if(m_bFirst)
+	{
+		m_bFirst = false;
+		Spec = m_Spec;
+		return true;
+	}
+	if(m_bDone) return false;
+	if(m_nConv>0 && Ahead(m_Sp[0], m_SpMax)<=tol) return false;
+
+	//the end of the range is always calculated
+	if(Ahead(m_SpMax, m_Spec)>0.0) m_Spec = m_SpMax;
+
+	Spec = m_Spec;
+	return true;
+}
+
+
+bool CAlphaStepper::SetResult(bool bConverged, int Iterations, double Cl, double Cd)
+{
+	// processes the result of the point at the last angle returned by GetNext()
+	// and returns true if the point is kept
+	int i;
+	double dir     = m_SpInc>=0.0 ? 1.0 : -1.0;
+	double MinStep = ADAPTIVEMINSTEP*abs(m_SpInc);
+	bool bAtEnd    = Ahead(m_SpMax, m_Spec) >= -1.e-4*abs(m_SpInc);
+
+	if(!bConverged)
+	{
+		if(m_nConv>0 && m_Step>MinStep*1.0001)
+		{
+			// retry closer to the last converged point
+			m_Step = max(m_Step/2.0, MinStep);
+			m_Spec = m_Sp[0] + dir*m_Step;
+			return false;
+		}
+		// leave this point out and march on with the nominal step,
+		// the lift curve being discontinuous across the gap
+		if(bAtEnd) m_bDone = true;
+		m_nConv = 0;
+		m_Step = abs(m_SpInc);
+		m_Spec = m_Spec + dir*m_Step;
+		return false;
+	}
+
+	if(m_nConv>0 && m_Step>MinStep*1.0001)
+	{
+		if((m_dClMax>0.0 && abs(Cl-m_Cl[0])>m_dClMax) || (m_dCdMax>0.0 && abs(Cd-m_Cd[0])>m_dCdMax))
+		{
+			// the increments exceed the resolution, so fill the gap
+			m_Step = max(m_Step/2.0, MinStep);
+			m_Spec = m_Sp[0] + dir*m_Step;
+			return false;
+		}
+	}
+
+	for(i=2; i>0; i--)
+	{
+		m_Sp[i] = m_Sp[i-1];
+		m_Cl[i] = m_Cl[i-1];
+		m_Cd[i] = m_Cd[i-1];
+	}
+	m_Sp[0] = m_Spec;
+	m_Cl[0] = Cl;
+	m_Cd[0] = Cd;
+	m_nConv = min(m_nConv+1, 3);
+
+	SetNextStep(Iterations);
+	m_Spec = m_Sp[0] + dir*m_Step;
+	return true;
+}
+
+
+void CAlphaStepper::SetNextStep(int Iterations)
+{
+	// sets the step from the last converged point
+	double dSp, ClSlope, CdSlope, ClSlope1;
+	double MinStep = ADAPTIVEMINSTEP*abs(m_SpInc);
+	double MaxStep = ADAPTIVEMAXSTEP*abs(m_SpInc);
+
+	if(m_nConv<2) return;
+
+	dSp     = m_Sp[0]-m_Sp[1];
+	ClSlope = (m_Cl[0]-m_Cl[1])/dSp;
+	CdSlope = (m_Cd[0]-m_Cd[1])/dSp;
+
+	if(Iterations > ADAPTIVESLOWITER*m_IterLim)
+	{
+		m_Step /= 1.5;
+	}
+	else if(Iterations <= ADAPTIVEFASTITER*m_IterLim && m_nConv>=3)
+	{
+		ClSlope1 = (m_Cl[1]-m_Cl[2])/(m_Sp[1]-m_Sp[2]);
+		if(abs(ClSlope-ClSlope1) <= ADAPTIVELINEAR*abs(ClSlope)) m_Step *= 1.5;
+	}
+
+	//keep the predicted increments within the resolution
+	if(m_dClMax>0.0 && abs(ClSlope)*m_Step > ADAPTIVEMARGIN*m_dClMax)
+		m_Step = ADAPTIVEMARGIN*m_dClMax/abs(ClSlope);
+	if(m_dCdMax>0.0 && abs(CdSlope)*m_Step > ADAPTIVEMARGIN*m_dCdMax)
+		m_Step = ADAPTIVEMARGIN*m_dCdMax/abs(CdSlope);
+
+	m_Step = max(m_Step, MinStep);
+	m_Step = min(m_Step, MaxStep);
+}
+
+
+void CAlphaStepper::Skip()
+{
+	// the user has skipped the point, so march on without changing the step
+	double dir = m_SpInc>=0.0 ? 1.0 : -1.0;
+	if(Ahead(m_SpMax, m_Spec) >= -1.e-4*abs(m_SpInc)) m_bDone = true;
+	m_Spec += dir*m_Step;
+}
@@ -0,0 +1,62 @@
+/****************************************************************************
+
+    Alpha Stepper class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+// AlphaStepper.h: interface for the CAlphaStepper class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#define ADAPTIVEMAXSTEP    4.0		// max ratio of the adaptive step to the nominal step
+#define ADAPTIVEMINSTEP    0.125	// min ratio of the adaptive step to the nominal step
+
+// Chooses the angles of attack of a viscous alpha sequence.
+// The step grows while the points converge quickly on the linear part of the lift curve,
+// is bisected back from the last converged point when a point fails to converge,
+// and is kept small enough for the Cl and Cd increments between two consecutive points
+// not to exceed the requested resolution.
+// The angles are in the units of the range, degrees or radians.
+
+class CAlphaStepper
+{
+public:
+	CAlphaStepper();
+
+	void Init(double SpMin, double SpMax, double SpInc, double dClMax, double dCdMax, int IterLim);
+	bool GetNext(double &Spec);
+	bool SetResult(bool bConverged, int Iterations, double Cl, double Cd);
+	void Skip();
+
+protected:
+	double Ahead(double Sp0, double Sp1);
+	void SetNextStep(int Iterations);
+
+	double m_SpMin, m_SpMax, m_SpInc;	// the range and the nominal step, whose sign gives the direction
+	double m_dClMax, m_dCdMax;			// the resolution in Cl and Cd, 0 if none
+	int m_IterLim;
+
+	double m_Step;			// the absolute value of the current step
+	double m_Spec;			// the angle of the point being calculated
+	int m_nConv;			// the number of converged points in the history, up to 3
+	double m_Sp[3], m_Cl[3], m_Cd[3];	// the last converged points, the latest first
+	bool m_bFirst, m_bDone;
+};
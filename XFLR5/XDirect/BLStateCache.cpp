@@ -0,0 +1,134 @@
+/****************************************************************************
+
+    BL State Cache class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+//////////////////////////////////////////////////////////////////////
+//
+// BLStateCache.cpp: implementation of the CBLStateCache class.
+// The states are matched on the paneled foil, the Mach number and NCrit.
+// Among those, the nearest in alpha and Reynolds number is used.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "../X-FLR5.h"
+#include "BLStateCache.h"
+
+#define SEEDMAXDISTANCE 3.0	// beyond this distance, a cold start is preferred
+
+
+CBLStateCache::CBLStateCache()
+{
+	m_nStates = 0;
+	m_iNext   = 0;
+	InitializeCriticalSection(&m_cs);
+}
+
+
+CBLStateCache::~CBLStateCache()
+{
+	Clear();
+	DeleteCriticalSection(&m_cs);
+}
+
+
+void CBLStateCache::Clear()
+{
+	EnterCriticalSection(&m_cs);
+	for(int i=0; i<m_nStates; i++) delete m_pState[i];
+	m_nStates = 0;
+	m_iNext   = 0;
+	LeaveCriticalSection(&m_cs);
+}
+
+
+double CBLStateCache::Distance(XFoilBLState *pState, XFoil *pXFoil)
+{
+	// returns a distance in degrees, a factor 2 on Re counting as 1.4 degree
+	// or a negative value if the state cannot be used for this point
+	if(abs(pState->minf  - pXFoil->minf1) > 1.e-4) return -1.0;
+	if(abs(pState->acrit - pXFoil->acrit) > 1.e-4) return -1.0;
+	if(pState->reinf<=0.0 || pXFoil->reinf1<=0.0)  return -1.0;
+	if(!pXFoil->IsSamePaneling(pState))            return -1.0;
+
+	return abs(pState->alfa - pXFoil->alfa)*180.0/3.141592654 + 2.0*abs(log(pXFoil->reinf1/pState->reinf));
+}
+
+
+void CBLStateCache::Store(XFoil *pXFoil)
+{
+	// stores the boundary layer of a converged point
+	// a state at the same point is replaced, otherwise the oldest one
+	int i;
+	if(!pXFoil->lvconv) return;
+
+	EnterCriticalSection(&m_cs);
+	XFoilBLState *pState = NULL;
+	for(i=0; i<m_nStates; i++)
+	{
+		double d = Distance(m_pState[i], pXFoil);
+		if(d>=0.0 && d<1.e-6)
+		{
+			pState = m_pState[i];
+			break;
+		}
+	}
+	if(!pState)
+	{
+		if(m_nStates<MAXBLSTATES)
+		{
+			pState = new XFoilBLState;
+			m_pState[m_nStates++] = pState;
+		}
+		else
+		{
+			pState = m_pState[m_iNext];
+			m_iNext = (m_iNext+1)%MAXBLSTATES;
+		}
+	}
+	pXFoil->GetBLState(pState);
+	LeaveCriticalSection(&m_cs);
+}
+
+
+bool CBLStateCache::Seed(XFoil *pXFoil)
+{
+	// sets the nearest stored boundary layer as the initial guess for the current point
+	// returns false if no state is close enough, in which case pXFoil is left unchanged
+	int i;
+	double d, dmin = SEEDMAXDISTANCE;
+	XFoilBLState *pNearest = NULL;
+
+	EnterCriticalSection(&m_cs);
+	for(i=0; i<m_nStates; i++)
+	{
+		d = Distance(m_pState[i], pXFoil);
+		if(d>=0.0 && d<dmin)
+		{
+			dmin = d;
+			pNearest = m_pState[i];
+		}
+	}
+	if(pNearest) pXFoil->SetBLState(pNearest);
+	LeaveCriticalSection(&m_cs);
+
+	return pNearest!=NULL;
+}
@@ -0,0 +1,55 @@
+/****************************************************************************
+
+    BL State Cache class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+// BLStateCache.h: interface for the CBLStateCache class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "XFoil.h"
+
+#define MAXBLSTATES 100		// max number of boundary layers kept in the cache
+
+// Keeps the converged boundary layers of the previous analyses, so that a new
+// point may be started from its nearest converged neighbour instead of from
+// the inviscid solution. The states of all the polars of a foil are shared,
+// and may be accessed concurrently by the batch analysis workers.
+
+class CBLStateCache
+{
+public:
+	CBLStateCache();
+	~CBLStateCache();
+
+	void Clear();
+	void Store(XFoil *pXFoil);
+	bool Seed(XFoil *pXFoil);
+
+protected:
+	double Distance(XFoilBLState *pState, XFoil *pXFoil);
+
+	XFoilBLState *m_pState[MAXBLSTATES];
+	int m_nStates;
+	int m_iNext;	// the state to replace next once the cache is full
+	CRITICAL_SECTION m_cs;
+};
@@ -553,7 +553,7 @@ bool CBatchDlg::InitXFoil2()
 }
 
 
-void CBatchDlg::UpdateOutput(CString &str)
+void CBatchDlg::UpdateOutput(const CString &str)
 {
 	if(m_bShowTextOutput)
 		m_ctrlOutput.ReplaceSel(str);
@@ -666,12 +666,13 @@ void CBatchDlg::OnCancel()
 	else CDialog::OnCancel();
 }
 
-void CBatchDlg::OutputIter(int iter, double Re, double Alpha)
+void CBatchDlg::OutputIter(XFoil *pXFoil, int iter)
 {
+	// pXFoil is the batch thread's own XFoil object, not the dialog's
 	if(iter){
-		m_RmsGraph.GetCurve(0)->AddPoint(iter, m_pXFoil->rmsbl);
-		m_RmsGraph.GetCurve(1)->AddPoint(iter, m_pXFoil->rmxbl);
-		UpdateGraph(Re, Alpha);
+		m_RmsGraph.GetCurve(0)->AddPoint(iter, pXFoil->rmsbl);
+		m_RmsGraph.GetCurve(1)->AddPoint(iter, pXFoil->rmxbl);
+		UpdateGraph(pXFoil->reinf1, pXFoil->alfa);
 	}
 }
 
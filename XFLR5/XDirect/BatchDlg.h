@@ -97,9 +97,9 @@ private:
 	void Analysis2();
 	void Analysis3();
 	void CleanUp();
-	void UpdateOutput(CString &str);
+	void UpdateOutput(const CString &str);
 	void UpdateGraph(double Re, double Alpha);
-	void OutputIter(int iter, double Re, double Alpha);
+	void OutputIter(XFoil *pXFoil, int iter);
 	void ReadParams();
 	void SetFileHeader();
 	void ResetCurves();
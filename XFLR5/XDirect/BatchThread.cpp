@@ -25,6 +25,7 @@
 #include "../X-FLR5.h"
 #include "BatchThread.h"
 #include "BatchDlg.h"
+#include "AlphaStepper.h"
 #include "../main/MainFrm.h"
 
 /////////////////////////////////////////////////////////////////////////////
@@ -40,6 +41,11 @@ CBatchThread::CBatchThread(CWnd* pParent)
 	m_MachList   = NULL;
 	m_NCritList  = NULL;
 	m_NRe        = 0;
+	m_ppPolar    = NULL;
+	m_PolarLog   = NULL;
+	m_NPolars    = 0;
+	m_nWorkers   = 0;
+	m_pRecovery  = NULL;
 	m_bCancel         = false;
 	m_bType4          = false;
 	m_bInitBL         = false;
@@ -48,6 +54,7 @@ CBatchThread::CBatchThread(CWnd* pParent)
 	m_bFromZero       = false;
 	m_bSkipPoint      = false;
 	m_bSkipPolar      = false;
+	for(int i=0; i<MAXWORKERS; i++) m_pWorkerXFoil[i] = NULL;
 }
 
 CBatchThread::~CBatchThread(){
@@ -73,88 +80,123 @@ END_MESSAGE_MAP()
 /////////////////////////////////////////////////////////////////////////////
 // CBatchThread message handlers
 
-bool CBatchThread::Iterate()
+bool CBatchThread::IsSkipped(int iWorker)
 {
+	return iWorker==0 && (m_bSkipPoint || m_bSkipPolar);
+}
+
+
+void CBatchThread::Output(CString const &str)
+{
+	// the workers write to the dialog box one at a time
+	if(!m_bShowTextOutput) return;
 	CBatchDlg* pBDlg = (CBatchDlg*) m_pParent;
-	CString StrTmp;
+	EnterCriticalSection(&m_csOutput);
+	pBDlg->UpdateOutput(str);
+	LeaveCriticalSection(&m_csOutput);
+}
+
 
-	if(!m_pXFoil->viscal())
+void CBatchThread::Abort(CString const &str)
+{
+	// cancels the batch, and advises the user once, whichever worker has failed first
+	EnterCriticalSection(&m_csOutput);
+	if(!m_bCancel)
 	{
-		m_pXFoil->lvconv = false;//point is unconverged
-		CString str;
-		str.Format("CpCalc: local speed too large \r\n Compressibility corrections invalid \r\n");
-		AfxMessageBox(str, MB_OK); // to advise user that the analysis has failed
 		m_bCancel = true;
+		AfxMessageBox(str, MB_OK);
+	}
+	LeaveCriticalSection(&m_csOutput);
+}
+
+
+bool CBatchThread::Iterate(XFoil *pXFoil, int &Iterations, int iWorker)
+{
+	CBatchDlg* pBDlg = (CBatchDlg*) m_pParent;
+	CString StrTmp;
+
+	//rather than from the inviscid solution, start from the nearest converged point, 
+	//which may have been calculated by another worker for another polar
+	if(!pXFoil->lblini) m_pXDirect->m_BLCache.Seed(pXFoil);
+
+	if(!pXFoil->viscal())
+	{
+		pXFoil->lvconv = false;//point is unconverged
+		// to advise user that the analysis has failed
+		Abort("CpCalc: local speed too large \r\n Compressibility corrections invalid \r\n");
 		return true;
 	}
 
-	while(m_Iterations<m_IterLim && !m_pXFoil->lvconv && !m_bCancel && !m_bSkipPoint && !m_bSkipPolar)
+	while(Iterations<m_IterLim && !pXFoil->lvconv && !m_bCancel && !IsSkipped(iWorker))
 	{
-		if(m_pXFoil->ViscousIter())
+		if(pXFoil->ViscousIter())
 		{
-			m_Iterations++;	
-			pBDlg->OutputIter(m_Iterations, m_pXFoil->reinf1, m_pXFoil->alfa);
+			Iterations++;	
+			//only the point calculated by the batch thread is shown in the dialog box
+			if(iWorker==0)
+			{
+				EnterCriticalSection(&m_csOutput);
+				pBDlg->OutputIter(pXFoil, Iterations);
+				LeaveCriticalSection(&m_csOutput);
+			}
 		}
 		else 
 		{
-			m_Iterations = m_IterLim;
+			Iterations = m_IterLim;
 		}
 	}
-	pBDlg->OutputIter(0, 0.0, 0.0);
 	if(m_bCancel) return true;
 
-	if(m_bSkipPoint || m_bSkipPolar)
+	if(IsSkipped(iWorker))
 	{
-		m_pXFoil->lblini = false;
-		m_pXFoil->lipan = false;
+		pXFoil->lblini = false;
+		pXFoil->lipan = false;
 		return true;
 	}
 	
-	if(!m_pXFoil->ViscalEnd())
+	if(!pXFoil->ViscalEnd())
 	{
-		m_pXFoil->lvconv = false;//point is unconverged
-		CString str;
-		str.Format("CpCalc: local speed too large \r\n Compressibility corrections invalid \r\n");
-		AfxMessageBox(str, MB_OK); // to advise user analysis has failed
-		m_bCancel = true;
-		m_pXFoil->lblini = false;
-		m_pXFoil->lipan  = false;
+		pXFoil->lvconv = false;//point is unconverged
+		// to advise user analysis has failed
+		Abort("CpCalc: local speed too large \r\n Compressibility corrections invalid \r\n");
+		pXFoil->lblini = false;
+		pXFoil->lipan  = false;
 		return true;// to exit loop
 	}
-	m_bCalc = true;
 	
-	if(m_Iterations>=m_IterLim && !m_pXFoil->lvconv)
+	if(Iterations>=m_IterLim && !pXFoil->lvconv)
 	{
 		if(m_pXDirect->m_bAutoInitBL) {
-			m_pXFoil->lblini = false;
-			m_pXFoil->lipan = false;
+			pXFoil->lblini = false;
+			pXFoil->lipan = false;
 		}
-		m_pXFoil->fcpmin();// Is it of any use ?
+		pXFoil->fcpmin();// Is it of any use ?
 		return true;
 	}
-	if(!m_pXFoil->lvconv) {
-		m_pXFoil->fcpmin();// Is it of any use ?
+	if(!pXFoil->lvconv) {
+		pXFoil->fcpmin();// Is it of any use ?
 		return false;
 	}
 	else {//converged at last
-		m_pXFoil->fcpmin();// Is it of any use ?
+		pXFoil->fcpmin();// Is it of any use ?
+		m_pXDirect->m_BLCache.Store(pXFoil);
 		return true;
 	}
 }
 
 
-void CBatchThread::SetPlrName()
+void CBatchThread::SetPlrName(CPolar *pPolar)
 {
 	if(!m_bType4){
-		double R = m_pCurPolar->m_Reynolds/1000000.;
-		m_pCurPolar->m_PlrName.Format("T%d_Re%.2f_M%.2f", m_pCurPolar->m_Type, R, m_pCurPolar->m_Mach);
+		double R = pPolar->m_Reynolds/1000000.;
+		pPolar->m_PlrName.Format("T%d_Re%.2f_M%.2f", pPolar->m_Type, R, pPolar->m_Mach);
 	}
 	else{
-		m_pCurPolar->m_PlrName.Format("T%d_Al%5.2f_M%.2f", m_pCurPolar->m_Type, m_pCurPolar->m_ASpec, m_pCurPolar->m_Mach);
+		pPolar->m_PlrName.Format("T%d_Al%5.2f_M%.2f", pPolar->m_Type, pPolar->m_ASpec, pPolar->m_Mach);
 	}
 	CString str;
-	str.Format("_N%.1f", m_pCurPolar->m_ACrit);
-	m_pCurPolar->m_PlrName += str;
+	str.Format("_N%.1f", pPolar->m_ACrit);
+	pPolar->m_PlrName += str;
 }
 
 
@@ -163,326 +205,651 @@ void CBatchThread::Cancel()
 	m_bCancel = true;
 }
 
+
+void CBatchThread::GetPolarSpec(int iPolar, double &Spec, double &Mach, double &NCrit)
+{
+	// returns the Reynolds number, or the angle of attack for type 4, of polar iPolar
+	Mach  = m_pXFoil->minf1;
+	NCrit = m_pXFoil->acrit;
+	if(m_bType4)
+	{
+		Spec = m_SpMin + iPolar*m_SpInc;
+	}
+	else if(!m_bFromList)
+	{
+		Spec = m_ReMin + iPolar *m_ReInc;
+	}
+	else
+	{
+		Spec  = m_ReList[iPolar];
+		Mach  = m_MachList[iPolar];
+		NCrit = m_NCritList[iPolar];
+	}
+}
+
+
 BOOL CBatchThread::InitInstance()
 {
 	CBatchDlg* pBDlg = (CBatchDlg*) m_pParent;
+	CString strong;
+	double Spec, Mach, NCrit;
+	int i, nWorkers;
 
-	if(!m_bType4) 
-		ReLoop();
-	
-	else AlphaLoop();
+	if(!m_bType4)
+	{
+		if(!m_bFromList) m_NPolars = (int)abs((m_ReMax-m_ReMin)/m_ReInc) + 1;
+		else             m_NPolars = m_NRe;
+	}
+	else m_NPolars = (int)(abs((m_SpMax-m_SpMin)*1.000f/m_SpInc)) + 1;
+
+	// The polars are created here in Re order, or in Alpha order for type 4,
+	// so that they are stored in this order whatever the order in which they are completed
+	m_ppPolar  = new CPolar*[m_NPolars];
+	m_PolarLog = new CString[m_NPolars];
+	for (i=0; i<m_NPolars; i++)
+	{
+		GetPolarSpec(i, Spec, Mach, NCrit);
+		m_ppPolar[i] = CreatePolar(Spec, Mach, NCrit);
+	}
+
+	// each worker runs its polars with its own copy of the XFoil object
+	nWorkers = m_nWorkers;
+	if(nWorkers<=0) nWorkers = CTaskPool::GetProcessorCount();
+	nWorkers = min(nWorkers, m_NPolars);
+	nWorkers = min(nWorkers, MAXWORKERS);
+	for (i=0; i<nWorkers; i++)
+	{
+		m_pWorkerXFoil[i] = new XFoil;
+		*m_pWorkerXFoil[i] = *m_pXFoil;
+		m_pWorkerXFoil[i]->pXFile = NULL;// the log file is only written by this thread
+		m_pWorkerXFoil[i]->m_nWorkers = 1;// the processors are already busy with the other polars
+	}
 
-	CString strong = "Analysis completed";
-	if(m_bShowTextOutput) pBDlg->UpdateOutput(strong);
+	InitializeCriticalSection(&m_csPolar);
+	InitializeCriticalSection(&m_csOutput);
+	CTaskPool::Run(m_NPolars, PolarTask, this, nWorkers, &m_bCancel);
+	if(m_pXDirect->m_bStallRecovery && !m_bCancel && m_StallPoint.GetSize()>0) Recover();
+
+	for (i=0; i<m_NPolars; i++) m_pXFile->WriteString(m_PolarLog[i]);
+	if(m_bCancel) m_pXFile->WriteString("Analysis interrupted\r\n");
+
+	for (i=0; i<MAXWORKERS; i++)
+	{
+		if(m_pWorkerXFoil[i]) delete m_pWorkerXFoil[i];
+		m_pWorkerXFoil[i] = NULL;
+	}
+	m_StallPoint.RemoveAll();
+	delete [] m_ppPolar;
+	delete [] m_PolarLog;
+	m_ppPolar  = NULL;
+	m_PolarLog = NULL;
+
+	if(m_pXDirect->m_bPolar)
+	{
+		m_pXDirect->CreatePolarCurves();
+		m_pXDirect->UpdateView();
+	}
+
+	strong = "Analysis completed";
+	Output(strong);
+	DeleteCriticalSection(&m_csOutput);
+	DeleteCriticalSection(&m_csPolar);
 
 	pBDlg->CleanUp();
 	return FALSE;
 }
 
-bool CBatchThread::ReLoop()
+
+void CBatchThread::PolarTask(int iPolar, int iWorker, void *pParam)
 {
+	CBatchThread *pThread = (CBatchThread*)pParam;
+	if(!pThread->m_bType4) pThread->RePolar(iPolar, iWorker);
+	else                   pThread->AlphaPolar(iPolar, iWorker);
+}
+
+
+bool CBatchThread::RePolar(int iPolar, int iWorker)
+{
+	// calculates the polar iPolar of a type 1, 2 or 3 batch
 	CBatchDlg* pBDlg = (CBatchDlg*) m_pParent;
-	CString str;
-	CString strong = "";
-	CString StrTmp;
+	XFoil *pXFoil  = m_pWorkerXFoil[iWorker];
+	CPolar *pPolar = m_ppPolar[iPolar];
+	CString str, strPoint, strRe;
+	CString &strong = m_PolarLog[iPolar];
+	CAlphaStepper Stepper;
 	double alphadeg, alfa;
-	int ia, iRe, nRe, series, total, MaxSeries;
+	int ia, series, total, MaxSeries, Iterations;
 	double SpMin, SpMax, SpInc;
+	bool bAdaptive = m_bAlpha && m_pXDirect->m_bAdaptiveAlpha;
 
-	if(!m_bFromList) nRe = (int)abs((m_ReMax-m_ReMin)/m_ReInc);
-	else             nRe = m_NRe-1;
+	GetPolarSpec(iPolar, pXFoil->reinf1, pXFoil->minf1, pXFoil->acrit);
 
-	for (iRe=0; iRe<=nRe; iRe++)
+	str.Format("Re = %8.0f\r\n", pXFoil->reinf1);
+	strong+= str;
+	//the points of several polars are output concurrently, so each line recalls its Re
+	strRe.Format("Re = %8.0f   ", pXFoil->reinf1);
+
+	if (m_bFromZero && m_SpMin*m_SpMax<0) 
 	{
-		if(!m_bFromList) m_pXFoil->reinf1 = m_ReMin + iRe *m_ReInc;
-		else
-		{
-			m_pXFoil->reinf1 = m_ReList[iRe];
-			m_pXFoil->minf1  = m_MachList[iRe];
-			m_pXFoil->acrit  = m_NCritList[iRe];
-		}
-		str.Format("Re = %8.0f\r\n", m_pXFoil->reinf1);
-		strong+= str;
-		if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
+		MaxSeries = 2;
+		SpMin = 0.0;
+		SpMax = m_SpMax;
+		SpInc = m_SpInc;
+	}
+	else  
+	{
+		MaxSeries = 1;
+		SpMin = m_SpMin;
+		SpMax = m_SpMax;
+		SpInc = m_SpInc;
+	}
 
-		if (m_bFromZero && m_SpMin*m_SpMax<0) 
-		{
-			MaxSeries = 2;
-			SpMin = 0.0;
-			SpMax = m_SpMax;
-			SpInc = m_SpInc;
-		}
-		else  
+	if(iWorker==0) m_bSkipPolar = false;
+
+	for (series=0; series<MaxSeries;series++)
+	{
+		total = int((SpMax*1.0001-SpMin)/SpInc);//*1.0001 to make sure upper limit is included
+		if (m_bInitBL)
 		{
-			MaxSeries = 1;
-			SpMin = m_SpMin;
-			SpMax = m_SpMax;
-			SpInc = m_SpInc;
+			pXFoil->lblini = false;
+			pXFoil->lipan = false;
 		}
+		if(bAdaptive) Stepper.Init(SpMin, SpMax, SpInc, m_pXDirect->m_AdaptiveDCl, m_pXDirect->m_AdaptiveDCd, m_IterLim);
 
-		m_bSkipPolar = false;
-
-		for (series=0; series<MaxSeries;series++)
+		for (ia=0; bAdaptive || ia<=total; ia++)
 		{
-			total = int((SpMax*1.0001-SpMin)/SpInc);//*1.0001 to make sure upper limit is included
-			CreatePolar(m_pXFoil->reinf1, m_pXFoil->minf1, m_pXFoil->acrit);
-			if (m_bInitBL)
+			if(m_bCancel || (iWorker==0 && m_bSkipPolar)) break;
+			if(iWorker==0)
 			{
-				m_pXFoil->lblini = false;
-				m_pXFoil->lipan = false;
+				EnterCriticalSection(&m_csOutput);
+				pBDlg->ResetCurves();
+				LeaveCriticalSection(&m_csOutput);
 			}
 
-			for (ia=0; ia<=total; ia++)
+			if(m_bAlpha)
 			{
-				pBDlg->ResetCurves();
-				if(!m_bCancel && !m_bSkipPolar)
+				if(!bAdaptive) alfa = SpMin+ia*SpInc;
+				else if(!Stepper.GetNext(alfa)) break;
+				pXFoil->alfa = alfa;
+				pXFoil->lalfa = true;
+				pXFoil->qinf = 1.0;
+				alphadeg = pXFoil->alfa*180./3.141592654;
+				strPoint.Format("Alpha = %9.3f", alphadeg);
+
+				// here we go !
+				if (!pXFoil->specal())
 				{
-					if(m_bAlpha)
-					{
-						alfa = SpMin+ia*SpInc;
-						m_pXFoil->alfa = alfa;
-						m_pXFoil->lalfa = true;
-						m_pXFoil->qinf = 1.0;
-						alphadeg = m_pXFoil->alfa*180./3.141592654;
-						str.Format("Alpha = %9.3f", alphadeg);
-						strong+=str;
-						if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
-
-						// here we go !
-						if (!m_pXFoil->specal())
-						{
-							CString str;
-							str.Format("Invalid Analysis Settings\nCpCalc: local speed too large \n Compressibility corrections invalid ");
-							AfxMessageBox(str, MB_OK);
-							m_bCancel = true;
-							return FALSE;
-						}
-					}
-					else
-					{
-						m_pXFoil->lalfa = false;
-						m_pXFoil->alfa = 0.0;
-						m_pXFoil->qinf = 1.0;
-						m_pXFoil->clspec = SpMin+ia*SpInc;
-						str.Format("Cl = %9.3f", m_pXFoil->clspec);
-						strong+=str;
-						if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
-						if(!m_pXFoil->speccl())
-						{
-							CString str;
-							str.Format("Invalid Analysis Settings\nCpCalc: local speed too large \n Compressibility corrections invalid ");
-							AfxMessageBox(str, MB_OK);
-							m_bCancel = true;
-							return FALSE;
-						}
-					}
-
-					m_pXFoil->lwake = false;
-					m_pXFoil->lvconv = false;
-
-					m_Iterations = 0;
-
-					m_bSkipPoint = false;
-
-					while(!Iterate()){}
-
-					if(m_pXFoil->lvconv)
-					{
-						str.Format("   ...converged after %3d iterations\r\n", m_Iterations);
-						strong+= str;
-						if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
-						m_pCurPolar->AddData(m_pXFoil);
-					}
-					else if(m_bSkipPoint || m_bSkipPolar)
-					{
-						str.Format("   ...skipped after %3d iterations\r\n", m_Iterations);
-						strong+= str;
-						if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
-
-					}
-					else
-					{
-						str.Format("   ...unconverged after %3d iterations\r\n", m_Iterations);
-						strong+= str;
-						if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
-
-					}
-					CXDirect* pXDirect = (CXDirect*)pBDlg->m_pXDirect;
-					if(pXDirect->m_bPolar)
-					{
-						pXDirect->CreatePolarCurves();
-						pXDirect->UpdateView();
-					}
+					Abort("Invalid Analysis Settings\nCpCalc: local speed too large \n Compressibility corrections invalid ");
+					return false;
 				}
-				else
+			}
+			else
+			{
+				pXFoil->lalfa = false;
+				pXFoil->alfa = 0.0;
+				pXFoil->qinf = 1.0;
+				pXFoil->clspec = SpMin+ia*SpInc;
+				strPoint.Format("Cl = %9.3f", pXFoil->clspec);
+				if(!pXFoil->speccl())
 				{
-					break;
+					Abort("Invalid Analysis Settings\nCpCalc: local speed too large \n Compressibility corrections invalid ");
+					return false;
 				}
-			}// end Alpha or Cl loop
-			SpMin = 0;
-			SpMax = m_SpMin;
-			SpInc = -m_SpInc;
-		}
-		strong+="\r\n";
-		if(m_bCancel)
-		{
-			strong+="Analysis interrupted\r\n";
-			break;
-		}
-	}//end Re loop
-	m_pXFile->WriteString(strong);
+			}
+
+			pXFoil->lwake = false;
+			pXFoil->lvconv = false;
+
+			Iterations = 0;
+
+			if(iWorker==0) m_bSkipPoint = false;
+
+			while(!Iterate(pXFoil, Iterations, iWorker)){}
+
+			if(pXFoil->lvconv && bAdaptive && !Stepper.SetResult(true, Iterations, pXFoil->cl, pXFoil->cd))
+			{
+				str.Format("   ...converged after %3d iterations, left out to refine the step\r\n", Iterations);
+			}
+			else if(pXFoil->lvconv)
+			{
+				str.Format("   ...converged after %3d iterations\r\n", Iterations);
+				EnterCriticalSection(&m_csPolar);
+				pPolar->AddData(pXFoil);
+				LeaveCriticalSection(&m_csPolar);
+			}
+			else if(IsSkipped(iWorker))
+			{
+				str.Format("   ...skipped after %3d iterations\r\n", Iterations);
+				if(bAdaptive) Stepper.Skip();
+			}
+			else
+			{
+				str.Format("   ...unconverged after %3d iterations\r\n", Iterations);
+				if(m_bAlpha) AddStallPoint(iPolar, alfa, SpInc);
+				else         AddStallPoint(iPolar, pXFoil->clspec, SpInc);
+				if(bAdaptive)
+				{
+					//the next point restarts from the nearest converged boundary layer
+					Stepper.SetResult(false, Iterations, 0.0, 0.0);
+					pXFoil->lblini = false;
+					pXFoil->lipan  = false;
+				}
+			}
+			strPoint += str;
+			strong   += strPoint;
+			Output(strRe + strPoint);
+
+			if(iWorker==0 && m_pXDirect->m_bPolar)
+			{
+				EnterCriticalSection(&m_csPolar);
+				m_pXDirect->CreatePolarCurves();
+				LeaveCriticalSection(&m_csPolar);
+				EnterCriticalSection(&m_csOutput);
+				m_pXDirect->UpdateView();
+				LeaveCriticalSection(&m_csOutput);
+			}
+		}// end Alpha or Cl loop
+		SpMin = 0;
+		SpMax = m_SpMin;
+		SpInc = -m_SpInc;
+	}
+	strong+="\r\n";
 	return true;
 }
 
-bool CBatchThread::AlphaLoop()
+
+bool CBatchThread::AlphaPolar(int iPolar, int iWorker)
 {
+	// calculates the polar iPolar of a type 4 batch
 	CBatchDlg* pBDlg = (CBatchDlg*) m_pParent;
-	CString str;
-	CString strong = "";
-	CString StrTmp;
-	int iRe, iAlpha, nAlpha;
-	double alphadeg;
-	nAlpha = (int)(abs((m_SpMax-m_SpMin)*1.000f/m_SpInc));//*1.0001 to make sure upper limit is included
-	
-	for (iAlpha=0; iAlpha<=nAlpha; iAlpha++)
+	XFoil *pXFoil  = m_pWorkerXFoil[iWorker];
+	CPolar *pPolar = m_ppPolar[iPolar];
+	CString str, strPoint, strAlpha;
+	CString &strong = m_PolarLog[iPolar];
+	int iRe, total, Iterations;
+	double alphadeg, Mach, NCrit;
+
+	GetPolarSpec(iPolar, alphadeg, Mach, NCrit);
+	pXFoil->alfa = alphadeg*3.141592654/180.0;
+	str.Format("Alpha = %.2f\r\n", alphadeg);
+	strong+= str;
+	//the points of several polars are output concurrently, so each line recalls its alpha
+	strAlpha.Format("Alpha = %.2f   ", alphadeg);
+
+	total = (int)(abs((m_ReMax-m_ReMin)*1.0001/m_ReInc));
+
+	if (m_bInitBL)
 	{
-		alphadeg = m_SpMin + iAlpha*m_SpInc;
-		m_pXFoil->alfa = alphadeg*3.141592654/180.0;
-		str.Format("Alpha = %.2f\r\n", alphadeg);
-		strong+= str;
-		if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
+		pXFoil->lblini = false;
+		pXFoil->lipan = false;
+	}
 
-		int total = (int)(abs((m_ReMax-m_ReMin)*1.0001/m_ReInc));
-		CreatePolar(alphadeg, m_pXFoil->minf1, m_pXFoil->acrit);// Do something
+	if(iWorker==0) m_bSkipPolar = false;
 
-		if (m_bInitBL)
+	for (iRe=0; iRe<=total; iRe++)
+	{
+		if(m_bCancel || (iWorker==0 && m_bSkipPolar)) break;
+		if(iWorker==0)
 		{
-			m_pXFoil->lblini = false;
-			m_pXFoil->lipan = false;
+			EnterCriticalSection(&m_csOutput);
+			pBDlg->ResetCurves();
+			LeaveCriticalSection(&m_csOutput);
 		}
 
-		m_bSkipPolar = false;
+		pXFoil->reinf1 = m_ReMin + iRe *m_ReInc;
+		pXFoil->lalfa  = true;
+		pXFoil->qinf   = 1.0;
+		strPoint.Format("Re = %8.0f", pXFoil->reinf1);
 
-		for (iRe=0; iRe<=total; iRe++)
+		// here we go !
+		if (!pXFoil->specal()) 
 		{
-			pBDlg->ResetCurves();
-			if(!m_bCancel && !m_bSkipPolar)
-			{
-				m_pXFoil->reinf1 = m_ReMin + iRe *m_ReInc;
-				m_pXFoil->lalfa  = true;
-				m_pXFoil->qinf   = 1.0;
-				str.Format("Re = %8.0f", m_pXFoil->reinf1);
-				strong+=str;
-				if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
+			Abort("Invalid Analysis Settings\nCpCalc: local speed too large \n Compressibility corrections invalid ");
+			return false;
+		}
 
-				// here we go !
-				if (!m_pXFoil->specal()) 
-				{
-					CString str;
-					str.Format("Invalid Analysis Settings\nCpCalc: local speed too large \n Compressibility corrections invalid ");
-					AfxMessageBox(str, MB_OK);
-					m_bCancel = true;
-					return FALSE;
-				}
+		pXFoil->lwake  = false;
+		pXFoil->lvconv = false;
+
+		Iterations = 0;
+
+		if(iWorker==0) m_bSkipPoint = false;
+
+		while(!Iterate(pXFoil, Iterations, iWorker)){}
 
-				if (abs(m_pXFoil->alfa-m_pXFoil->awake) > 0.00001) m_pXFoil->lwake  = false;
-				if (abs(m_pXFoil->alfa-m_pXFoil->avisc) > 0.00001) m_pXFoil->lvconv = false;
-				if (abs(m_pXFoil->minf-m_pXFoil->mvisc) > 0.00001) m_pXFoil->lvconv = false;
+		if(pXFoil->lvconv){
+			str.Format("   ...converged after %3d iterations\r\n", Iterations);
+			EnterCriticalSection(&m_csPolar);
+			pPolar->AddData(pXFoil);
+			LeaveCriticalSection(&m_csPolar);
+		}
+		else if(IsSkipped(iWorker)){
+			str.Format("   ...skipped after %3d iterations\r\n", Iterations);
+		}
+		else {
+			str.Format("   ...unconverged after %3d iterations\r\n", Iterations);
+			AddStallPoint(iPolar, pXFoil->reinf1, m_ReInc);
+		}
+		strPoint += str;
+		strong   += strPoint;
+		Output(strAlpha + strPoint);
+	}// end Re loop
+	strong+="\r\n";
+	return true;
+}
 
-				m_pXFoil->lwake  = false;
-				m_pXFoil->lvconv = false;
 
-				m_Iterations = 0;
 
-				m_bSkipPoint = false;
+void CBatchThread::AddStallPoint(int iPolar, double Spec, double Inc)
+{
+	// records an unconverged point, to be retried at the end of the batch
+	BatchStallPoint SP;
+	SP.iPolar = iPolar;
+	SP.Spec   = Spec;
+	SP.Inc    = Inc;
+	EnterCriticalSection(&m_csPolar);
+	m_StallPoint.Add(SP);
+	LeaveCriticalSection(&m_csPolar);
+}
 
-				while(!Iterate()){}
 
-				if(m_pXFoil->lvconv){
-					str.Format("   ...converged after %3d iterations\r\n", m_Iterations);
-					strong+= str;
-					if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
-					m_pCurPolar->AddData(m_pXFoil);
-				}
-				else if(m_bSkipPoint || m_bSkipPolar){
-					str.Format("   ...skipped after %3d iterations\r\n", m_Iterations);
-					strong+= str;
-					if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
+bool CBatchThread::GetNeighbour(int iPolar, double Spec, double Inc, double &Neighbour)
+{
+	// returns the nearest converged point of the polar on the side of Spec+Inc,
+	// or false if there is none within three increments
+	CPolar *pPolar = m_ppPolar[iPolar];
+	double v, d, dmin;
+	bool bFound = false;
+
+	dmin = 3.0*abs(Inc) * 1.0001;
+	for (int i=0; i<pPolar->m_Alpha.GetSize(); i++)
+	{
+		if(m_bType4)     v = pPolar->m_Re[i];
+		else if(m_bAlpha) v = pPolar->m_Alpha[i]*3.141592654/180.0;
+		else             v = pPolar->m_Cl[i];
 
-				}
-				else {
-					str.Format("   ...unconverged after %3d iterations\r\n", m_Iterations);
-					strong+= str;
-					if(m_bShowTextOutput) pBDlg->UpdateOutput(str);
-				}
-			}
-			else {
-				break;
+		if(Inc>0.0) d = v - Spec;
+		else        d = Spec - v;
+		if(d>abs(Inc)*0.01 && d<dmin)
+		{
+			dmin = d;
+			Neighbour = v;
+			bFound = true;
+		}
+	}
+	return bFound;
+}
+
+
+bool CBatchThread::IsRecovered(int iTask)
+{
+	// true if a strategy preferred to that of task iTask has already converged on the same point
+	for (int i=iTask-iTask%NRECOVERY; i<iTask; i++)
+	{
+		if(m_pRecovery[i].bConverged) return true;
+	}
+	return false;
+}
+
+
+bool CBatchThread::SolvePoint(XFoil *pXFoil, double Spec, int IterLim, bool bSeed, int &Iterations, int iTask)
+{
+	// calculates one point of a recovery attempt, from the worker's current boundary layer,
+	// or from the nearest stored one if bSeed is true and the boundary layer is not initialized
+	// returns true if the point has converged
+	int Iter = 0;
+
+	pXFoil->qinf = 1.0;
+	if(m_bType4)
+	{
+		pXFoil->reinf1 = Spec;
+		pXFoil->lalfa  = true;
+	}
+	else if(m_bAlpha)
+	{
+		pXFoil->alfa  = Spec;
+		pXFoil->lalfa = true;
+	}
+	else
+	{
+		pXFoil->lalfa  = false;
+		pXFoil->alfa   = 0.0;
+		pXFoil->clspec = Spec;
+	}
+	if(pXFoil->lalfa) 
+	{
+		if(!pXFoil->specal()) return false;
+	}
+	else if(!pXFoil->speccl()) return false;
+
+	pXFoil->lwake  = false;
+	pXFoil->lvconv = false;
+
+	if(bSeed && !pXFoil->lblini) m_pXDirect->m_BLCache.Seed(pXFoil);
+
+	if(pXFoil->viscal())
+	{
+		while(Iter<IterLim && !pXFoil->lvconv && !m_bCancel && !IsRecovered(iTask))
+		{
+			if(!pXFoil->ViscousIter()) break;
+			Iter++;
+		}
+		if(!pXFoil->ViscalEnd()) pXFoil->lvconv = false;
+	}
+	else pXFoil->lvconv = false;
+	Iterations += Iter;
+
+	pXFoil->fcpmin();
+	if(!pXFoil->lvconv)
+	{
+		pXFoil->lblini = false;
+		pXFoil->lipan  = false;
+		return false;
+	}
+	m_pXDirect->m_BLCache.Store(pXFoil);
+	return true;
+}
+
+
+void CBatchThread::RecoverTask(int iTask, int iWorker, void *pParam)
+{
+	CBatchThread *pThread = (CBatchThread*)pParam;
+	pThread->RecoverPoint(iTask, iWorker);
+}
+
+
+void CBatchThread::RecoverPoint(int iTask, int iWorker)
+{
+	// retries the stall point iTask/NRECOVERY with the strategy iTask%NRECOVERY
+	// the strategies of a point are consecutive tasks, so that they run concurrently
+	BatchStallPoint &SP = m_StallPoint[iTask/NRECOVERY];
+	BatchRecovery &R = m_pRecovery[iTask];
+	XFoil *pXFoil = m_pWorkerXFoil[iWorker];
+	double Spec, Mach, NCrit, From, vaccel;
+	int k, nSteps, Iterations;
+	bool bConverged = false;
+
+	if(IsRecovered(iTask)) return;
+
+	GetPolarSpec(SP.iPolar, Spec, Mach, NCrit);
+	if(m_bType4) pXFoil->alfa   = Spec*3.141592654/180.0;
+	else         pXFoil->reinf1 = Spec;
+	pXFoil->minf1 = Mach;
+	pXFoil->acrit = NCrit;
+	pXFoil->lblini = false;
+	pXFoil->lipan  = false;
+	Iterations = 0;
+
+	switch(iTask%NRECOVERY)
+	{
+		case RECOVERVACCEL:
+		{
+			vaccel = pXFoil->vaccel;
+			pXFoil->vaccel = vaccel/10.0;
+			bConverged = SolvePoint(pXFoil, SP.Spec, m_IterLim, true, Iterations, iTask);
+			pXFoil->vaccel = vaccel;
+			break;
+		}
+		case RECOVERNEIGHBOUR:
+		case RECOVEROPPOSITE:
+		{
+			// the sequence reached the point from the side of Spec-Inc
+			if(iTask%NRECOVERY==RECOVERNEIGHBOUR) bConverged = GetNeighbour(SP.iPolar, SP.Spec, -SP.Inc, From);
+			else                                  bConverged = GetNeighbour(SP.iPolar, SP.Spec,  SP.Inc, From);
+			if(!bConverged) break;
+
+			nSteps = max(1, (int)(2.0*abs((SP.Spec-From)/SP.Inc) + 0.5));
+			for (k=0; k<=nSteps && bConverged; k++)
+			{
+				Spec = From + (SP.Spec-From)*(double)k/(double)nSteps;
+				bConverged = SolvePoint(pXFoil, Spec, m_IterLim, k==0, Iterations, iTask);
 			}
-		}// end Alpha or Cl loop
-		strong+="\r\n";
-		if(m_bCancel){
-			strong+="Analysis interrupted\r\n";
 			break;
 		}
-	}//end Re loop
-	m_pXFile->WriteString(strong);
-	return true;
+		case RECOVERITERLIM:
+		{
+			bConverged = SolvePoint(pXFoil, SP.Spec, 4*m_IterLim, false, Iterations, iTask);
+			break;
+		}
+	}
+
+	if(bConverged)
+	{
+		R.Alpha = pXFoil->alfa*180.0/3.141592654;
+		R.Cd    = pXFoil->cd;
+		R.Cdp   = pXFoil->cdp;
+		R.Cl    = pXFoil->cl;
+		R.Cm    = pXFoil->cm;
+		R.Xtr1  = pXFoil->xoctr[1];
+		R.Xtr2  = pXFoil->xoctr[2];
+		R.HMom  = pXFoil->hmom;
+		R.Cpmn  = pXFoil->cpmn;
+		R.Re    = pXFoil->reinf1;
+		R.XCp   = pXFoil->xcp;
+		R.Iterations = Iterations;
+		R.bConverged = true;
+	}
+
+	// the next task may be for another polar
+	pXFoil->lblini = false;
+	pXFoil->lipan  = false;
 }
 
 
+void CBatchThread::Recover()
+{
+	// retries the unconverged points of the batch with each of the recovery strategies,
+	// and adds to the polars the result of the preferred strategy which has converged
+	static char const *StrategyName[NRECOVERY] = {
+		"reduced VAccel", "restart from the previous point", "approach from the next point", "extended iteration limit"};
+	CString str, strPoint;
+	int i, s, nPoints, nTasks, nWorkers;
+
+	nPoints = (int)m_StallPoint.GetSize();
+	nTasks  = nPoints*NRECOVERY;
+	str.Format("Retrying %d unconverged points\r\n", nPoints);
+	Output(str);
+
+	m_pRecovery = new BatchRecovery[nTasks];
+	for (i=0; i<nTasks; i++) m_pRecovery[i].bConverged = false;
+
+	// a single polar may leave several points, so all the processors are used
+	nWorkers = m_nWorkers;
+	if(nWorkers<=0) nWorkers = CTaskPool::GetProcessorCount();
+	nWorkers = min(nWorkers, nTasks);
+	nWorkers = min(nWorkers, MAXWORKERS);
+	for (i=0; i<nWorkers; i++)
+	{
+		if(m_pWorkerXFoil[i]) continue;
+		m_pWorkerXFoil[i] = new XFoil;
+		*m_pWorkerXFoil[i] = *m_pXFoil;
+		m_pWorkerXFoil[i]->pXFile = NULL;
+		m_pWorkerXFoil[i]->m_nWorkers = 1;
+	}
+
+	CTaskPool::Run(nTasks, RecoverTask, this, nWorkers, &m_bCancel);
 
-void CBatchThread::CreatePolar(double Spec, double Mach, double NCrit)
+	for (i=0; i<nPoints; i++)
+	{
+		BatchStallPoint &SP = m_StallPoint[i];
+		if(m_bType4)      strPoint.Format("Alpha = %.2f   Re = %8.0f", m_ppPolar[SP.iPolar]->m_ASpec, SP.Spec);
+		else if(m_bAlpha) strPoint.Format("Re = %8.0f   Alpha = %9.3f", m_ppPolar[SP.iPolar]->m_Reynolds, SP.Spec*180.0/3.141592654);
+		else              strPoint.Format("Re = %8.0f   Cl = %9.3f", m_ppPolar[SP.iPolar]->m_Reynolds, SP.Spec);
+
+		for (s=0; s<NRECOVERY; s++)
+		{
+			if(m_pRecovery[i*NRECOVERY+s].bConverged) break;
+		}
+		if(s<NRECOVERY)
+		{
+			BatchRecovery &R = m_pRecovery[i*NRECOVERY+s];
+			EnterCriticalSection(&m_csPolar);
+			m_ppPolar[SP.iPolar]->AddPoint(R.Alpha, R.Cd, R.Cdp, R.Cl, R.Cm, R.Xtr1, R.Xtr2, R.HMom, R.Cpmn, R.Re, R.XCp);
+			LeaveCriticalSection(&m_csPolar);
+			str.Format("   ...recovered by %s after %3d iterations\r\n", StrategyName[s], R.Iterations);
+		}
+		else str = "   ...still unconverged\r\n";
+
+		strPoint += str;
+		m_PolarLog[SP.iPolar] += strPoint;
+		Output(strPoint);
+	}
+
+	delete [] m_pRecovery;
+	m_pRecovery = NULL;
+}
+
+
+CPolar* CBatchThread::CreatePolar(double Spec, double Mach, double NCrit)
 {
 	CBatchDlg* pBDlg = (CBatchDlg*) m_pParent;
 	
-	m_pCurPolar = new CPolar(m_pXDirect->m_pFrame);
-	m_pCurPolar->m_FoilName   = pBDlg->m_FoilName;
-	m_pCurPolar->m_bIsVisible = true;
-	m_pCurPolar->m_Type = pBDlg->m_Type;
-	switch (m_pCurPolar->m_Type){
+	CPolar *pCurPolar = new CPolar(m_pXDirect->m_pFrame);
+	pCurPolar->m_FoilName   = pBDlg->m_FoilName;
+	pCurPolar->m_bIsVisible = true;
+	pCurPolar->m_Type = pBDlg->m_Type;
+	switch (pCurPolar->m_Type){
 		case 1:
-			m_pCurPolar->m_MaType = 1;
-			m_pCurPolar->m_ReType = 1;
+			pCurPolar->m_MaType = 1;
+			pCurPolar->m_ReType = 1;
 			break;
 		case 2:
-			m_pCurPolar->m_MaType = 2;
-			m_pCurPolar->m_ReType = 2;
+			pCurPolar->m_MaType = 2;
+			pCurPolar->m_ReType = 2;
 			break;
 		case 3:
-			m_pCurPolar->m_MaType = 1;
-			m_pCurPolar->m_ReType = 3;
+			pCurPolar->m_MaType = 1;
+			pCurPolar->m_ReType = 3;
 			break;
 		case 4:
-			m_pCurPolar->m_MaType = 1;
-			m_pCurPolar->m_ReType = 1;
+			pCurPolar->m_MaType = 1;
+			pCurPolar->m_ReType = 1;
 			break;
 		default:
-			m_pCurPolar->m_ReType = 1;
-			m_pCurPolar->m_MaType = 1;
+			pCurPolar->m_ReType = 1;
+			pCurPolar->m_MaType = 1;
 			break;
 	}
 	if(!m_bType4){
-		m_pCurPolar->m_Reynolds = Spec;
+		pCurPolar->m_Reynolds = Spec;
 	}
 	else{
-		m_pCurPolar->m_ASpec = Spec;
+		pCurPolar->m_ASpec = Spec;
 	}
-	m_pCurPolar->m_Mach  = Mach;
-	m_pCurPolar->m_ACrit = NCrit;
+	pCurPolar->m_Mach  = Mach;
+	pCurPolar->m_ACrit = NCrit;
 
-	m_pCurPolar->m_XTop  = pBDlg->m_XTopTr;
-	m_pCurPolar->m_XBot  = pBDlg->m_XBotTr;
+	pCurPolar->m_XTop  = pBDlg->m_XTopTr;
+	pCurPolar->m_XBot  = pBDlg->m_XBotTr;
 
 	CMainFrame *pFrame = (CMainFrame*)m_pXDirect->m_pFrame;
-	m_pCurPolar->m_Color = pFrame->GetColor(1);
+	pCurPolar->m_Color = pFrame->GetColor(1);
 
-	SetPlrName();
-	CPolar *pPolar = m_pXDirect->GetPolar(m_pCurPolar->m_PlrName);
+	SetPlrName(pCurPolar);
+	CPolar *pPolar = m_pXDirect->GetPolar(pCurPolar->m_PlrName);
 	if(pPolar){
-		delete m_pCurPolar;
-		m_pCurPolar = pPolar;
+		delete pCurPolar;
+		return pPolar;
 	}
-	else m_pCurPolar = m_pXDirect->AddPolar(m_pCurPolar);
+	else return m_pXDirect->AddPolar(pCurPolar);
 }
-
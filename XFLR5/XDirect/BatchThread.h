@@ -25,8 +25,34 @@
 
 
 #include "XDirect.h"
+#include "../misc/TaskPool.h"
+
+#define RECOVERVACCEL    0	// reduced vaccel, from the nearest stored boundary layer
+#define RECOVERNEIGHBOUR 1	// marched in half steps from the nearest converged point before it
+#define RECOVEROPPOSITE  2	// marched in half steps from the nearest converged point beyond it
+#define RECOVERITERLIM   3	// cold start with four times the iteration limit
+#define NRECOVERY        4	// the number of recovery strategies, in order of preference
+
+// An unconverged point of the batch, retried once all the polars have been calculated
+struct BatchStallPoint
+{
+	int iPolar;
+	double Spec;	// alpha in radians or Cl for types 1, 2 and 3, Re for type 4
+	double Inc;		// the sequence's increment, which tells from which side the point was reached
+};
+
+// The result of one recovery strategy for one point
+struct BatchRecovery
+{
+	volatile bool bConverged;
+	int Iterations;
+	double Alpha, Cd, Cdp, Cl, Cm, Xtr1, Xtr2, HMom, Cpmn, Re, XCp;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 // CBatchThread thread
+// The polars of the batch are independent, and are calculated concurrently,
+// each worker of the task pool using its own copy of the XFoil object
 
 class CBatchThread : public CWinThread{
 	friend class CBatchDlg;
@@ -59,18 +85,41 @@ protected:
 
 	DECLARE_MESSAGE_MAP()
 private:
-	bool AlphaLoop();
-	bool Iterate();
-	bool ReLoop();
-	void CreatePolar(double Spec, double Mach, double NCrit);
+	void Abort(CString const &str);
+	void Output(CString const &str);
+	bool AlphaPolar(int iPolar, int iWorker);
+	bool Iterate(XFoil *pXFoil, int &Iterations, int iWorker);
+	bool IsSkipped(int iWorker);
+	bool RePolar(int iPolar, int iWorker);
+	void AddStallPoint(int iPolar, double Spec, double Inc);
+	bool GetNeighbour(int iPolar, double Spec, double Inc, double &Neighbour);
+	bool IsRecovered(int iTask);
+	void Recover();
+	void RecoverPoint(int iTask, int iWorker);
+	bool SolvePoint(XFoil *pXFoil, double Spec, int IterLim, bool bSeed, int &Iterations, int iTask);
+	CPolar* CreatePolar(double Spec, double Mach, double NCrit);
 	void Cancel();
-	void SetPlrName();
+	void GetPolarSpec(int iPolar, double &Spec, double &Mach, double &NCrit);
+	void SetPlrName(CPolar *pPolar);
+
+	static void PolarTask(int iPolar, int iWorker, void *pParam);
+	static void RecoverTask(int iTask, int iWorker, void *pParam);
 
 	CStdioFile *m_pXFile;
 	CWnd*  m_pParent;
-	XFoil* m_pXFoil;
+	XFoil* m_pXFoil;						// the XFoil object initialized by the dialog box, copied to each worker
+	XFoil* m_pWorkerXFoil[MAXWORKERS];	// each worker's own XFoil object
 	CXDirect* m_pXDirect;
-	CPolar* m_pCurPolar;
+
+	CPolar **m_ppPolar;			// the polars of the batch, in Re order, or in Alpha order for type 4
+	CString *m_PolarLog;		// the output of each polar, written to the log file in order at the end
+	int m_NPolars;
+	int m_nWorkers;				// the number of threads, 0 for one per processor
+	CRITICAL_SECTION m_csPolar;	// serializes the updates of the polars' data and curves
+	CRITICAL_SECTION m_csOutput;// serializes the workers' calls to the dialog box and to the view
+
+	CArray<BatchStallPoint, BatchStallPoint&> m_StallPoint;	// the unconverged points, protected by m_csPolar
+	BatchRecovery *m_pRecovery;	// NRECOVERY results for each stall point, during the recovery pass
 
 	double m_SpMin, m_SpMax, m_SpInc;
 	double m_ReMin, m_ReMax, m_ReInc;
@@ -85,17 +134,15 @@ private:
 	bool m_bShowTextOutput;
 	bool m_bType4;
 	bool m_bAlpha;
-	bool m_bCalc;
 	bool m_bAutotDelete;
 	bool m_bCancel;
 	bool m_bFromZero;
 
+	// the skip commands apply to the point shown in the dialog's iteration graph, i.e. to worker 0
 	bool m_bSkipPoint;
 	bool m_bSkipPolar;
 
-	int m_Iterations;
 	int m_IterLim;
 };
 
 /////////////////////////////////////////////////////////////////////////////
-
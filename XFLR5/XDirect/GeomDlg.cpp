@@ -270,9 +270,11 @@ void CGeomDlg::Apply()
 		m_bAppliedX = true;
 	}
 
-	if(m_pXFoil->nb>350) 
+	if(m_pXFoil->nb>IQX-6) 
 	{
-		AfxMessageBox("Panel number cannot exceed 350", MB_OK);
+		CString strong;
+		strong.Format("Panel number cannot exceed %d", IQX-6);
+		AfxMessageBox(strong, MB_OK);
 		//reset everything and retry
 		for (i=0; i< m_pMemFoil->nb; i++){
 			m_pXFoil->x[i+1] = m_pMemFoil->xb[i];
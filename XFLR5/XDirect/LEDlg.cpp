@@ -110,8 +110,10 @@ void CLEDlg::OnApply()
 	m_ctrlBlend.GetValue(m_Blend);
 
 	m_pXFoil->lerad(m_LErfac,m_Blend/100.f);
-	if(m_pXFoil->n>350) {
-		AfxMessageBox("Panel number cannot exceed 350", MB_OK);
+	if(m_pXFoil->n>IQX-6) {
+		CString strong;
+		strong.Format("Panel number cannot exceed %d", IQX-6);
+		AfxMessageBox(strong, MB_OK);
 		//reset everything and retry
 		for (int i=0; i< m_pMemFoil->nb; i++){
 			m_pXFoil->x[i+1] = m_pMemFoil->xb[i] ;
@@ -110,7 +110,7 @@ void CPolar::Copy(CPolar *pPolar)
 	}
 }
 
-void CPolar::Export(CString FileName, int FileType)
+bool CPolar::Export(CString FileName, int FileType)
 {
 	CMainFrame* pFrame = (CMainFrame*)m_pFrame;
 	CStdioFile XFile;
@@ -136,12 +136,13 @@ void CPolar::Export(CString FileName, int FileType)
 		ex->GetErrorMessage(szCause, 255);
 		str = _T("Error exporting polar : ");
 		str += szCause;
-		AfxMessageBox(str);
+		if(pFrame) AfxMessageBox(str);// no message box when run from the command line
 //		ex->Delete();
-		return ;
+		return false;
 	}
 
-	strong ="\n    " + pFrame->m_VersionName + "\n\n";
+	if(pFrame) strong ="\n    " + pFrame->m_VersionName + "\n\n";
+	else       strong ="\n    XFLR5\n\n";
 	XFile.WriteString(strong);
 	strong =" Calculated polar for: ";
 	strong += m_FoilName + "\n\n";
@@ -218,6 +219,7 @@ void CPolar::Export(CString FileName, int FileType)
 	}
 	XFile.WriteString("\n\n");
 	XFile.Close();
+	return true;
 }
 
 
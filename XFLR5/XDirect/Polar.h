@@ -94,7 +94,7 @@ private:
 	
 	void AddData(OpPoint* pOpPoint);
 	void AddData(XFoil* pXFoil);
-	void Export(CString FileName, int FileType);
+	bool Export(CString FileName, int FileType);
 	void ResetPolar();
 	void Copy(CPolar *pPolar);
 
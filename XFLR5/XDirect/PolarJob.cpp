@@ -0,0 +1,550 @@
+/****************************************************************************
+
+    Polar Job class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+//////////////////////////////////////////////////////////////////////
+//
+// PolarJob.cpp: implementation of the CPolarJob class.
+// The job is run by the application when launched with the option
+//		X-FLR6.exe /polars JobFile
+// in which case no window is created. The progress of each polar is
+// written to the file polars.log in the output directory.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "../X-FLR5.h"
+#include "PolarJob.h"
+#include "AlphaStepper.h"
+
+
+CPolarJob::CPolarJob()
+{
+	m_nFoils   = 0;
+	m_nRe      = 0;
+	m_Mach     = 0.0;
+	m_NCrit    = 9.0;
+	m_XTop     = 1.0;
+	m_XBot     = 1.0;
+	m_bAlpha   = true;
+	m_SpMin    = 0.0;
+	m_SpMax    = 10.0;
+	m_SpInc    = 0.5;
+	m_bFromZero = false;
+	m_bAdaptive = false;
+	m_AdaptiveDCl = 0.1;
+	m_AdaptiveDCd = 0.002;
+	m_nPanels  = 0;
+	m_IterLim  = 100;
+	m_FileType = 1;
+	m_nWorkers = 0;
+	m_nFailed  = 0;
+	m_TaskLog  = NULL;
+	m_Output   = "";
+	m_Directory = "";
+	m_strError = "";
+	for(int i=0; i<MAXWORKERS; i++) m_pWorkerXFoil[i] = NULL;
+}
+
+
+CPolarJob::~CPolarJob()
+{
+	for(int i=0; i<MAXWORKERS; i++)
+	{
+		if(m_pWorkerXFoil[i]) delete m_pWorkerXFoil[i];
+	}
+	if(m_TaskLog) delete [] m_TaskLog;
+}
+
+
+static CString JobPath(CString Directory, CString Path)
+{
+	// returns the path relative to the job file's directory, unless it is absolute
+	Path.TrimLeft();
+	Path.TrimRight();
+	if(Path.GetLength()>1 && Path[1]==':')      return Path;
+	if(Path.GetLength()>0 && (Path[0]=='\\' || Path[0]=='/')) return Path;
+	return Directory + Path;
+}
+
+
+bool CPolarJob::Read(CString FileName)
+{
+	CStdioFile XFile;
+	CString Strong, Keyword, Values;
+	double Re[MAXJOBRE];
+	double f1, f2, f3;
+	int pos, res, k, Line;
+
+	if(!XFile.Open(FileName, CFile::modeRead | CFile::typeText))
+	{
+		m_strError = "Could not open the job file " + FileName;
+		return false;
+	}
+	pos = max(FileName.ReverseFind('\\'), FileName.ReverseFind('/'));
+	m_Directory = FileName.Left(pos+1);
+	m_Output    = m_Directory;
+
+	Line = 0;
+	while(XFile.ReadString(Strong))
+	{
+		Line++;
+		pos = Strong.Find("#");
+		if(pos>=0) Strong = Strong.Left(pos);
+		Strong.TrimLeft();
+		Strong.TrimRight();
+		if(Strong.IsEmpty()) continue;
+
+		pos = Strong.Find("=");
+		if(pos<0)
+		{
+			m_strError.Format("Line %d of the job file has no keyword", Line);
+			XFile.Close();
+			return false;
+		}
+		Keyword = Strong.Left(pos);
+		Values  = Strong.Mid(pos+1);
+		Keyword.TrimRight();
+		Keyword.MakeLower();
+		Values.TrimLeft();
+
+		res = 1;
+		if(Keyword=="foil")
+		{
+			if(m_nFoils>=MAXJOBFOILS) res = 0;
+			else m_FoilFile[m_nFoils++] = JobPath(m_Directory, Values);
+		}
+		else if(Keyword=="re")
+		{
+			res = sscanf(Values, "%lf%lf%lf%lf%lf%lf%lf%lf%lf%lf%lf%lf%lf%lf%lf",
+						 Re, Re+1, Re+2, Re+3, Re+4, Re+5, Re+6, Re+7, Re+8, Re+9, Re+10, Re+11, Re+12, Re+13, Re+14);
+			for(k=0; k<res && m_nRe<MAXJOBRE; k++)
+			{
+				if(Re[k]<=0.0) res = 0;
+				else m_Re[m_nRe++] = Re[k];
+			}
+		}
+		else if(Keyword=="mach")     res = sscanf(Values, "%lf", &m_Mach);
+		else if(Keyword=="ncrit")    res = sscanf(Values, "%lf", &m_NCrit);
+		else if(Keyword=="xtrtop")   res = sscanf(Values, "%lf", &m_XTop);
+		else if(Keyword=="xtrbot")   res = sscanf(Values, "%lf", &m_XBot);
+		else if(Keyword=="panels")   res = sscanf(Values, "%d", &m_nPanels);
+		else if(Keyword=="iterlim")  res = sscanf(Values, "%d", &m_IterLim);
+		else if(Keyword=="format")   res = sscanf(Values, "%d", &m_FileType);
+		else if(Keyword=="threads")  res = sscanf(Values, "%d", &m_nWorkers);
+		else if(Keyword=="output")   m_Output = JobPath(m_Directory, Values);
+		else if(Keyword=="fromzero")
+		{
+			res = sscanf(Values, "%d", &k);
+			m_bFromZero = (k!=0);
+		}
+		else if(Keyword=="alpha" || Keyword=="cl")
+		{
+			res = sscanf(Values, "%lf%lf%lf", &f1, &f2, &f3);
+			if(res==3 && abs(f3)>0.0)
+			{
+				m_bAlpha = (Keyword=="alpha");
+				m_SpMin  = f1;
+				m_SpMax  = f2;
+				m_SpInc  = f2>=f1 ? abs(f3) : -abs(f3);
+			}
+			else res = 0;
+		}
+		else if(Keyword=="adaptive")
+		{
+			res = sscanf(Values, "%lf%lf", &f1, &f2);
+			if(res==2)
+			{
+				m_bAdaptive   = true;
+				m_AdaptiveDCl = f1;
+				m_AdaptiveDCd = f2;
+			}
+			else res = 0;
+		}
+		else
+		{
+			m_strError.Format("Unknown keyword \"%s\" on line %d of the job file", Keyword, Line);
+			XFile.Close();
+			return false;
+		}
+
+		if(res<1)
+		{
+			m_strError.Format("Invalid value for \"%s\" on line %d of the job file", Keyword, Line);
+			XFile.Close();
+			return false;
+		}
+	}
+	XFile.Close();
+
+	if(m_nFoils==0 || m_nRe==0)
+	{
+		m_strError = "The job file defines no foil or no Reynolds number";
+		return false;
+	}
+	if(m_nPanels>IQX-6)
+	{
+		m_strError.Format("The number of panels cannot exceed %d", IQX-6);
+		return false;
+	}
+	if(m_Output.Right(1)!="\\" && m_Output.Right(1)!="/") m_Output += "\\";
+	return true;
+}
+
+
+bool CPolarJob::ReadFoil(CString FileName, XFoil *pXFoil, CString &FoilName)
+{
+	// reads the foil's coordinates in XFoil's buffer, counter-clockwise
+	CStdioFile XFile;
+	CString Strong;
+	BOOL bRead;
+	double x, y, area, tmp;
+	int i, ip, nb, pos;
+
+	if(!XFile.Open(FileName, CFile::modeRead | CFile::typeText)) return false;
+
+	//the first line which is not a comment holds the name, unless it holds coordinates
+	do
+	{
+		bRead = XFile.ReadString(Strong);
+	}
+	while(bRead && Strong.Find("#")>=0);
+
+	if(!bRead)
+	{
+		XFile.Close();
+		return false;
+	}
+
+	nb = 0;
+	if(sscanf(Strong, "%lf%lf", &x, &y)==2)
+	{
+		pos = max(FileName.ReverseFind('\\'), FileName.ReverseFind('/'));
+		FoilName = FileName.Mid(pos+1);
+		pos = FoilName.ReverseFind('.');
+		if(pos>0) FoilName = FoilName.Left(pos);
+		nb = 1;
+		pXFoil->xb[nb] = x;
+		pXFoil->yb[nb] = y;
+	}
+	else
+	{
+		FoilName = Strong;
+		FoilName.TrimLeft();
+		FoilName.TrimRight();
+	}
+
+	while(XFile.ReadString(Strong))
+	{
+		if(Strong.Find("#")>=0) continue;
+		if(sscanf(Strong, "%lf%lf", &x, &y)!=2) break;
+		if(nb>=IQX-6)
+		{
+			XFile.Close();
+			return false;
+		}
+		nb++;
+		pXFoil->xb[nb] = x;
+		pXFoil->yb[nb] = y;
+	}
+	XFile.Close();
+	if(nb<=2) return false;
+	pXFoil->nb = nb;
+
+	area = 0.0;
+	for (i=1; i<=nb; i++)
+	{
+		if(i==nb) ip = 1;
+		else      ip = i+1;
+		area += 0.5*(pXFoil->yb[i]+pXFoil->yb[ip])*(pXFoil->xb[i]-pXFoil->xb[ip]);
+	}
+	if(area<0.0)
+	{
+		for (i=1; i<=nb/2; i++)
+		{
+			tmp = pXFoil->xb[i]; pXFoil->xb[i] = pXFoil->xb[nb-i+1]; pXFoil->xb[nb-i+1] = tmp;
+			tmp = pXFoil->yb[i]; pXFoil->yb[i] = pXFoil->yb[nb-i+1]; pXFoil->yb[nb-i+1] = tmp;
+		}
+	}
+	return true;
+}
+
+
+bool CPolarJob::SetFoil(XFoil *pXFoil, int iFoil, CString &FoilName)
+{
+	int i;
+
+	pXFoil->Initialize();
+	if(!ReadFoil(m_FoilFile[iFoil], pXFoil, FoilName)) return false;
+
+	pXFoil->lflap  = false;
+	pXFoil->lbflap = false;
+	if(!pXFoil->Preprocess()) return false;
+
+	if(m_nPanels>0)
+	{
+		pXFoil->npan = m_nPanels;
+		pXFoil->pangen();
+		//the analysis runs on the paneled foil, as for a foil refined in XDirect
+		for (i=1; i<=pXFoil->n; i++)
+		{
+			pXFoil->xb[i] = pXFoil->x[i];
+			pXFoil->yb[i] = pXFoil->y[i];
+		}
+		pXFoil->nb = pXFoil->n;
+		if(!pXFoil->Preprocess()) return false;
+	}
+	return true;
+}
+
+
+bool CPolarJob::Iterate(XFoil *pXFoil, int &Iterations)
+{
+	// converges the current point, and returns true if it has converged
+	Iterations = 0;
+	if(!pXFoil->viscal()) 
+	{
+		pXFoil->lvconv = false;
+	}
+	else
+	{
+		while(Iterations<m_IterLim && !pXFoil->lvconv)
+		{
+			if(!pXFoil->ViscousIter()) break;
+			Iterations++;
+		}
+		if(!pXFoil->ViscalEnd()) pXFoil->lvconv = false;
+	}
+
+	if(!pXFoil->lvconv)
+	{
+		//start the next point from the inviscid solution
+		pXFoil->lblini = false;
+		pXFoil->lipan  = false;
+	}
+	pXFoil->fcpmin();
+	return pXFoil->lvconv;
+}
+
+
+void CPolarJob::PolarTask(int iTask, int iWorker, void *pParam)
+{
+	CPolarJob *pJob = (CPolarJob*)pParam;
+	pJob->RunPolar(iTask, iWorker);
+}
+
+
+void CPolarJob::RunPolar(int iTask, int iWorker)
+{
+	// calculates the polar of foil iTask/m_nRe at the Reynolds number iTask%m_nRe
+	XFoil *pXFoil = m_pWorkerXFoil[iWorker];
+	CString &strong = m_TaskLog[iTask];
+	CString str, FoilName, FileName;
+	CPolar Polar(NULL);
+	CAlphaStepper Stepper;
+	double SpMin, SpMax, SpInc, Spec;
+	int iFoil, iRe, series, MaxSeries, ia, total, Iterations, nPoints;
+	bool bAdaptive = m_bAlpha && m_bAdaptive;
+
+	iFoil = iTask/m_nRe;
+	iRe   = iTask%m_nRe;
+
+	if(!SetFoil(pXFoil, iFoil, FoilName))
+	{
+		strong = "Could not load the foil " + m_FoilFile[iFoil] + "\r\n\r\n";
+		InterlockedIncrement(&m_nFailed);
+		return;
+	}
+
+	pXFoil->pXFile   = NULL;
+	pXFoil->m_bTrace = false;
+	pXFoil->reinf1 = m_Re[iRe];
+	pXFoil->minf1  = m_Mach;
+	pXFoil->retyp  = 1;
+	pXFoil->matyp  = 1;
+	pXFoil->acrit     = m_NCrit;
+	pXFoil->xstrip[1] = m_XTop;
+	pXFoil->xstrip[2] = m_XBot;
+	pXFoil->lalfa  = true;
+	pXFoil->qinf   = 1.0;
+	pXFoil->lvisc  = true;
+	pXFoil->lblini = false;
+	pXFoil->lipan  = false;
+	if(m_Mach>0.0 && !pXFoil->SetMach())
+	{
+		strong = FoilName + " : invalid Mach number\r\n\r\n";
+		InterlockedIncrement(&m_nFailed);
+		return;
+	}
+
+	Polar.m_FoilName = FoilName;
+	Polar.m_Type     = 1;
+	Polar.m_ReType   = 1;
+	Polar.m_MaType   = 1;
+	Polar.m_Reynolds = m_Re[iRe];
+	Polar.m_Mach     = m_Mach;
+	Polar.m_ACrit    = m_NCrit;
+	Polar.m_XTop     = m_XTop;
+	Polar.m_XBot     = m_XBot;
+	Polar.m_PlrName.Format("T1_Re%.2f_M%.2f_N%.1f", m_Re[iRe]/1000000.0, m_Mach, m_NCrit);
+
+	strong.Format("%s   Re = %.0f\r\n", FoilName, m_Re[iRe]);
+
+	if(m_bFromZero && m_SpMin*m_SpMax<0.0)
+	{
+		MaxSeries = 2;
+		SpMin = 0.0;
+	}
+	else
+	{
+		MaxSeries = 1;
+		SpMin = m_SpMin;
+	}
+	SpMax = m_SpMax;
+	SpInc = m_SpInc;
+
+	nPoints = 0;
+	for (series=0; series<MaxSeries; series++)
+	{
+		total = int((SpMax-SpMin)*1.0001/SpInc);//*1.0001 to make sure upper limit is included
+		if(bAdaptive) Stepper.Init(SpMin, SpMax, SpInc, m_AdaptiveDCl, m_AdaptiveDCd, m_IterLim);
+
+		// each series starts from the inviscid solution
+		pXFoil->lblini = false;
+		pXFoil->lipan  = false;
+
+		for (ia=0; bAdaptive || ia<=total; ia++)
+		{
+			if(!bAdaptive) Spec = SpMin + ia*SpInc;
+			else if(!Stepper.GetNext(Spec)) break;
+
+			if(m_bAlpha)
+			{
+				pXFoil->lalfa = true;
+				pXFoil->alfa  = Spec*3.141592654/180.0;
+				pXFoil->qinf  = 1.0;
+				str.Format("   Alpha = %9.3f", Spec);
+				if(!pXFoil->specal()) break;
+			}
+			else
+			{
+				pXFoil->lalfa  = false;
+				pXFoil->alfa   = 0.0;
+				pXFoil->qinf   = 1.0;
+				pXFoil->clspec = Spec;
+				str.Format("   Cl = %9.3f", Spec);
+				if(!pXFoil->speccl()) break;
+			}
+			strong += str;
+
+			pXFoil->lwake  = false;
+			pXFoil->lvconv = false;
+
+			if(Iterate(pXFoil, Iterations))
+			{
+				if(bAdaptive && !Stepper.SetResult(true, Iterations, pXFoil->cl, pXFoil->cd))
+				{
+					str.Format("   ...converged after %3d iterations, left out to refine the step\r\n", Iterations);
+				}
+				else
+				{
+					str.Format("   ...converged after %3d iterations\r\n", Iterations);
+					Polar.AddData(pXFoil);
+					nPoints++;
+				}
+			}
+			else
+			{
+				str.Format("   ...unconverged after %3d iterations\r\n", Iterations);
+				if(bAdaptive) Stepper.SetResult(false, Iterations, 0.0, 0.0);
+			}
+			strong += str;
+		}
+		SpMin = 0.0;
+		SpMax = m_SpMin;
+		SpInc = -m_SpInc;
+	}
+
+	//the foil's name may hold characters which are not allowed in file names
+	str = FoilName;
+	str.Replace('\\', '_');	str.Replace('/', '_');	str.Replace(':', '_');
+	str.Replace('*', '_');	str.Replace('?', '_');	str.Replace('"', '_');
+	str.Replace('<', '_');	str.Replace('>', '_');	str.Replace('|', '_');
+	FileName = m_Output + str + "_" + Polar.m_PlrName;
+	if(m_FileType==1) FileName += ".txt";
+	else              FileName += ".csv";
+	if(!Polar.Export(FileName, m_FileType))
+	{
+		strong += "Could not write the file " + FileName + "\r\n\r\n";
+		InterlockedIncrement(&m_nFailed);
+		return;
+	}
+
+	str.Format("%d points written to ", nPoints);
+	strong += str + FileName + "\r\n\r\n";
+	if(nPoints==0) InterlockedIncrement(&m_nFailed);
+}
+
+
+int CPolarJob::Run()
+{
+	// calculates the polars, and returns the number of polars which could not be calculated
+	CStdioFile XFile;
+	CString strong;
+	int i, nTasks, nWorkers;
+
+	CreateDirectory(m_Output, NULL);
+
+	nTasks    = m_nFoils*m_nRe;
+	m_TaskLog = new CString[nTasks];
+	m_nFailed = 0;
+
+	nWorkers = m_nWorkers;
+	if(nWorkers<=0) nWorkers = CTaskPool::GetProcessorCount();
+	nWorkers = min(nWorkers, nTasks);
+	nWorkers = min(nWorkers, MAXWORKERS);
+	for (i=0; i<nWorkers; i++)
+	{
+		m_pWorkerXFoil[i] = new XFoil;
+		// with a single polar, the processors build its influence matrices instead
+		if(nWorkers>1) m_pWorkerXFoil[i]->m_nWorkers = 1;
+	}
+
+	CTaskPool::Run(nTasks, PolarTask, this, nWorkers);
+
+	if(XFile.Open(m_Output + "polars.log", CFile::modeCreate | CFile::modeWrite | CFile::typeText))
+	{
+		for (i=0; i<nTasks; i++) XFile.WriteString(m_TaskLog[i]);
+		strong.Format("%d polars calculated, %d failed\r\n", nTasks-m_nFailed, m_nFailed);
+		XFile.WriteString(strong);
+		XFile.Close();
+	}
+
+	for (i=0; i<nWorkers; i++)
+	{
+		delete m_pWorkerXFoil[i];
+		m_pWorkerXFoil[i] = NULL;
+	}
+	delete [] m_TaskLog;
+	m_TaskLog = NULL;
+
+	return m_nFailed;
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+
+    Polar Job class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+// PolarJob.h: interface for the CPolarJob class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "XFoil.h"
+#include "Polar.h"
+#include "../misc/TaskPool.h"
+
+#define MAXJOBFOILS  200	// max number of foils in a polar job
+#define MAXJOBRE      30	// max number of Reynolds numbers in a polar job
+
+// Generates the type 1 polars of a set of foils without the user interface.
+// The job is described by a text file of "keyword = values" lines, the foils
+// being read from .dat files and the polars written in the format of CPolar::Export.
+// Each polar, i.e. each foil and Reynolds number, is a task of the pool,
+// calculated with the worker's own XFoil object.
+//
+//	# comment
+//	foil     = naca2412.dat		one line per foil, relative to the job file
+//	re       = 100000 200000 500000
+//	mach     = 0.0
+//	ncrit    = 9.0
+//	xtrtop   = 1.0				forced transition locations
+//	xtrbot   = 1.0
+//	alpha    = -4 12 0.5		min, max and increment, or
+//	cl       = 0 1.2 0.05
+//	fromzero = 1				the sequences start at 0 in both directions
+//	adaptive = 0.1 0.002		adaptive alpha step, with its resolution in Cl and Cd
+//	panels   = 160				repanels the foils, 0 to use the file's points
+//	iterlim  = 100
+//	output   = polars			the directory of the polar files, relative to the job file
+//	format   = 1				1 for text, 2 for csv
+//	threads  = 0				0 for one per processor
+
+class CPolarJob
+{
+public:
+	CPolarJob();
+	~CPolarJob();
+
+	bool Read(CString FileName);
+	int Run();
+
+	CString m_strError;		// the reason why the job could not be read
+
+protected:
+	bool ReadFoil(CString FileName, XFoil *pXFoil, CString &FoilName);
+	bool SetFoil(XFoil *pXFoil, int iFoil, CString &FoilName);
+	bool Iterate(XFoil *pXFoil, int &Iterations);
+	void RunPolar(int iTask, int iWorker);
+
+	static void PolarTask(int iTask, int iWorker, void *pParam);
+
+	CString m_Directory;			// the directory of the job file
+	CString m_FoilFile[MAXJOBFOILS];
+	int m_nFoils;
+	double m_Re[MAXJOBRE];
+	int m_nRe;
+	double m_Mach, m_NCrit, m_XTop, m_XBot;
+	double m_SpMin, m_SpMax, m_SpInc;
+	double m_AdaptiveDCl, m_AdaptiveDCd;
+	bool m_bAlpha, m_bFromZero, m_bAdaptive;
+	int m_nPanels, m_IterLim, m_FileType, m_nWorkers;
+	CString m_Output;
+
+	XFoil *m_pWorkerXFoil[MAXWORKERS];
+	CString *m_TaskLog;		// the output of each task, written to the log file in order at the end
+	volatile LONG m_nFailed;	// the number of polars which could not be calculated
+};
@@ -140,8 +140,10 @@ void CTEGapDlg::OnApply()
 	m_ctrlBlend.GetValue(m_Blend);
 
 	m_pXFoil->tgap(m_Gap/100.0,m_Blend/100.0);
-	if(m_pXFoil->n>350) {
-		AfxMessageBox("Panel number cannot exceed 350", MB_OK);
+	if(m_pXFoil->n>IQX-6) {
+		CString strong;
+		strong.Format("Panel number cannot exceed %d", IQX-6);
+		AfxMessageBox(strong, MB_OK);
 		//reset everything and retry
 		for (int i=0; i< m_pMemFoil->nb; i++){
 			m_pXFoil->x[i+1] = m_pMemFoil->xb[i] ;
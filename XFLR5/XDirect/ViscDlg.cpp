@@ -156,6 +156,10 @@ BOOL CViscDlg::OnInitDialog()
 	
 	m_pIterThread->m_bAutoDelete = false;
 	m_pIterThread->m_bAutoInitBL = pXDirect->m_bAutoInitBL;
+	m_pIterThread->m_bAdaptiveAlpha = pXDirect->m_bAdaptiveAlpha;
+	m_pIterThread->m_AdaptiveDCl    = pXDirect->m_AdaptiveDCl;
+	m_pIterThread->m_AdaptiveDCd    = pXDirect->m_AdaptiveDCd;
+	m_pIterThread->m_pBLCache    = &pXDirect->m_BLCache;
 
 	m_pIterThread->m_IterLim     = m_IterLim;
 	m_pIterThread->ResumeThread();
@@ -46,6 +46,10 @@ CViscThread::CViscThread(CWnd *pParent)
 	m_pParent     = pParent;
 	m_bType4      = false;
 	m_bAutoInitBL = true;
+	m_bAdaptiveAlpha = false;
+	m_AdaptiveDCl = 0.1;
+	m_AdaptiveDCd = 0.002;
+	m_pBLCache = NULL;
 	m_AlphaMin = 0.0;
 	m_AlphaMax = 1.0;
 	m_DeltaAlpha = 0.5;
@@ -125,19 +129,25 @@ bool CViscThread::AlphaLoop()
 	double pi = 3.141592654;
 
 	CViscDlg* pVDlg = (CViscDlg*) m_pParent;
+	CAlphaStepper Stepper;
 	CString str;
 	int ia, total;
+	bool bKeep;
+	bool bAdaptive = pVDlg->m_bAlpha && m_bAdaptiveAlpha;
 
 	if(pVDlg->m_bAlpha) total=int((m_AlphaMax-m_AlphaMin)*1.0001/m_DeltaAlpha);//*1.0001 to make sure upper limit is included
 	else                total=int((m_ClMax-m_ClMin)*1.0001/m_DeltaCl);//*1.0001 to make sure upper limit is included
 
-	for (ia=0; ia<=total; ia++)
+	if(bAdaptive) Stepper.Init(m_AlphaMin, m_AlphaMax, m_DeltaAlpha, m_AdaptiveDCl, m_AdaptiveDCd, m_IterLim);
+
+	for (ia=0; bAdaptive || ia<=total; ia++)
 	{
 		if(!m_bExit)
 		{
 			if(pVDlg->m_bAlpha)
 			{
-				alfa = m_AlphaMin+ia*m_DeltaAlpha;
+				if(!bAdaptive) alfa = m_AlphaMin+ia*m_DeltaAlpha;
+				else if(!Stepper.GetNext(alfa)) break;
 				m_pXFoil->alfa = alfa*pi/180.0;
 				m_pXFoil->lalfa = true;
 				m_pXFoil->qinf = 1.0;
@@ -184,11 +194,25 @@ bool CViscThread::AlphaLoop()
 			m_bSkip = false;
 			while(!Iterate()){}
 
+			bKeep = true;
+			if(bAdaptive)
+			{
+				if(m_pXFoil->lvconv) bKeep = Stepper.SetResult(true, m_Iterations, m_pXFoil->cl, m_pXFoil->cd);
+				else if(m_bSkip)     Stepper.Skip();
+				else
+				{
+					//the next point restarts from the nearest converged boundary layer
+					Stepper.SetResult(false, m_Iterations, 0.0, 0.0);
+					m_pXFoil->lblini = false;
+					m_pXFoil->lipan  = false;
+				}
+				if(!bKeep) m_pXFoil->pXFile->WriteString("Point left out to refine the step\r\n");
+			}
 			
 			pVDlg->ResetCurves();
 			m_Iterations = 0;
 
-			pVDlg->AddOpPoint();// only if converged ???
+			if(bKeep) pVDlg->AddOpPoint();// only if converged ???
 		}
 		else
 		{
@@ -262,6 +286,7 @@ bool CViscThread::Iterate()
 {
 	CViscDlg* pViscDlg = (CViscDlg*)m_pParent;
 	CCurve *pCurve;
+	if(!m_pXFoil->lblini && m_pBLCache) m_pBLCache->Seed(m_pXFoil);
 	if(!m_pXFoil->viscal()){
 		m_pXFoil->lvconv = false;//point is unconverged
 		CString str;
@@ -328,6 +353,7 @@ bool CViscThread::Iterate()
 	}
 	else {//converged at last
 		m_pXFoil->fcpmin();
+		if(m_pBLCache) m_pBLCache->Store(m_pXFoil);
 		return true;
 	}
 }
@@ -27,6 +27,8 @@
  
 
 #include "XFoil.h"
+#include "BLStateCache.h"
+#include "AlphaStepper.h"
 
 /////////////////////////////////////////////////////////////////////////////
 // CViscThread thread
@@ -47,6 +49,10 @@ public:
 	bool m_bFinished;
 	bool m_bSkip, m_bExit, m_bSuspend, m_bCalc;
 	bool m_bAutoInitBL;
+	bool m_bAdaptiveAlpha;					// true if the alpha sequences adapt their step
+	double m_AdaptiveDCl, m_AdaptiveDCd;	// the resolution of the adaptive sequences
+
+	CBLStateCache *m_pBLCache;	// the converged boundary layers of XDirect, may be NULL
 
 	CWnd* m_pParent;
 
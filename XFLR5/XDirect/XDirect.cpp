@@ -166,6 +166,8 @@ CXDirect::CXDirect(CWnd* pWnd)
 	m_bAnimatePlus    = false;
 	m_bBL             = false;
 	m_bAutoInitBL     = true;
+	m_bAdaptiveAlpha  = false;
+	m_bStallRecovery  = true;
 	m_bCpGraph        = true;
 	m_bTransGraph     = false;
 	m_bPolar          = false;
@@ -189,6 +191,8 @@ CXDirect::CXDirect(CWnd* pWnd)
 	m_bViscous        = true;
 
 	m_IterLim   = 100;
+	m_AdaptiveDCl = 0.1;
+	m_AdaptiveDCd = 0.002;
 
 	m_iPlrGraph = 0;
 	m_iPlrView  = 0;
@@ -2312,11 +2316,19 @@ void CXDirect::OnAdvSettings()
 	dlg.m_fVAccel  = m_pXFoil->vaccel;
 	dlg.m_iIterLim = m_IterLim;
 	dlg.m_bAutoInitBL = m_bAutoInitBL;
+	dlg.m_bAdaptiveAlpha = m_bAdaptiveAlpha;
+	dlg.m_AdaptiveDCl    = m_AdaptiveDCl;
+	dlg.m_AdaptiveDCd    = m_AdaptiveDCd;
+	dlg.m_bStallRecovery = m_bStallRecovery;
 
 	if (IDOK == dlg.DoModal()){
 		m_pXFoil->vaccel = dlg.m_fVAccel;
 		m_IterLim        = dlg.m_iIterLim;
 		m_bAutoInitBL    = dlg.m_bAutoInitBL;
+		m_bAdaptiveAlpha = dlg.m_bAdaptiveAlpha;
+		m_AdaptiveDCl    = dlg.m_AdaptiveDCl;
+		m_AdaptiveDCd    = dlg.m_AdaptiveDCd;
+		m_bStallRecovery = dlg.m_bStallRecovery;
 	}	
 }
 
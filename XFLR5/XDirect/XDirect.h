@@ -33,6 +33,7 @@
 #include "./FoilAnalysisDlg.h"
 #include "./ViscDlg.h"
 #include "./Foil.h"
+#include "./BLStateCache.h"
 #include "atlimage.h"
 
 /////////////////////////////////////////////////////////////////////////////
@@ -102,6 +103,8 @@ private:
 	bool m_bShowPanels;		// true if the panels should be displayed on the foil surface
 	bool m_bType1, m_bType2, m_bType3, m_bType4; // filter for polar diplay
 	bool m_bAutoInitBL;		// true if the BL initialization is left to the code's decision
+	bool m_bAdaptiveAlpha;	// true if the viscous alpha sequences adapt their step
+	bool m_bStallRecovery;	// true if the unconverged points of a batch analysis are retried
 	bool m_bTrans;			// true if the user is dragging a view
 	bool m_bTransGraph;		// true if the user is dragging a graph
 	bool m_bFromList;		// true if the batch analysis is based on a list of Re values
@@ -125,6 +128,7 @@ private:
 	int m_iPlrView;			// 0 is all, 1 is single, 2 is two !
 
 	double m_fFoilScale;	// foil display scale
+	double m_AdaptiveDCl, m_AdaptiveDCd;// max Cl and Cd increments between two points of an adaptive sequence
 	double m_ReMax, m_ReInc;// for batch analysis
 	double m_ReList[30];	// for batch analysis
 	double m_MachList[30];	// for batch analysis
@@ -150,6 +154,7 @@ private:
 	Graph* m_pCurGraph;
 
 	CStdioFile m_XFile;		//output file for the analysis
+	CBLStateCache m_BLCache;// converged boundary layers, used to warm start the analyses
 
 	HCURSOR m_hcMove;
 	HCURSOR m_hcCross;
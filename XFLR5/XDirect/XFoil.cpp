@@ -29,9 +29,149 @@
 #include "stdafx.h"
 #include "../X-FLR5.h"
 #include "XFoil.h"
+#include <malloc.h>
+#include <float.h>
+#include <emmintrin.h>
 //using namespace std;//
 
 
+//////////////////////////////////////////////////////////////////////
+// XFoilMatrix
+//////////////////////////////////////////////////////////////////////
+
+XFoilMatrix::XFoilMatrix()
+{
+	m_nRows  = 0;
+	m_nCols  = 0;
+	m_Stride = 0;
+	m_pData  = NULL;
+}
+
+
+XFoilMatrix::XFoilMatrix(XFoilMatrix const &M)
+{
+	m_nRows  = 0;
+	m_nCols  = 0;
+	m_Stride = 0;
+	m_pData  = NULL;
+	*this = M;
+}
+
+
+XFoilMatrix::~XFoilMatrix()
+{
+	Release();
+}
+
+
+XFoilMatrix& XFoilMatrix::operator=(XFoilMatrix const &M)
+{
+	if(this==&M) return *this;
+	if(!M.m_pData) 
+	{
+		Release();
+		return *this;
+	}
+	if(m_nRows!=M.m_nRows || m_nCols!=M.m_nCols)
+	{
+		if(!Allocate(M.m_nRows, M.m_nCols)) return *this;
+	}
+	memcpy(m_pData, M.m_pData, m_nRows*m_Stride*sizeof(double));
+	return *this;
+}
+
+
+bool XFoilMatrix::Allocate(int nRows, int nCols)
+{
+	// allocates a zeroed matrix of nRows x nCols, the indexes starting at 0
+	// each row is padded to an even length, so that all rows are aligned on 16 bytes
+	Release();
+	m_Stride = nCols + (nCols%2);
+	m_pData  = (double*)_aligned_malloc(nRows*m_Stride*sizeof(double), 16);
+	if(!m_pData)
+	{
+		m_Stride = 0;
+		return false;
+	}
+	memset(m_pData, 0, nRows*m_Stride*sizeof(double));
+	m_nRows = nRows;
+	m_nCols = nCols;
+	return true;
+}
+
+
+void XFoilMatrix::Release()
+{
+	if(m_pData) _aligned_free(m_pData);
+	m_pData  = NULL;
+	m_nRows  = 0;
+	m_nCols  = 0;
+	m_Stride = 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// XFoilFactorCache
+//////////////////////////////////////////////////////////////////////
+
+XFoilFactorCache XFoil::s_FactorCache;
+
+
+XFoilFactorCache::XFoilFactorCache()
+{
+	m_nEntries = 0;
+	m_iNext    = 0;
+	InitializeCriticalSection(&m_cs);
+}
+
+
+XFoilFactorCache::~XFoilFactorCache()
+{
+	for(int i=0; i<m_nEntries; i++) delete m_pEntry[i];
+	DeleteCriticalSection(&m_cs);
+}
+
+
+XFoilFactorization* XFoilFactorCache::Find(int n, double qinf, double x[], double y[])
+{
+	// returns the factorization of the panel nodes x[1..n], y[1..n], or NULL
+	// the cache must be locked by the caller
+	for(int i=0; i<m_nEntries; i++)
+	{
+		XFoilFactorization *pF = m_pEntry[i];
+		if(pF->n==n && pF->qinf==qinf &&
+		   memcmp(pF->x+1, x+1, n*sizeof(double))==0 &&
+		   memcmp(pF->y+1, y+1, n*sizeof(double))==0)
+			return pF;
+	}
+	return NULL;
+}
+
+
+XFoilFactorization* XFoilFactorCache::NewEntry()
+{
+	// returns an entry to fill, recycling the oldest one once the cache is full
+	// the cache must be locked by the caller
+	if(m_nEntries<MAXFACTORIZATIONS)
+	{
+		m_pEntry[m_nEntries] = new XFoilFactorization;
+		return m_pEntry[m_nEntries++];
+	}
+	XFoilFactorization *pF = m_pEntry[m_iNext];
+	m_iNext = (m_iNext+1)%MAXFACTORIZATIONS;
+	return pF;
+}
+
+
+void XFoilFactorCache::Clear()
+{
+	// the cache must be locked by the caller
+	for(int i=0; i<m_nEntries; i++) delete m_pEntry[i];
+	m_nEntries = 0;
+	m_iNext    = 0;
+}
+
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -47,6 +187,10 @@ XFoil::XFoil(){
 	
 	// imx   number of complex mapping coefficients  cn
 	m_bTrace = false;
+	m_bFactorCache = true;
+	m_nWorkers = 0;
+	m_pPsiWork = NULL;
+	m_iClosure = 0;
 	pi = 3.141592654;
 	
 	sccon = 5.6  ;
@@ -110,9 +254,9 @@ bool XFoil::abcopy()
 		
 		return false;
 	}
-	else if(nb>IQX-2) {
+	else if(nb>IQX-6) {
 		CString str1, str2;
-		str1.Format("Maximum number of panel nodes  : %d\r\n",IQX-2);
+		str1.Format("Maximum number of panel nodes  : %d\r\n",IQX-6);
 		str2.Format("Number of buffer airfoil points: %d\r\n",nb);
 		str2+="Current airfoil cannot be set\r\n";
 		str2+="Try executing PANE at top level instead";
@@ -171,6 +315,8 @@ bool XFoil::abcopy()
 	lipan = false;
 	lvconv = false;
 //	lscini = false;
+
+	if(!AllocateMatrices()) return false;
 	
 	//   write(*,1200) n
 	// 1200 format(/' current airfoil nodes set from buffer airfoil nodes (', i4,' )')
@@ -410,8 +556,10 @@ bool XFoil::axset(double hk1, double t1, double rt1, double a1,
 	double axa, axa_ax1, axa_ax2;
 	double exn, exn_a1, exn_a2, dax, dax_a1, dax_a2, dax_t1, dax_t2; 
 	double f_arg;//ex arg
-	dampl(hk1, t1, rt1, ax1, ax1_hk1, ax1_t1, ax1_rt1);
-	dampl(hk2, t2, rt2, ax2, ax2_hk2, ax2_t2, ax2_rt2);
+	if(!BatchDampl(hk1, t1, rt1, ax1, ax1_hk1, ax1_t1, ax1_rt1))
+		dampl(hk1, t1, rt1, ax1, ax1_hk1, ax1_t1, ax1_rt1);
+	if(!BatchDampl(hk2, t2, rt2, ax2, ax2_hk2, ax2_t2, ax2_rt2))
+		dampl(hk2, t2, rt2, ax2, ax2_hk2, ax2_t2, ax2_rt2);
 	//---- rms-average version (seems a little better on coarse grids)
 	axsq = 0.5*(ax1*ax1 + ax2*ax2);
 	if(axsq <= 0.0) {
@@ -971,7 +1119,16 @@ bool XFoil::blmid(int ityp){
 		cfm_ms  = 0.0;
 	}
 	else {
-		if(ityp==1) cfl( hka, rta, cfm, cfm_hka, cfm_rta, cfm_ma );
+		int k = m_iClosure;
+		if(k>0 && m_Closures.ityp[k]==ityp
+		   && m_Closures.hka[k]==hka && m_Closures.rta[k]==rta && m_Closures.ma[k]==ma){
+			//----- evaluated by SetClosures
+			cfm     = m_Closures.cfm[k];
+			cfm_hka = m_Closures.cfm_hka[k];
+			cfm_rta = m_Closures.cfm_rta[k];
+			cfm_ma  = m_Closures.cfm_ma[k];
+		}
+		else if(ityp==1) cfl( hka, rta, cfm, cfm_hka, cfm_rta, cfm_ma );
 		else {
 			cft( hka, rta, ma, cfm, cfm_hka, cfm_rta, cfm_ma );
 			cfl( hka, rta, cfml, cfml_hka, cfml_rta, cfml_ma);
@@ -1025,6 +1182,85 @@ bool XFoil::blprv(double xsi, double ami, double cti, double thi,
 
 
 
+//////////////////////////////////////////////////////////////////////
+// Row operations of blsolve on the columns l0..l1 of the vm blocks
+// The rows are contiguous and aligned on 16 bytes, so the columns are
+// processed two at a time with SSE2 if the processor supports it
+//////////////////////////////////////////////////////////////////////
+
+static bool s_bSSE2 = IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE)!=0;
+
+
+static void RowScale(double *y, double a, int l0, int l1)
+{
+	// y = a.y
+	int l = l0;
+	if(s_bSSE2)
+	{
+		if(l%2 && l<=l1) {y[l] = y[l]*a; l++;}
+		__m128d ma = _mm_set1_pd(a);
+		for(; l<l1; l+=2) _mm_store_pd(y+l, _mm_mul_pd(_mm_load_pd(y+l), ma));
+	}
+	for(; l<=l1; l++) y[l] = y[l]*a;
+}
+
+
+static void RowAxpy(double *y, double a, double const *x, int l0, int l1)
+{
+	// y = y - a.x
+	int l = l0;
+	if(s_bSSE2)
+	{
+		if(l%2 && l<=l1) {y[l] = y[l] - a*x[l]; l++;}
+		__m128d ma = _mm_set1_pd(a);
+		for(; l<l1; l+=2) 
+			_mm_store_pd(y+l, _mm_sub_pd(_mm_load_pd(y+l), _mm_mul_pd(ma, _mm_load_pd(x+l))));
+	}
+	for(; l<=l1; l++) y[l] = y[l] - a*x[l];
+}
+
+
+static void RowAxpy2(double *y, double a1, double const *x1, double a2, double const *x2, int l0, int l1)
+{
+	// y = y - (a1.x1 + a2.x2)
+	int l = l0;
+	if(s_bSSE2)
+	{
+		if(l%2 && l<=l1) {y[l] = y[l] - (a1*x1[l] + a2*x2[l]); l++;}
+		__m128d ma1 = _mm_set1_pd(a1);
+		__m128d ma2 = _mm_set1_pd(a2);
+		for(; l<l1; l+=2)
+		{
+			__m128d s = _mm_add_pd(_mm_mul_pd(ma1, _mm_load_pd(x1+l)), _mm_mul_pd(ma2, _mm_load_pd(x2+l)));
+			_mm_store_pd(y+l, _mm_sub_pd(_mm_load_pd(y+l), s));
+		}
+	}
+	for(; l<=l1; l++) y[l] = y[l] - (a1*x1[l] + a2*x2[l]);
+}
+
+
+static void RowAxpy3(double *y, double a1, double const *x1, double a2, double const *x2, 
+					 double a3, double const *x3, int l0, int l1)
+{
+	// y = y - (a1.x1 + a2.x2 + a3.x3)
+	int l = l0;
+	if(s_bSSE2)
+	{
+		if(l%2 && l<=l1) {y[l] = y[l] - (a1*x1[l] + a2*x2[l] + a3*x3[l]); l++;}
+		__m128d ma1 = _mm_set1_pd(a1);
+		__m128d ma2 = _mm_set1_pd(a2);
+		__m128d ma3 = _mm_set1_pd(a3);
+		for(; l<l1; l+=2)
+		{
+			__m128d s = _mm_add_pd(_mm_mul_pd(ma1, _mm_load_pd(x1+l)), _mm_mul_pd(ma2, _mm_load_pd(x2+l)));
+			s = _mm_add_pd(s, _mm_mul_pd(ma3, _mm_load_pd(x3+l)));
+			_mm_store_pd(y+l, _mm_sub_pd(_mm_load_pd(y+l), s));
+		}
+	}
+	for(; l<=l1; l++) y[l] = y[l] - (a1*x1[l] + a2*x2[l] + a3*x3[l]);
+}
+
+
 bool XFoil::blsolve()
 {
 	//-----------------------------------------------------------------
@@ -1047,7 +1283,11 @@ bool XFoil::blsolve()
 	//      s        3x1  re influence vectors
 	//-----------------------------------------------------------------
 	//
-	int iv, kv, ivp, k, l;
+	//     the vm blocks are stored by rows, vm[k][iv][l] being the influence of
+	//     the mass defect of station l on equation k of station iv, so that the
+	//     eliminations below run along contiguous rows
+	//-----------------------------------------------------------------
+	int iv, kv, ivp, k;
 
 	int ivte1 = isys[iblte[1]][1];
 	//
@@ -1060,7 +1300,7 @@ bool XFoil::blsolve()
 		//------ normalize first row
 		double pivot = 1.0 / va[1][1][iv];
 		va[1][2][iv] = va[1][2][iv] * pivot;
-		for (l=iv;l<= nsys;l++) vm[1][l][iv] = vm[1][l][iv]*pivot;
+		RowScale(vm[1][iv], pivot, iv, nsys);
 		vdel[1][1][iv] = vdel[1][1][iv]*pivot;
 		vdel[1][2][iv] = vdel[1][2][iv]*pivot;
 		//
@@ -1068,27 +1308,27 @@ bool XFoil::blsolve()
 		for (k=2; k<= 3; k++){
 			double vtmp = va[k][1][iv];
 			va[k][2][iv] = va[k][2][iv] - vtmp*va[1][2][iv];
-			for (int l=iv; l<=nsys; l++) vm[k][l][iv] = vm[k][l][iv] - vtmp*vm[1][l][iv];
+			RowAxpy(vm[k][iv], vtmp, vm[1][iv], iv, nsys);
 			vdel[k][1][iv] = vdel[k][1][iv] - vtmp*vdel[1][1][iv];
 			vdel[k][2][iv] = vdel[k][2][iv] - vtmp*vdel[1][2][iv];
 		}
 		//
 		//------ normalize second row
 		pivot = 1.0 / va[2][2][iv];
-		for (l=iv; l<= nsys; l++) vm[2][l][iv] = vm[2][l][iv]*pivot;
+		RowScale(vm[2][iv], pivot, iv, nsys);
 		vdel[2][1][iv] = vdel[2][1][iv]*pivot;
 		vdel[2][2][iv] = vdel[2][2][iv]*pivot;
 		//
 		//------ eliminate lower second column in va block
 		k = 3;
 		double vtmp = va[k][2][iv];
-		for (l=iv; l<=nsys; l++) vm[k][l][iv] = vm[k][l][iv] - vtmp*vm[2][l][iv];
+		RowAxpy(vm[k][iv], vtmp, vm[2][iv], iv, nsys);
 		vdel[k][1][iv] = vdel[k][1][iv] - vtmp*vdel[2][1][iv];
 		vdel[k][2][iv] = vdel[k][2][iv] - vtmp*vdel[2][2][iv];
 		
 		//------ normalize third row
 		pivot = 1.0/vm[3][iv][iv];
-		for (l=ivp; l<=nsys; l++) vm[3][l][iv] = vm[3][l][iv]*pivot;
+		RowScale(vm[3][iv], pivot, ivp, nsys);
 		vdel[3][1][iv] = vdel[3][1][iv]*pivot;
 		vdel[3][2][iv] = vdel[3][2][iv]*pivot;
 		//
@@ -1096,10 +1336,8 @@ bool XFoil::blsolve()
 		//------ eliminate upper third column in va block
 		double vtmp1 = vm[1][iv][iv];
 		double vtmp2 = vm[2][iv][iv];
-		for(l=ivp;l<= nsys;l++){
-			vm[1][l][iv] = vm[1][l][iv] - vtmp1*vm[3][l][iv];
-			vm[2][l][iv] = vm[2][l][iv] - vtmp2*vm[3][l][iv];
-		}
+		RowAxpy(vm[1][iv], vtmp1, vm[3][iv], ivp, nsys);
+		RowAxpy(vm[2][iv], vtmp2, vm[3][iv], ivp, nsys);
 		vdel[1][1][iv] = vdel[1][1][iv] - vtmp1*vdel[3][1][iv];
 		vdel[2][1][iv] = vdel[2][1][iv] - vtmp2*vdel[3][1][iv];
 		vdel[1][2][iv] = vdel[1][2][iv] - vtmp1*vdel[3][2][iv];
@@ -1107,7 +1345,7 @@ bool XFoil::blsolve()
 		//
 		//------ eliminate upper second column in va block
 		vtmp = va[1][2][iv];
-		for (l=ivp; l<=nsys;l++) vm[1][l][iv] = vm[1][l][iv] - vtmp*vm[2][l][iv];
+		RowAxpy(vm[1][iv], vtmp, vm[2][iv], ivp, nsys);
 		
 		vdel[1][1][iv] = vdel[1][1][iv] - vtmp*vdel[2][1][iv];
 		vdel[1][2][iv] = vdel[1][2][iv] - vtmp*vdel[2][2][iv];
@@ -1119,9 +1357,8 @@ bool XFoil::blsolve()
 			for (k=1; k<= 3;k++){
 				vtmp1 = vb[k][ 1][ivp];
 				vtmp2 = vb[k][ 2][ivp];
-				double vtmp3 = vm[k][iv][ivp];
-				for(l=ivp; l<= nsys;l++) vm[k][l][ivp] = vm[k][l][ivp]
-					-(vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]+vtmp3*vm[3][l][iv]);
+				double vtmp3 = vm[k][ivp][iv];
+				RowAxpy3(vm[k][ivp], vtmp1, vm[1][iv], vtmp2, vm[2][iv], vtmp3, vm[3][iv], ivp, nsys);
 				vdel[k][1][ivp] = vdel[k][1][ivp]-(vtmp1*vdel[1][1][iv]+vtmp2*vdel[2][1][iv]+ vtmp3*vdel[3][1][iv]);
 				vdel[k][2][ivp] = vdel[k][2][ivp]-(vtmp1*vdel[1][2][iv]+vtmp2*vdel[2][2][iv]+ vtmp3*vdel[3][2][iv]);
 			}
@@ -1133,9 +1370,7 @@ bool XFoil::blsolve()
 				for(k=1;k<=3;k++){
 					vtmp1 = vz[k][1];
 					vtmp2 = vz[k][2];
-					for (l=ivp;l<= nsys;l++){
-						vm[k][l][ivz] = vm[k][l][ivz]-(vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]);
-					}
+					RowAxpy2(vm[k][ivz], vtmp1, vm[1][iv], vtmp2, vm[2][iv], ivp, nsys);
 					vdel[k][1][ivz] = vdel[k][1][ivz]-(vtmp1*vdel[1][1][iv]+ vtmp2*vdel[2][1][iv]);
 					vdel[k][2][ivz] = vdel[k][2][ivz]-(vtmp1*vdel[1][2][iv]+ vtmp2*vdel[2][2][iv]);
 				}
@@ -1145,24 +1380,24 @@ bool XFoil::blsolve()
 				//
 				//====== eliminate lower vm column
 				for(kv=iv+2; kv<= nsys;kv++){
-					vtmp1 = vm[1][iv][kv];
-					vtmp2 = vm[2][iv][kv];
-					double vtmp3 = vm[3][iv][kv];
+					vtmp1 = vm[1][kv][iv];
+					vtmp2 = vm[2][kv][iv];
+					double vtmp3 = vm[3][kv][iv];
 					//
 					if(abs(vtmp1)>vaccel){
-						for(l=ivp;l<= nsys;l++) vm[1][l][kv] = vm[1][l][kv] - vtmp1*vm[3][l][iv];
+						RowAxpy(vm[1][kv], vtmp1, vm[3][iv], ivp, nsys);
 						vdel[1][1][kv] = vdel[1][1][kv] - vtmp1*vdel[3][1][iv];
 						vdel[1][2][kv] = vdel[1][2][kv] - vtmp1*vdel[3][2][iv];
 					}
 					//
 					if(abs(vtmp2)>vaccel) {
-						for (l=ivp;l<=nsys;l++) vm[2][l][kv] = vm[2][l][kv] - vtmp2*vm[3][l][iv];
+						RowAxpy(vm[2][kv], vtmp2, vm[3][iv], ivp, nsys);
 						vdel[2][1][kv] = vdel[2][1][kv] - vtmp2*vdel[3][1][iv];
 						vdel[2][2][kv] = vdel[2][2][kv] - vtmp2*vdel[3][2][iv];
 					}
 					//
 					if(abs(vtmp3)>vaccel) {
-						for(l=ivp;l<=nsys;l++) vm[3][l][kv] = vm[3][l][kv] - vtmp3*vm[3][l][iv];
+						RowAxpy(vm[3][kv], vtmp3, vm[3][iv], ivp, nsys);
 						vdel[3][1][kv] = vdel[3][1][kv] - vtmp3*vdel[3][1][iv];
 						vdel[3][2][kv] = vdel[3][2][kv] - vtmp3*vdel[3][2][iv];
 					}
@@ -1177,15 +1412,15 @@ bool XFoil::blsolve()
 		//------ eliminate upper vm columns
 		double vtmp = vdel[3][1][iv];
 		for (kv=iv-1; kv>=1;kv--){
-			vdel[1][1][kv] = vdel[1][1][kv] - vm[1][iv][kv]*vtmp;
-			vdel[2][1][kv] = vdel[2][1][kv] - vm[2][iv][kv]*vtmp;
-			vdel[3][1][kv] = vdel[3][1][kv] - vm[3][iv][kv]*vtmp;
+			vdel[1][1][kv] = vdel[1][1][kv] - vm[1][kv][iv]*vtmp;
+			vdel[2][1][kv] = vdel[2][1][kv] - vm[2][kv][iv]*vtmp;
+			vdel[3][1][kv] = vdel[3][1][kv] - vm[3][kv][iv]*vtmp;
 		}
 		vtmp = vdel[3][2][iv];
 		for (kv=iv-1; kv>=1;kv--){
-			vdel[1][2][kv] = vdel[1][2][kv] - vm[1][iv][kv]*vtmp;
-			vdel[2][2][kv] = vdel[2][2][kv] - vm[2][iv][kv]*vtmp;
-			vdel[3][2][kv] = vdel[3][2][kv] - vm[3][iv][kv]*vtmp;
+			vdel[1][2][kv] = vdel[1][2][kv] - vm[1][kv][iv]*vtmp;
+			vdel[2][2][kv] = vdel[2][2][kv] - vm[2][kv][iv]*vtmp;
+			vdel[3][2][kv] = vdel[3][2][kv] - vm[3][kv][iv]*vtmp;
 		}
 		//
 	}
@@ -1310,15 +1545,31 @@ bool XFoil::blvar(int ityp){
 	if(ityp==3) hk2 = max(hk2,1.00005);
 	if(ityp!=3) hk2 = max(hk2,1.05000);
 	
+	//---- use the closures evaluated by SetClosures if they are for this station
+	XFoilClosures &C = m_Closures;
+	int k = m_iClosure;
+	bool bBatch = IsBatchStation(ityp);
+
 	//---- density thickness shape parameter     ( h** )
-	hct( hk2, m2, hc2, hc2_hk2, hc2_m2 );
+	if(bBatch) {
+		hc2     = C.hc[k];
+		hc2_hk2 = C.hc_hk[k];
+		hc2_m2  = C.hc_msq[k];
+	}
+	else hct( hk2, m2, hc2, hc2_hk2, hc2_m2 );
 	hc2_u2 = hc2_hk2*hk2_u2 + hc2_m2*m2_u2;
 	hc2_t2 = hc2_hk2*hk2_t2;
 	hc2_d2 = hc2_hk2*hk2_d2;
 	hc2_ms = hc2_hk2*hk2_ms + hc2_m2*m2_ms;
 	
 	//---- set ke thickness shape parameter from  h - h*  correlations
-	if(ityp==1) hsl(hk2, hs2, hs2_hk2, hs2_rt2, hs2_m2 );
+	if(bBatch) {
+		hs2     = C.hs[k];
+		hs2_hk2 = C.hs_hk[k];
+		hs2_rt2 = C.hs_rt[k];
+		hs2_m2  = C.hs_msq[k];
+	}
+	else if(ityp==1) hsl(hk2, hs2, hs2_hk2, hs2_rt2, hs2_m2 );
 	else hst(hk2, rt2, m2, hs2, hs2_hk2, hs2_rt2, hs2_m2 );
 	
 	
@@ -1412,6 +1663,13 @@ bool XFoil::blvar(int ityp){
 		cf2_rt2 = 0.0;
 		cf2_m2  = 0.0;
 	}
+	else if(bBatch) {
+		//----- laminar, or turbulent limited by laminar
+		cf2     = C.cf[k];
+		cf2_hk2 = C.cf_hk[k];
+		cf2_rt2 = C.cf_rt[k];
+		cf2_m2  = C.cf_msq[k];
+	}
 	else{ 
 		if(ityp==1) 
 			//----- laminar
@@ -1441,7 +1699,12 @@ bool XFoil::blvar(int ityp){
 	if(ityp==1) {
 		
 		//----- laminar
-		dil( hk2, rt2, di2, di2_hk2, di2_rt2 );
+		if(bBatch) {
+			di2     = C.di[k];
+			di2_hk2 = C.di_hk[k];
+			di2_rt2 = C.di_rt[k];
+		}
+		else dil( hk2, rt2, di2, di2_hk2, di2_rt2 );
 		
 		di2_u2 = di2_hk2*hk2_u2 + di2_rt2*rt2_u2;
 		di2_t2 = di2_hk2*hk2_t2 + di2_rt2*rt2_t2;
@@ -1455,7 +1718,13 @@ bool XFoil::blvar(int ityp){
 			
 			
 			//----- turbulent wall contribution
-			cft(hk2, rt2, m2, cf2t, cf2t_hk2, cf2t_rt2, cf2t_m2);
+			if(bBatch) {
+				cf2t     = C.cft[k];
+				cf2t_hk2 = C.cft_hk[k];
+				cf2t_rt2 = C.cft_rt[k];
+				cf2t_m2  = C.cft_msq[k];
+			}
+			else cft(hk2, rt2, m2, cf2t, cf2t_hk2, cf2t_rt2, cf2t_m2);
 			cf2t_u2 = cf2t_hk2*hk2_u2 + cf2t_rt2*rt2_u2 + cf2t_m2*m2_u2;
 			cf2t_t2 = cf2t_hk2*hk2_t2 + cf2t_rt2*rt2_t2;
 			cf2t_d2 = cf2t_hk2*hk2_d2;
@@ -1544,7 +1813,12 @@ bool XFoil::blvar(int ityp){
 	}
 	
 	if(ityp==2) {
-		dil( hk2, rt2, di2l, di2l_hk2, di2l_rt2 );
+		if(bBatch) {
+			di2l     = C.di[k];
+			di2l_hk2 = C.di_hk[k];
+			di2l_rt2 = C.di_rt[k];
+		}
+		else dil( hk2, rt2, di2l, di2l_hk2, di2l_rt2 );
 		
 		if(di2l>di2) {
 			//------- laminar cd is greater than turbulent cd -- use laminar
@@ -1561,7 +1835,12 @@ bool XFoil::blvar(int ityp){
 	
 	if(ityp==3) {
 		//------ laminar wake cd
-		dilw( hk2, rt2, di2l, di2l_hk2, di2l_rt2 );
+		if(bBatch) {
+			di2l     = C.di[k];
+			di2l_hk2 = C.di_hk[k];
+			di2l_rt2 = C.di_rt[k];
+		}
+		else dilw( hk2, rt2, di2l, di2l_hk2, di2l_rt2 );
 		if(di2l > di2) {
 			//------- laminar wake cd is greater than turbulent cd -- use laminar
 			//-       (this will only occur for unreasonably small rtheta)
@@ -1688,50 +1967,66 @@ bool XFoil::cdcalc()
 
 bool XFoil::cfl(double hk, double rt, 
 				double &cf, double &cf_hk, double &cf_rt, double &cf_msq){
+	cflBatch(1, &hk, &rt, &cf, &cf_hk, &cf_rt, &cf_msq);
+	return true;
+}
+
+
+void XFoil::cflBatch(int n, double const hk[], double const rt[],
+					 double cf[], double cf_hk[], double cf_rt[], double cf_msq[]){
 	//---- laminar skin friction function  ( cf )    ( from falkner-skan )
-	double tmp;
-	if(hk<5.5) {
-		tmp = (5.5-hk)*(5.5-hk)*(5.5-hk) / (hk+1.0);
-		cf    = ( 0.0727*tmp                      - 0.07       )/rt;
-		cf_hk = ( -.0727*tmp*3.0/(5.5-hk) - 0.0727*tmp/(hk+1.0))/rt;
-	}
-	else{
-		tmp = 1.0 - 1.0/(hk-4.5);
-		cf    = ( 0.015*tmp*tmp      - 0.07  ) / rt;
-		cf_hk = ( 0.015*tmp*2.0/(hk-4.5)/(hk-4.5) ) / rt;
+	double h, tmp;
+	for(int i=0; i<n; i++){
+		h = hk[i];
+		if(h<5.5) {
+			tmp = (5.5-h)*(5.5-h)*(5.5-h) / (h+1.0);
+			cf[i]    = ( 0.0727*tmp                      - 0.07       )/rt[i];
+			cf_hk[i] = ( -.0727*tmp*3.0/(5.5-h) - 0.0727*tmp/(h+1.0))/rt[i];
+		}
+		else{
+			tmp = 1.0 - 1.0/(h-4.5);
+			cf[i]    = ( 0.015*tmp*tmp      - 0.07  ) / rt[i];
+			cf_hk[i] = ( 0.015*tmp*2.0/(h-4.5)/(h-4.5) ) / rt[i];
+		}
+		cf_rt[i] = -cf[i]/rt[i];
+		cf_msq[i] = 0.0;
 	}
-	cf_rt = -cf/rt;
-	cf_msq = 0.0;
-	
-	return true;
 }
 
 
 bool XFoil::cft(double hk, double rt, double msq, double &cf, double &cf_hk, double &cf_rt, double &cf_msq){
+	cftBatch(1, &hk, &rt, &msq, &cf, &cf_hk, &cf_rt, &cf_msq);
+	return true;
+}
+
+
+void XFoil::cftBatch(int n, double const hk[], double const rt[], double const msq[],
+					 double cf[], double cf_hk[], double cf_rt[], double cf_msq[]){
 	double gam =1.4;
-	double gm1, f_arg, fc, grt, gex, thk, cfo;
+	double gm1 = gam - 1.0;
+	double h, f_arg, fc, grt, gex, thk, cfo;
 	
 	//---- turbulent skin friction function  ( cf )    (coles)
-	gm1 = gam - 1.0;
-	fc  = sqrt(1.0 + 0.5*gm1*msq);
-	grt = log(rt/fc);
-	grt = max(grt,3.0);
-	
-	gex = -1.74 - 0.31*hk;
-	
-	f_arg = -1.33*hk;
-	f_arg = max(-20.0, f_arg );
-	
-	thk = tanh(4.0 - hk/0.875);
-	
-	cfo =  0.3*exp(f_arg) * pow((grt/2.3026),gex);
-	cf     = ( cfo  +  0.00011*(thk-1.0) ) / fc;
-	cf_hk  = (-1.33*cfo - 0.31*log(grt/2.3026)*cfo
-		- 0.00011*(1.0-thk*thk) / 0.875    ) / fc;
-	cf_rt  = gex*cfo/(fc*grt) / rt;
-	cf_msq = gex*cfo/(fc*grt) * (-0.25*gm1/fc/fc) - 0.25*gm1*(cf)/fc/fc;
-	
-	return true;
+	for(int i=0; i<n; i++){
+		h   = hk[i];
+		fc  = sqrt(1.0 + 0.5*gm1*msq[i]);
+		grt = log(rt[i]/fc);
+		grt = max(grt,3.0);
+		
+		gex = -1.74 - 0.31*h;
+		
+		f_arg = -1.33*h;
+		f_arg = max(-20.0, f_arg );
+		
+		thk = tanh(4.0 - h/0.875);
+		
+		cfo =  0.3*exp(f_arg) * pow((grt/2.3026),gex);
+		cf[i]     = ( cfo  +  0.00011*(thk-1.0) ) / fc;
+		cf_hk[i]  = (-1.33*cfo - 0.31*log(grt/2.3026)*cfo
+			- 0.00011*(1.0-thk*thk) / 0.875    ) / fc;
+		cf_rt[i]  = gex*cfo/(fc*grt) / rt[i];
+		cf_msq[i] = gex*cfo/(fc*grt) * (-0.25*gm1/fc/fc) - 0.25*gm1*(cf[i])/fc/fc;
+	}
 }
 
 
@@ -2004,80 +2299,85 @@ bool XFoil::dampl(double hk, double th, double rt,
 //            is below the critical rtheta.  transition occurs
 //            when n(x) reaches ncrit (ncrit= 9 is "standard").
 //==============================================================
-  //    implicit real (a-h,m,o-z)
+	damplBatch(1, &hk, &th, &rt, &ax, &ax_hk, &ax_th, &ax_rt);
+	return true;
+}
+
+
+void XFoil::damplBatch(int n, double const hk[], double const th[], double const rt[],
+					   double ax[], double ax_hk[], double ax_th[], double ax_rt[]){
 	double dgr = 0.08;
 
 	double hmi, hmi_hk,aa, aa_hk, bb, bb_hk, grcrit, grc_hk, gr, gr_rt;
 	double rnorm, rn_hk, rn_rt, rfac, rfac_hk, rfac_rt;
 	double rfac_rn, arg_hk,ex, f_arg,	ex_hk;
 	double af, af_hmi, af_hk, dadr, dadr_hk;
-	hmi = 1.0/(hk - 1.0);
-	hmi_hk = -hmi*hmi;
-	
-	//---- log10(critical rth) - h   correlation for falkner-skan profiles
-	aa    = 2.492*pow(hmi,0.43);
-	aa_hk =   (aa/hmi)*0.43 * hmi_hk;
-	bb    = tanh(14.0*hmi - 9.24);
-	bb_hk = (1.0 - bb*bb) * 14.0 * hmi_hk;
-	grcrit = aa    + 0.7*(bb + 1.0);
-	grc_hk = aa_hk + 0.7* bb_hk;
-	gr = log10(rt);
-	gr_rt = 1.0 / (2.3025851*rt);
-	if(gr < grcrit-dgr) {
-		
-		//----- no amplification for rtheta < rcrit
-		ax    = 0.0;
-		ax_hk = 0.0;
-		ax_th = 0.0;
-		ax_rt = 0.0;
-	}
-	else{
-		
-		//----- set steep cubic ramp used to turn on ax smoothly as rtheta 
-		//-     exceeds rcrit (previously, this was done discontinuously).
-		//-     the ramp goes between  -dgr < log10(rtheta/rcrit) < dgr
-		
-		rnorm = (gr - (grcrit-dgr)) / (2.0*dgr);
-		rn_hk =     -  grc_hk       / (2.0*dgr);
-		rn_rt =  gr_rt              / (2.0*dgr);
-		
-		if(rnorm >= 1.0) {
-			rfac    = 1.0;
-			rfac_hk = 0.0;
-			rfac_rt = 0.0;
+	for(int i=0; i<n; i++){
+		hmi = 1.0/(hk[i] - 1.0);
+		hmi_hk = -hmi*hmi;
+		
+		//---- log10(critical rth) - h   correlation for falkner-skan profiles
+		aa    = 2.492*pow(hmi,0.43);
+		aa_hk =   (aa/hmi)*0.43 * hmi_hk;
+		bb    = tanh(14.0*hmi - 9.24);
+		bb_hk = (1.0 - bb*bb) * 14.0 * hmi_hk;
+		grcrit = aa    + 0.7*(bb + 1.0);
+		grc_hk = aa_hk + 0.7* bb_hk;
+		gr = log10(rt[i]);
+		gr_rt = 1.0 / (2.3025851*rt[i]);
+		if(gr < grcrit-dgr) {
+			
+			//----- no amplification for rtheta < rcrit
+			ax[i]    = 0.0;
+			ax_hk[i] = 0.0;
+			ax_th[i] = 0.0;
+			ax_rt[i] = 0.0;
 		}
 		else{
-			rfac    = 3.0*rnorm*rnorm - 2.0*rnorm*rnorm*rnorm;
-			rfac_rn = 6.0*rnorm    - 6.0*rnorm*rnorm;
 			
-			rfac_hk = rfac_rn*rn_hk;
-			rfac_rt = rfac_rn*rn_rt;
+			//----- set steep cubic ramp used to turn on ax smoothly as rtheta 
+			//-     exceeds rcrit (previously, this was done discontinuously).
+			//-     the ramp goes between  -dgr < log10(rtheta/rcrit) < dgr
+			
+			rnorm = (gr - (grcrit-dgr)) / (2.0*dgr);
+			rn_hk =     -  grc_hk       / (2.0*dgr);
+			rn_rt =  gr_rt              / (2.0*dgr);
+			
+			if(rnorm >= 1.0) {
+				rfac    = 1.0;
+				rfac_hk = 0.0;
+				rfac_rt = 0.0;
+			}
+			else{
+				rfac    = 3.0*rnorm*rnorm - 2.0*rnorm*rnorm*rnorm;
+				rfac_rn = 6.0*rnorm    - 6.0*rnorm*rnorm;
+				
+				rfac_hk = rfac_rn*rn_hk;
+				rfac_rt = rfac_rn*rn_rt;
+			}
+			
+			//----- amplification envelope slope correlation for falkner-skan
+			f_arg  = 3.87*hmi    - 2.52;
+			arg_hk = 3.87*hmi_hk;
+			
+			ex    = exp(-f_arg*f_arg);
+			ex_hk = ex * (-2.0*f_arg*arg_hk);
+			
+			dadr    = 0.028*(hk[i]-1.0) - 0.0345*ex;
+			dadr_hk = 0.028           - 0.0345*ex_hk;
+			
+			//----- new m(h) correlation    1 march 91
+			af = -0.05 + 2.7*hmi -  5.5*hmi*hmi + 3.0*hmi*hmi*hmi;
+			af_hmi =      2.7     - 11.0*hmi    + 9.0*hmi*hmi;
+			af_hk = af_hmi*hmi_hk;
+			
+			ax[i]    = (af   *dadr/th[i]                   ) * rfac;
+			ax_hk[i] = (af_hk*dadr/th[i] + af*dadr_hk/th[i]) * rfac
+					 + (af   *dadr/th[i]                   ) * rfac_hk;
+			ax_th[i] = -(ax[i])/th[i];
+			ax_rt[i] =  (af   *dadr/th[i]                  ) * rfac_rt;
 		}
-		
-		//----- amplification envelope slope correlation for falkner-skan
-		f_arg  = 3.87*hmi    - 2.52;
-		arg_hk = 3.87*hmi_hk;
-		
-		ex    = exp(-f_arg*f_arg);
-		ex_hk = ex * (-2.0*f_arg*arg_hk);
-		
-		dadr    = 0.028*(hk-1.0) - 0.0345*ex;
-		dadr_hk = 0.028           - 0.0345*ex_hk;
-		
-		//----- new m(h) correlation    1 march 91
-		af = -0.05 + 2.7*hmi -  5.5*hmi*hmi + 3.0*hmi*hmi*hmi;
-		af_hmi =      2.7     - 11.0*hmi    + 9.0*hmi*hmi;
-		af_hk = af_hmi*hmi_hk;
-		
-		ax    = (af   *dadr/th                ) * rfac;
-		ax_hk = (af_hk*dadr/th + af*dadr_hk/th) * rfac
-			  + (af   *dadr/th                ) * rfac_hk;
-		ax_th = -(ax)/th;
-		ax_rt =  (af   *dadr/th               ) * rfac_rt;
-	
 	}
-	
-	return true;
 }
 
 
@@ -2111,37 +2411,52 @@ double XFoil::deval(double ss, double x[], double xs[], double s[], int n){
 
 
 bool XFoil::dil(double hk, double rt, double &di, double &di_hk, double &di_rt){
+	dilBatch(1, &hk, &rt, &di, &di_hk, &di_rt);
+	return true;
+}
+
+
+void XFoil::dilBatch(int n, double const hk[], double const rt[],
+					 double di[], double di_hk[], double di_rt[]){
 //---- laminar dissipation function  ( 2 cd/h* )     (from falkner-skan)
-	if(hk<4.0) {
-		di    = ( 0.00205   *  pow((4.0-hk),5.5) + 0.207 ) / rt;
-		di_hk = ( -.00205*5.5*pow((4.0-hk),4.5)         ) / rt;
-	}
-	else{
-		double hkb = hk - 4.0;
-		double den = 1.0 + 0.02*hkb*hkb;
-		di    = ( -.0016  *  hkb*hkb  /den   + 0.207              ) / rt;
-		di_hk = ( -.0016*2.0*hkb*(1.0/den - 0.02*hkb*hkb/den/den) ) / rt;
+	double hkb, den;
+	for(int i=0; i<n; i++){
+		if(hk[i]<4.0) {
+			di[i]    = ( 0.00205   *  pow((4.0-hk[i]),5.5) + 0.207 ) / rt[i];
+			di_hk[i] = ( -.00205*5.5*pow((4.0-hk[i]),4.5)         ) / rt[i];
+		}
+		else{
+			hkb = hk[i] - 4.0;
+			den = 1.0 + 0.02*hkb*hkb;
+			di[i]    = ( -.0016  *  hkb*hkb  /den   + 0.207              ) / rt[i];
+			di_hk[i] = ( -.0016*2.0*hkb*(1.0/den - 0.02*hkb*hkb/den/den) ) / rt[i];
+		}
+		di_rt[i] = -(di[i])/rt[i];
 	}
-	di_rt = -(di)/rt;
-	
-	return true;
 }
 
 
 bool XFoil::dilw(double hk, double rt, double &di, double &di_hk, double &di_rt){
+	dilwBatch(1, &hk, &rt, &di, &di_hk, &di_rt);
+	return true;
+}
+
+
+void XFoil::dilwBatch(int n, double const hk[], double const rt[],
+					  double di[], double di_hk[], double di_rt[]){
 	//	double msq = 0.0;
-	double hs, hs_hk, hs_rt, hs_msq;
+	double hs, hs_hk, hs_rt, hs_msq, rcd, rcd_hk;
 
-	hsl(hk, hs, hs_hk, hs_rt, hs_msq);
-	//---- laminar wake dissipation function  ( 2 cd/h* )
-	double rcd    =  1.10 * (1.0 - 1.0/hk)* (1.0 - 1.0/hk) / hk;
-	double rcd_hk = -1.10 * (1.0 - 1.0/hk)*2.0/hk/hk/hk- rcd/hk;
-	
-	di    = 2.0*rcd   /(hs*rt);
-	di_hk = 2.0*rcd_hk/(hs*rt) - ((di)/hs)*hs_hk;
-	di_rt = -(di)/rt         - ((di)/hs)*hs_rt;
-	
-	return true;
+	for(int i=0; i<n; i++){
+		hslBatch(1, hk+i, &hs, &hs_hk, &hs_rt, &hs_msq);
+		//---- laminar wake dissipation function  ( 2 cd/h* )
+		rcd    =  1.10 * (1.0 - 1.0/hk[i])* (1.0 - 1.0/hk[i]) / hk[i];
+		rcd_hk = -1.10 * (1.0 - 1.0/hk[i])*2.0/hk[i]/hk[i]/hk[i]- rcd/hk[i];
+		
+		di[i]    = 2.0*rcd   /(hs*rt[i]);
+		di_hk[i] = 2.0*rcd_hk/(hs*rt[i]) - ((di[i])/hs)*hs_hk;
+		di_rt[i] = -(di[i])/rt[i]        - ((di[i])/hs)*hs_rt;
+	}
 }
 
 
@@ -2272,7 +2587,7 @@ bool XFoil::Gauss(int nn, double z[][6], double r[5]){
 	return true;
 }
 
-bool XFoil::Gauss(int nn, double z[IQX][IQX], double r[IQX]){
+bool XFoil::Gauss(int nn, XFoilMatrix &z, double r[IQX]){
 /*******************************************************
  *                                                     *
  *   solves general nxn system in nn unknowns          *
@@ -2754,9 +3069,12 @@ bool XFoil::ggcalc()
 //     in specal or speccl for specified alpha or cl.
 //--------------------------------------------------------------
 	int i,j, iu;
-	double psi, psi_n, psiinf, res, res1, res2, ag1, ag2;
+	double psi, res, ag1, ag2;
 	double abis, cbis, sbis, ds1, ds2, dsmin;
 	double xbis, ybis, qbis;
+
+	if(!AllocateMatrices()) return false;
+
 	cosa = cos(alfa);
 	sina = sin(alfa);
 
@@ -2775,35 +3093,23 @@ bool XFoil::ggcalc()
 		gamu[i][2] = 0.0;
 	}
 	psio = 0.0;
+
+	if(GetFactorization()){
+		//---- this paneling has already been factored, by this or another XFoil object
+		for (i=1; i<= n; i++){
+			qinvu[i][1] = gamu[i][1];
+			qinvu[i][2] = gamu[i][2];
+		}
+		return true;
+	}
 	
 	//---- set up matrix system for  psi = psio  on airfoil surface.
 	//-    the unknowns are (dgamma)i and dpsio.
-	for (i=1;i<= n;i++){
-		
-		//------ calculate psi and dpsi/dgamma array for current node
-		psilin(i,x[i],y[i],nx[i],ny[i],psi,psi_n,false,true);
-		
-		psiinf = qinf*(cosa*y[i] - sina*x[i]);
-		
-		//------ res1 = psi( 0) - psio
-		//------ res2 = psi(90) - psio
-		res1 =  qinf*y[i];
-		res2 = -qinf*x[i];
-		
-		//------ dres/dgamma
-		for (j=1; j<= n; j++) {
-			aij[i][j] = dzdg[j];
-		}
-		
-		for (j=1; j<= n; j++){
-			bij[i][j] = -dzdm[j];
-		}
-		
-		//------ dres/dpsio
-		aij[i][n+1] = -1.0;
-		
-		gamu[i][1] = -res1;
-		gamu[i][2] = -res2;
+	if(IsMultiThreaded()) RunConcurrently(n, ggRowTask);
+	else{
+		XFoilPsiSens S;
+		InitPsiSens(S);
+		for (i=1;i<= n;i++) ggRow(i, S);
 	}
 	
 	//---- set kutta condition
@@ -2868,7 +3174,7 @@ bool XFoil::ggcalc()
 	}
 	
 	//---- lu-factor coefficient matrix aij
-	ludcmp(n+1,aij,aijpiv);
+	ludcmpBlock(n+1,aij,aijpiv);
 	lqaij = true;
 	
 	//---- solve system for the two vorticity distributions
@@ -2895,7 +3201,81 @@ bool XFoil::ggcalc()
 
 
 
-bool XFoil::baksub(int n, double a[IQX][IQX], int indx[], double b[])
+void XFoil::ggRow(int i, XFoilPsiSens &S)
+{
+	//------ sets the row of node i in the aij and bij matrices
+	int j;
+	double psi, psi_n, res1, res2;
+
+	//------ calculate psi and dpsi/dgamma array for current node
+	psilin(i,x[i],y[i],nx[i],ny[i],psi,psi_n,false,true,S);
+		
+	//------ res1 = psi( 0) - psio
+	//------ res2 = psi(90) - psio
+	res1 =  qinf*y[i];
+	res2 = -qinf*x[i];
+		
+	//------ dres/dgamma
+	for (j=1; j<= n; j++) {
+		aij[i][j] = S.dzdg[j];
+	}
+		
+	for (j=1; j<= n; j++){
+		bij[i][j] = -S.dzdm[j];
+	}
+		
+	//------ dres/dpsio
+	aij[i][n+1] = -1.0;
+		
+	gamu[i][1] = -res1;
+	gamu[i][2] = -res2;
+}
+
+
+void XFoil::ggRowTask(int iTask, int iWorker, void *pParam)
+{
+	XFoil *pXFoil = (XFoil*)pParam;
+	pXFoil->ggRow(iTask+1, pXFoil->m_pPsiWork[iWorker].S);
+}
+
+
+bool XFoil::IsMultiThreaded()
+{
+	// the threads are only worth their start-up cost for the larger panel counts
+	if(m_nWorkers==1 || n<XFOILMTPANELS) return false;
+	return m_nWorkers>1 || CTaskPool::GetProcessorCount()>1;
+}
+
+
+void XFoil::RunConcurrently(int nTasks, TASKPROC pTaskProc)
+{
+	// runs the row or column tasks of the inviscid matrices on m_nWorkers threads,
+	// each with its own psilin vectors
+	int k, nWorkers;
+	nWorkers = m_nWorkers;
+	if(nWorkers<=0) nWorkers = CTaskPool::GetProcessorCount();
+	nWorkers = min(nWorkers, MAXWORKERS);
+
+	m_pPsiWork = new XFoilPsiWork[nWorkers];
+	for(k=0; k<nWorkers; k++)
+	{
+		XFoilPsiWork *pW = m_pPsiWork+k;
+		InitPsiSens(pW->S);
+		pW->S.dzdg = pW->dzdg;
+		pW->S.dzdn = pW->dzdn;
+		pW->S.dqdg = pW->dqdg;
+		pW->S.dzdm = pW->dzdm;
+		pW->S.dqdm = pW->dqdm;
+	}
+
+	CTaskPool::Run(nTasks, pTaskProc, this, nWorkers);
+
+	delete [] m_pPsiWork;
+	m_pPsiWork = NULL;
+}
+
+
+bool XFoil::baksub(int n, XFoilMatrix &a, int indx[], double b[])
 {
 	double sum;
 	int i, ii, ll, j;
@@ -2926,14 +3306,22 @@ bool XFoil::baksub(int n, double a[IQX][IQX], int indx[], double b[])
 
 bool XFoil::hct(double hk, double msq, double &hc, double &hc_hk, double &hc_msq)
 {
-//---- density shape parameter    (from whitfield)
-	hc     = msq * (0.064/(hk-0.8) + 0.251);
-	hc_hk  = msq * (-.064/(hk-0.8)/(hk-0.8));
-	hc_msq =        0.064/(hk-0.8) + 0.251;
-	
+	hctBatch(1, &hk, &msq, &hc, &hc_hk, &hc_msq);
 	return true;
 }
 
+
+void XFoil::hctBatch(int n, double const hk[], double const msq[],
+					 double hc[], double hc_hk[], double hc_msq[])
+{
+//---- density shape parameter    (from whitfield)
+	for(int i=0; i<n; i++){
+		hc[i]     = msq[i] * (0.064/(hk[i]-0.8) + 0.251);
+		hc_hk[i]  = msq[i] * (-.064/(hk[i]-0.8)/(hk[i]-0.8));
+		hc_msq[i] =           0.064/(hk[i]-0.8) + 0.251;
+	}
+}
+
 void XFoil::hipnt(double chpnt, double thpnt)
 {
 //      dimension rinput(*)
@@ -3069,111 +3457,136 @@ void XFoil::hipnt(double chpnt, double thpnt)
 }
 
 bool XFoil::hkin(double h, double msq, double &hk, double &hk_h, double &hk_msq){
+	hkinBatch(1, &h, &msq, &hk, &hk_h, &hk_msq);
+	return true;
+}
+
+
+void XFoil::hkinBatch(int n, double const h[], double const msq[],
+					  double hk[], double hk_h[], double hk_msq[]){
 	//---- calculate kinematic shape parameter (assuming air)
 	//     (from Whitfield )
-	hk     =    (h - 0.29*msq)   /(1.0 + 0.113*msq);
-	hk_h   =     1.0              /(1.0 + 0.113*msq);
-	hk_msq = (-.29 - 0.113*(hk))/(1.0 + 0.113*msq);
-	
-	return true;
+	for(int i=0; i<n; i++){
+		hk[i]     =    (h[i] - 0.29*msq[i]) /(1.0 + 0.113*msq[i]);
+		hk_h[i]   =     1.0                 /(1.0 + 0.113*msq[i]);
+		hk_msq[i] = (-.29 - 0.113*(hk[i]))  /(1.0 + 0.113*msq[i]);
+	}
 }
 
 
 bool XFoil::hsl(double hk, double &hs, 
 				double &hs_hk, double &hs_rt, double &hs_msq){
+	hslBatch(1, &hk, &hs, &hs_hk, &hs_rt, &hs_msq);
+	return true;
+}
+
+
+void XFoil::hslBatch(int n, double const hk[], double hs[],
+					 double hs_hk[], double hs_rt[], double hs_msq[]){
 //---- laminar hs correlation
-	if(hk<4.35) {
-		double tmp = hk - 4.35;
-		hs    = 0.0111*tmp*tmp/(hk+1.0)
-			- 0.0278*tmp*tmp*tmp/(hk+1.0)  + 1.528
-			- 0.0002*(tmp*hk)*(tmp*hk);
-		hs_hk = 0.0111*(2.0*tmp    - tmp*tmp/(hk+1.0))/(hk+1.0)
-			- 0.0278*(3.0*tmp*tmp - tmp*tmp*tmp/(hk+1.0))/(hk+1.0)
-			- 0.0002*2.0*tmp*hk * (tmp + hk);
-	}
-	else{
-		hs    = 0.015*    (hk-4.35)*(hk-4.35)/hk + 1.528;
-		hs_hk = 0.015*2.0*(hk-4.35)   /hk
-		- 0.015*    (hk-4.35)* (hk-4.35)/hk/hk;
+	double h, tmp;
+	for(int i=0; i<n; i++){
+		h = hk[i];
+		if(h<4.35) {
+			tmp = h - 4.35;
+			hs[i]    = 0.0111*tmp*tmp/(h+1.0)
+				- 0.0278*tmp*tmp*tmp/(h+1.0)  + 1.528
+				- 0.0002*(tmp*h)*(tmp*h);
+			hs_hk[i] = 0.0111*(2.0*tmp    - tmp*tmp/(h+1.0))/(h+1.0)
+				- 0.0278*(3.0*tmp*tmp - tmp*tmp*tmp/(h+1.0))/(h+1.0)
+				- 0.0002*2.0*tmp*h * (tmp + h);
+		}
+		else{
+			hs[i]    = 0.015*    (h-4.35)*(h-4.35)/h + 1.528;
+			hs_hk[i] = 0.015*2.0*(h-4.35)   /h
+			- 0.015*    (h-4.35)* (h-4.35)/h/h;
+		}
+		
+		hs_rt[i]  = 0.0;
+		hs_msq[i] = 0.0;
 	}
-	
-	hs_rt  = 0.0;
-	hs_msq = 0.0;
-	
-	return true;
 }
 
 
 
 bool XFoil::hst(double hk, double rt, double msq,
 				double &hs, double &hs_hk, double &hs_rt, double &hs_msq){
+	hstBatch(1, &hk, &rt, &msq, &hs, &hs_hk, &hs_rt, &hs_msq);
+	return true;
+}
+
+
+void XFoil::hstBatch(int n, double const hk[], double const rt[], double const msq[],
+					 double hs[], double hs_hk[], double hs_rt[], double hs_msq[]){
 //---- turbulent hs correlation
      
 	double hsmin = 1.5;
 	double dhsinf = 0.015;
-	double rtz, rtz_rt, ho, ho_rt;
+	double h, r, rtz, rtz_rt, ho, ho_rt, fm;
+	double hr, hr_hk, hr_rt, grt, hdif, rtmp, htmp, htmp_hk, htmp_rt;
 
+	for(int i=0; i<n; i++){
+		h = hk[i];
+		r = rt[i];
 //---- ###  12/4/94
 //---- limited rtheta dependence for rtheta < 200
 
-	if(rt>400.0) {
-		ho    = 3.0 + 400.0/rt;
-		ho_rt =      - 400.0/rt/rt;
-	}
-	else{
-		ho    = 4.0;
-		ho_rt = 0.0;
-	}
-	
-	if(rt>200.0) {
-		rtz    = rt;
-		rtz_rt = 1.0;
-	}
-	else{
-		rtz    = 200.0;
-		rtz_rt = 0.0;
-	}
-
-	if(hk<ho) {
-		//----- attached branch
-		//----- new correlation  29 nov 91
-		//-     (from  arctan(y+) + schlichting  profiles)
-		double hr    =   (ho - hk)/(ho-1.0);
-		double hr_hk =      - 1.0/(ho-1.0);
-		double hr_rt = (1.0 - hr)/(ho-1.0) * ho_rt;
-		hs    = (2.0-hsmin-4.0/rtz)*hr*hr  * 1.5/(hk+0.5) + hsmin
-			+ 4.0/rtz;
-		hs_hk =-(2.0-hsmin-4.0/rtz)*hr*hr  * 1.5/(hk+0.5)/(hk+0.5)
-			+ (2.0-hsmin-4.0/rtz)*hr*2.0 * 1.5/(hk+0.5) * hr_hk;
-		hs_rt = (2.0-hsmin-4.0/rtz)*hr*2.0 * 1.5/(hk+0.5) * hr_rt
-			+ (hr*hr * 1.5/(hk+0.5) - 1.0)*4.0/rtz/rtz * rtz_rt;
-	}
-	else{
-		
-		//----- separated branch
-		double grt = log(rtz);
-		double hdif = hk - ho ;
-		double rtmp = hk - ho + 4.0/grt;
-		double htmp    = 0.007*grt/rtmp/rtmp + dhsinf/hk;
-		double htmp_hk = -.014*grt/rtmp/rtmp/rtmp - dhsinf/hk/hk;
-		double htmp_rt = -.014*grt/rtmp/rtmp/rtmp * (-ho_rt - 4.0/grt/grt/rtz * rtz_rt)
-						+ 0.007  /rtmp/rtmp / rtz * rtz_rt;
-		hs    = hdif*hdif * htmp + hsmin + 4.0/rtz;
-		hs_hk = hdif*2.0* htmp + hdif*hdif * htmp_hk;
-		hs_rt = hdif*hdif * htmp_rt      - 4.0/rtz/rtz * rtz_rt
-			    + hdif*2.0* htmp * (-ho_rt);
+		if(r>400.0) {
+			ho    = 3.0 + 400.0/r;
+			ho_rt =      - 400.0/r/r;
+		}
+		else{
+			ho    = 4.0;
+			ho_rt = 0.0;
+		}
 		
-	}
+		if(r>200.0) {
+			rtz    = r;
+			rtz_rt = 1.0;
+		}
+		else{
+			rtz    = 200.0;
+			rtz_rt = 0.0;
+		}
+
+		if(h<ho) {
+			//----- attached branch
+			//----- new correlation  29 nov 91
+			//-     (from  arctan(y+) + schlichting  profiles)
+			hr    =   (ho - h)/(ho-1.0);
+			hr_hk =      - 1.0/(ho-1.0);
+			hr_rt = (1.0 - hr)/(ho-1.0) * ho_rt;
+			hs[i]    = (2.0-hsmin-4.0/rtz)*hr*hr  * 1.5/(h+0.5) + hsmin
+				+ 4.0/rtz;
+			hs_hk[i] =-(2.0-hsmin-4.0/rtz)*hr*hr  * 1.5/(h+0.5)/(h+0.5)
+				+ (2.0-hsmin-4.0/rtz)*hr*2.0 * 1.5/(h+0.5) * hr_hk;
+			hs_rt[i] = (2.0-hsmin-4.0/rtz)*hr*2.0 * 1.5/(h+0.5) * hr_rt
+				+ (hr*hr * 1.5/(h+0.5) - 1.0)*4.0/rtz/rtz * rtz_rt;
+		}
+		else{
+			
+			//----- separated branch
+			grt = log(rtz);
+			hdif = h - ho ;
+			rtmp = h - ho + 4.0/grt;
+			htmp    = 0.007*grt/rtmp/rtmp + dhsinf/h;
+			htmp_hk = -.014*grt/rtmp/rtmp/rtmp - dhsinf/h/h;
+			htmp_rt = -.014*grt/rtmp/rtmp/rtmp * (-ho_rt - 4.0/grt/grt/rtz * rtz_rt)
+							+ 0.007  /rtmp/rtmp / rtz * rtz_rt;
+			hs[i]    = hdif*hdif * htmp + hsmin + 4.0/rtz;
+			hs_hk[i] = hdif*2.0* htmp + hdif*hdif * htmp_hk;
+			hs_rt[i] = hdif*hdif * htmp_rt      - 4.0/rtz/rtz * rtz_rt
+				    + hdif*2.0* htmp * (-ho_rt);
+			
+		}
 
 //---- whitfield's minor additional compressibility correction
-      double fm = 1.0 + 0.014*msq;
-      hs     = ( hs + 0.028*msq) / fm;
-      hs_hk  = ( hs_hk          ) / fm;
-      hs_rt  = ( hs_rt          ) / fm;
-      hs_msq = 0.028/fm - 0.014*(hs)/fm;
-
-      return true;
-      
+		fm = 1.0 + 0.014*msq[i];
+		hs[i]     = ( hs[i] + 0.028*msq[i]) / fm;
+		hs_hk[i]  = ( hs_hk[i]            ) / fm;
+		hs_rt[i]  = ( hs_rt[i]            ) / fm;
+		hs_msq[i] = 0.028/fm - 0.014*(hs[i])/fm;
+	}
 }
 
 bool XFoil::iblpan()
@@ -3247,23 +3660,70 @@ bool XFoil::iblsys()
 //     corresponding to each bl station.
 //---------------------------------------------
 
-	int iv = 0;
-	for (int is=1; is<=2;is++){
-		for (int ibl=2; ibl<= nbl[is]; ibl++){
-			iv = iv+1;
-			isys[ibl][is] = iv;
-		}
-	}
-	
-	nsys = iv;
-	if(nsys>2*IVX) {
-//		AfxMessageBox("*** iblsys: bl system array overflow. ***", MB_ICONSTOP | MB_OK);
+	int iv = 0;
+	for (int is=1; is<=2;is++){
+		for (int ibl=2; ibl<= nbl[is]; ibl++){
+			iv = iv+1;
+			isys[ibl][is] = iv;
+		}
+	}
+	
+	nsys = iv;
+	if(nsys>2*IVX) {
+//		AfxMessageBox("*** iblsys: bl system array overflow. ***", MB_ICONSTOP | MB_OK);
+		CString str;
+		str.Format("*** iblsys: bl system array overflow. ***");
+		if(m_bTrace)pXFile->WriteString(str);
+		return false;
+	}
+	
+	return true;
+}
+
+
+bool XFoil::AllocateMatrices()
+{
+//---------------------------------------------------
+//     sizes the influence matrices and the bl newton system
+//     to the current number of panel nodes n.
+//     the wake has n/8+2 nodes, as set in xywake, and the
+//     bl system has one line per bl station, i.e. n+nw lines.
+//     the matrices are only re-allocated if n has changed,
+//     in which case their previous contents are lost.
+//---------------------------------------------------
+	int k, nq, nz, nwk;
+
+	nwk = min(n/8 + 2, IWX);
+	nq  = n + 7;//qdes uses columns up to n+6
+	nz  = n + nwk + 6;
+
+	if(aij.m_pData && aij.m_nRows==nq && dij.m_nRows==nz) return true;
+
+	lqaij = false;
+	ladij = false;
+	lwdij = false;
+
+	bool bOK = true;
+	bOK = bOK && q.Allocate(nq, nq);
+	bOK = bOK && aij.Allocate(nq, nq);
+	bOK = bOK && bij.Allocate(nq, nz);
+	bOK = bOK && dij.Allocate(nz, nz);
+	bOK = bOK && cij.Allocate(nwk+2, nq);
+	for (k=1; k<=3; k++) bOK = bOK && vm[k].Allocate(nz, nz);
+
+	if(!bOK)
+	{
+		q.Release();
+		aij.Release();
+		bij.Release();
+		dij.Release();
+		cij.Release();
+		for (k=1; k<=3; k++) vm[k].Release();
 		CString str;
-		str.Format("*** iblsys: bl system array overflow. ***");
-		if(m_bTrace)pXFile->WriteString(str);
+		str.Format("XFoil: not enough memory for %d panel nodes\r\n", n);
+		if(pXFile) pXFile->WriteString(str);
 		return false;
 	}
-	
 	return true;
 }
 
@@ -3281,18 +3741,15 @@ bool XFoil::Initialize()
 	dtor = pi/180.0;
 
 	n=0;// arcds : so that current airfoil is not initialized
+	AllocateMatrices();// releases the matrices of the previous airfoil
 
 	memset(aijpiv, 0, sizeof(aijpiv));
 	memset(apanel, 0, sizeof(apanel));
 	memset(blsav, 0, sizeof(blsav));
-	memset(aij, 0, sizeof(aij));
-	memset(bij, 0, sizeof(bij));
-	memset(cij, 0, sizeof(cij));
 	memset(cpi, 0, sizeof(cpi));
 	memset(cpv, 0, sizeof(cpv));
 	memset(ctau, 0, sizeof(ctau));
 	memset(ctq, 0, sizeof(ctq));
-	memset(dij, 0, sizeof(dij));
 	memset(dis, 0, sizeof(dis));
 	memset(dq, 0, sizeof(dq));
 	memset(dqdg, 0, sizeof(dqdg));
@@ -3314,7 +3771,6 @@ bool XFoil::Initialize()
 	memset(gamu, 0, sizeof(gamu));
 	memset(gam, 0, sizeof(gam));
 	memset(gam_a, 0, sizeof(gam_a));
-	memset(q, 0, sizeof(q));
 	memset(qf0, 0, sizeof(qf0));
 	memset(qf1, 0, sizeof(qf1));
 	memset(qf2, 0, sizeof(qf2));
@@ -3347,7 +3803,6 @@ bool XFoil::Initialize()
 	memset(va, 0, sizeof(va));
 	memset(vb, 0, sizeof(vb));
 	memset(vdel, 0, sizeof(vdel));
-	memset(vm, 0, sizeof(vm));
 	memset(vs1, 0, sizeof(vs1));
 	memset(vs2, 0, sizeof(vs2));
 	memset(vsrez, 0, sizeof(vsrez));
@@ -3912,7 +4367,7 @@ bool XFoil::lefind(double &sle, double x[], double xp[],
 }
 
 
-bool XFoil::ludcmp(int n, double a[IQX][IQX], int indx[IQX])
+bool XFoil::ludcmp(int n, XFoilMatrix &a, int indx[IQX])
 {
 	//    *******************************************************
 	//    *                                                     *
@@ -3987,6 +4442,117 @@ bool XFoil::ludcmp(int n, double a[IQX][IQX], int indx[IQX])
 }
 
 
+// one column panel step of ludcmpBlock, shared between the threads by rows
+struct XFoilLUStep
+{
+	XFoilMatrix *pA;
+	int n, k0, k1;
+};
+
+
+static void LUTrailingRow(XFoilLUStep *pStep, int i)
+{
+	//---- a22 = a22 - l21.u12 for row i
+	XFoilMatrix &a = *pStep->pA;
+	double lij;
+	for(int t=pStep->k0; t<pStep->k1; t++){
+		lij = a[i][t];
+		if(lij!=0.0) RowAxpy(a[i], lij, a[t], pStep->k1, pStep->n);
+	}
+}
+
+
+static void LUTrailingTask(int iTask, int iWorker, void *pParam)
+{
+	XFoilLUStep *pStep = (XFoilLUStep*)pParam;
+	LUTrailingRow(pStep, pStep->k1+iTask);
+}
+
+
+bool XFoil::ludcmpBlock(int n, XFoilMatrix &a, int indx[])
+{
+	//-----------------------------------------------------------
+	//     same as ludcmp, with the same scaled partial pivoting,
+	//     but right-looking and by column panels of LUBLOCK width,
+	//     so that the update of the trailing sub-matrix runs along 
+	//     contiguous rows, and may be shared between threads.
+	//     the factors and indx are in the form expected by baksub.
+	//-----------------------------------------------------------
+	int i, j, k, p, k0, k1;
+	double vv[IQX];
+	double dum, aamax, lij;
+	XFoilLUStep Step;
+
+	if(n>=IQX) {
+		CString str;
+		str.Format("Stop ludcmpBlock: array overflow. Increase nvx");
+		if(m_bTrace)pXFile->WriteString(str);
+		return false;
+	}
+	
+	for (i=1; i<=n; i++){
+		aamax = 0.0;
+		for (j=1; j<=n; j++) aamax = max(abs(a[i][j]), aamax);
+		vv[i] = 1.0/aamax;
+	}
+
+	bool bMT = IsMultiThreaded();
+	Step.pA = &a;
+	Step.n  = n;
+
+	for(k0=1; k0<=n; k0+=LUBLOCK){
+		k1 = min(k0+LUBLOCK, n+1);
+
+		//---- factor the column panel k0..k1-1
+		for(j=k0; j<k1; j++){
+			p = j;
+			aamax = 0.0;
+			for (i=j; i<=n; i++){
+				dum = vv[i]*abs(a[i][j]);
+				if(dum>=aamax){
+					p = i;
+					aamax = dum;
+				}
+			}
+			if(p!=j){
+				for (k=1; k<=n; k++){
+					dum = a[p][k];
+					a[p][k] = a[j][k];
+					a[j][k] = dum;
+				}
+				vv[p] = vv[j];
+			}
+			indx[j] = p;
+
+			if(j!=n){
+				dum = 1.0/a[j][j];
+				for(i=j+1; i<=n; i++){
+					a[i][j] = a[i][j]*dum;
+					lij = a[i][j];
+					if(lij!=0.0) RowAxpy(a[i], lij, a[j], j+1, k1-1);
+				}
+			}
+		}
+		if(k1>n) break;
+
+		//---- u12 = l11^-1 . a12
+		for(j=k0; j<k1; j++){
+			for(i=j+1; i<k1; i++){
+				lij = a[i][j];
+				if(lij!=0.0) RowAxpy(a[i], lij, a[j], k1, n);
+			}
+		}
+
+		//---- a22 = a22 - l21.u12
+		Step.k0 = k0;
+		Step.k1 = k1;
+		if(bMT) CTaskPool::Run(n-k1+1, LUTrailingTask, &Step, m_nWorkers);
+		else for(i=k1; i<=n; i++) LUTrailingRow(&Step, i);
+	}
+	return true;
+}
+
+
 bool XFoil::mhinge()
 {
 	//----------------------------------------------------
@@ -5376,6 +5942,8 @@ stop25:
 	lipan = false;
 	lblini = false;
 	lvconv = false;
+
+	AllocateMatrices();
 	
 	if(lbflap) {
 		xof = xbf;
@@ -5473,13 +6041,58 @@ bool XFoil::Preprocess(){
 
 
 
+void XFoil::InitPsiSens(XFoilPsiSens &S)
+{
+	// points S to the member vectors, and starts from the member scalars
+	S.dzdg = dzdg;
+	S.dzdn = dzdn;
+	S.dqdg = dqdg;
+	S.dzdm = dzdm;
+	S.dqdm = dqdm;
+	S.qtan1   = qtan1;
+	S.qtan2   = qtan2;
+	S.sigte   = sigte;
+	S.gamte   = gamte;
+	S.z_qinf  = z_qinf;
+	S.z_alfa  = z_alfa;
+	S.z_qdof0 = z_qdof0;
+	S.z_qdof1 = z_qdof1;
+	S.z_qdof2 = z_qdof2;
+	S.z_qdof3 = z_qdof3;
+}
+
+
 bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi, 
 				   double &psi, double &psi_ni, bool geolin, bool siglin){
+	//---- serial version : the results are returned in the member variables
+	XFoilPsiSens S;
+	InitPsiSens(S);
+	cosa = cos(alfa);
+	sina = sin(alfa);
+
+	bool bRes = psilin(i, xi, yi, nxi, nyi, psi, psi_ni, geolin, siglin, S);
+
+	qtan1   = S.qtan1;
+	qtan2   = S.qtan2;
+	sigte   = S.sigte;
+	gamte   = S.gamte;
+	z_qinf  = S.z_qinf;
+	z_alfa  = S.z_alfa;
+	z_qdof0 = S.z_qdof0;
+	z_qdof1 = S.z_qdof1;
+	z_qdof2 = S.z_qdof2;
+	z_qdof3 = S.z_qdof3;
+	return bRes;
+}
+
+
+bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi, 
+				   double &psi, double &psi_ni, bool geolin, bool siglin, XFoilPsiSens &S){
 	//-----------------------------------------------------------------------
 	//	   calculates current streamfunction psi at panel node or wake node
 	//	   i due to freestream and all bound vorticity gam on the airfoil. 
-	//	   sensitivities of psi with respect to alpha (z_alfa) and inverse
-	//	   qspec dofs (z_qdof0,z_qdof1) which influence gam in inverse cases.
+	//	   sensitivities of psi with respect to alpha (S.z_alfa) and inverse
+	//	   qspec dofs (S.z_qdof0,S.z_qdof1) which influence gam in inverse cases.
 	//	   also calculates the sensitivity vector dpsi/dgam (dzdg).
 	//
 	//	   if siglin=true, then psi includes the effects of the viscous
@@ -5499,8 +6112,12 @@ bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi,
 	int io,jo,jm,jq;
 	io = i;
 	
-	cosa = cos(alfa);
-	sina = sin(alfa);
+	//---- this version only writes to S, so that the rows of the influence
+	//     matrices may be built concurrently; hence the local variables
+	//     below which hide the members of the same name
+	double cosa = cos(alfa);
+	double sina = sin(alfa);
+	double x1, x2, t1, t2;
 
 	double dxinv,psum;
 	double qtanm;
@@ -5537,28 +6154,28 @@ bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi,
 
 
 	for (jo=1;jo<= n;jo++){
-		dzdg[jo] = 0.0;
-		dzdn[jo] = 0.0;
-		dqdg[jo] = 0.0;
+		S.dzdg[jo] = 0.0;
+		S.dzdn[jo] = 0.0;
+		S.dqdg[jo] = 0.0;
 	}
 	
 	for (jo=1;jo<= n;jo++){
-		dzdm[jo] = 0.0;
-		dqdm[jo] = 0.0;
+		S.dzdm[jo] = 0.0;
+		S.dqdm[jo] = 0.0;
 	}
 	
-	z_qinf = 0.0;
-	z_alfa = 0.0;
-	z_qdof0 = 0.0;
-	z_qdof1 = 0.0;
-	z_qdof2 = 0.0;
-	z_qdof3 = 0.0;
+	S.z_qinf = 0.0;
+	S.z_alfa = 0.0;
+	S.z_qdof0 = 0.0;
+	S.z_qdof1 = 0.0;
+	S.z_qdof2 = 0.0;
+	S.z_qdof3 = 0.0;
 	
 	psi  = 0.0;
 	psi_ni = 0.0;
 	
-	qtan1 = 0.0;
-	qtan2 = 0.0;
+	S.qtan1 = 0.0;
+	S.qtan2 = 0.0;
 	qtanm = 0.0;
 	
 	if(sharp){
@@ -5694,9 +6311,9 @@ bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi,
 			psi = psi + qopi*(psum*ssum + pdif*sdif);
 			
 			//------- dpsi/dm
-			dzdm[jm] = dzdm[jm] + qopi*(-psum*dsim + pdif*dsim);
-			dzdm[jo] = dzdm[jo] + qopi*(-psum*dsio - pdif*dsio);
-			dzdm[jp] = dzdm[jp] + qopi*( psum*(dsio+dsim) + pdif*(dsio-dsim));
+			S.dzdm[jm] = S.dzdm[jm] + qopi*(-psum*dsim + pdif*dsim);
+			S.dzdm[jo] = S.dzdm[jo] + qopi*(-psum*dsio - pdif*dsio);
+			S.dzdm[jp] = S.dzdm[jp] + qopi*( psum*(dsio+dsim) + pdif*(dsio-dsim));
 			
 			//------- dpsi/dni
 			psni = psx1*x1i + psx0*(x1i+x2i)*0.5 + psyy*yyi;
@@ -5705,9 +6322,9 @@ bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi,
 			
 			qtanm = qtanm + qopi*(psni*ssum + pdni*sdif);
 			
-			dqdm[jm] = dqdm[jm] + qopi*(-psni*dsim + pdni*dsim);
-			dqdm[jo] = dqdm[jo] + qopi*(-psni*dsio - pdni*dsio);
-			dqdm[jp] = dqdm[jp] + qopi*( psni*(dsio+dsim)+ pdni*(dsio-dsim));
+			S.dqdm[jm] = S.dqdm[jm] + qopi*(-psni*dsim + pdni*dsim);
+			S.dqdm[jo] = S.dqdm[jo] + qopi*(-psni*dsio - pdni*dsio);
+			S.dqdm[jp] = S.dqdm[jp] + qopi*( psni*(dsio+dsim)+ pdni*(dsio-dsim));
 			
 			
 			//------- calculate source contribution to psi	for  0-2  half-panel
@@ -5737,9 +6354,9 @@ bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi,
 			psi = psi + qopi*(psum*ssum + pdif*sdif);
 			
 			//------- dpsi/dm
-			dzdm[jo] = dzdm[jo] + qopi*(-psum*(dsip+dsio)- pdif*(dsip-dsio));
-			dzdm[jp] = dzdm[jp] + qopi*( psum*dsio - pdif*dsio);
-			dzdm[jq] = dzdm[jq] + qopi*( psum*dsip + pdif*dsip);
+			S.dzdm[jo] = S.dzdm[jo] + qopi*(-psum*(dsip+dsio)- pdif*(dsip-dsio));
+			S.dzdm[jp] = S.dzdm[jp] + qopi*( psum*dsio - pdif*dsio);
+			S.dzdm[jq] = S.dzdm[jq] + qopi*( psum*dsip + pdif*dsip);
 			
 			//------- dpsi/dni
 			psni = psx0*(x1i+x2i)*0.5 + psx2*x2i + psyy*yyi;
@@ -5748,9 +6365,9 @@ bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi,
 			
 			qtanm = qtanm + qopi*(psni*ssum + pdni*sdif);
 			
-			dqdm[jo] = dqdm[jo] + qopi*(-psni*(dsip+dsio)- pdni*(dsip-dsio));
-			dqdm[jp] = dqdm[jp] + qopi*( psni*dsio - pdni*dsio);
-			dqdm[jq] = dqdm[jq] + qopi*( psni*dsip + pdni*dsip);
+			S.dqdm[jo] = S.dqdm[jo] + qopi*(-psni*(dsip+dsio)- pdni*(dsip-dsio));
+			S.dqdm[jp] = S.dqdm[jp] + qopi*( psni*dsio - pdni*dsio);
+			S.dqdm[jq] = S.dqdm[jq] + qopi*( psni*dsip + pdni*dsip);
 			
 		}
 		
@@ -5778,35 +6395,35 @@ bool XFoil::psilin(int i, double xi, double yi, double nxi, double nyi,
 		psi = psi + qopi*(psis*gsum + psid*gdif);
 		
 		//------ dpsi/dgam
-		dzdg[jo] = dzdg[jo] + qopi*(psis-psid);
-		dzdg[jp] = dzdg[jp] + qopi*(psis+psid);
+		S.dzdg[jo] = S.dzdg[jo] + qopi*(psis-psid);
+		S.dzdg[jp] = S.dzdg[jp] + qopi*(psis+psid);
 		
 		//------ dpsi/dni
 		psni = psx1*x1i + psx2*x2i + psyy*yyi;
 		pdni = pdx1*x1i + pdx2*x2i + pdyy*yyi;
 		psi_ni = psi_ni + qopi*(gsum*psni + gdif*pdni);
 		
-		qtan1 = qtan1 + qopi*(gsum1*psni + gdif1*pdni);
-		qtan2 = qtan2 + qopi*(gsum2*psni + gdif2*pdni);
+		S.qtan1 = S.qtan1 + qopi*(gsum1*psni + gdif1*pdni);
+		S.qtan2 = S.qtan2 + qopi*(gsum2*psni + gdif2*pdni);
 		
-		dqdg[jo] = dqdg[jo] + qopi*(psni - pdni);
-		dqdg[jp] = dqdg[jp] + qopi*(psni + pdni);
+		S.dqdg[jo] = S.dqdg[jo] + qopi*(psni - pdni);
+		S.dqdg[jp] = S.dqdg[jp] + qopi*(psni + pdni);
 		
 		if(geolin) {
 			
 			//------- dpsi/dn
-			dzdn[jo] = dzdn[jo]+ qopi*gsum*(psx1*x1o + psx2*x2o + psyy*yyo)
+			S.dzdn[jo] = S.dzdn[jo]+ qopi*gsum*(psx1*x1o + psx2*x2o + psyy*yyo)
 				+ qopi*gdif*(pdx1*x1o + pdx2*x2o + pdyy*yyo);
-			dzdn[jp] = dzdn[jp]+ qopi*gsum*(psx1*x1p + psx2*x2p + psyy*yyp)
+			S.dzdn[jp] = S.dzdn[jp]+ qopi*gsum*(psx1*x1p + psx2*x2p + psyy*yyp)
 				+ qopi*gdif*(pdx1*x1p + pdx2*x2p + pdyy*yyp);
 			//------- dpsi/dp
-			z_qdof0 = z_qdof0
+			S.z_qdof0 = S.z_qdof0
 				+ qopi*((psis-psid)*qf0[jo] + (psis+psid)*qf0[jp]);
-			z_qdof1 = z_qdof1
+			S.z_qdof1 = S.z_qdof1
 				+ qopi*((psis-psid)*qf1[jo] + (psis+psid)*qf1[jp]);
-			z_qdof2 = z_qdof2
+			S.z_qdof2 = S.z_qdof2
 				+ qopi*((psis-psid)*qf2[jo] + (psis+psid)*qf2[jp]);
-			z_qdof3 = z_qdof3
+			S.z_qdof3 = S.z_qdof3
 				+ qopi*((psis-psid)*qf3[jo] + (psis+psid)*qf3[jp]);
 		}
 stop10:
@@ -5834,46 +6451,46 @@ stop11:
 	gamte1 = -.5*sds*(gamu[jp][1] - gamu[jo][1]);
 	gamte2 = -.5*sds*(gamu[jp][2] - gamu[jo][2]);
 	
-	sigte = 0.5*scs*(gam[jp] - gam[jo]);
-	gamte = -.5*sds*(gam[jp] - gam[jo]);
+	S.sigte = 0.5*scs*(gam[jp] - gam[jo]);
+	S.gamte = -.5*sds*(gam[jp] - gam[jo]);
 	
 	//---- te panel contribution to psi
-	psi = psi + hopi*(psig*sigte + pgam*gamte);
+	psi = psi + hopi*(psig*S.sigte + pgam*S.gamte);
 	
 	//---- dpsi/dgam
-	dzdg[jo] = dzdg[jo] - hopi*psig*scs*0.5;
-	dzdg[jp] = dzdg[jp] + hopi*psig*scs*0.5;
+	S.dzdg[jo] = S.dzdg[jo] - hopi*psig*scs*0.5;
+	S.dzdg[jp] = S.dzdg[jp] + hopi*psig*scs*0.5;
 	
-	dzdg[jo] = dzdg[jo] + hopi*pgam*sds*0.5;
-	dzdg[jp] = dzdg[jp] - hopi*pgam*sds*0.5;
+	S.dzdg[jo] = S.dzdg[jo] + hopi*pgam*sds*0.5;
+	S.dzdg[jp] = S.dzdg[jp] - hopi*pgam*sds*0.5;
 	
 	//---- dpsi/dni
-	psi_ni = psi_ni + hopi*(psigni*sigte + pgamni*gamte);
+	psi_ni = psi_ni + hopi*(psigni*S.sigte + pgamni*S.gamte);
 	
-	qtan1 = qtan1 + hopi*(psigni*sigte1 + pgamni*gamte1);
-	qtan2 = qtan2 + hopi*(psigni*sigte2 + pgamni*gamte2);
+	S.qtan1 = S.qtan1 + hopi*(psigni*sigte1 + pgamni*gamte1);
+	S.qtan2 = S.qtan2 + hopi*(psigni*sigte2 + pgamni*gamte2);
 	
-	dqdg[jo] = dqdg[jo] - hopi*(psigni*0.5*scs - pgamni*0.5*sds);
-	dqdg[jp] = dqdg[jp] + hopi*(psigni*0.5*scs - pgamni*0.5*sds);
+	S.dqdg[jo] = S.dqdg[jo] - hopi*(psigni*0.5*scs - pgamni*0.5*sds);
+	S.dqdg[jp] = S.dqdg[jp] + hopi*(psigni*0.5*scs - pgamni*0.5*sds);
 	
 	if(geolin){
 		
 		//----- dpsi/dn
-		dzdn[jo] = dzdn[jo]
-			+ hopi*(psigx1*x1o + psigx2*x2o + psigyy*yyo)*sigte
-			+ hopi*(pgamx1*x1o + pgamx2*x2o + pgamyy*yyo)*gamte;
-		dzdn[jp] = dzdn[jp]
-			+ hopi*(psigx1*x1p + psigx2*x2p + psigyy*yyp)*sigte
-			+ hopi*(pgamx1*x1p + pgamx2*x2p + pgamyy*yyp)*gamte;
+		S.dzdn[jo] = S.dzdn[jo]
+			+ hopi*(psigx1*x1o + psigx2*x2o + psigyy*yyo)*S.sigte
+			+ hopi*(pgamx1*x1o + pgamx2*x2o + pgamyy*yyo)*S.gamte;
+		S.dzdn[jp] = S.dzdn[jp]
+			+ hopi*(psigx1*x1p + psigx2*x2p + psigyy*yyp)*S.sigte
+			+ hopi*(pgamx1*x1p + pgamx2*x2p + pgamyy*yyp)*S.gamte;
 		
 		//----- dpsi/dp
-		z_qdof0 = z_qdof0 + hopi*psig*0.5*(qf0[jp]-qf0[jo])*scs
+		S.z_qdof0 = S.z_qdof0 + hopi*psig*0.5*(qf0[jp]-qf0[jo])*scs
 			- hopi*pgam*0.5*(qf0[jp]-qf0[jo])*sds;
-		z_qdof1 = z_qdof1 + hopi*psig*0.5*(qf1[jp]-qf1[jo])*scs
+		S.z_qdof1 = S.z_qdof1 + hopi*psig*0.5*(qf1[jp]-qf1[jo])*scs
 			- hopi*pgam*0.5*(qf1[jp]-qf1[jo])*sds;
-		z_qdof2 = z_qdof2 + hopi*psig*0.5*(qf2[jp]-qf2[jo])*scs
+		S.z_qdof2 = S.z_qdof2 + hopi*psig*0.5*(qf2[jp]-qf2[jo])*scs
 			- hopi*pgam*0.5*(qf2[jp]-qf2[jo])*sds;
-		z_qdof3 = z_qdof3 + hopi*psig*0.5*(qf3[jp]-qf3[jo])*scs
+		S.z_qdof3 = S.z_qdof3 + hopi*psig*0.5*(qf3[jp]-qf3[jo])*scs
 			- hopi*pgam*0.5*(qf3[jp]-qf3[jo])*sds;
 		
 	}   
@@ -5885,14 +6502,14 @@ stop12:
 	//---- dpsi/dn
 	psi_ni = psi_ni + qinf*(cosa*nyi - sina*nxi);
 	
-	qtan1 = qtan1 + qinf*nyi;
-	qtan2 = qtan2 - qinf*nxi;
+	S.qtan1 = S.qtan1 + qinf*nyi;
+	S.qtan2 = S.qtan2 - qinf*nxi;
 	
 	//---- dpsi/dqinf
-	z_qinf = z_qinf + (cosa*yi - sina*xi);
+	S.z_qinf = S.z_qinf + (cosa*yi - sina*xi);
 	
 	//---- dpsi/dalfa
-	z_alfa = z_alfa - qinf*(sina*yi + cosa*xi);
+	S.z_alfa = S.z_alfa - qinf*(sina*yi + cosa*xi);
 	
 	if(!limage)
 		return false;
@@ -6015,9 +6632,9 @@ stop12:
 			psi = psi + qopi*(psum*ssum + pdif*sdif);
 			
 			//------- dpsi/dm
-			dzdm[jm] = dzdm[jm] + qopi*(-psum*dsim + pdif*dsim);
-			dzdm[jo] = dzdm[jo] + qopi*(-psum*dsio - pdif*dsio);
-			dzdm[jp] = dzdm[jp] + qopi*( psum*(dsio+dsim)+ pdif*(dsio-dsim));
+			S.dzdm[jm] = S.dzdm[jm] + qopi*(-psum*dsim + pdif*dsim);
+			S.dzdm[jo] = S.dzdm[jo] + qopi*(-psum*dsio - pdif*dsio);
+			S.dzdm[jp] = S.dzdm[jp] + qopi*( psum*(dsio+dsim)+ pdif*(dsio-dsim));
 			
 			//------- dpsi/dni
 			psni = psx1*x1i + psx0*(x1i+x2i)*0.5+ psyy*yyi;
@@ -6026,9 +6643,9 @@ stop12:
 			
 			qtanm = qtanm + qopi*(psni*ssum + pdni*sdif);
 			
-			dqdm[jm] = dqdm[jm] + qopi*(-psni*dsim + pdni*dsim);
-			dqdm[jo] = dqdm[jo] + qopi*(-psni*dsio - pdni*dsio);
-			dqdm[jp] = dqdm[jp] + qopi*( psni*(dsio+dsim)+ pdni*(dsio-dsim));
+			S.dqdm[jm] = S.dqdm[jm] + qopi*(-psni*dsim + pdni*dsim);
+			S.dqdm[jo] = S.dqdm[jo] + qopi*(-psni*dsio - pdni*dsio);
+			S.dqdm[jp] = S.dqdm[jp] + qopi*( psni*(dsio+dsim)+ pdni*(dsio-dsim));
 			
 			//------- calculate source contribution to psi	for  0-2  half-panel
 			dxinv = 1.0/(x0-x2);
@@ -6058,9 +6675,9 @@ stop12:
 			psi = psi + qopi*(psum*ssum + pdif*sdif);
 			
 			//------- dpsi/dm
-			dzdm[jo] = dzdm[jo] + qopi*(-psum*(dsip+dsio)- pdif*(dsip-dsio));
-			dzdm[jp] = dzdm[jp] + qopi*( psum*dsio - pdif*dsio);
-			dzdm[jq] = dzdm[jq] + qopi*( psum*dsip + pdif*dsip);
+			S.dzdm[jo] = S.dzdm[jo] + qopi*(-psum*(dsip+dsio)- pdif*(dsip-dsio));
+			S.dzdm[jp] = S.dzdm[jp] + qopi*( psum*dsio - pdif*dsio);
+			S.dzdm[jq] = S.dzdm[jq] + qopi*( psum*dsip + pdif*dsip);
 			
 			//------- dpsi/dni
 			psni = psx0*(x1i+x2i)*0.5 + psx2*x2i + psyy*yyi;
@@ -6069,9 +6686,9 @@ stop12:
 			
 			qtanm = qtanm + qopi*(psni*ssum + pdni*sdif);
 			
-			dqdm[jo] = dqdm[jo] + qopi*(-psni*(dsip+dsio)- pdni*(dsip-dsio));
-			dqdm[jp] = dqdm[jp] + qopi*( psni*dsio - pdni*dsio);
-			dqdm[jq] = dqdm[jq] + qopi*( psni*dsip + pdni*dsip);
+			S.dqdm[jo] = S.dqdm[jo] + qopi*(-psni*(dsip+dsio)- pdni*(dsip-dsio));
+			S.dqdm[jp] = S.dqdm[jp] + qopi*( psni*dsio - pdni*dsio);
+			S.dqdm[jq] = S.dqdm[jq] + qopi*( psni*dsip + pdni*dsip);
 			
 		}
 		
@@ -6101,32 +6718,32 @@ stop12:
 		psi = psi - qopi*(psis*gsum + psid*gdif);
 		
 		//------ dpsi/dgam
-		dzdg[jo] = dzdg[jo] - qopi*(psis-psid);
-		dzdg[jp] = dzdg[jp] - qopi*(psis+psid);
+		S.dzdg[jo] = S.dzdg[jo] - qopi*(psis-psid);
+		S.dzdg[jp] = S.dzdg[jp] - qopi*(psis+psid);
 		
 		//------ dpsi/dni
 		psni = psx1*x1i + psx2*x2i + psyy*yyi;
 		pdni = pdx1*x1i + pdx2*x2i + pdyy*yyi;
 		psi_ni = psi_ni - qopi*(gsum*psni + gdif*pdni);
 		
-		qtan1 = qtan1 - qopi*(gsum1*psni + gdif1*pdni);
-		qtan2 = qtan2 - qopi*(gsum2*psni + gdif2*pdni);
+		S.qtan1 = S.qtan1 - qopi*(gsum1*psni + gdif1*pdni);
+		S.qtan2 = S.qtan2 - qopi*(gsum2*psni + gdif2*pdni);
 		
-		dqdg[jo] = dqdg[jo] - qopi*(psni - pdni);
-		dqdg[jp] = dqdg[jp] - qopi*(psni + pdni);
+		S.dqdg[jo] = S.dqdg[jo] - qopi*(psni - pdni);
+		S.dqdg[jp] = S.dqdg[jp] - qopi*(psni + pdni);
 		
 		if(geolin) {
 			
 			//------- dpsi/dn
-			dzdn[jo] = dzdn[jo]- qopi*gsum*(psx1*x1o + psx2*x2o + psyy*yyo)
+			S.dzdn[jo] = S.dzdn[jo]- qopi*gsum*(psx1*x1o + psx2*x2o + psyy*yyo)
 				- qopi*gdif*(pdx1*x1o + pdx2*x2o + pdyy*yyo);
-			dzdn[jp] = dzdn[jp]- qopi*gsum*(psx1*x1p + psx2*x2p + psyy*yyp)
+			S.dzdn[jp] = S.dzdn[jp]- qopi*gsum*(psx1*x1p + psx2*x2p + psyy*yyp)
 				- qopi*gdif*(pdx1*x1p + pdx2*x2p + pdyy*yyp);
 			//------- dpsi/dp
-			z_qdof0 = z_qdof0- qopi*((psis-psid)*qf0[jo] + (psis+psid)*qf0[jp]);
-			z_qdof1 = z_qdof1- qopi*((psis-psid)*qf1[jo] + (psis+psid)*qf1[jp]);
-			z_qdof2 = z_qdof2- qopi*((psis-psid)*qf2[jo] + (psis+psid)*qf2[jp]);
-			z_qdof3 = z_qdof3- qopi*((psis-psid)*qf3[jo] + (psis+psid)*qf3[jp]);
+			S.z_qdof0 = S.z_qdof0- qopi*((psis-psid)*qf0[jo] + (psis+psid)*qf0[jp]);
+			S.z_qdof1 = S.z_qdof1- qopi*((psis-psid)*qf1[jo] + (psis+psid)*qf1[jp]);
+			S.z_qdof2 = S.z_qdof2- qopi*((psis-psid)*qf2[jo] + (psis+psid)*qf2[jp]);
+			S.z_qdof3 = S.z_qdof3- qopi*((psis-psid)*qf3[jo] + (psis+psid)*qf3[jp]);
 		}
 stop20:
 		int nothing;
@@ -6152,46 +6769,46 @@ stop21:
 	gamte1 = -.5*sds*(gamu[jp][1] - gamu[jo][1]);
 	gamte2 = -.5*sds*(gamu[jp][2] - gamu[jo][2]);
 	
-	sigte = 0.5*scs*(gam[jp] - gam[jo]);
-	gamte = -.5*sds*(gam[jp] - gam[jo]);
+	S.sigte = 0.5*scs*(gam[jp] - gam[jo]);
+	S.gamte = -.5*sds*(gam[jp] - gam[jo]);
 	
 	//---- te panel contribution to psi
-	psi = psi + hopi*(psig*sigte - pgam*gamte);
+	psi = psi + hopi*(psig*S.sigte - pgam*S.gamte);
 	
 	//---- dpsi/dgam
-	dzdg[jo] = dzdg[jo] - hopi*psig*scs*0.5;
-	dzdg[jp] = dzdg[jp] + hopi*psig*scs*0.5;
+	S.dzdg[jo] = S.dzdg[jo] - hopi*psig*scs*0.5;
+	S.dzdg[jp] = S.dzdg[jp] + hopi*psig*scs*0.5;
 	
-	dzdg[jo] = dzdg[jo] - hopi*pgam*sds*0.5;
-	dzdg[jp] = dzdg[jp] + hopi*pgam*sds*0.5;
+	S.dzdg[jo] = S.dzdg[jo] - hopi*pgam*sds*0.5;
+	S.dzdg[jp] = S.dzdg[jp] + hopi*pgam*sds*0.5;
 	
 	//---- dpsi/dni
-	psi_ni = psi_ni + hopi*(psigni*sigte - pgamni*gamte);
+	psi_ni = psi_ni + hopi*(psigni*S.sigte - pgamni*S.gamte);
 	
-	qtan1 = qtan1 + hopi*(psigni*sigte1 - pgamni*gamte1);
-	qtan2 = qtan2 + hopi*(psigni*sigte2 - pgamni*gamte2);
+	S.qtan1 = S.qtan1 + hopi*(psigni*sigte1 - pgamni*gamte1);
+	S.qtan2 = S.qtan2 + hopi*(psigni*sigte2 - pgamni*gamte2);
 	
-	dqdg[jo] = dqdg[jo] - hopi*(psigni*0.5*scs + pgamni*0.5*sds);
-	dqdg[jp] = dqdg[jp] + hopi*(psigni*0.5*scs + pgamni*0.5*sds);
+	S.dqdg[jo] = S.dqdg[jo] - hopi*(psigni*0.5*scs + pgamni*0.5*sds);
+	S.dqdg[jp] = S.dqdg[jp] + hopi*(psigni*0.5*scs + pgamni*0.5*sds);
 	
 	if(geolin) {
 		
 		//----- dpsi/dn
-		dzdn[jo] = dzdn[jo]
-			+ hopi*(psigx1*x1o + psigx2*x2o + psigyy*yyo)*sigte
-			- hopi*(pgamx1*x1o + pgamx2*x2o + pgamyy*yyo)*gamte;
-		dzdn[jp] = dzdn[jp]
-			+ hopi*(psigx1*x1p + psigx2*x2p + psigyy*yyp)*sigte
-			- hopi*(pgamx1*x1p + pgamx2*x2p + pgamyy*yyp)*gamte;
+		S.dzdn[jo] = S.dzdn[jo]
+			+ hopi*(psigx1*x1o + psigx2*x2o + psigyy*yyo)*S.sigte
+			- hopi*(pgamx1*x1o + pgamx2*x2o + pgamyy*yyo)*S.gamte;
+		S.dzdn[jp] = S.dzdn[jp]
+			+ hopi*(psigx1*x1p + psigx2*x2p + psigyy*yyp)*S.sigte
+			- hopi*(pgamx1*x1p + pgamx2*x2p + pgamyy*yyp)*S.gamte;
 		
 		//----- dpsi/dp
-		z_qdof0 = z_qdof0 + hopi*psig*0.5*(qf0[jp]-qf0[jo])*scs
+		S.z_qdof0 = S.z_qdof0 + hopi*psig*0.5*(qf0[jp]-qf0[jo])*scs
 			+ hopi*pgam*0.5*(qf0[jp]-qf0[jo])*sds;
-		z_qdof1 = z_qdof1 + hopi*psig*0.5*(qf1[jp]-qf1[jo])*scs
+		S.z_qdof1 = S.z_qdof1 + hopi*psig*0.5*(qf1[jp]-qf1[jo])*scs
 			+ hopi*pgam*0.5*(qf1[jp]-qf1[jo])*sds;
-		z_qdof2 = z_qdof2 + hopi*psig*0.5*(qf2[jp]-qf2[jo])*scs
+		S.z_qdof2 = S.z_qdof2 + hopi*psig*0.5*(qf2[jp]-qf2[jo])*scs
 			+ hopi*pgam*0.5*(qf2[jp]-qf2[jo])*sds;
-		z_qdof3 = z_qdof3 + hopi*psig*0.5*(qf3[jp]-qf3[jo])*scs
+		S.z_qdof3 = S.z_qdof3 + hopi*psig*0.5*(qf3[jp]-qf3[jo])*scs
 			+ hopi*pgam*0.5*(qf3[jp]-qf3[jo])*sds;
 		
 
@@ -6202,6 +6819,17 @@ stop22:
 
 bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi, 
 				   double &psi, double &psi_ni){
+	//---- serial version : the results are returned in the member variables
+	XFoilPsiSens S;
+	InitPsiSens(S);
+	cosa = cos(alfa);
+	sina = sin(alfa);
+	return pswlin(i, xi, yi, nxi, nyi, psi, psi_ni, S);
+}
+
+
+bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi, 
+				   double &psi, double &psi_ni, XFoilPsiSens &S){
 	//--------------------------------------------------------------------
 	//	   calculates current streamfunction psi and tangential velocity
 	//	   qtan at panel node or wake node i due to freestream and wake
@@ -6222,13 +6850,10 @@ bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi,
 	int io,jo;
 	io = i;
 	
-	cosa = cos(alfa);
-	sina = sin(alfa);
-
 	
 	for(jo=n+1;jo<= n+nw;jo++){
-		dzdm[jo] = 0.0;
-		dqdm[jo] = 0.0;
+		S.dzdm[jo] = 0.0;
+		S.dqdm[jo] = 0.0;
 	}
 	
 	psi	 = 0.0;
@@ -6329,18 +6954,18 @@ bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi,
 		psi = psi + qopi*(psum*ssum + pdif*sdif);
 		
 		//------- dpsi/dm
-		dzdm[jm] = dzdm[jm] + qopi*(-psum*dsim + pdif*dsim);
-		dzdm[jo] = dzdm[jo] + qopi*(-psum*dsio - pdif*dsio);
-		dzdm[jp] = dzdm[jp] + qopi*( psum*(dsio+dsim) + pdif*(dsio-dsim));
+		S.dzdm[jm] = S.dzdm[jm] + qopi*(-psum*dsim + pdif*dsim);
+		S.dzdm[jo] = S.dzdm[jo] + qopi*(-psum*dsio - pdif*dsio);
+		S.dzdm[jp] = S.dzdm[jp] + qopi*( psum*(dsio+dsim) + pdif*(dsio-dsim));
 		
 		//------- dpsi/dni
 		psni = psx1*x1i + psx0*(x1i+x2i)*0.5+ psyy*yyi;
 		pdni = pdx1*x1i + pdx0*(x1i+x2i)*0.5+ pdyy*yyi;
 		psi_ni = psi_ni + qopi*(psni*ssum + pdni*sdif);
 		
-		dqdm[jm] = dqdm[jm] + qopi*(-psni*dsim + pdni*dsim);
-		dqdm[jo] = dqdm[jo] + qopi*(-psni*dsio - pdni*dsio);
-		dqdm[jp] = dqdm[jp] + qopi*( psni*(dsio+dsim)+ pdni*(dsio-dsim));
+		S.dqdm[jm] = S.dqdm[jm] + qopi*(-psni*dsim + pdni*dsim);
+		S.dqdm[jo] = S.dqdm[jo] + qopi*(-psni*dsio - pdni*dsio);
+		S.dqdm[jp] = S.dqdm[jp] + qopi*( psni*(dsio+dsim)+ pdni*(dsio-dsim));
 		
 		
 		//------- calculate source contribution to psi	for  0-2  half-panel
@@ -6370,18 +6995,18 @@ bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi,
 		psi = psi + qopi*(psum*ssum + pdif*sdif);
 		
 		//------- dpsi/dm
-		dzdm[jo] = dzdm[jo] + qopi*(-psum*(dsip+dsio)- pdif*(dsip-dsio));
-		dzdm[jp] = dzdm[jp] + qopi*( psum*dsio - pdif*dsio);
-		dzdm[jq] = dzdm[jq] + qopi*( psum*dsip + pdif*dsip);
+		S.dzdm[jo] = S.dzdm[jo] + qopi*(-psum*(dsip+dsio)- pdif*(dsip-dsio));
+		S.dzdm[jp] = S.dzdm[jp] + qopi*( psum*dsio - pdif*dsio);
+		S.dzdm[jq] = S.dzdm[jq] + qopi*( psum*dsip + pdif*dsip);
 		
 		//------- dpsi/dni
 		psni = psx0*(x1i+x2i)*0.5+ psx2*x2i + psyy*yyi;
 		pdni = pdx0*(x1i+x2i)*0.5+ pdx2*x2i + pdyy*yyi;
 		psi_ni = psi_ni + qopi*(psni*ssum + pdni*sdif);
 		
-		dqdm[jo] = dqdm[jo] + qopi*(-psni*(dsip+dsio)- pdni*(dsip-dsio));
-		dqdm[jp] = dqdm[jp] + qopi*( psni*dsio - pdni*dsio);
-		dqdm[jq] = dqdm[jq] + qopi*( psni*dsip + pdni*dsip);
+		S.dqdm[jo] = S.dqdm[jo] + qopi*(-psni*(dsip+dsio)- pdni*(dsip-dsio));
+		S.dqdm[jp] = S.dqdm[jp] + qopi*( psni*dsio - pdni*dsio);
+		S.dqdm[jq] = S.dqdm[jq] + qopi*( psni*dsip + pdni*dsip);
 		
 	}
 
@@ -6392,41 +7017,35 @@ bool XFoil::qdcalc(){
 	//-----------------------------------------------------
 	//	   calculates source panel influence coefficient
 	//	   matrix for current airfoil and wake geometry.
+	//     the rows and columns are independent, and are
+	//     calculated concurrently for the larger panel counts
 	//-----------------------------------------------------
-	int i,j,k, iu;
-	double psi, psi_n, sum;
-	double bbb[IQX];
+	int i,j;
+	bool bMT;
+	XFoilPsiSens S;
+
+	if(!AllocateMatrices()) return false;
 	
 	//TRACE("calculating source influence matrix ...\n");
 	CString str;
 	str.Format(" Calculating source influence matrix ...\r\n");
 	if(m_bTrace)pXFile->WriteString(str);
 
+	bMT = IsMultiThreaded();
+	InitPsiSens(S);
 
 	if(!ladij) {
 		//----- calculate source influence matrix for airfoil surface if it doesn't exist
-		for (j=1; j<= n;j++){
-			
-			//------- multiply each dpsi/sig vector by inverse of factored dpsi/dgam matrix
-			for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//arcds : create a dummy array
-			baksub(n+1,aij,aijpiv,bbb);
-			for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
-			
-			//------- store resulting dgam/dsig = dqtan/dsig vector
-			for (i=1; i<= n;i++){
-				dij[i][j] = bij[i][j]; 	
-			}
-		}
+		//------- multiply each dpsi/sig vector by inverse of factored dpsi/dgam matrix
+		if(bMT) RunConcurrently(n, qdColumnTask);
+		else for (j=1; j<= n;j++) qdColumn(j);
 		ladij = true;
+		StoreFactorization();
 	}
 
 	//---- set up coefficient matrix of dpsi/dm on airfoil surface
-	for (i=1; i<= n;i++){
-		pswlin(i,x[i],y[i],nx[i],ny[i],psi,psi_n);
-		for (j=n+1; j<=n+nw;j++) {
-			bij[i][j] = -dzdm[j];
-		}
-	}
+	if(bMT) RunConcurrently(n, qdSurfaceRowTask);
+	else for (i=1; i<= n;i++) qdSurfaceRow(i, S);
 	
 	//---- set up kutta condition (no direct source influence)
 	for(j=n+1;j<= n+nw;j++) bij[n+1][j] = 0.0;
@@ -6437,60 +7056,13 @@ bool XFoil::qdcalc(){
 	
 	
 	//---- multiply by inverse of factored dpsi/dgam matrix
-	for(j=n+1;j<= n+nw;j++){
-//		baksub(iqx,n+1,aijpiv,j);
-		for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//arcds : create a dummy array
-		
-		baksub(n+1,aij,aijpiv,bbb);
-		for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
-	}
-	//---- set the source influence matrix for the wake sources
-	for(i=1;i<= n;i++){
-		for(j=n+1;j<= n+nw;j++) {
-			dij[i][j] = bij[i][j];
-		}
-	}
+	//---- and set the source influence matrix for the wake sources
+	if(bMT) RunConcurrently(nw, qdColumnTask);
+	else for(j=n+1;j<= n+nw;j++) qdColumn(j);
 	
 	//**** now we need to calculate the influence of sources on the wake velocities
-	
-	//---- calculate dqtan/dgam and dqtan/dsig at the wake points
-
-	for (i=n+1; i<= n+nw;i++){
-		int iw = i-n;
-		//------ airfoil contribution at wake panel node
-		psilin(i,x[i],y[i],nx[i],ny[i],psi,psi_n,false,true);
-		for(j=1; j<= n;j++) {
-			cij[iw][j] = dqdg[j];
-		}
-		for(j=1; j<= n;j++) {
-			dij[i][j] = dqdm[j];
-		}
-		//------ wake contribution
-		pswlin(i,x[i],y[i],nx[i],ny[i],psi,psi_n);
-		for(j=n+1;j<= n+nw;j++) {
-			dij[i][j] = dqdm[j];
-		}
-	}
-	
-	//---- add on effect of all sources on airfoil vorticity which effects wake qtan
-	for(i=n+1;i<= n+nw;i++){
-		int iw = i-n;
-		
-		//------ airfoil surface source contribution first
-		for(j=1;j<= n;j++){
-			sum = 0.0;
-			for (k=1;k<= n;k++) sum = sum + cij[iw][k]*dij[k][j];
-			dij[i][j] = dij[i][j] + sum;
-		}
-		
-		//------ wake source contribution next
-		for(j=n+1; j<= n+nw;j++){
-			sum = 0.0;
-			for(k=1;k<=n;k++) sum = sum + cij[iw][k]*bij[k][j];
-			dij[i][j] = dij[i][j] + sum;
-		}
-		
-	}
+	if(bMT) RunConcurrently(nw, qdWakeRowTask);
+	else for (i=n+1; i<= n+nw;i++) qdWakeRow(i, S);
 	
 	//---- make sure first wake point has same velocity as trailing edge
 	for(j=1;j<= n+nw;j++){
@@ -6503,6 +7075,98 @@ bool XFoil::qdcalc(){
 }
 
 
+void XFoil::qdColumn(int j)
+{
+	//---- multiplies the dpsi/dsig column j of bij by the inverse of the 
+	//     factored dpsi/dgam matrix, and stores the resulting dgam/dsig = dqtan/dsig 
+	//     vector in dij
+	int i, iu;
+	double bbb[IQX];
+
+	for (iu=0; iu<=n+1; iu++) bbb[iu] = bij[iu][j];//arcds : create a dummy array
+	baksub(n+1,aij,aijpiv,bbb);
+	for (iu=0; iu<=n+1; iu++) bij[iu][j] = bbb[iu];
+
+	for (i=1; i<= n;i++){
+		dij[i][j] = bij[i][j]; 	
+	}
+}
+
+
+void XFoil::qdSurfaceRow(int i, XFoilPsiSens &S)
+{
+	//---- sets the dpsi/dm of the wake sources on airfoil node i
+	int j;
+	double psi, psi_n;
+	pswlin(i,x[i],y[i],nx[i],ny[i],psi,psi_n,S);
+	for (j=n+1; j<=n+nw;j++) {
+		bij[i][j] = -S.dzdm[j];
+	}
+}
+
+
+void XFoil::qdWakeRow(int i, XFoilPsiSens &S)
+{
+	//---- calculates the row of dij for wake node i
+	int j, k, iw;
+	double psi, psi_n, sum;
+
+	iw = i-n;
+	//---- calculate dqtan/dgam and dqtan/dsig at the wake point
+	//------ airfoil contribution at wake panel node
+	psilin(i,x[i],y[i],nx[i],ny[i],psi,psi_n,false,true,S);
+	for(j=1; j<= n;j++) {
+		cij[iw][j] = S.dqdg[j];
+	}
+	for(j=1; j<= n;j++) {
+		dij[i][j] = S.dqdm[j];
+	}
+	//------ wake contribution
+	pswlin(i,x[i],y[i],nx[i],ny[i],psi,psi_n,S);
+	for(j=n+1;j<= n+nw;j++) {
+		dij[i][j] = S.dqdm[j];
+	}
+	
+	//---- add on effect of all sources on airfoil vorticity which effects wake qtan
+	//------ airfoil surface source contribution first
+	for(j=1;j<= n;j++){
+		sum = 0.0;
+		for (k=1;k<= n;k++) sum = sum + cij[iw][k]*dij[k][j];
+		dij[i][j] = dij[i][j] + sum;
+	}
+		
+	//------ wake source contribution next
+	for(j=n+1; j<= n+nw;j++){
+		sum = 0.0;
+		for(k=1;k<=n;k++) sum = sum + cij[iw][k]*bij[k][j];
+		dij[i][j] = dij[i][j] + sum;
+	}
+}
+
+
+void XFoil::qdColumnTask(int iTask, int iWorker, void *pParam)
+{
+	// the columns of the airfoil sources if ladij is not set yet, then those of the wake sources
+	XFoil *pXFoil = (XFoil*)pParam;
+	if(!pXFoil->ladij) pXFoil->qdColumn(iTask+1);
+	else               pXFoil->qdColumn(pXFoil->n+1+iTask);
+}
+
+
+void XFoil::qdSurfaceRowTask(int iTask, int iWorker, void *pParam)
+{
+	XFoil *pXFoil = (XFoil*)pParam;
+	pXFoil->qdSurfaceRow(iTask+1, pXFoil->m_pPsiWork[iWorker].S);
+}
+
+
+void XFoil::qdWakeRowTask(int iTask, int iWorker, void *pParam)
+{
+	XFoil *pXFoil = (XFoil*)pParam;
+	pXFoil->qdWakeRow(pXFoil->n+1+iTask, pXFoil->m_pPsiWork[iWorker].S);
+}
+
+
 bool XFoil::qiset(){
 	//-------------------------------------------------------
 	//    sets inviscid panel tangential velocity for
@@ -6977,6 +7641,8 @@ bool XFoil::setbl(){
 	double cte_cte1= 0.0;//added arcds
 	double cte_cte2= 0.0;//added arcds
 
+	if(!AllocateMatrices()) return false;
+
 	//---- set the cl used to define mach, reynolds numbers
 	if(lalfa) clmr = cl;
 	else  clmr = clspec;
@@ -7103,6 +7769,9 @@ bool XFoil::setbl(){
 		//---- set forced transition arc length position
 		xifset(is);
 		
+		//---- evaluate the closures of all the stations at once
+		SetClosures(is);
+
 		tran = false;
 		turb = false;
 		
@@ -7110,6 +7779,7 @@ bool XFoil::setbl(){
 		for(ibl=2;ibl<= nbl[is];ibl++){
 			
 			iv	= isys[ibl][is];
+			m_iClosure = ibl;
 			
 			simi = (ibl==2);
 			wake = (ibl>iblte[is]);
@@ -7236,7 +7906,7 @@ bool XFoil::setbl(){
 			//---- stuff bl system coefficients into main jacobian matrix
 			
 			for( jv=1; jv<= nsys;jv++){
-				vm[1][jv][iv] = vs1[1][3]*d1_m[jv] + vs1[1][4]*u1_m[jv]
+				vm[1][iv][jv] = vs1[1][3]*d1_m[jv] + vs1[1][4]*u1_m[jv]
 					+ vs2[1][3]*d2_m[jv] + vs2[1][4]*u2_m[jv]
 					+ (vs1[1][5] + vs2[1][5] + vsx[1])
 					*(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7263,7 +7933,7 @@ bool XFoil::setbl(){
 				*(xi_ule1*dule1 + xi_ule2*dule2);
 			
 			for(jv=1; jv<= nsys;jv++){
-				vm[2][jv][iv] = vs1[2][3]*d1_m[jv] + vs1[2][4]*u1_m[jv]
+				vm[2][iv][jv] = vs1[2][3]*d1_m[jv] + vs1[2][4]*u1_m[jv]
 					+ vs2[2][3]*d2_m[jv] + vs2[2][4]*u2_m[jv]
 					+ (vs1[2][5] + vs2[2][5] + vsx[2])
 					*(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7291,7 +7961,7 @@ bool XFoil::setbl(){
 
 			//memory overlap problem
 			for(jv=1; jv<= nsys;jv++){
-				vm[3][jv][iv] = vs1[3][3]*d1_m[jv] + vs1[3][4]*u1_m[jv]
+				vm[3][iv][jv] = vs1[3][3]*d1_m[jv] + vs1[3][4]*u1_m[jv]
 							  + vs2[3][3]*d2_m[jv] + vs2[3][4]*u2_m[jv]
 							  + (vs1[3][5] + vs2[3][5] + vsx[3])
 								*(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7407,10 +8077,157 @@ bool XFoil::setbl(){
 		
 		//---- next airfoil side
 	}
+	m_iClosure = 0;
 	return true;
 }
 
 
+void XFoil::SetClosures(int is)
+{
+//-------------------------------------------------------------
+//     evaluates the closure functions at all the stations of
+//     side is from the current bl variables, each function being
+//     called once over the range of laminar, turbulent and wake
+//     stations. blvar, blmid and axset use the results as long
+//     as the station's variables have not changed since.
+//-------------------------------------------------------------
+	XFoilClosures &C = m_Closures;
+	double lcf[IVX], lcf_hk[IVX], lcf_rt[IVX], lcf_msq[IVX];
+	double xsi, ami, cti, uei, thi, dsi, dswaki;
+	int ibl, k, k1, k2, n;
+
+	ami = 0.0;
+	cti = 0.0;
+
+	//---- primary and kinematic variables, as set for each station by setbl
+	for(ibl=2; ibl<=nbl[is]; ibl++){
+		xsi = xssi[ibl][is];
+		if(ibl<itran[is]) ami = ctau[ibl][is];
+		else              cti = ctau[ibl][is];
+		uei = uedg[ibl][is];
+		thi = thet[ibl][is];
+		dsi = mass[ibl][is]/uei;
+		if(ibl>iblte[is]) dswaki = wgap[ibl-iblte[is]];
+		else              dswaki = 0.0;
+
+		blprv(xsi,ami,cti,thi,dsi,dswaki,uei);
+		blkin();
+
+		//---- same limits as blvar
+		if(ibl>iblte[is]) {
+			C.ityp[ibl] = 3;
+			C.hk[ibl]   = max(hk2,1.00005);
+		}
+		else {
+			if(ibl>=itran[is]) C.ityp[ibl] = 2;
+			else               C.ityp[ibl] = 1;
+			C.hk[ibl] = max(hk2,1.05000);
+		}
+		C.rt[ibl]  = rt2;
+		C.msq[ibl] = m2;
+		C.th[ibl]  = t2;
+	}
+	//---- the first wake station is set by tesys from both te stations
+	if(iblte[is]+1<=nbl[is]) C.ityp[iblte[is]+1] = 0;
+
+	//---- midpoint variables, as set by blmid
+	for(ibl=2; ibl<=nbl[is]; ibl++){
+		if(ibl==2) k = ibl;// no "1" station at similarity
+		else       k = ibl-1;
+		C.hka[ibl] = 0.5*(C.hk[k]  + C.hk[ibl]);
+		C.rta[ibl] = 0.5*(C.rt[k]  + C.rt[ibl]);
+		C.ma[ibl]  = 0.5*(C.msq[k] + C.msq[ibl]);
+	}
+
+	//---- laminar stations
+	k1 = 2;
+	k2 = min(itran[is]-1, iblte[is]);
+	n  = k2-k1+1;
+	if(n>0){
+		hctBatch(n, C.hk+k1, C.msq+k1, C.hc+k1, C.hc_hk+k1, C.hc_msq+k1);
+		hslBatch(n, C.hk+k1, C.hs+k1, C.hs_hk+k1, C.hs_rt+k1, C.hs_msq+k1);
+		cflBatch(n, C.hk+k1, C.rt+k1, C.cf+k1, C.cf_hk+k1, C.cf_rt+k1, C.cf_msq+k1);
+		dilBatch(n, C.hk+k1, C.rt+k1, C.di+k1, C.di_hk+k1, C.di_rt+k1);
+		damplBatch(n, C.hk+k1, C.th+k1, C.rt+k1, C.ax+k1, C.ax_hk+k1, C.ax_th+k1, C.ax_rt+k1);
+		cflBatch(n, C.hka+k1, C.rta+k1, C.cfm+k1, C.cfm_hka+k1, C.cfm_rta+k1, C.cfm_ma+k1);
+	}
+
+	//---- turbulent stations, cf is limited by the laminar cf
+	k1 = max(itran[is], 2);
+	k2 = iblte[is];
+	n  = k2-k1+1;
+	if(n>0){
+		hctBatch(n, C.hk+k1, C.msq+k1, C.hc+k1, C.hc_hk+k1, C.hc_msq+k1);
+		hstBatch(n, C.hk+k1, C.rt+k1, C.msq+k1, C.hs+k1, C.hs_hk+k1, C.hs_rt+k1, C.hs_msq+k1);
+		cftBatch(n, C.hk+k1, C.rt+k1, C.msq+k1, C.cft+k1, C.cft_hk+k1, C.cft_rt+k1, C.cft_msq+k1);
+		cflBatch(n, C.hk+k1, C.rt+k1, lcf, lcf_hk, lcf_rt, lcf_msq);
+		dilBatch(n, C.hk+k1, C.rt+k1, C.di+k1, C.di_hk+k1, C.di_rt+k1);
+		for(k=0; k<n; k++){
+			if(lcf[k]>C.cft[k1+k]) {
+				C.cf[k1+k]     = lcf[k];
+				C.cf_hk[k1+k]  = lcf_hk[k];
+				C.cf_rt[k1+k]  = lcf_rt[k];
+				C.cf_msq[k1+k] = lcf_msq[k];
+			}
+			else {
+				C.cf[k1+k]     = C.cft[k1+k];
+				C.cf_hk[k1+k]  = C.cft_hk[k1+k];
+				C.cf_rt[k1+k]  = C.cft_rt[k1+k];
+				C.cf_msq[k1+k] = C.cft_msq[k1+k];
+			}
+		}
+
+		cftBatch(n, C.hka+k1, C.rta+k1, C.ma+k1, C.cfm+k1, C.cfm_hka+k1, C.cfm_rta+k1, C.cfm_ma+k1);
+		cflBatch(n, C.hka+k1, C.rta+k1, lcf, lcf_hk, lcf_rt, lcf_msq);
+		for(k=0; k<n; k++){
+			if(lcf[k]>C.cfm[k1+k]) {
+				C.cfm[k1+k]     = lcf[k];
+				C.cfm_hka[k1+k] = lcf_hk[k];
+				C.cfm_rta[k1+k] = lcf_rt[k];
+				C.cfm_ma[k1+k]  = lcf_msq[k];
+			}
+		}
+	}
+
+	//---- wake stations, no wall contribution
+	k1 = iblte[is]+1;
+	k2 = nbl[is];
+	n  = k2-k1+1;
+	if(n>0){
+		hctBatch(n, C.hk+k1, C.msq+k1, C.hc+k1, C.hc_hk+k1, C.hc_msq+k1);
+		hstBatch(n, C.hk+k1, C.rt+k1, C.msq+k1, C.hs+k1, C.hs_hk+k1, C.hs_rt+k1, C.hs_msq+k1);
+		dilwBatch(n, C.hk+k1, C.rt+k1, C.di+k1, C.di_hk+k1, C.di_rt+k1);
+	}
+}
+
+
+bool XFoil::IsBatchStation(int ityp)
+{
+	//---- true if SetClosures has evaluated the closures of the current "2" variables
+	int k = m_iClosure;
+	return k>0 && m_Closures.ityp[k]==ityp
+		&& m_Closures.hk[k]==hk2 && m_Closures.rt[k]==rt2 && m_Closures.msq[k]==m2;
+}
+
+
+bool XFoil::BatchDampl(double hk, double th, double rt,
+					   double &ax, double &ax_hk, double &ax_th, double &ax_rt)
+{
+	//---- looks for the amplification rate of the "1" or "2" station in the closures
+	XFoilClosures &C = m_Closures;
+	for(int k=m_iClosure; k>=2 && k>=m_iClosure-1; k--){
+		if(C.ityp[k]==1 && C.hk[k]==hk && C.th[k]==th && C.rt[k]==rt){
+			ax    = C.ax[k];
+			ax_hk = C.ax_hk[k];
+			ax_th = C.ax_th[k];
+			ax_rt = C.ax_rt[k];
+			return true;
+		}
+	}
+	return false;
+}
+
+
 void XFoil::scheck(double x[], double y[], int *n, double stol, bool *lchange){
 
 //-------------------------------------------------------------
@@ -9577,7 +10394,6 @@ bool XFoil::ViscousIter()
 
 //	Performs one iteration
 	double eps1 =0.0001;
-	CString str;
 
 
 	setbl();//	------ fill newton system for bl variables
@@ -9604,21 +10420,14 @@ bool XFoil::ViscousIter()
 	clcalc(xcmref,ycmref);
 	cdcalc();
 	
-	//	------ display changes and test for convergence
-	if(rlx<1.0) str.Format("     rms:%.2e   max:%.2e at %d %d   rlx:%.3f\r\n",rmsbl, rmxbl, imxbl,ismxbl,rlx);
-	else if(abs(rlx-1.0)<0.001) str.Format("     rms:%.2e  max:%.2e at %d %d \r\n", rmsbl, rmxbl,imxbl,ismxbl);
-	if(m_bTrace)pXFile->WriteString(str);
-
 	cdp = cd - cdf;
 
-	str.Format("     a=%.3f    cl=%.4f \r\n     cm=%.4f  cd=%.5f => cdf=%.5f cdp=%.5f\r\n\r\n", alfa/dtor, cl, cm, cd, cdf, cdp);
-	if(m_bTrace)pXFile->WriteString(str);
+	//	------ display changes and test for convergence
+	if(m_bTrace) TraceIteration();
 
-	int pos = str.Find("QN",0);
-	if(pos>0){
+	if(IsDiverged()){
 		lvconv = false;
-		str.Format("--------UNCONVERGED----------\r\n\r\n");
-		if(m_bTrace)pXFile->WriteString(str);
+		if(m_bTrace && pXFile) pXFile->WriteString("--------UNCONVERGED----------\r\n\r\n");
 		return false;
 	}
 
@@ -9626,12 +10435,151 @@ bool XFoil::ViscousIter()
 		lvconv = true;
 		avisc = alfa;	
 		mvisc = minf;
-		str.Format("----------CONVERGED----------\r\n\r\n");
-		if(m_bTrace)pXFile->WriteString(str);
+		if(m_bTrace && pXFile) pXFile->WriteString("----------CONVERGED----------\r\n\r\n");
+	}
+	return true;
+}
+
+
+bool XFoil::IsDiverged()
+{
+	// the newton iteration has blown up if the residuals or the coefficients
+	// are no longer finite numbers
+	return !_finite(rmsbl) || !_finite(rmxbl) || !_finite(cl) || !_finite(cd) || !_finite(cm);
+}
+
+
+void XFoil::TraceIteration()
+{
+	// writes the residuals and the coefficients of the current iteration to the log file
+	if(!pXFile) return;
+
+	CString str;
+	if(rlx<1.0) str.Format("     rms:%.2e   max:%.2e at %d %d   rlx:%.3f\r\n",rmsbl, rmxbl, imxbl,ismxbl,rlx);
+	else if(abs(rlx-1.0)<0.001) str.Format("     rms:%.2e  max:%.2e at %d %d \r\n", rmsbl, rmxbl,imxbl,ismxbl);
+	else str.Empty();
+	pXFile->WriteString(str);
+
+	str.Format("     a=%.3f    cl=%.4f \r\n     cm=%.4f  cd=%.5f => cdf=%.5f cdp=%.5f\r\n\r\n", alfa/dtor, cl, cm, cd, cdf, cdp);
+	pXFile->WriteString(str);
+}
+
+
+void XFoil::GetBLState(XFoilBLState *pState)
+{
+	// copies the current boundary layer and its station pointers to pState
+	pState->alfa  = alfa;
+	pState->reinf = reinf1;
+	pState->minf  = minf1;
+	pState->acrit = acrit;
+	pState->n     = n;
+	memcpy(pState->x, x, sizeof(x));
+	memcpy(pState->y, y, sizeof(y));
+
+	pState->ist    = ist;
+	pState->nsys   = nsys;
+	pState->sst    = sst;
+	pState->sst_go = sst_go;
+	pState->sst_gp = sst_gp;
+	memcpy(pState->nbl,   nbl,   sizeof(nbl));
+	memcpy(pState->iblte, iblte, sizeof(iblte));
+	memcpy(pState->itran, itran, sizeof(itran));
+	memcpy(pState->ipan,  ipan,  sizeof(ipan));
+	memcpy(pState->isys,  isys,  sizeof(isys));
+	memcpy(pState->xssi,  xssi,  sizeof(xssi));
+	memcpy(pState->vti,   vti,   sizeof(vti));
+	memcpy(pState->uedg,  uedg,  sizeof(uedg));
+	memcpy(pState->thet,  thet,  sizeof(thet));
+	memcpy(pState->dstr,  dstr,  sizeof(dstr));
+	memcpy(pState->ctau,  ctau,  sizeof(ctau));
+	memcpy(pState->mass,  mass,  sizeof(mass));
+}
+
+
+void XFoil::SetBLState(XFoilBLState *pState)
+{
+	// restores a boundary layer saved with GetBLState as the initial guess of the next viscal()
+	// the caller must have checked that the paneling is the same
+	ist    = pState->ist;
+	nsys   = pState->nsys;
+	sst    = pState->sst;
+	sst_go = pState->sst_go;
+	sst_gp = pState->sst_gp;
+	memcpy(nbl,   pState->nbl,   sizeof(nbl));
+	memcpy(iblte, pState->iblte, sizeof(iblte));
+	memcpy(itran, pState->itran, sizeof(itran));
+	memcpy(ipan,  pState->ipan,  sizeof(ipan));
+	memcpy(isys,  pState->isys,  sizeof(isys));
+	memcpy(xssi,  pState->xssi,  sizeof(xssi));
+	memcpy(vti,   pState->vti,   sizeof(vti));
+	memcpy(uedg,  pState->uedg,  sizeof(uedg));
+	memcpy(thet,  pState->thet,  sizeof(thet));
+	memcpy(dstr,  pState->dstr,  sizeof(dstr));
+	memcpy(ctau,  pState->ctau,  sizeof(ctau));
+	memcpy(mass,  pState->mass,  sizeof(mass));
+
+	lipan  = true;
+	lblini = true;
+}
+
+
+bool XFoil::IsSamePaneling(XFoilBLState *pState)
+{
+	if(pState->n != n) return false;
+	return memcmp(pState->x+1, x+1, n*sizeof(double))==0 && memcmp(pState->y+1, y+1, n*sizeof(double))==0;
+}
+
+
+bool XFoil::GetFactorization()
+{
+	// sets aij, gamu and the airfoil part of bij and dij from the cache
+	// returns false if the current paneling has not been factored yet
+	if(!m_bFactorCache) return false;
+	s_FactorCache.Lock();
+	XFoilFactorization *pF = s_FactorCache.Find(n, qinf, x, y);
+	if(pF)
+	{
+		aij = pF->aij;
+		bij = pF->bij;
+		dij = pF->dij;
+		memcpy(aijpiv, pF->aijpiv, sizeof(aijpiv));
+		memcpy(gamu,   pF->gamu,   sizeof(gamu));
 	}
+	s_FactorCache.Unlock();
+	if(!pF) return false;
+
+	lqaij = true;
+	lgamu = true;
+	ladij = true;
+	lwdij = false;// the wake part of dij is not stored
 	return true;
 }
 
+
+void XFoil::StoreFactorization()
+{
+	// stores the factorization of the current paneling, once ggcalc and
+	// the airfoil part of qdcalc have been run
+	if(!m_bFactorCache || !lqaij || !lgamu || !ladij) return;
+
+	s_FactorCache.Lock();
+	if(!s_FactorCache.Find(n, qinf, x, y))
+	{
+		XFoilFactorization *pF = s_FactorCache.NewEntry();
+		pF->n    = n;
+		pF->qinf = qinf;
+		memcpy(pF->x, x, (n+1)*sizeof(double));
+		memcpy(pF->y, y, (n+1)*sizeof(double));
+		memcpy(pF->aijpiv, aijpiv, sizeof(aijpiv));
+		memcpy(pF->gamu,   gamu,   sizeof(gamu));
+		pF->aij = aij;
+		pF->bij = bij;
+		pF->dij = dij;
+	}
+	s_FactorCache.Unlock();
+}
+
+
 bool XFoil::xicalc(){
 	//-------------------------------------------------------------
 	//     sets bl arc length array on each airfoil side and wake
@@ -11865,6 +12813,9 @@ bool XFoil::mixed(int kqsp)
 	double res;
 	double dnmax, dgmax;
 	CString strong;
+
+	if(!AllocateMatrices()) return false;
+
 	//---- distance of internal control point ahead of sharp te
 	//    (fraction of smaller panel length adjacent to te)
 	bwt = 0.1;
@@ -30,6 +30,7 @@
 #include <math.h>
 #include <complex>
 #include "Foil.h"
+#include "../misc/TaskPool.h"
 
 using namespace std;
 	//------ derived dimensioning limit parameters
@@ -54,6 +55,119 @@ struct blData{
 };
 
 
+// A converged boundary layer, used to warm start the analysis of a neighbouring point
+// The bl arrays are only meaningful for the paneling they were computed with
+struct XFoilBLState
+{
+	double alfa, reinf, minf, acrit;	// the operating point
+	int n;								// the paneling
+	double x[IZX], y[IZX];
+
+	int ist, nsys, nbl[ISX], iblte[ISX], itran[3];
+	int ipan[IVX][ISX], isys[IVX][ISX];
+	double sst, sst_go, sst_gp;
+	double xssi[IVX][ISX], vti[IVX][ISX];
+	double uedg[IVX][ISX], thet[IVX][ISX], dstr[IVX][ISX], ctau[IVX][ISX], mass[IVX][ISX];
+};
+
+
+// The sensitivity vectors and scalars calculated by psilin and pswlin
+// The serial versions point to the members of the same names, while the
+// concurrent builds of the influence matrices give each thread its own vectors
+struct XFoilPsiSens
+{
+	double *dzdg, *dzdn, *dqdg, *dzdm, *dqdm;
+	double qtan1, qtan2, sigte, gamte;
+	double z_qinf, z_alfa, z_qdof0, z_qdof1, z_qdof2, z_qdof3;
+};
+
+// The vectors of one thread
+struct XFoilPsiWork
+{
+	double dzdg[IQX], dzdn[IQX], dqdg[IQX], dzdm[IZX], dqdm[IZX];
+	XFoilPsiSens S;
+};
+
+#define XFOILMTPANELS 120	// min number of panel nodes for which the inviscid matrices are built concurrently
+
+
+// The closure functions of the stations of one side, evaluated in a single pass
+// by setbl and indexed by ibl. blvar, blmid and axset use them in place of the
+// scalar closures when the current station and its variables match.
+struct XFoilClosures
+{
+	int ityp[IVX];			// the station's ityp, 0 if not evaluated
+	double hk[IVX], rt[IVX], msq[IVX], th[IVX];
+	double hc[IVX], hc_hk[IVX], hc_msq[IVX];
+	double hs[IVX], hs_hk[IVX], hs_rt[IVX], hs_msq[IVX];
+	double cf[IVX], cf_hk[IVX], cf_rt[IVX], cf_msq[IVX];		// after the laminar limit
+	double cft[IVX], cft_hk[IVX], cft_rt[IVX], cft_msq[IVX];	// turbulent wall contribution
+	double di[IVX], di_hk[IVX], di_rt[IVX];						// laminar, or laminar wake cd
+	double ax[IVX], ax_hk[IVX], ax_th[IVX], ax_rt[IVX];			// laminar stations only
+	double hka[IVX], rta[IVX], ma[IVX];							// midpoint with the previous station
+	double cfm[IVX], cfm_hka[IVX], cfm_rta[IVX], cfm_ma[IVX];
+};
+
+
+// A dense matrix, allocated on the heap in a single aligned buffer
+// Indexed as a[i][j] like the fixed size arrays of the Fortran code
+// Copies are deep, so that XFoil objects may be copied
+class XFoilMatrix
+{
+public:
+	XFoilMatrix();
+	XFoilMatrix(XFoilMatrix const &M);
+	~XFoilMatrix();
+	XFoilMatrix& operator=(XFoilMatrix const &M);
+	bool Allocate(int nRows, int nCols);
+	void Release();
+	double* operator[](int i) {return m_pData + i*m_Stride;}
+	double const* operator[](int i) const {return m_pData + i*m_Stride;}
+
+	int m_nRows, m_nCols;
+	int m_Stride;		// the row length, padded so that each row is aligned
+	double *m_pData;
+};
+
+
+
+// The inviscid factorization of a paneled foil : the lu-factored aij matrix,
+// the unit vorticity distributions for alpha=0,90 and the airfoil part of the
+// source influence matrices bij and dij. These depend only on the panel nodes.
+struct XFoilFactorization
+{
+	int n;
+	double qinf;
+	double x[IQX], y[IQX];
+	int aijpiv[IQX];
+	double gamu[IQX][ISX];
+	XFoilMatrix aij, bij, dij;
+};
+
+
+#define MAXFACTORIZATIONS 8	// max number of paneled foils kept in the factorization cache
+
+// A store of factorizations shared by all the XFoil objects, including the
+// copies made for the batch analysis. An entry is never modified once stored,
+// it is only replaced when the cache is full.
+class XFoilFactorCache
+{
+public:
+	XFoilFactorCache();
+	~XFoilFactorCache();
+	void Lock()   {EnterCriticalSection(&m_cs);}
+	void Unlock() {LeaveCriticalSection(&m_cs);}
+	XFoilFactorization* Find(int n, double qinf, double x[], double y[]);
+	XFoilFactorization* NewEntry();
+	void Clear();
+
+protected:
+	XFoilFactorization *m_pEntry[MAXFACTORIZATIONS];
+	int m_nEntries;
+	int m_iNext;	// the entry to replace next once the cache is full
+	CRITICAL_SECTION m_cs;
+};
+
 
 class XFoil  {
 	friend class CXInverse;
@@ -92,6 +206,7 @@ public:
 
 	CString m_FoilName;
 	bool m_bTrace;
+	bool m_bFactorCache;// false if this instance neither reads nor fills the shared factorization cache
 
 	bool lqspec, lsym,leiw,lqslop,lscini, lrecalc, lcnpl;
 	int nsp,nqsp,iacqsp;
@@ -191,6 +306,10 @@ public:
 	bool viscal();
 	bool ViscalEnd();
 	bool ViscousIter();
+	bool IsDiverged();
+	void GetBLState(XFoilBLState *pState);
+	void SetBLState(XFoilBLState *pState);
+	bool IsSamePaneling(XFoilBLState *pState);
 
 
 
@@ -228,8 +347,18 @@ public:
 	double angtol;
 	CStdioFile *pXFile;
 
+	int m_nWorkers;	// threads used to build the inviscid matrices, 0 = all the processors, 1 = serial
+	XFoilPsiWork *m_pPsiWork;	// one per thread during the concurrent builds, NULL otherwise
+	XFoilClosures m_Closures;	// the closures of the side being set up by setbl
+	int m_iClosure;				// the station being set up by setbl, 0 outside of setbl
+
+	static XFoilFactorCache s_FactorCache;
+
 protected:
 	double DeRotate();
+	void TraceIteration();
+	bool GetFactorization();
+	void StoreFactorization();
 
 //____________FUNCTION & METHODS___________________________________________________
 	bool aecalc(int n, double x[], double y[], double t[], int itype, double &area, 
@@ -240,7 +369,8 @@ protected:
 				double acrit, double &ax,
 				double &ax_hk1, double &ax_t1, double &ax_rt1, double &ax_a1,
 				double &ax_hk2, double &ax_t2, double &ax_rt2, double &ax_a2);
-	bool baksub(int n, double a[IQX][IQX],int indx[], double b[]);
+	bool AllocateMatrices();
+	bool baksub(int n, XFoilMatrix &a,int indx[], double b[]);
 	bool bldif(int ityp);
 	bool blkin();
 	bool blmid(int ityp);
@@ -252,17 +382,27 @@ protected:
 	bool cdcalc();
 	bool cfl(double hk, double rt, double &cf, double &cf_hk, double &cf_rt, double &cf_msq);
 	bool cft(double hk, double rt, double msq, double &cf, double &cf_hk, double &cf_rt, double &cf_msq);
+	static void cflBatch(int n, double const hk[], double const rt[],
+						 double cf[], double cf_hk[], double cf_rt[], double cf_msq[]);
+	static void cftBatch(int n, double const hk[], double const rt[], double const msq[],
+						 double cf[], double cf_hk[], double cf_rt[], double cf_msq[]);
 	bool clcalc(double xref, double yref);
 	bool cpcalc(int n, double q[], double qinf, double minf, double cp[]);
 	bool dampl(double hk, double th, double rt, 
 			   double &ax, double &ax_hk, double &ax_th, double &ax_rt);
 	bool dil(double hk, double rt, double &di, double &di_hk, double &di_rt);
 	bool dilw(double hk, double rt, double &di, double &di_hk, double &di_rt);
+	static void damplBatch(int n, double const hk[], double const th[], double const rt[],
+						   double ax[], double ax_hk[], double ax_th[], double ax_rt[]);
+	static void dilBatch(int n, double const hk[], double const rt[],
+						 double di[], double di_hk[], double di_rt[]);
+	static void dilwBatch(int n, double const hk[], double const rt[],
+						  double di[], double di_hk[], double di_rt[]);
 	bool dslim(double &dstr, double thet, double msq, double hklim);
 
 	bool gamqv();
 	bool Gauss(int nn, double z[][6], double r[5]);
-	bool Gauss(int nn, double z[IQX][IQX], double r[IQX]);
+	bool Gauss(int nn, XFoilMatrix &z, double r[IQX]);
 	bool geopar(double x[], double xp[], double y[], double yp[], double s[],
 			   int n, double t[], double &sle, double &chord,
 			   double &area, double &radle, double &angte,
@@ -282,17 +422,43 @@ protected:
 	bool hkin(double h, double msq, double &hk, double &hk_h, double &hk_msq);
 	bool hsl(double hk, double &hs, double &hs_hk, double &hs_rt, double &hs_msq);
 	bool hst(double hk, double rt, double msq, double &hs, double &hs_hk, double &hs_rt, double &hs_msq );
+	static void hctBatch(int n, double const hk[], double const msq[],
+						 double hc[], double hc_hk[], double hc_msq[]);
+	static void hkinBatch(int n, double const h[], double const msq[],
+						  double hk[], double hk_h[], double hk_msq[]);
+	static void hslBatch(int n, double const hk[],
+						 double hs[], double hs_hk[], double hs_rt[], double hs_msq[]);
+	static void hstBatch(int n, double const hk[], double const rt[], double const msq[],
+						 double hs[], double hs_hk[], double hs_rt[], double hs_msq[]);
+	void SetClosures(int is);
+	bool IsBatchStation(int ityp);
+	bool BatchDampl(double hk, double th, double rt,
+					double &ax, double &ax_hk, double &ax_th, double &ax_rt);
 	bool iblpan();
 	bool iblsys();
 	bool lefind(double &sle, double x[], double xp[], double y[], double yp[], double s[], int n);
 	void lerscl(double *x, double *xp, double* y, double *yp, double *s, int n, double doc, double rfac, double *xnew,double *ynew);
-	bool ludcmp(int n, double a[IQX][IQX],int indx[IQX]);
+	bool ludcmp(int n, XFoilMatrix &a,int indx[IQX]);
 	bool mhinge();
 	bool mrchdu();
 	bool mrchue();
 	bool ncalc(double x[], double y[], double s[], int n, double xn[], double yn[]);
 	bool psilin(int i, double xi,double yi,double nxi, double nyi, double &psi, double &psi_ni, bool geolin, bool siglin);
+	bool psilin(int i, double xi,double yi,double nxi, double nyi, double &psi, double &psi_ni, bool geolin, bool siglin, XFoilPsiSens &S);
 	bool pswlin(int i,double xi, double yi, double nxi, double nyi, double &psi, double &psi_ni);
+	bool pswlin(int i,double xi, double yi, double nxi, double nyi, double &psi, double &psi_ni, XFoilPsiSens &S);
+	void InitPsiSens(XFoilPsiSens &S);
+	bool IsMultiThreaded();
+	void ggRow(int i, XFoilPsiSens &S);
+	void qdSurfaceRow(int i, XFoilPsiSens &S);
+	void qdColumn(int j);
+	void qdWakeRow(int i, XFoilPsiSens &S);
+	bool ludcmpBlock(int n, XFoilMatrix &a, int indx[]);
+	void RunConcurrently(int nTasks, TASKPROC pTaskProc);
+	static void ggRowTask(int iTask, int iWorker, void *pParam);
+	static void qdSurfaceRowTask(int iTask, int iWorker, void *pParam);
+	static void qdColumnTask(int iTask, int iWorker, void *pParam);
+	static void qdWakeRowTask(int iTask, int iWorker, void *pParam);
 	bool qdcalc();
 	bool qiset();
 	bool qvfue();
@@ -406,11 +572,13 @@ private:
 //	double sigte_a,gamte_a;
 	double dste,aste;
 	double qinv[IZX],qvis[IZX],qinvu[IZX][3], qinv_a[IZX];
-	double q[IQX][IQX],dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
+	double dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
 	double dqdm[IZX],qtan1,qtan2,z_qinf,z_alfa,z_qdof0,z_qdof1,z_qdof2,z_qdof3;
-	double aij[IQX][IQX];
-	double bij[IQX][IZX],dij[IZX][IZX];
-	double cij[IWX][IQX];
+	// the influence matrices are sized to the number of panel nodes by AllocateMatrices()
+	XFoilMatrix q;
+	XFoilMatrix aij;
+	XFoilMatrix bij, dij;
+	XFoilMatrix cij;
 	double pi,hopi,qopi,dtor;
 
    
@@ -451,7 +619,8 @@ private:
 	double cfm, cfm_ms, cfm_re, cfm_u1, cfm_t1, cfm_d1, cfm_u2, cfm_t2, cfm_d2;
 	double xt, xt_a1, xt_ms, xt_re, xt_xf, xt_x1, xt_t1, xt_d1, xt_u1,
 		  xt_x2, xt_t2, xt_d2, xt_u2;
-	double va[4][3][IZX],vb[4][3][IZX],vdel[4][3][IZX],vm[4][IZX][IZX],vz[4][3];	
+	double va[4][3][IZX],vb[4][3][IZX],vdel[4][3][IZX],vz[4][3];	
+	XFoilMatrix vm[4];	// the bl newton system, vm[k][iv][jv], sized to the number of bl stations by AllocateMatrices()
  
 //	int ncpref, napol[9], npol, ipact, nlref, icolp[9],icolr[9],imatyp[9],iretyp[9], nxypol[9],npolref, ndref[4][9];
 //	double c1sav[74], c2sav[74];
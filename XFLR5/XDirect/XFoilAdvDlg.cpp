@@ -37,6 +37,10 @@ CXFoilAdvDlg::CXFoilAdvDlg(CWnd* pParent /*=NULL*/)
 	m_bAutoInitBL = true;
 	m_iIterLim    = 100;
 	m_fVAccel     = 0.01;
+	m_bAdaptiveAlpha = false;
+	m_AdaptiveDCl    = 0.1;
+	m_AdaptiveDCd    = 0.002;
+	m_bStallRecovery = true;
 }
 
 
@@ -47,6 +51,10 @@ void CXFoilAdvDlg::DoDataExchange(CDataExchange* pDX)
 	DDX_Control(pDX, IDC_ITERLIM, m_ctrlIterLim);
 	DDX_Control(pDX, IDC_INITBL, m_ctrlInitBL);
 	DDX_Control(pDX, IDC_VACCEL, m_ctrlVAccel);
+	DDX_Control(pDX, IDC_ADAPTIVEALPHA, m_ctrlAdaptiveAlpha);
+	DDX_Control(pDX, IDC_ADAPTIVEDCL, m_ctrlAdaptiveDCl);
+	DDX_Control(pDX, IDC_ADAPTIVEDCD, m_ctrlAdaptiveDCd);
+	DDX_Control(pDX, IDC_STALLRECOVERY, m_ctrlStallRecovery);
 	//}}AFX_DATA_MAP
 }
 
@@ -54,6 +62,7 @@ void CXFoilAdvDlg::DoDataExchange(CDataExchange* pDX)
 BEGIN_MESSAGE_MAP(CXFoilAdvDlg, CDialog)
 	//{{AFX_MSG_MAP(CXFoilAdvDlg)
 	ON_BN_CLICKED(IDC_INITBL, OnAutoInitBLs)
+	ON_BN_CLICKED(IDC_ADAPTIVEALPHA, OnAdaptiveAlpha)
 	//}}AFX_MSG_MAP
 END_MESSAGE_MAP()
 
@@ -69,6 +78,15 @@ BOOL CXFoilAdvDlg::OnInitDialog() {
 
 	if(m_bAutoInitBL) m_ctrlInitBL.SetCheck(1);
 
+	m_ctrlAdaptiveAlpha.SetCheck(m_bAdaptiveAlpha);
+	m_ctrlAdaptiveDCl.SetPrecision(3);
+	m_ctrlAdaptiveDCd.SetPrecision(4);
+	m_ctrlAdaptiveDCl.SetValue(m_AdaptiveDCl);
+	m_ctrlAdaptiveDCd.SetValue(m_AdaptiveDCd);
+	m_ctrlAdaptiveDCl.EnableWindow(m_bAdaptiveAlpha);
+	m_ctrlAdaptiveDCd.EnableWindow(m_bAdaptiveAlpha);
+	m_ctrlStallRecovery.SetCheck(m_bStallRecovery);
+
 	m_ctrlVAccel.SetFocus();
 	return FALSE;  // return TRUE unless you set the focus to a control
 	              // EXCEPTION: OCX Property Pages should return FALSE
@@ -78,6 +96,9 @@ void CXFoilAdvDlg::OnOK() {
 	// TODO: Add extra validation here
 	m_fVAccel  = m_ctrlVAccel.GetValue();
 	m_iIterLim = m_ctrlIterLim.GetValue();
+	m_AdaptiveDCl = max(m_ctrlAdaptiveDCl.GetValue(), 0.0);
+	m_AdaptiveDCd = max(m_ctrlAdaptiveDCd.GetValue(), 0.0);
+	m_bStallRecovery = (m_ctrlStallRecovery.GetCheck()!=0);
 	
 
 	CDialog::OnOK();
@@ -91,3 +112,12 @@ void CXFoilAdvDlg::OnAutoInitBLs()
 	else						m_bAutoInitBL = false;
 }
 
+
+void CXFoilAdvDlg::OnAdaptiveAlpha() 
+{
+	if(m_ctrlAdaptiveAlpha.GetCheck()) m_bAdaptiveAlpha = true;
+	else							   m_bAdaptiveAlpha = false;
+	m_ctrlAdaptiveDCl.EnableWindow(m_bAdaptiveAlpha);
+	m_ctrlAdaptiveDCd.EnableWindow(m_bAdaptiveAlpha);
+}
+
@@ -43,7 +43,11 @@ public:
 	CNumEdit	m_ctrlIterLim;
 
 	CButton	m_ctrlInitBL;
+	CButton	m_ctrlAdaptiveAlpha;
+	CButton	m_ctrlStallRecovery;
 	CFloatEdit	m_ctrlVAccel;
+	CFloatEdit	m_ctrlAdaptiveDCl;
+	CFloatEdit	m_ctrlAdaptiveDCd;
 	//}}AFX_DATA
 
 
@@ -59,6 +63,9 @@ protected:
 	int m_iIterLim;
 	double m_fVAccel;
 	bool m_bAutoInitBL;
+	bool m_bAdaptiveAlpha;
+	bool m_bStallRecovery;
+	double m_AdaptiveDCl, m_AdaptiveDCd;
 
 
 	// Generated message map functions
@@ -66,6 +73,7 @@ protected:
 	virtual BOOL OnInitDialog();
 	virtual void OnOK();
 	afx_msg void OnAutoInitBLs();
+	afx_msg void OnAdaptiveAlpha();
 	//}}AFX_MSG
 	DECLARE_MESSAGE_MAP()
 };
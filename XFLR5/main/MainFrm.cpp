@@ -3031,7 +3031,8 @@ void CMainFrame::SaveSettings()
 	else
 	{
 		CArchive ar(&fp, CArchive::store);
-		ar << 200416;
+		ar << 200417;
+			//200417 : added the far-field ratio for the 3D induced speeds
 			//100413 : Set default core radius to 1 micron
 			//100322 : corrected wake params
 			//100321 : added woperdlgbar properties
@@ -3121,7 +3122,7 @@ void CMainFrame::LoadSettings()
 			CArchive ar(&fp, CArchive::load);
 
 			ar >> ArchiveFormat;
-			if(ArchiveFormat!=200416)
+			if(ArchiveFormat!=200416 && ArchiveFormat!=200417)
 			{
 				ar.Close();
 				fp.Close();
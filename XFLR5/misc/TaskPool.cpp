@@ -0,0 +1,127 @@
+/****************************************************************************
+
+    CTaskPool Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+//////////////////////////////////////////////////////////////////////
+//
+// TaskPool.cpp: implementation of the CTaskPool class.
+// Runs a set of independent tasks on all the available processors
+// The tasks are not assigned in advance : each thread picks the next 
+// free task index as soon as it is done with the previous one, so that
+// expensive and cheap tasks balance out between the threads.
+// The calling thread takes part in the work as worker 0, so that it 
+// may keep on reporting progress to the dialog box.
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "../X-FLR5.h"
+#include ".\TaskPool.h"
+
+
+CTaskPool::CTaskPool()
+{
+	m_pTaskProc = NULL;
+	m_pParam    = NULL;
+	m_pbCancel  = NULL;
+	m_pPool     = NULL;
+	m_nTasks    = 0;
+	m_iWorker   = 0;
+	m_NextTask  = 0;
+	m_nDone     = 0;
+}
+
+
+int CTaskPool::GetProcessorCount()
+{
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	return max(1, (int)si.dwNumberOfProcessors);
+}
+
+
+int CTaskPool::Run(int nTasks, TASKPROC pTaskProc, void *pParam, int nWorkers, bool *pbCancel)
+{
+	// Runs the tasks 0 to nTasks-1 and returns when all are done, or cancelled
+	// nWorkers is the number of threads to use, including the calling thread
+	// if nWorkers=0, one thread per processor is used
+	// returns the number of tasks which have been run
+	CTaskPool Pool;
+	CTaskPool Worker[MAXWORKERS];
+	CWinThread *pThread[MAXWORKERS];
+	HANDLE hThread[MAXWORKERS];
+	int i, nThreads;
+
+	if(nTasks<=0) return 0;
+
+	if(nWorkers<=0) nWorkers = GetProcessorCount();
+	nWorkers = min(nWorkers, nTasks);
+	nWorkers = min(nWorkers, MAXWORKERS);
+
+	Pool.m_pTaskProc = pTaskProc;
+	Pool.m_pParam    = pParam;
+	Pool.m_pbCancel  = pbCancel;
+	Pool.m_nTasks    = nTasks;
+	Pool.m_NextTask  = 0;
+	Pool.m_nDone     = 0;
+
+	nThreads = 0;
+	for (i=1; i<nWorkers; i++)
+	{
+		Worker[i].m_pPool   = &Pool;
+		Worker[i].m_iWorker = i;
+		pThread[nThreads] = AfxBeginThread(WorkerProc, Worker+i, THREAD_PRIORITY_LOWEST, 0, CREATE_SUSPENDED);
+		if(!pThread[nThreads]) break;//run with what we have
+		pThread[nThreads]->m_bAutoDelete = false;
+		hThread[nThreads] = pThread[nThreads]->m_hThread;
+		pThread[nThreads]->ResumeThread();
+		nThreads++;
+	}
+
+	Pool.Work(0);
+
+	if(nThreads) WaitForMultipleObjects(nThreads, hThread, TRUE, INFINITE);
+	for (i=0; i<nThreads; i++) delete pThread[i];
+
+	return (int)Pool.m_nDone;
+}
+
+
+UINT CTaskPool::WorkerProc(LPVOID pParam)
+{
+	CTaskPool *pWorker = (CTaskPool*)pParam;
+	pWorker->m_pPool->Work(pWorker->m_iWorker);
+	return 0;
+}
+
+
+void CTaskPool::Work(int iWorker)
+{
+	int iTask;
+	while(true)
+	{
+		if(m_pbCancel && *m_pbCancel) break;
+		iTask = (int)InterlockedIncrement(&m_NextTask) - 1;
+		if(iTask>=m_nTasks) break;
+		m_pTaskProc(iTask, iWorker, m_pParam);
+		InterlockedIncrement(&m_nDone);
+	}
+}
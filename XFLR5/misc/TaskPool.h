@@ -0,0 +1,55 @@
+/****************************************************************************
+
+    CTaskPool Class
+	Copyright (C) 2008 Andr Deperrois xflr5@yahoo.com
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+// TaskPool.h: interface for the CTaskPool class.
+//
+//////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#define MAXWORKERS 64 //max number of threads launched by the pool
+
+// The task procedure is called once for each task index
+// iWorker is the index of the thread running the task, 0 being the calling thread
+typedef void (*TASKPROC)(int iTask, int iWorker, void *pParam);
+
+class CTaskPool  
+{
+public:
+	CTaskPool();
+	static int GetProcessorCount();
+	static int Run(int nTasks, TASKPROC pTaskProc, void *pParam, int nWorkers=0, bool *pbCancel=NULL);
+
+protected:
+	static UINT WorkerProc(LPVOID pParam);
+	void Work(int iWorker);
+
+	TASKPROC m_pTaskProc;
+	void *m_pParam;
+	bool *m_pbCancel;
+	int m_nTasks;
+	volatile LONG m_NextTask;
+	volatile LONG m_nDone;
+
+	CTaskPool *m_pPool;	// used by each worker thread to get back to the shared pool
+	int m_iWorker;
+};
@@ -133,6 +133,7 @@
 #define IDR_CTXBODYPOINTCTRLMENU        355
 #define IDR_CTXBODYCTRLMENU             356
 #define IDD_VIEWBITMAP                  362
+#define IDD_WPOLARBATCHDLG              367
 #define IDC_SHOWPRESSURE                1001
 #define IDC_REMAX                       1003
 #define IDC_REYNOLDS                    1004
@@ -734,6 +735,22 @@
 #define IDC_WTYPE6                      5235
 #define IDC_NEWFOILNAME                 5237
 #define IDC_BUTTON1                     5240
+#define IDC_FARFIELDTHETA               5241
+#define IDC_PANELCOST                   5242
+#define IDC_ADAPTIVEALPHA               5243
+#define IDC_ADAPTIVEDCL                 5244
+#define IDC_ADAPTIVEDCD                 5245
+#define IDC_STALLRECOVERY               5246
+#define IDC_ANDERSON                    5247
+#define IDC_JOBLIST                     5248
+#define IDC_MEMLIMIT                    5249
+#define IDC_QINFMIN                     5250
+#define IDC_QINFMAX                     5251
+#define IDC_DQINF                       5252
+#define IDC_CTRLMIN                     5253
+#define IDC_CTRLMAX                     5254
+#define IDC_DCTRL                       5255
+#define IDC_SOLVERBENCH                 5256
 #define IDM_LOADREFFOIL                 32772
 #define ID_EDIT_NEW                     32773
 #define IDM_DEFINEWING                  32777
@@ -1024,6 +1041,7 @@
 #define IDM_RECENTFILE4                 33270
 #define IDM_CPVIEW                      33272
 #define IDM_WADVSETTINGS                33274
+#define IDM_WBATCHANALYSIS              33350
 #define IDM_INSERTPOINT                 33278
 #define IDM_INSERTFRAME                 33279
 #define IDM_DELETEFRAME                 33280
@@ -1059,9 +1077,9 @@
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_3D_CONTROLS                     1
-#define _APS_NEXT_RESOURCE_VALUE        367
-#define _APS_NEXT_COMMAND_VALUE         33350
-#define _APS_NEXT_CONTROL_VALUE         5241
+#define _APS_NEXT_RESOURCE_VALUE        368
+#define _APS_NEXT_COMMAND_VALUE         33351
+#define _APS_NEXT_CONTROL_VALUE         5257
 #define _APS_NEXT_SYMED_VALUE           110
 #endif
 #endif
@@ -52,21 +52,27 @@
 #define MAXSTATIONS	      100 //max number of stations for LLT or VLM analysis
 #define MAXCHORDPANELS	   30
 //#define MAXVLMSURFACES     50 //2 * MAXPANELS
-#define VLMMATSIZE       2000
-#define VLMHALF          1000
+#define VLMHALF          1000 //max number of flap panels and flap nodes on a single surface
+#define LUBLOCK            48 //column panel width for the blocked LU factorization of the influence matrix
+#define LUBENCHSIZE      2000 //largest system of the solver benchmark, the former fixed matrix size VLMMATSIZE
+#define RHSBLOCK           20 //max number of operating points processed at once for each 3D analysis
+#define LLTHISTORY          5 //max number of past iterations used by the Anderson mixing of the LLT
+#define LLTRESGROWTH      2.0 //residual growth ratio which restarts the Anderson mixing of the LLT
+#define LLTMAXCOEF     1000.0 //max sum of the Anderson coefficients above which the mixed step is rejected
+#define WAKETOLERANCE  1.e-4 //wake node displacement, relative to the span, below which the wake is not updated
 #define MAXCONTROLS        10 //max controls per wing section
 #define SPLINECONTROLSIZE  50 //maximum number of control points
 #define MAXBODYFRAMES      30
 #define MAXSIDELINES       20
 
-#define IQX  302	//300 = number of surface panel nodes + 6
-#define IQX2 151	//IQX/2 added arcds
-#define IWX   50	// number of wake panel nodes
+#define IQX  606	//600 = number of surface panel nodes + 6, mixed inverse uses n+5
+#define IQX2 303	//IQX/2 added arcds
+#define IWX   80	// number of wake panel nodes, >= IQX/8+2
 #define IPX    6	//6 number of qspec[s] distributions
 #define ISX    3	//number of airfoil sides
-#define IBX  604	//600 number of buffer airfoil nodes = 2*IQX
-#define IZX  350	//350 = number of panel nodes [airfoil + wake]
-#define IVX  302	//300 = number of nodes along bl on one side of airfoil and wake
+#define IBX 1212	//1212 number of buffer airfoil nodes = 2*IQX
+#define IZX  686	//686 = number of panel nodes [airfoil + wake] = IQX+IWX
+#define IVX  606	//606 = number of nodes along bl on one side of airfoil and wake = IQX
 
 //----INVERSE
 #define ICX 257//   number of circle-plane points for complex mapping   ( 2^n  + 1 )